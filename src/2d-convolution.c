@@ -4,8 +4,14 @@
 
 #include<stdio.h>
 #include<stdlib.h>
+#include<math.h>
 #include "convolution/convolution-util.h"
 #include "convolution/convolution-run.h"
+#include "convolution/convolution-stream.h"
+#include "convolution/convolution-batch.h"
+#include "convolution/convolution-precision.h"
+#include "convolution/convolution-channels.h"
+#include "convolution/convolution-chain.h"
 
 #ifndef REPETITION
 #define REPETITION (10)
@@ -17,6 +23,57 @@
 void free_resources(Args *args, Image *kernel, ImageWithPadding *padded_img,
                     ImageWithPadding *padded_buffer, ImageWithPadding *backup);
 
+/**
+ * Run the benchmark with the streaming engine, the image is never loaded as a whole
+ *
+ * @return non - zero exit code indicates error.
+ */
+int run_streaming(Args *args, Image *kernel);
+
+/**
+ * Run the benchmark on a batch of images
+ *
+ * @return non - zero exit code indicates error.
+ */
+int run_batch_mode(Args *args, Image *kernel);
+
+/**
+ * Run the benchmark on an image with several channels and report the throughput per channel
+ *
+ * @return non - zero exit code indicates error.
+ */
+int run_channels(Args *args);
+
+/**
+ * Run the benchmark with a chain of kernels, every iteration applies all of them
+ *
+ * @param placement Placement of the threads, to report where the pages of the image reside
+ * @return non - zero exit code indicates error.
+ */
+int run_chain(Args *args, ThreadPlacement *placement);
+
+/**
+ * Report the estimated memory bandwidth and the nodes of the pages of the image if the first touch mode or
+ * pinning is used, see print_memory_locality(...).
+ * Every pass over the image reads the image and writes the buffer once.
+ *
+ * @param placement Placement of the threads that ran the benchmark
+ * @param padded_img Image of the benchmark
+ * @param passes Number of passes over the image
+ * @param time Time of the benchmark
+ */
+void report_bandwidth(Args *args, ThreadPlacement *placement, ImageWithPadding *padded_img, int passes, time_t time);
+
+/**
+ * Run the benchmark with an image of reduced precision and compare its checksum with the one of float64
+ *
+ * @param backup Image to restore before every run
+ * @param padded_img Image for the float64 reference
+ * @param padded_buffer Buffer for the float64 reference
+ */
+void run_precision(Args *args, Image *kernel, ImageWithPadding *backup, ImageWithPadding **padded_img,
+                   ImageWithPadding **padded_buffer, FILE *res, FILE *check);
+
 /**
  * Entry point of the program
  *
@@ -28,24 +85,50 @@ int main(int argc, char **argv) {
     // argument parsing
     pgmname = argv[0]; // for error messages
     Args *args = parse_args(argc, argv);
+    // the same team runs every parallel region, so the threads stay on their cores
+    ThreadPlacement *placement = pin_threads(args->pin_policy, args->number_of_processes);
     // parse args
+    if (args->channels > 1) {
+        // the kernel argument lists the kernels of the channels
+        int ret = run_channels(args);
+        free_thread_placement(placement);
+        free_args(args);
+        return ret;
+    }
+    if (args->number_of_kernels > 1) {
+        int ret = run_chain(args, placement);
+        free_thread_placement(placement);
+        free_args(args);
+        return ret;
+    }
     // allocate memory
-    Image *image = create_image(args);
     Image *kernel = create_kernel(args);
-    if (kernel == NULL || image == NULL) {
-        free_image(image);
+    if (kernel != NULL && (args->stream_band_rows > 0 || args->batch_path != NULL)) {
+        int ret = args->batch_path != NULL ? run_batch_mode(args, kernel) : run_streaming(args, kernel);
+        free_thread_placement(placement);
+        free_image(kernel);
+        free_args(args);
+        return ret;
+    }
+    // binary images are mapped straight into the padded layout of the backup, a virtual halo needs no padding
+    int padding = kernel != NULL && !args->virtual_halo ? kernel->width / 2 : 0;
+    ImageWithPadding *backup = kernel != NULL ? create_padded_image(args, padding) : NULL;
+    if (kernel == NULL || backup == NULL) {
+        free_padded_image(backup);
         free_image(kernel);
         free_args(args);
         bail_out("kernel or image could not be created");
     }
-    ImageWithPadding *padded_img = add_padding(image, kernel->width / 2);
-    ImageWithPadding *padded_buffer = add_padding(image, kernel->width / 2);
-    ImageWithPadding *backup = add_padding(image, kernel->width / 2);
+    // the image and the buffer are touched by the threads that compute their rows, the backup is only copied
+    int first_touch = args->numa_first_touch ? args->number_of_processes : 1;
+    ImageWithPadding *padded_img = init_padded_image_first_touch(backup->inner_width, backup->inner_height,
+                                                                 backup->padding, args->layout, first_touch);
+    ImageWithPadding *padded_buffer = init_padded_image_first_touch(backup->inner_width, backup->inner_height,
+                                                                    backup->padding, args->layout, first_touch);
 
-    free_image(image);
     // sanity check
     if (padded_img != NULL && padded_buffer != NULL && backup != NULL) {
-        int ret = copy_padded_image(padded_img, backup);
+        int ret = copy_padded_image(backup, padded_img);
         if (ret == -1) {
             free_resources(args, kernel, padded_img, padded_buffer, backup);
             bail_out("Could not backup image, something was NULL");
@@ -53,6 +136,8 @@ int main(int argc, char **argv) {
             free_resources(args, kernel, padded_img, padded_buffer, backup);
             bail_out("Could not backup image, extents were wrong");
         }
+        // the buffer starts as a copy of the image as well
+        copy_padded_image(backup, padded_buffer);
         // open benchmark files
         // TODO: make this definable by argument
         FILE *res = fopen("../2d-convolution.time.res", "a+");
@@ -61,7 +146,17 @@ int main(int argc, char **argv) {
             free_resources(args, kernel, padded_img, padded_buffer, backup);
             bail_out("Could not open benchmark output files");
         }
+        if (args->precision != PIXEL_FLOAT64) {
+            run_precision(args, kernel, backup, &padded_img, &padded_buffer, res, check);
+            fclose(check);
+            fclose(res);
+            free_thread_placement(placement);
+            free_resources(args, kernel, padded_img, padded_buffer, backup);
+            return 0;
+        }
         // start benchmarking
+        time_t last_t = 0;
+        double last_checksum = 0.0;
         for (int i = 0; i < REPETITION; ++i) {
             if (copy_padded_image(backup, padded_img) < 0) {
                 free_resources(args, kernel, padded_img, padded_buffer, backup);
@@ -69,13 +164,34 @@ int main(int argc, char **argv) {
             }
             time_t seq_t = benchmark(&padded_img, kernel, args, &padded_buffer);
 
-            append_convolution_csv(res, padded_img, args, seq_t);
+            append_convolution_csv(res, padded_img->inner_width, padded_img->inner_height, args, seq_t);
             // TODO: this is not optimal
             // could be reused
             Image *img = remove_padding(padded_img);
-            write_checksum_to(check, get_checksum(img));
+            last_t = seq_t;
+            last_checksum = get_checksum(img);
+            write_checksum_to(check, last_checksum);
             free_image(img);
         }
+        // temporal blocking advances several iterations per pass
+        int steps = args->temporal_steps > 1 ? args->temporal_steps : 1;
+        report_bandwidth(args, placement, padded_img, (args->number_of_iterations + steps - 1) / steps, last_t);
+        if (args->debug && args->temporal_steps > 1) {
+            // compare temporal blocking with one pass over the image per iteration
+            int temporal_steps = args->temporal_steps;
+            args->temporal_steps = 1;
+            if (copy_padded_image(backup, padded_img) < 0) {
+                free_resources(args, kernel, padded_img, padded_buffer, backup);
+                bail_out("Could not restore image, something must have been changed");
+            }
+            time_t reference_t = benchmark(&padded_img, kernel, args, &padded_buffer);
+            Image *img = remove_padding(padded_img);
+            double reference_checksum = get_checksum(img);
+            free_image(img);
+            args->temporal_steps = temporal_steps;
+            printf("Temporal blocking speedup: %.2fx, checksums %s\n", (double) reference_t / (double) last_t,
+                   reference_checksum == last_checksum ? "identical" : "differ");
+        }
         fflush(check);
         fflush(res);
         fclose(check);
@@ -85,14 +201,233 @@ int main(int argc, char **argv) {
         if (args->debug) {
             fprintf(stderr, "Memory could not be allocated\n");
         }
+        free_thread_placement(placement);
         free_resources(args, kernel, padded_img, padded_buffer, backup);
         return EXIT_FAILURE;
     }
     // free resources
+    free_thread_placement(placement);
     free_resources(args, kernel, padded_img, padded_buffer, backup);
     return 0;
 }
 
+void report_bandwidth(Args *args, ThreadPlacement *placement, ImageWithPadding *padded_img, int passes, time_t time) {
+    if (args->numa_first_touch || args->pin_policy != PIN_NONE) {
+        double bytes = 2.0 * sizeof(double) * (double) padded_img->width * padded_img->height * passes;
+        // the rows of the contiguous block are split among the threads like the rows of the benchmark
+        size_t size = padded_img->data != NULL ? sizeof(double) * padded_img->stride * padded_img->height : 0;
+        print_memory_locality(placement, padded_img->data, size, bytes, time);
+    }
+}
+
+void run_precision(Args *args, Image *kernel, ImageWithPadding *backup, ImageWithPadding **padded_img,
+                   ImageWithPadding **padded_buffer, FILE *res, FILE *check) {
+    time_t last_t = 0;
+    double last_checksum = 0.0;
+    for (int i = 0; i < REPETITION; ++i) {
+        TypedImage *img = convert_padded_image(backup, args->precision);
+        TypedImage *buffer = convert_padded_image(backup, args->precision);
+        last_t = typed_benchmark(&img, kernel, args, &buffer);
+        append_convolution_csv(res, img->inner_width, img->inner_height, args, last_t);
+        last_checksum = get_typed_checksum(img);
+        write_checksum_to(check, last_checksum);
+        free_typed_image(img);
+        free_typed_image(buffer);
+    }
+    // float64 reference of the same image and kernel
+    copy_padded_image(backup, *padded_img);
+    copy_padded_image(backup, *padded_buffer);
+    time_t reference_t = benchmark(padded_img, kernel, args, padded_buffer);
+    Image *reference = remove_padding(*padded_img);
+    double reference_checksum = get_checksum(reference);
+    free_image(reference);
+    double error = reference_checksum != 0.0 ? fabs(last_checksum - reference_checksum) / fabs(reference_checksum)
+                                             : fabs(last_checksum);
+    printf("Precision %s: checksum %f, float64 checksum %f, relative error %.3e, speedup %.2fx\n",
+           pixel_type_name(args->precision), last_checksum, reference_checksum, error,
+           last_t > 0 ? (double) reference_t / (double) last_t : 0.0);
+}
+
+int run_channels(Args *args) {
+    ChannelKernels *kernels = create_channel_kernels(args);
+    ChannelImage *backup = kernels != NULL ? create_channel_image(args, kernels->width / 2) : NULL;
+    if (kernels == NULL || backup == NULL) {
+        free_channel_kernels(kernels);
+        free_channel_image(backup);
+        free_args(args);
+        bail_out("kernels of the channels or image could not be created");
+    }
+    ChannelImage *img = init_channel_image(backup->inner_width, backup->inner_height, backup->channels,
+                                           backup->padding, backup->layout);
+    ChannelImage *buffer = init_channel_image(backup->inner_width, backup->inner_height, backup->channels,
+                                              backup->padding, backup->layout);
+    FILE *res = fopen("../2d-convolution.time.res", "a+");
+    FILE *check = fopen("../2d-convolution.res", "w+");
+    if (res == NULL || check == NULL) {
+        free_channel_kernels(kernels);
+        free_channel_image(backup);
+        free_channel_image(img);
+        free_channel_image(buffer);
+        if (args->debug) {
+            fprintf(stderr, "Could not open benchmark output files\n");
+        }
+        return EXIT_FAILURE;
+    }
+    time_t last_t = 0;
+    for (int i = 0; i < REPETITION; ++i) {
+        copy_channel_image(backup, img);
+        copy_channel_image(backup, buffer);
+        last_t = channel_benchmark(&img, kernels, args, &buffer);
+        append_convolution_csv(res, img->inner_width, img->inner_height, args, last_t);
+        double checksum = 0.0;
+        for (int c = 0; c < img->channels; ++c) {
+            checksum += get_channel_checksum(img, c);
+        }
+        write_checksum_to(check, checksum);
+    }
+    // all channels are computed in the same pass, each of them advanced every pixel in the measured time
+    double pixels = (double) img->inner_width * img->inner_height * args->number_of_iterations;
+    double seconds = (double) last_t / 1e6;
+    for (int c = 0; c < img->channels; ++c) {
+        printf("Channel %d: checksum %f, %.1f Mpixel/s\n", c, get_channel_checksum(img, c),
+               seconds > 0.0 ? pixels / seconds / 1e6 : 0.0);
+    }
+    printf("Channels %d %s: %.1f Mvalues/s\n", img->channels, channel_layout_name(img->layout),
+           seconds > 0.0 ? pixels * img->channels / seconds / 1e6 : 0.0);
+    fflush(check);
+    fflush(res);
+    fclose(check);
+    fclose(res);
+    free_channel_kernels(kernels);
+    free_channel_image(backup);
+    free_channel_image(img);
+    free_channel_image(buffer);
+    return 0;
+}
+
+int run_chain(Args *args, ThreadPlacement *placement) {
+    KernelChain *chain = create_kernel_chain(args);
+    ImageWithPadding *backup = chain != NULL ? create_padded_image(args, chain->padding) : NULL;
+    if (chain == NULL || backup == NULL) {
+        free_kernel_chain(chain);
+        free_padded_image(backup);
+        free_args(args);
+        bail_out("kernel or image could not be created");
+    }
+    int first_touch = args->numa_first_touch ? args->number_of_processes : 1;
+    ImageWithPadding *padded_img = init_padded_image_first_touch(backup->inner_width, backup->inner_height,
+                                                                 backup->padding, args->layout, first_touch);
+    ImageWithPadding *padded_buffer = init_padded_image_first_touch(backup->inner_width, backup->inner_height,
+                                                                    backup->padding, args->layout, first_touch);
+    plan_kernel_chain(chain, backup->inner_width, backup->inner_height);
+    if (args->debug) {
+        for (int g = 0; g < chain->groups; ++g) {
+            int first = chain->first_stage[g] + 1;
+            int last = chain->first_stage[g + 1];
+            if (last > first) {
+                printf("Stages %d to %d: fused\n", first, last);
+            } else {
+                printf("Stage %d: on its own\n", first);
+            }
+        }
+    }
+    FILE *res = fopen("../2d-convolution.time.res", "a+");
+    FILE *check = fopen("../2d-convolution.res", "w+");
+    if (res == NULL || check == NULL) {
+        free_kernel_chain(chain);
+        free_resources(args, NULL, padded_img, padded_buffer, backup);
+        bail_out("Could not open benchmark output files");
+    }
+    time_t last_t = 0;
+    double last_checksum = 0.0;
+    for (int i = 0; i < REPETITION; ++i) {
+        copy_padded_image(backup, padded_img);
+        last_t = chain_benchmark(&padded_img, chain, args, &padded_buffer);
+        append_convolution_csv(res, padded_img->inner_width, padded_img->inner_height, args, last_t);
+        Image *img = remove_padding(padded_img);
+        last_checksum = get_checksum(img);
+        write_checksum_to(check, last_checksum);
+        free_image(img);
+    }
+    // every group of stages is one pass over the image
+    report_bandwidth(args, placement, padded_img, args->number_of_iterations * chain->groups, last_t);
+    if (args->debug && chain->groups < chain->stages) {
+        // compare the fused groups with one pass over the image per stage
+        plan_kernel_chain(chain, 0, 0);
+        copy_padded_image(backup, padded_img);
+        time_t reference_t = chain_benchmark(&padded_img, chain, args, &padded_buffer);
+        Image *img = remove_padding(padded_img);
+        double reference_checksum = get_checksum(img);
+        free_image(img);
+        printf("Fusion speedup: %.2fx, checksums %s\n", (double) reference_t / (double) last_t,
+               reference_checksum == last_checksum ? "identical" : "differ");
+    }
+    fflush(check);
+    fflush(res);
+    fclose(check);
+    fclose(res);
+    free_kernel_chain(chain);
+    free_padded_image(padded_img);
+    free_padded_image(padded_buffer);
+    free_padded_image(backup);
+    return 0;
+}
+
+int run_streaming(Args *args, Image *kernel) {
+    FILE *res = fopen("../2d-convolution.time.res", "a+");
+    FILE *check = fopen("../2d-convolution.res", "w+");
+    if (res == NULL || check == NULL) {
+        if (args->debug) {
+            fprintf(stderr, "Could not open benchmark output files\n");
+        }
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < REPETITION; ++i) {
+        double checksum;
+        time_t seq_t = stream_benchmark(kernel, args, &checksum);
+        append_convolution_csv(res, args->width, args->height, args, seq_t);
+        write_checksum_to(check, checksum);
+    }
+    fflush(check);
+    fflush(res);
+    fclose(check);
+    fclose(res);
+    return 0;
+}
+
+int run_batch_mode(Args *args, Image *kernel) {
+    int count;
+    char **paths = list_batch_images(args->batch_path, &count);
+    if (paths == NULL || count == 0) {
+        free_batch_images(paths, count);
+        if (args->debug) {
+            fprintf(stderr, "No images found in %s\n", args->batch_path);
+        }
+        return EXIT_FAILURE;
+    }
+    FILE *res = fopen("../2d-convolution.batch.res", "a+");
+    FILE *check = fopen("../2d-convolution.res", "w+");
+    if (res == NULL || check == NULL) {
+        free_batch_images(paths, count);
+        if (args->debug) {
+            fprintf(stderr, "Could not open benchmark output files\n");
+        }
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < REPETITION; ++i) {
+        BatchStats stats;
+        batch_benchmark(paths, count, kernel, args, &stats);
+        append_batch_csv(res, args, &stats);
+        write_checksum_to(check, stats.checksum);
+    }
+    fflush(check);
+    fflush(res);
+    fclose(check);
+    fclose(res);
+    free_batch_images(paths, count);
+    return 0;
+}
+
 void free_resources(Args *args, Image *kernel, ImageWithPadding *padded_img,
                     ImageWithPadding *padded_buffer, ImageWithPadding *backup) {
     free_image(kernel);
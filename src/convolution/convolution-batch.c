@@ -0,0 +1,341 @@
+//
+// Created by agent on 10/17/26.
+//
+
+// directories and strdup are POSIX
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include "convolution-batch.h"
+#include "convolution-binary.h"
+#include "convolution-parse.h"
+#include "convolution-fixed.h"
+
+// longest line of a list file
+#define BATCH_LIST_LINE_SIZE (4096)
+
+/**
+ * Pooled images of a slot, they are handed from one image of the slot to the next
+ */
+struct BatchSlot {
+    ImageWithPadding *img;
+    ImageWithPadding *buffer;
+};
+
+/**
+ * State of an image while it passes the stages
+ */
+struct BatchImage {
+    const char *path;
+    // NULL if the result is not written
+    char *output_path;
+    // loaded image, handed from the load to the pad stage
+    Image *text;
+    BinaryImageHeader *binary;
+    size_t binary_size;
+    // start of the load stage
+    time_t start;
+    double checksum;
+    bool failed;
+};
+
+const char *batch_stage_name(BatchStage stage) {
+    switch (stage) {
+        case BATCH_LOAD:
+            return "load";
+        case BATCH_PAD:
+            return "pad";
+        case BATCH_CONVOLVE:
+            return "convolve";
+        case BATCH_WRITE:
+            return "write";
+        case BATCH_STAGES:
+            break;
+    }
+    return "unknown";
+}
+
+static void append_path(char ***paths, int *count, int *capacity, char *path) {
+    if (*count == *capacity) {
+        *capacity *= 2;
+        *paths = (char **) realloc(*paths, sizeof(char *) * *capacity);
+    }
+    (*paths)[(*count)++] = path;
+}
+
+static int compare_paths(const void *a, const void *b) {
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+char **list_batch_images(const char *path, int *count) {
+    int capacity = 16;
+    char **paths = (char **) malloc(sizeof(char *) * capacity);
+    *count = 0;
+    DIR *dir = opendir(path);
+    if (dir != NULL) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (entry->d_name[0] == '.') {
+                continue;
+            }
+            char *file = (char *) malloc(strlen(path) + strlen(entry->d_name) + 2);
+            sprintf(file, "%s/%s", path, entry->d_name);
+            struct stat status;
+            if (stat(file, &status) != 0 || !S_ISREG(status.st_mode)) {
+                free(file);
+                continue;
+            }
+            append_path(&paths, count, &capacity, file);
+        }
+        closedir(dir);
+        // readdir returns the files in any order
+        qsort(paths, (size_t) *count, sizeof(char *), compare_paths);
+        return paths;
+    }
+
+    FILE *fd = fopen(path, "r");
+    if (fd == NULL) {
+        free(paths);
+        return NULL;
+    }
+    char line[BATCH_LIST_LINE_SIZE];
+    while (fgets(line, BATCH_LIST_LINE_SIZE, fd) != NULL) {
+        size_t length = strlen(line);
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r' || line[length - 1] == ' ')) {
+            line[--length] = '\0';
+        }
+        if (length > 0) {
+            append_path(&paths, count, &capacity, strdup(line));
+        }
+    }
+    fclose(fd);
+    return paths;
+}
+
+void free_batch_images(char **paths, int count) {
+    if (paths != NULL) {
+        for (int i = 0; i < count; ++i) {
+            free(paths[i]);
+        }
+        free(paths);
+    }
+}
+
+/**
+ * Path of the result of an image: the name of the image without extension and ".conv.bin" in the output directory
+ */
+static char *batch_output_path(const char *directory, const char *path) {
+    const char *name = strrchr(path, '/');
+    name = name != NULL ? name + 1 : path;
+    const char *extension = strrchr(name, '.');
+    int length = (int) (extension != NULL && extension != name ? (size_t) (extension - name) : strlen(name));
+    char *output_path = (char *) malloc(strlen(directory) + (size_t) length + 11);
+    sprintf(output_path, "%s/%.*s.conv.bin", directory, length, name);
+    return output_path;
+}
+
+static void record_stage(BatchStats *stats, BatchStage stage, time_t start) {
+    time_t time = mytime() - start;
+#pragma omp atomic
+    stats->stage_time[stage] += time;
+#pragma omp critical (batch_stage_max)
+    {
+        if (time > stats->stage_max[stage]) {
+            stats->stage_max[stage] = time;
+        }
+    }
+}
+
+static void load_image(struct BatchImage *image) {
+    if (is_binary_image(image->path)) {
+        image->binary = open_binary_image(image->path, &image->binary_size);
+        image->failed = image->binary == NULL;
+    } else {
+        FILE *fd = fopen(image->path, "r");
+        if (fd != NULL) {
+            // the images are loaded in parallel, each one by a single thread
+            image->text = parse_text_image(fd, 1, NULL);
+            fclose(fd);
+        }
+        image->failed = image->text == NULL;
+    }
+}
+
+/**
+ * Copy the loaded image into the pooled image of the slot, which is only reallocated if the extent changes
+ */
+static void pad_image(struct BatchImage *image, struct BatchSlot *slot, int padding, ImageLayout layout,
+                      BatchStats *stats) {
+    if (image->failed) {
+        return;
+    }
+    int width = image->text != NULL ? image->text->width : (int) image->binary->width;
+    int height = image->text != NULL ? image->text->height : (int) image->binary->height;
+    if (slot->img == NULL || slot->img->inner_width != width || slot->img->inner_height != height) {
+        free_padded_image(slot->img);
+        free_padded_image(slot->buffer);
+        slot->img = init_padded_image_with_layout(width, height, padding, layout);
+        slot->buffer = init_padded_image_with_layout(width, height, padding, layout);
+#pragma omp atomic
+        stats->allocations += 2;
+    }
+    if (image->text != NULL) {
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                ACCESS_IMAGE(slot->img, x, y) = image->text->image[y][x];
+            }
+        }
+        update_borders(slot->img);
+        free_image(image->text);
+        image->text = NULL;
+    } else {
+        copy_binary_image_into(image->binary, slot->img);
+        close_binary_image(image->binary, image->binary_size);
+        image->binary = NULL;
+    }
+}
+
+/**
+ * Apply the kernel for all iterations without opening a parallel region, see apply_kernel_to_padded_image(...)
+ */
+static void convolve_image(struct BatchImage *image, struct BatchSlot *slot, FixedKernel *fixed, Image *kernel,
+                           int iterations) {
+    if (image->failed) {
+        return;
+    }
+    for (int i = 0; i < iterations; ++i) {
+        for (int y = 0; y < slot->img->inner_height; ++y) {
+            apply_fixed_kernel_to_row(fixed, kernel, (const double *const *) slot->img->image + y,
+                                      &ACCESS_IMAGE(slot->buffer, 0, y), slot->img->inner_width);
+        }
+        update_borders(slot->buffer);
+        swap_ptr(&slot->img, &slot->buffer, ImageWithPadding *);
+    }
+}
+
+static void write_image(struct BatchImage *image, struct BatchSlot *slot) {
+    if (image->failed) {
+        return;
+    }
+    // same summation order as get_checksum(...)
+    double checksum = 0.0;
+    for (int y = 0; y < slot->img->inner_height; ++y) {
+        for (int x = 0; x < slot->img->inner_width; ++x) {
+            checksum += ACCESS_IMAGE(slot->img, x, y);
+        }
+    }
+    image->checksum = checksum;
+    if (image->output_path != NULL && write_padded_binary_image(image->output_path, slot->img) != 0) {
+        image->failed = true;
+    }
+}
+
+int run_batch(char **paths, int count, const char *output_directory, Image *kernel, Args *args, BatchStats *stats) {
+    memset(stats, 0, sizeof(BatchStats));
+    stats->images = count;
+    int threads = args->number_of_processes;
+    int slot_count = threads * BATCH_SLOTS_PER_THREAD < count ? threads * BATCH_SLOTS_PER_THREAD : count;
+    if (slot_count < 1) {
+        slot_count = 1;
+    }
+    struct BatchSlot *slots = (struct BatchSlot *) calloc((size_t) slot_count, sizeof(struct BatchSlot));
+    // the stages of a slot depend on each other through its element
+    char *order = (char *) calloc((size_t) slot_count, sizeof(char));
+    struct BatchImage *images = (struct BatchImage *) calloc((size_t) count + 1, sizeof(struct BatchImage));
+    for (int i = 0; i < count; ++i) {
+        images[i].path = paths[i];
+        images[i].output_path = output_directory != NULL ? batch_output_path(output_directory, paths[i]) : NULL;
+    }
+    FixedKernel fixed;
+    select_fixed_kernel(kernel, &fixed);
+    int padding = kernel->width / 2;
+    int iterations = args->number_of_iterations;
+    ImageLayout layout = args->layout;
+
+    time_t start = mytime();
+#pragma omp parallel num_threads(threads)
+#pragma omp single
+    {
+        for (int i = 0; i < count; ++i) {
+            struct BatchImage *image = &images[i];
+            struct BatchSlot *slot = &slots[i % slot_count];
+#pragma omp task depend(inout: order[i % slot_count])
+            {
+                image->start = mytime();
+                load_image(image);
+                record_stage(stats, BATCH_LOAD, image->start);
+            }
+#pragma omp task depend(inout: order[i % slot_count])
+            {
+                time_t begin = mytime();
+                pad_image(image, slot, padding, layout, stats);
+                record_stage(stats, BATCH_PAD, begin);
+            }
+#pragma omp task depend(inout: order[i % slot_count])
+            {
+                time_t begin = mytime();
+                convolve_image(image, slot, &fixed, kernel, iterations);
+                record_stage(stats, BATCH_CONVOLVE, begin);
+            }
+#pragma omp task depend(inout: order[i % slot_count])
+            {
+                time_t begin = mytime();
+                write_image(image, slot);
+                record_stage(stats, BATCH_WRITE, begin);
+                time_t latency = mytime() - image->start;
+#pragma omp atomic
+                stats->latency += latency;
+            }
+        }
+    }
+    stats->time = mytime() - start;
+
+    int ret = 0;
+    for (int i = 0; i < count; ++i) {
+        if (images[i].failed) {
+            ret = -1;
+        }
+        stats->checksum += images[i].checksum;
+        free(images[i].output_path);
+    }
+    for (int i = 0; i < slot_count; ++i) {
+        free_padded_image(slots[i].img);
+        free_padded_image(slots[i].buffer);
+    }
+    free(images);
+    free(order);
+    free(slots);
+    return ret;
+}
+
+time_t batch_benchmark(char **paths, int count, Image *kernel, Args *args, BatchStats *stats) {
+    printf("Starting Kernel...\n");
+    if (run_batch(paths, count, args->output_file_path, kernel, args, stats) != 0) {
+        bail_out("an image of the batch could not be read or written");
+    }
+    time_t seq_t = stats->time;
+    // print kernel time
+    printf("Kernel time: %zu.%06zus\n", seq_t / 1000000, seq_t % 1000000);
+    double seconds = (double) seq_t / 1e6;
+    printf("Batch: %d images, %.1f images/s, mean latency %.3fms, %d pooled allocations\n", stats->images,
+           seconds > 0.0 ? stats->images / seconds : 0.0,
+           stats->images > 0 ? (double) stats->latency / stats->images / 1e3 : 0.0, stats->allocations);
+    for (int stage = 0; stage < BATCH_STAGES; ++stage) {
+        printf("\t%s: mean %.3fms, max %.3fms\n", batch_stage_name((BatchStage) stage),
+               stats->images > 0 ? (double) stats->stage_time[stage] / stats->images / 1e3 : 0.0,
+               (double) stats->stage_max[stage] / 1e3);
+    }
+    return seq_t;
+}
+
+void append_batch_csv(FILE *fd, Args *args, BatchStats *stats) {
+    fprintf(fd, "%d,%d,%d,%zu,%d", args->number_of_processes, stats->images, args->number_of_iterations, stats->time,
+            stats->allocations);
+    for (int stage = 0; stage < BATCH_STAGES; ++stage) {
+        fprintf(fd, ",%zu", stats->images > 0 ? stats->stage_time[stage] / stats->images : 0);
+    }
+    fprintf(fd, "\n");
+}
@@ -0,0 +1,118 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_BATCH_H
+#define HG_C_BENCHMARKS_CONVOLUTION_BATCH_H
+
+#include "convolution-util.h"
+
+// number of images in flight per thread, each one holds a pooled image and buffer
+#define BATCH_SLOTS_PER_THREAD (2)
+
+/**
+ * Stages every image of a batch passes through
+ */
+enum BatchStage {
+    // read a text image or map a binary image
+    BATCH_LOAD = 0,
+    // copy the image into a pooled padded image and update the borders
+    BATCH_PAD,
+    // apply the kernel for all iterations
+    BATCH_CONVOLVE,
+    // write the result and compute its checksum
+    BATCH_WRITE,
+    BATCH_STAGES
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef enum BatchStage BatchStage;
+
+/**
+ * Statistics of a batch
+ */
+struct BatchStats {
+    int images;
+    // time of the whole batch in microseconds
+    time_t time;
+    // summed and largest time of every stage over all images in microseconds
+    time_t stage_time[BATCH_STAGES];
+    time_t stage_max[BATCH_STAGES];
+    // summed time from the start of loading to the end of writing an image, including waiting between the stages
+    time_t latency;
+    // number of padded images that had to be allocated by the pool
+    int allocations;
+    // sum of the checksums of all results, in the order of the images
+    double checksum;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct BatchStats BatchStats;
+
+/**
+ * @param stage Stage of the batch
+ * @return Name of the stage
+ */
+const char *batch_stage_name(BatchStage stage);
+
+/**
+ * List the images of a batch.
+ * A directory contributes all of its files that do not start with a dot, sorted by name.
+ * Any other file is read as a list of image paths, one per line.
+ *
+ * @param path Directory or list file
+ * @param count Number of images
+ * @return Paths of the images, NULL if the path can not be read
+ */
+char **list_batch_images(const char *path, int *count);
+
+/**
+ * Free the paths of list_batch_images(...)
+ */
+void free_batch_images(char **paths, int count);
+
+/**
+ * Convolve a batch of text or binary images.
+ * Every image passes the stages of BatchStage, each stage is a task of one persistent parallel region.
+ * Images are assigned to BATCH_SLOTS_PER_THREAD * args->number_of_processes slots round robin, the stages
+ * of a slot run in order while the slots are in different stages, so loading and writing overlap with
+ * the convolution of other images. The padded images of a slot are reused by the next image of the slot
+ * if the extent matches, so a batch of equally sized images only allocates them once per slot.
+ * Every image is convolved by one thread with the direct engine, like run_on_padded_image(...).
+ *
+ * @param paths Paths of the images
+ * @param count Number of images
+ * @param output_directory Directory the results are written to as float64 binary images, may be NULL
+ * @param kernel Kernel to apply
+ * @param args Number of iterations, processes and the layout
+ * @param stats Statistics of the batch
+ * @return 0 on success, -1 if an image could not be read or written
+ */
+int run_batch(char **paths, int count, const char *output_directory, Image *kernel, Args *args, BatchStats *stats);
+
+/**
+ * Benchmark a batch and print its throughput and the latency of every stage, see benchmark(...)
+ *
+ * @param paths Paths of the images
+ * @param count Number of images
+ * @param kernel Kernel to apply
+ * @param args Arguments of the program
+ * @param stats Statistics of the batch
+ * @return Time of the batch in microseconds
+ */
+time_t batch_benchmark(char **paths, int count, Image *kernel, Args *args, BatchStats *stats);
+
+/**
+ * Append the results of a batch to a file.
+ * The columns are processes, images, iterations, time, allocations and the mean time of every stage.
+ * @param fd File to append the results to
+ * @param args Arguments of the program
+ * @param stats Statistics of the batch
+ */
+void append_batch_csv(FILE *fd, Args *args, BatchStats *stats);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_BATCH_H
@@ -0,0 +1,272 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "convolution-binary.h"
+
+size_t pixel_type_size(PixelType type) {
+    switch (type) {
+        case PIXEL_FLOAT64:
+            return sizeof(double);
+        case PIXEL_FLOAT32:
+            return sizeof(float);
+        case PIXEL_UINT8:
+            return sizeof(uint8_t);
+        case PIXEL_UINT16:
+            return sizeof(uint16_t);
+        case PIXEL_INT16:
+            return sizeof(int16_t);
+    }
+    return 0;
+}
+
+const char *pixel_type_name(PixelType type) {
+    switch (type) {
+        case PIXEL_FLOAT64:
+            return "float64";
+        case PIXEL_FLOAT32:
+            return "float32";
+        case PIXEL_UINT8:
+            return "uint8";
+        case PIXEL_UINT16:
+            return "uint16";
+        case PIXEL_INT16:
+            return "int16";
+    }
+    return "unknown";
+}
+
+int parse_pixel_type(const char *name, PixelType *type) {
+    for (int t = PIXEL_FLOAT64; t <= PIXEL_INT16; ++t) {
+        if (strcmp(name, pixel_type_name((PixelType) t)) == 0) {
+            *type = (PixelType) t;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+bool is_binary_image(const char *path) {
+    FILE *fd = fopen(path, "rb");
+    if (fd == NULL) {
+        return false;
+    }
+    char magic[BINARY_IMAGE_MAGIC_SIZE];
+    bool binary = fread(magic, 1, BINARY_IMAGE_MAGIC_SIZE, fd) == BINARY_IMAGE_MAGIC_SIZE
+                  && memcmp(magic, BINARY_IMAGE_MAGIC, BINARY_IMAGE_MAGIC_SIZE) == 0;
+    fclose(fd);
+    return binary;
+}
+
+/**
+ * Check the header against the size of the file
+ */
+static bool valid_header(BinaryImageHeader *header, size_t file_size) {
+    if (memcmp(header->magic, BINARY_IMAGE_MAGIC, BINARY_IMAGE_MAGIC_SIZE) != 0 || header->width == 0 ||
+        header->height == 0 || header->pixel_type > PIXEL_INT16 ||
+        header->stride < header->width + 2 * (size_t) header->padding) {
+        return false;
+    }
+    size_t rows = header->height + 2 * (size_t) header->padding;
+    return file_size >= BINARY_IMAGE_HEADER_SIZE + rows * header->stride * pixel_type_size((PixelType) header->pixel_type);
+}
+
+int read_binary_image_header(const char *path, BinaryImageHeader *header) {
+    FILE *fd = fopen(path, "rb");
+    if (fd == NULL) {
+        return -1;
+    }
+    bool read = fread(header, sizeof(BinaryImageHeader), 1, fd) == 1;
+    fseek(fd, 0, SEEK_END);
+    long size = ftell(fd);
+    fclose(fd);
+    return read && size >= 0 && valid_header(header, (size_t) size) ? 0 : -1;
+}
+
+void store_pixel(void *row, int x, PixelType type, double value) {
+    switch (type) {
+        case PIXEL_FLOAT64:
+            ((double *) row)[x] = value;
+            break;
+        case PIXEL_FLOAT32:
+            ((float *) row)[x] = (float) value;
+            break;
+        case PIXEL_UINT8:
+            ((uint8_t *) row)[x] = (uint8_t) fmin(fmax(round(value), 0.0), UINT8_MAX);
+            break;
+        case PIXEL_UINT16:
+            ((uint16_t *) row)[x] = (uint16_t) fmin(fmax(round(value), 0.0), UINT16_MAX);
+            break;
+        case PIXEL_INT16:
+            ((int16_t *) row)[x] = (int16_t) fmin(fmax(round(value), INT16_MIN), INT16_MAX);
+            break;
+    }
+}
+
+double load_pixel(const void *row, int x, PixelType type) {
+    switch (type) {
+        case PIXEL_FLOAT64:
+            return ((const double *) row)[x];
+        case PIXEL_FLOAT32:
+            return ((const float *) row)[x];
+        case PIXEL_UINT8:
+            return ((const uint8_t *) row)[x];
+        case PIXEL_UINT16:
+            return ((const uint16_t *) row)[x];
+        case PIXEL_INT16:
+            return ((const int16_t *) row)[x];
+    }
+    return 0.0;
+}
+
+void init_binary_image_header(BinaryImageHeader *header, int width, int height, PixelType type, int padding) {
+    memset(header, 0, sizeof(BinaryImageHeader));
+    memcpy(header->magic, BINARY_IMAGE_MAGIC, BINARY_IMAGE_MAGIC_SIZE);
+    header->width = (uint32_t) width;
+    header->height = (uint32_t) height;
+    header->pixel_type = (uint32_t) type;
+    header->padding = (uint32_t) padding;
+    // same stride as a contiguous padded image, which allows to map float64 images without copying
+    header->stride = (uint32_t) image_stride(width + 2 * padding);
+}
+
+int write_binary_image(const char *path, Image *img, PixelType type, int padding) {
+    BinaryImageHeader header;
+    init_binary_image_header(&header, img->width, img->height, type, padding);
+
+    FILE *fd = fopen(path, "wb");
+    if (fd == NULL) {
+        return -1;
+    }
+    size_t row_size = header.stride * pixel_type_size(type);
+    void *row = calloc(header.stride, pixel_type_size(type));
+    bool written = fwrite(&header, sizeof(header), 1, fd) == 1;
+    for (int y = -padding; y < img->height + padding && written; ++y) {
+        const double *values = img->image[clamp(0, y, img->height - 1)];
+        for (int x = -padding; x < img->width + padding; ++x) {
+            store_pixel(row, x + padding, type, values[clamp(0, x, img->width - 1)]);
+        }
+        written = fwrite(row, row_size, 1, fd) == 1;
+    }
+    free(row);
+    return fclose(fd) == 0 && written ? 0 : -1;
+}
+
+int write_padded_binary_image(const char *path, ImageWithPadding *padded_img) {
+    BinaryImageHeader header;
+    init_binary_image_header(&header, padded_img->inner_width, padded_img->inner_height, PIXEL_FLOAT64,
+                             padded_img->padding);
+    // rows of the file are at most one cache line longer than the rows of the image
+    static const double zeros[IMAGE_ALIGNMENT / sizeof(double)] = {0.0};
+
+    FILE *fd = fopen(path, "wb");
+    if (fd == NULL) {
+        return -1;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, fd) == 1;
+    size_t width = (size_t) padded_img->width;
+    size_t gap = header.stride - width;
+    if (padded_img->layout == LAYOUT_CONTIGUOUS && (size_t) padded_img->stride == header.stride) {
+        written = written && fwrite(padded_img->data, sizeof(double) * header.stride, (size_t) padded_img->height, fd)
+                             == (size_t) padded_img->height;
+    } else {
+        for (int y = 0; y < padded_img->height && written; ++y) {
+            written = fwrite(padded_img->image[y], sizeof(double), width, fd) == width &&
+                      fwrite(zeros, sizeof(double), gap, fd) == gap;
+        }
+    }
+    return fclose(fd) == 0 && written ? 0 : -1;
+}
+
+BinaryImageHeader *open_binary_image(const char *path, size_t *size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || (size_t) status.st_size < sizeof(BinaryImageHeader)) {
+        close(fd);
+        return NULL;
+    }
+    *size = (size_t) status.st_size;
+    // private writable mapping, the benchmark may change the image but never the file
+    void *mapping = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+    BinaryImageHeader *header = (BinaryImageHeader *) mapping;
+    if (!valid_header(header, *size)) {
+        munmap(mapping, *size);
+        return NULL;
+    }
+    return header;
+}
+
+void close_binary_image(BinaryImageHeader *header, size_t size) {
+    if (header != NULL) {
+        munmap(header, size);
+    }
+}
+
+void copy_binary_image_into(const BinaryImageHeader *header, ImageWithPadding *padded_img) {
+    int width = (int) header->width;
+    int padding = (int) header->padding;
+    PixelType type = (PixelType) header->pixel_type;
+    size_t row_size = header->stride * pixel_type_size(type);
+    const char *data = (const char *) header + BINARY_IMAGE_HEADER_SIZE;
+    for (int y = 0; y < (int) header->height; ++y) {
+        const char *row = data + (size_t) (y + padding) * row_size;
+        double *out = &ACCESS_IMAGE(padded_img, 0, y);
+        if (type == PIXEL_FLOAT64) {
+            memcpy(out, (const double *) row + padding, sizeof(double) * width);
+        } else {
+            for (int x = 0; x < width; ++x) {
+                out[x] = load_pixel(row, x + padding, type);
+            }
+        }
+    }
+    update_borders(padded_img);
+}
+
+ImageWithPadding *map_padded_image(const char *path, int padding, ImageLayout layout) {
+    size_t size;
+    BinaryImageHeader *header = open_binary_image(path, &size);
+    if (header == NULL) {
+        return NULL;
+    }
+    int width = (int) header->width;
+    int height = (int) header->height;
+    PixelType type = (PixelType) header->pixel_type;
+
+    if (layout == LAYOUT_CONTIGUOUS && type == PIXEL_FLOAT64 && (int) header->padding == padding &&
+        (int) header->stride == image_stride(width + 2 * padding)) {
+        // the file already has the layout of a padded image
+        ImageWithPadding *padded_img = (ImageWithPadding *) malloc(sizeof(ImageWithPadding));
+        padded_img->padding = padding;
+        padded_img->width = width + 2 * padding;
+        padded_img->height = height + 2 * padding;
+        padded_img->inner_width = width;
+        padded_img->inner_height = height;
+        padded_img->layout = LAYOUT_CONTIGUOUS;
+        padded_img->stride = (int) header->stride;
+        padded_img->data = (double *) ((char *) header + BINARY_IMAGE_HEADER_SIZE);
+        padded_img->image = (double **) malloc(sizeof(double *) * padded_img->height);
+        for (int y = 0; y < padded_img->height; ++y) {
+            padded_img->image[y] = padded_img->data + (size_t) y * padded_img->stride;
+        }
+        padded_img->mapping = header;
+        padded_img->mapping_size = size;
+        return padded_img;
+    }
+
+    ImageWithPadding *padded_img = init_padded_image_with_layout(width, height, padding, layout);
+    copy_binary_image_into(header, padded_img);
+    close_binary_image(header, size);
+    return padded_img;
+}
@@ -0,0 +1,163 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_BINARY_H
+#define HG_C_BENCHMARKS_CONVOLUTION_BINARY_H
+
+#include <stdint.h>
+#include "convolution-util.h"
+
+// first bytes of every binary image file
+#define BINARY_IMAGE_MAGIC "HGCIMG01"
+#define BINARY_IMAGE_MAGIC_SIZE (8)
+// size of the header, the data behind it stays aligned to IMAGE_ALIGNMENT in the mapping
+#define BINARY_IMAGE_HEADER_SIZE (64)
+// padding that is stored by the converter if nothing else is requested, fits the default 5x5 kernel
+#define DEFAULT_BINARY_IMAGE_PADDING (2)
+
+/**
+ * Header of a binary image file.
+ * The header is followed by height + 2 * padding rows of stride values each, row major.
+ * The first and last padding rows and columns hold the clamped border like update_borders(...).
+ * All numbers are stored in the byte order of the machine that wrote the file.
+ */
+struct BinaryImageHeader {
+    char magic[BINARY_IMAGE_MAGIC_SIZE];
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixel_type;
+    // number of values between the beginning of two rows
+    uint32_t stride;
+    uint32_t padding;
+    uint8_t reserved[BINARY_IMAGE_HEADER_SIZE - BINARY_IMAGE_MAGIC_SIZE - 5 * sizeof(uint32_t)];
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct BinaryImageHeader BinaryImageHeader;
+
+/**
+ * @param type Type of the values
+ * @return Size of a value in bytes
+ */
+size_t pixel_type_size(PixelType type);
+
+/**
+ * @param type Type of the values
+ * @return Name of the type, like it is accepted by parse_pixel_type(...)
+ */
+const char *pixel_type_name(PixelType type);
+
+/**
+ * Parse the name of a pixel type
+ * @param name "float64", "float32", "uint8", "uint16" or "int16"
+ * @param type Parsed type
+ * @return 0 on success, -1 if the name is unknown
+ */
+int parse_pixel_type(const char *name, PixelType *type);
+
+/**
+ * Check whether a file starts with the magic of the binary format
+ * @param path Path to the file
+ * @return true if the file is a binary image, false if it is a text image or can not be read
+ */
+bool is_binary_image(const char *path);
+
+/**
+ * Read and validate the header of a binary image
+ * @param path Path to the file
+ * @param header Read header
+ * @return 0 on success, -1 if the file can not be read or the header is invalid
+ */
+int read_binary_image_header(const char *path, BinaryImageHeader *header);
+
+/**
+ * Initialize the header of a binary image, the stride is the one of a contiguous padded image
+ * @param header Header to initialize
+ * @param width Width of the image
+ * @param height Height of the image
+ * @param type Type of the stored values
+ * @param padding Number of clamped border rows and columns that are stored around the image
+ */
+void init_binary_image_header(BinaryImageHeader *header, int width, int height, PixelType type, int padding);
+
+/**
+ * Load a value of a row of a binary image
+ * @param row First value of the row
+ * @param x Index of the value in the row
+ * @param type Type of the stored values
+ * @return Loaded value
+ */
+double load_pixel(const void *row, int x, PixelType type);
+
+/**
+ * Store a value into a row of a binary image, integer types are rounded and saturated
+ * @param row First value of the row
+ * @param x Index of the value in the row
+ * @param type Type of the stored values
+ * @param value Value to store
+ */
+void store_pixel(void *row, int x, PixelType type, double value);
+
+/**
+ * Write an image in the binary format.
+ * Float64 images are stored with the stride of a contiguous padded image, so they can be mapped without copying.
+ * Integer types are rounded and saturated.
+ *
+ * @param path Path to the file, is overwritten
+ * @param img Image to write
+ * @param type Type of the stored values
+ * @param padding Number of clamped border rows and columns that are stored around the image
+ * @return 0 on success, -1 if the file could not be written
+ */
+int write_binary_image(const char *path, Image *img, PixelType type, int padding);
+
+/**
+ * Write a padded image in the binary format as float64 with the padding of the image
+ *
+ * @param path Path to the file, is overwritten
+ * @param padded_img Image to write, its borders must be up to date
+ * @return 0 on success, -1 if the file could not be written
+ */
+int write_padded_binary_image(const char *path, ImageWithPadding *padded_img);
+
+/**
+ * Map a binary image into memory and validate its header
+ *
+ * @param path Path to the file
+ * @param size Size of the mapping
+ * @return Header at the beginning of the mapping, NULL if the file can not be read or is invalid
+ */
+BinaryImageHeader *open_binary_image(const char *path, size_t *size);
+
+/**
+ * Unmap an image opened by open_binary_image(...)
+ * @param header Header at the beginning of the mapping, may be NULL
+ * @param size Size of the mapping
+ */
+void close_binary_image(BinaryImageHeader *header, size_t size);
+
+/**
+ * Convert the values of an opened binary image into a padded image and update its borders
+ * @param header Header of the opened image
+ * @param padded_img Image with the same inner extent, any padding and layout
+ */
+void copy_binary_image_into(const BinaryImageHeader *header, ImageWithPadding *padded_img);
+
+/**
+ * Load a binary image into a padded image via mmap.
+ * If the file stores float64 values with the requested padding and the stride of a contiguous padded image,
+ * the mapping itself is used as the padded image without copying (copy on write, the file is never changed).
+ * Otherwise the values are converted from the mapping into a newly allocated padded image.
+ * free_padded_image(...) unmaps the file.
+ *
+ * @param path Path to the file
+ * @param padding Padding of the image
+ * @param layout Layout of the image
+ * @return Padded image, NULL if the file can not be read or is invalid
+ */
+ImageWithPadding *map_padded_image(const char *path, int padding, ImageLayout layout);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_BINARY_H
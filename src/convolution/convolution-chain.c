@@ -0,0 +1,349 @@
+//
+// Created by agent on 10/17/26.
+//
+
+// sysconf is POSIX
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stddef.h>
+#include <unistd.h>
+#include "convolution-chain.h"
+#include "convolution-run.h"
+
+KernelChain *init_kernel_chain(Image **kernels, int stages) {
+    KernelChain *chain = (KernelChain *) malloc(sizeof(KernelChain));
+    chain->stages = stages;
+    chain->padding = 0;
+    for (int s = 0; s < stages; ++s) {
+        chain->kernels[s] = kernels[s];
+        select_fixed_kernel(kernels[s], &chain->fixed[s]);
+        int radius = (kernels[s]->width > kernels[s]->height ? kernels[s]->width : kernels[s]->height) / 2;
+        chain->padding = radius > chain->padding ? radius : chain->padding;
+    }
+    chain->groups = stages;
+    for (int s = 0; s <= stages; ++s) {
+        chain->first_stage[s] = s;
+    }
+    return chain;
+}
+
+void free_kernel_chain(KernelChain *chain) {
+    if (chain != NULL) {
+        for (int s = 0; s < chain->stages; ++s) {
+            free_image(chain->kernels[s]);
+        }
+        free(chain);
+    }
+}
+
+KernelChain *create_kernel_chain(Args *args) {
+    Image *kernels[KERNEL_CHAIN_MAX];
+    int stages = args->number_of_kernels > 0 ? args->number_of_kernels : 1;
+    for (int s = 0; s < stages; ++s) {
+        if (args->number_of_kernels == 0) {
+            kernels[s] = get_default_kernel();
+            continue;
+        }
+        // reading a file stores its extent in the arguments, but they must keep describing the image
+        int width = args->width;
+        int height = args->height;
+        FILE *fd = fopen(args->kernel_file_paths[s], "r");
+        kernels[s] = read_image_from_fd(fd, args);
+        fclose(fd);
+        args->width = width;
+        args->height = height;
+        if (kernels[s] == NULL) {
+            // an empty or broken kernel file, the chain is rejected as a whole
+            for (int t = 0; t < s; ++t) {
+                free_image(kernels[t]);
+            }
+            return NULL;
+        }
+    }
+    return init_kernel_chain(kernels, stages);
+}
+
+/**
+ * Values that are read before and after a pixel by a kernel, in one dimension
+ */
+static int radius_before(int extent) {
+    return extent / 2;
+}
+
+static int radius_after(int extent) {
+    return extent - 1 - extent / 2;
+}
+
+/**
+ * Work of the stages [first, last) on one fused tile, every stage computes the values the following stages read
+ */
+static double fused_tile_work(KernelChain *chain, int first, int last) {
+    double work = 0.0;
+    for (int s = first; s < last; ++s) {
+        int halo_x = 0;
+        int halo_y = 0;
+        for (int t = s + 1; t < last; ++t) {
+            halo_x += chain->kernels[t]->width - 1;
+            halo_y += chain->kernels[t]->height - 1;
+        }
+        work += (double) (CHAIN_TILE_WIDTH + halo_x) * (CHAIN_TILE_HEIGHT + halo_y)
+                * chain->kernels[s]->width * chain->kernels[s]->height;
+    }
+    return work;
+}
+
+/**
+ * @return Size of the last level cache in bytes
+ */
+static size_t last_level_cache_size(void) {
+    long size = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    if (size <= 0) {
+        size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    }
+#endif
+    return size > 0 ? (size_t) size : CHAIN_DEFAULT_CACHE_SIZE;
+}
+
+void plan_kernel_chain(KernelChain *chain, int width, int height) {
+    size_t image_size = sizeof(double) * (size_t) (width + 2 * chain->padding) * (height + 2 * chain->padding);
+    bool fuse = image_size > last_level_cache_size() / 4;
+    chain->groups = 0;
+    int first = 0;
+    while (first < chain->stages) {
+        int last = first + 1;
+        double work = (double) CHAIN_TILE_WIDTH * CHAIN_TILE_HEIGHT
+                      * chain->kernels[first]->width * chain->kernels[first]->height;
+        while (fuse && last < chain->stages) {
+            double stage_work = (double) CHAIN_TILE_WIDTH * CHAIN_TILE_HEIGHT
+                                * chain->kernels[last]->width * chain->kernels[last]->height;
+            if (fused_tile_work(chain, first, last + 1) > (1.0 + CHAIN_FUSION_MAX_OVERHEAD) * (work + stage_work)) {
+                break;
+            }
+            work += stage_work;
+            ++last;
+        }
+        chain->first_stage[chain->groups++] = first;
+        first = last;
+    }
+    chain->first_stage[chain->groups] = chain->stages;
+}
+
+void apply_chain_stage(ImageWithPadding *padded_img, KernelChain *chain, int stage, Args *args,
+                       ImageWithPadding *buffer) {
+    Image *kernel = chain->kernels[stage];
+    // the window of a pixel starts radius values left and above of it
+    int offset_x = padded_img->padding - radius_before(kernel->width);
+    int offset_y = padded_img->padding - radius_before(kernel->height);
+#pragma omp parallel num_threads(args->number_of_processes)
+    {
+        const double **window_rows = (const double **) malloc(sizeof(double *) * kernel->height);
+#pragma omp for schedule(static)
+        for (int y = 0; y < padded_img->inner_height; ++y) {
+            for (int ky = 0; ky < kernel->height; ++ky) {
+                window_rows[ky] = padded_img->image[y + offset_y + ky] + offset_x;
+            }
+            apply_fixed_kernel_to_row(&chain->fixed[stage], kernel, window_rows, &ACCESS_IMAGE(buffer, 0, y),
+                                      padded_img->inner_width);
+        }
+        free(window_rows);
+    }
+    update_borders(buffer);
+}
+
+/**
+ * Extent of a fused tile in one dimension, all values are inner coordinates of the image.
+ * Step 0 is the loaded image, step i the result of the i-th fused stage.
+ */
+struct ChainRange {
+    // first value of the output block and the value after its last one
+    int first;
+    int last;
+    // value that is stored at index 0 of the scratch buffers
+    int base;
+    // extent of the image
+    int extent;
+    // values that are read before and after a pixel by the stage that follows step i, 0 after the last one
+    int before[KERNEL_CHAIN_MAX + 1];
+    int after[KERNEL_CHAIN_MAX + 1];
+    // values that are read before and after the output block by all stages that follow step i
+    int reach_before[KERNEL_CHAIN_MAX + 1];
+    int reach_after[KERNEL_CHAIN_MAX + 1];
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct ChainRange ChainRange;
+
+static void init_chain_range(ChainRange *range, int first, int tile, int extent, int *before, int *after, int steps) {
+    range->first = first;
+    range->last = first + tile < extent ? first + tile : extent;
+    range->extent = extent;
+    range->before[steps] = 0;
+    range->after[steps] = 0;
+    range->reach_before[steps] = 0;
+    range->reach_after[steps] = 0;
+    for (int i = steps - 1; i >= 0; --i) {
+        range->before[i] = before[i];
+        range->after[i] = after[i];
+        range->reach_before[i] = range->reach_before[i + 1] + before[i];
+        range->reach_after[i] = range->reach_after[i + 1] + after[i];
+    }
+    range->base = first - range->reach_before[0];
+}
+
+/**
+ * Values of step i that the following stages read. With clamped the values outside of the image that are read
+ * by the next stage are included, otherwise only the computed values inside of the image.
+ */
+static void chain_needed_values(ChainRange *range, int step, bool clamped, int *begin, int *end) {
+    int lower = clamped ? -range->before[step] : 0;
+    int upper = clamped ? range->extent + range->after[step] : range->extent;
+    *begin = range->first - range->reach_before[step];
+    *end = range->last + range->reach_after[step];
+    *begin = *begin > lower ? *begin : lower;
+    *end = *end < upper ? *end : upper;
+}
+
+/**
+ * Apply the fused stages to one tile, the result is written to the output block of the tile in buffer
+ */
+static void advance_chain_tile(ImageWithPadding *padded_img, KernelChain *chain, int first, int steps,
+                               ImageWithPadding *buffer, ChainRange *columns, ChainRange *rows, double *source,
+                               double *target, int stride, const double **window_rows) {
+    int begin_x, end_x, begin_y, end_y;
+    chain_needed_values(columns, 0, true, &begin_x, &end_x);
+    chain_needed_values(rows, 0, true, &begin_y, &end_y);
+    // values outside the image come from the clamped padding
+    for (int y = begin_y; y < end_y; ++y) {
+        memcpy(source + (size_t) (y - rows->base) * stride + (begin_x - columns->base),
+               &ACCESS_IMAGE(padded_img, begin_x, y), sizeof(double) * (end_x - begin_x));
+    }
+
+    for (int step = 1; step <= steps; ++step) {
+        int stage = first + step - 1;
+        Image *kernel = chain->kernels[stage];
+        chain_needed_values(columns, step, false, &begin_x, &end_x);
+        chain_needed_values(rows, step, false, &begin_y, &end_y);
+        int low_x, high_x, low_y, high_y;
+        chain_needed_values(columns, step, true, &low_x, &high_x);
+        chain_needed_values(rows, step, true, &low_y, &high_y);
+        for (int y = begin_y; y < end_y; ++y) {
+            // the window of a pixel starts at the upper left corner of its neighbourhood
+            const double *window = source + (size_t) (y - rows->before[step - 1] - rows->base) * stride
+                                   + (begin_x - columns->before[step - 1] - columns->base);
+            double *out = target + (size_t) (y - rows->base) * stride - columns->base;
+            for (int ky = 0; ky < kernel->height; ++ky) {
+                window_rows[ky] = window + (size_t) ky * stride;
+            }
+            apply_fixed_kernel_to_row(&chain->fixed[stage], kernel, window_rows, out + begin_x, end_x - begin_x);
+            // clamp the columns outside of the image that the next stage reads, like update_borders(...)
+            for (int x = low_x; x < 0; ++x) {
+                out[x] = out[0];
+            }
+            for (int x = columns->extent; x < high_x; ++x) {
+                out[x] = out[columns->extent - 1];
+            }
+        }
+        // clamp the rows outside of the image, the clamped columns are part of them
+        size_t row_size = sizeof(double) * (high_x - low_x);
+        double *first_row = target + (size_t) (0 - rows->base) * stride + (low_x - columns->base);
+        double *last_row = target + (size_t) (rows->extent - 1 - rows->base) * stride + (low_x - columns->base);
+        for (int y = low_y; y < 0; ++y) {
+            memcpy(first_row + (ptrdiff_t) y * stride, first_row, row_size);
+        }
+        for (int y = rows->extent; y < high_y; ++y) {
+            memcpy(last_row + (size_t) (y - rows->extent + 1) * stride, last_row, row_size);
+        }
+        swap_ptr(&source, &target, double*);
+    }
+
+    for (int y = rows->first; y < rows->last; ++y) {
+        memcpy(&ACCESS_IMAGE(buffer, columns->first, y),
+               source + (size_t) (y - rows->base) * stride + (columns->first - columns->base),
+               sizeof(double) * (columns->last - columns->first));
+    }
+}
+
+void apply_chain_stages_fused(ImageWithPadding *padded_img, KernelChain *chain, int first, int last, Args *args,
+                              ImageWithPadding *buffer) {
+    int steps = last - first;
+    int left[KERNEL_CHAIN_MAX], right[KERNEL_CHAIN_MAX], above[KERNEL_CHAIN_MAX], below[KERNEL_CHAIN_MAX];
+    int halo_x = 0;
+    int halo_y = 0;
+    for (int i = 0; i < steps; ++i) {
+        Image *kernel = chain->kernels[first + i];
+        left[i] = radius_before(kernel->width);
+        right[i] = radius_after(kernel->width);
+        above[i] = radius_before(kernel->height);
+        below[i] = radius_after(kernel->height);
+        halo_x += kernel->width - 1;
+        halo_y += kernel->height - 1;
+    }
+    int tiles_x = (padded_img->inner_width + CHAIN_TILE_WIDTH - 1) / CHAIN_TILE_WIDTH;
+    int tiles_y = (padded_img->inner_height + CHAIN_TILE_HEIGHT - 1) / CHAIN_TILE_HEIGHT;
+    // a tile including the halo of the first stage
+    int stride = image_stride(CHAIN_TILE_WIDTH + halo_x);
+    int height = CHAIN_TILE_HEIGHT + halo_y;
+    int kernel_height = 0;
+    for (int s = first; s < last; ++s) {
+        kernel_height = chain->kernels[s]->height > kernel_height ? chain->kernels[s]->height : kernel_height;
+    }
+#pragma omp parallel num_threads(args->number_of_processes)
+    {
+        double *source = (double *) aligned_alloc(IMAGE_ALIGNMENT, sizeof(double) * height * stride);
+        double *target = (double *) aligned_alloc(IMAGE_ALIGNMENT, sizeof(double) * height * stride);
+        const double **window_rows = (const double **) malloc(sizeof(double *) * kernel_height);
+#pragma omp for collapse(2) schedule(static)
+        for (int tile_y = 0; tile_y < tiles_y; ++tile_y) {
+            for (int tile_x = 0; tile_x < tiles_x; ++tile_x) {
+                ChainRange columns;
+                ChainRange rows;
+                init_chain_range(&columns, tile_x * CHAIN_TILE_WIDTH, CHAIN_TILE_WIDTH, padded_img->inner_width,
+                                 left, right, steps);
+                init_chain_range(&rows, tile_y * CHAIN_TILE_HEIGHT, CHAIN_TILE_HEIGHT, padded_img->inner_height,
+                                 above, below, steps);
+                advance_chain_tile(padded_img, chain, first, steps, buffer, &columns, &rows, source, target, stride,
+                                   window_rows);
+            }
+        }
+        free(source);
+        free(target);
+        free(window_rows);
+    }
+    update_borders(buffer);
+}
+
+void run_kernel_chain(ImageWithPadding **padded_img, KernelChain *chain, Args *args, ImageWithPadding **buffer) {
+    for (int i = 0; i < args->number_of_iterations; i++) {
+        for (int g = 0; g < chain->groups; ++g) {
+            int first = chain->first_stage[g];
+            int last = chain->first_stage[g + 1];
+            if (last - first > 1 && (*padded_img)->layout == LAYOUT_CONTIGUOUS) {
+                apply_chain_stages_fused(*padded_img, chain, first, last, args, *buffer);
+                swap_ptr(padded_img, buffer, ImageWithPadding*);
+                continue;
+            }
+            for (int s = first; s < last; ++s) {
+                apply_chain_stage(*padded_img, chain, s, args, *buffer);
+                swap_ptr(padded_img, buffer, ImageWithPadding*);
+            }
+        }
+    }
+}
+
+time_t chain_benchmark(ImageWithPadding **padded_img, KernelChain *chain, Args *args, ImageWithPadding **buffer) {
+    time_t seq_t;
+    printf("Starting Kernel...\n");
+    TIC(0);
+    run_kernel_chain(padded_img, chain, args, buffer);
+    seq_t = TOC(0);
+    printf("Kernel time: %zu.%06zus\n", seq_t / 1000000, seq_t % 1000000);
+    return seq_t;
+}
@@ -0,0 +1,121 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_CHAIN_H
+#define HG_C_BENCHMARKS_CONVOLUTION_CHAIN_H
+
+#include "convolution-util.h"
+#include "convolution-fixed.h"
+
+// extent of the output block of a fused tile, like the tiles of temporal blocking
+#define CHAIN_TILE_WIDTH (256)
+#define CHAIN_TILE_HEIGHT (64)
+// size of the last level cache if the system does not report it
+#define CHAIN_DEFAULT_CACHE_SIZE (32 << 20)
+// largest share of the work of a group of fused stages that is spent on the redundant halos of the tiles
+#define CHAIN_FUSION_MAX_OVERHEAD (0.25)
+
+/**
+ * Kernels that are applied one after another, every iteration applies all stages
+ */
+struct KernelChain {
+    int stages;
+    // kernel of every stage, owned by the chain
+    Image *kernels[KERNEL_CHAIN_MAX];
+    FixedKernel fixed[KERNEL_CHAIN_MAX];
+    // padding the images need, the largest half extent of all kernels
+    int padding;
+    // the stages [first_stage[g], first_stage[g + 1]) form group g, stages of a group of more than one stage
+    // are fused tile by tile
+    int groups;
+    int first_stage[KERNEL_CHAIN_MAX + 1];
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct KernelChain KernelChain;
+
+/**
+ * Combine kernels to a chain, every stage forms a group of its own until plan_kernel_chain(...) is called
+ *
+ * @param kernels Kernels of the stages in the order they are applied, the chain takes ownership of them
+ * @param stages Number of stages, at most KERNEL_CHAIN_MAX
+ * @return Chain of the kernels, must be freed with free_kernel_chain(...)
+ */
+KernelChain *init_kernel_chain(Image **kernels, int stages);
+
+/**
+ * @param chain Chain to free, may be NULL
+ */
+void free_kernel_chain(KernelChain *chain);
+
+/**
+ * Create the chain of the kernel files of the arguments, see create_kernel(...)
+ *
+ * @param args Program arguments
+ * @return Chain of args->number_of_kernels stages, the default kernel if there is no kernel file,
+ * NULL if a kernel file could not be read
+ */
+KernelChain *create_kernel_chain(Args *args);
+
+/**
+ * Group the stages of the chain for an image.
+ * Images of at most a quarter of the last level cache are applied stage by stage, the image and the buffer of a
+ * stage stay in the cache for the next one. Otherwise consecutive stages are fused as long as the redundant halo
+ * work of their tiles stays below CHAIN_FUSION_MAX_OVERHEAD.
+ *
+ * @param chain Chain to plan
+ * @param width Width of the image
+ * @param height Height of the image
+ */
+void plan_kernel_chain(KernelChain *chain, int width, int height);
+
+/**
+ * Apply one stage of the chain to every pixel of an image and update the borders of the buffer.
+ * Kernels that are smaller than the padding read a window that is centered on the pixel.
+ *
+ * @param padded_img Image to which the kernel is applied, its padding is chain->padding
+ * @param chain Chain of the stage
+ * @param stage Index of the stage
+ * @param args Arguments to the program, the number of used processes is used for computation
+ * @param buffer Output buffer
+ */
+void apply_chain_stage(ImageWithPadding *padded_img, KernelChain *chain, int stage, Args *args,
+                       ImageWithPadding *buffer);
+
+/**
+ * Apply the stages [first, last) of the chain in one pass over the image.
+ * The image is cut into tiles of CHAIN_TILE_WIDTH x CHAIN_TILE_HEIGHT pixels, like temporal blocking every tile
+ * is loaded with a halo that shrinks by the radius of every stage, so the intermediate images stay in the cache.
+ * The result is bit identical to apply_chain_stage(...) for every stage.
+ *
+ * @param padded_img Image to which the stages are applied, is not changed, its padding is chain->padding
+ * @param chain Chain of the stages
+ * @param first First stage
+ * @param last Stage after the last applied one
+ * @param args Arguments to the program, the number of used processes is used for computation
+ * @param buffer Output buffer, contains the result with updated borders
+ */
+void apply_chain_stages_fused(ImageWithPadding *padded_img, KernelChain *chain, int first, int last, Args *args,
+                              ImageWithPadding *buffer);
+
+/**
+ * Runs args->number_of_iterations iterations of the whole chain on a contiguous image, group by group
+ *
+ * @param padded_img Image to apply the chain to, holds the result afterwards
+ * @param chain Planned chain
+ * @param args Arguments to the program
+ * @param buffer Buffer image to avoid repeated allocation
+ */
+void run_kernel_chain(ImageWithPadding **padded_img, KernelChain *chain, Args *args, ImageWithPadding **buffer);
+
+/**
+ * Benchmark how long it takes to apply the chain to an image, see benchmark(...)
+ *
+ * @return time it took to apply the chain
+ */
+time_t chain_benchmark(ImageWithPadding **padded_img, KernelChain *chain, Args *args, ImageWithPadding **buffer);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_CHAIN_H
@@ -0,0 +1,296 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "convolution-channels.h"
+#include "convolution-run.h"
+#include "convolution-simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHANNELS_X86 1
+#include <immintrin.h>
+#endif
+
+static InterleavedRowKernel select_interleaved_row_kernel(void);
+
+ChannelKernels *init_channel_kernels(Image **kernels, int channels) {
+    for (int c = 1; c < channels; ++c) {
+        if (kernels[c]->width != kernels[0]->width || kernels[c]->height != kernels[0]->height) {
+            for (int i = 0; i < channels; ++i) {
+                free_image(kernels[i]);
+            }
+            return NULL;
+        }
+    }
+    ChannelKernels *channel_kernels = (ChannelKernels *) malloc(sizeof(ChannelKernels));
+    channel_kernels->channels = channels;
+    channel_kernels->width = kernels[0]->width;
+    channel_kernels->height = kernels[0]->height;
+    for (int c = 0; c < channels; ++c) {
+        channel_kernels->kernels[c] = kernels[c];
+        select_fixed_kernel(kernels[c], &channel_kernels->fixed[c]);
+    }
+    channel_kernels->interleaved = select_interleaved_row_kernel();
+    int taps = channel_kernels->width * channel_kernels->height;
+    channel_kernels->pattern = (double *) malloc(sizeof(double) * taps * CHANNEL_BLOCK_SIZE);
+    for (int ky = 0; ky < channel_kernels->height; ++ky) {
+        for (int kx = 0; kx < channel_kernels->width; ++kx) {
+            double *coefficients = channel_kernels->pattern + (ky * channel_kernels->width + kx) * CHANNEL_BLOCK_SIZE;
+            for (int i = 0; i < CHANNEL_BLOCK_SIZE; ++i) {
+                coefficients[i] = kernels[i % channels]->image[ky][kx];
+            }
+        }
+    }
+    return channel_kernels;
+}
+
+void free_channel_kernels(ChannelKernels *kernels) {
+    if (kernels != NULL) {
+        for (int c = 0; c < kernels->channels; ++c) {
+            free_image(kernels->kernels[c]);
+        }
+        free(kernels->pattern);
+        free(kernels);
+    }
+}
+
+/**
+ * Read a kernel file, the extent of the image in the arguments is kept
+ */
+static Image *read_kernel_file(const char *path, Args *args) {
+    int width = args->width;
+    int height = args->height;
+    FILE *fd = fopen(path, "r");
+    Image *kernel = read_image_from_fd(fd, args);
+    fclose(fd);
+    args->width = width;
+    args->height = height;
+    return kernel;
+}
+
+ChannelKernels *create_channel_kernels(Args *args) {
+    Image *kernels[CHANNELS_MAX];
+    int count = 0;
+    if (args->opt_kernel_from_file) {
+        // split a copy of the list, every file name is terminated where its comma was
+        size_t length = strlen(args->kernel_file_path);
+        char *list = (char *) malloc(length + 1);
+        memcpy(list, args->kernel_file_path, length + 1);
+        char *path = list;
+        while (path != NULL && count < CHANNELS_MAX) {
+            char *comma = strchr(path, ',');
+            if (comma != NULL) {
+                *comma = '\0';
+            }
+            kernels[count] = read_kernel_file(path, args);
+            if (kernels[count] == NULL) {
+                // an empty or broken kernel file, the list is rejected as a whole
+                break;
+            }
+            count++;
+            path = comma != NULL ? comma + 1 : NULL;
+        }
+        free(list);
+        if (path != NULL || (count != 1 && count != args->channels)) {
+            for (int c = 0; c < count; ++c) {
+                free_image(kernels[c]);
+            }
+            return NULL;
+        }
+    } else {
+        kernels[count++] = get_default_kernel();
+    }
+    // a single kernel is shared by all channels
+    for (int c = count; c < args->channels; ++c) {
+        kernels[c] = copy_shape(kernels[0]);
+        copy_image(kernels[0], kernels[c]);
+    }
+    return init_channel_kernels(kernels, args->channels);
+}
+
+ChannelImage *create_channel_image(Args *args, int padding) {
+    Image *img = args->opt_image_from_file ? create_image(args)
+                                           : init_image(args->width * args->channels, args->height, 1.0);
+    if (img == NULL) {
+        return NULL;
+    }
+    ChannelImage *channel_img = split_channels(img, args->channels, padding, args->channel_layout);
+    free_image(img);
+    if (channel_img != NULL) {
+        args->width = channel_img->inner_width;
+    }
+    return channel_img;
+}
+
+void apply_interleaved_kernels_to_row(const double *const *rows, ChannelKernels *kernels, double *out, int count) {
+    int channels = kernels->channels;
+    int x = 0;
+    // every block starts with channel 0, so the channel of a value is its index in the block modulo channels.
+    // Several blocks share every load of the coefficients
+    for (; x + CHANNEL_BLOCKS_PER_STRIP * CHANNEL_BLOCK_SIZE <= count; x += CHANNEL_BLOCKS_PER_STRIP * CHANNEL_BLOCK_SIZE) {
+        double acc[CHANNEL_BLOCKS_PER_STRIP][CHANNEL_BLOCK_SIZE] = {{0.0}};
+        const double *coefficients = kernels->pattern;
+        for (int ky = 0; ky < kernels->height; ++ky) {
+            const double *row = rows[ky] + x;
+            for (int kx = 0; kx < kernels->width; ++kx) {
+                const double *window = row + kx * channels;
+#pragma omp simd
+                for (int i = 0; i < CHANNEL_BLOCK_SIZE; ++i) {
+                    for (int b = 0; b < CHANNEL_BLOCKS_PER_STRIP; ++b) {
+                        acc[b][i] += coefficients[i] * window[b * CHANNEL_BLOCK_SIZE + i];
+                    }
+                }
+                coefficients += CHANNEL_BLOCK_SIZE;
+            }
+        }
+        for (int b = 0; b < CHANNEL_BLOCKS_PER_STRIP; ++b) {
+#pragma omp simd
+            for (int i = 0; i < CHANNEL_BLOCK_SIZE; ++i) {
+                out[x + b * CHANNEL_BLOCK_SIZE + i] = acc[b][i];
+            }
+        }
+    }
+    for (int i = 0; x + i < count; ++i) {
+        double val = 0.0;
+        const double *coefficients = kernels->pattern + i % CHANNEL_BLOCK_SIZE;
+        for (int ky = 0; ky < kernels->height; ++ky) {
+            const double *row = rows[ky] + x + i;
+            for (int kx = 0; kx < kernels->width; ++kx) {
+                val += *coefficients * row[kx * channels];
+                coefficients += CHANNEL_BLOCK_SIZE;
+            }
+        }
+        out[x + i] = val;
+    }
+}
+
+#ifdef CHANNELS_X86
+
+/**
+ * AVX-512 version of apply_interleaved_kernels_to_row(...).
+ * A strip of four blocks is kept in twelve registers, the three registers of coefficients of a kernel value
+ * are loaded once per strip.
+ */
+__attribute__((target("avx512f")))
+static void apply_interleaved_kernels_to_row_avx512(const double *const *rows, ChannelKernels *kernels, double *out,
+                                                    int count) {
+    int channels = kernels->channels;
+    int x = 0;
+    for (; x + 4 * CHANNEL_BLOCK_SIZE <= count; x += 4 * CHANNEL_BLOCK_SIZE) {
+        __m512d acc[12];
+        for (int i = 0; i < 12; ++i) {
+            acc[i] = _mm512_setzero_pd();
+        }
+        const double *coefficients = kernels->pattern;
+        for (int ky = 0; ky < kernels->height; ++ky) {
+            const double *row = rows[ky] + x;
+            for (int kx = 0; kx < kernels->width; ++kx) {
+                const double *window = row + kx * channels;
+                __m512d c0 = _mm512_loadu_pd(coefficients);
+                __m512d c1 = _mm512_loadu_pd(coefficients + 8);
+                __m512d c2 = _mm512_loadu_pd(coefficients + 16);
+                for (int b = 0; b < 4; ++b) {
+                    const double *block = window + b * CHANNEL_BLOCK_SIZE;
+                    acc[3 * b] = _mm512_fmadd_pd(c0, _mm512_loadu_pd(block), acc[3 * b]);
+                    acc[3 * b + 1] = _mm512_fmadd_pd(c1, _mm512_loadu_pd(block + 8), acc[3 * b + 1]);
+                    acc[3 * b + 2] = _mm512_fmadd_pd(c2, _mm512_loadu_pd(block + 16), acc[3 * b + 2]);
+                }
+                coefficients += CHANNEL_BLOCK_SIZE;
+            }
+        }
+        for (int i = 0; i < 12; ++i) {
+            _mm512_storeu_pd(out + x + 8 * i, acc[i]);
+        }
+    }
+    for (; x < count; x += 8) {
+        // the coefficients of a value only depend on its position in the block
+        __mmask8 mask = count - x < 8 ? (__mmask8) ((1u << (count - x)) - 1u) : (__mmask8) 0xFF;
+        __m512d acc = _mm512_setzero_pd();
+        const double *coefficients = kernels->pattern + x % CHANNEL_BLOCK_SIZE;
+        for (int ky = 0; ky < kernels->height; ++ky) {
+            const double *row = rows[ky] + x;
+            for (int kx = 0; kx < kernels->width; ++kx) {
+                acc = _mm512_fmadd_pd(_mm512_loadu_pd(coefficients),
+                                      _mm512_maskz_loadu_pd(mask, row + kx * channels), acc);
+                coefficients += CHANNEL_BLOCK_SIZE;
+            }
+        }
+        _mm512_mask_storeu_pd(out + x, mask, acc);
+    }
+}
+
+static InterleavedRowKernel select_interleaved_row_kernel(void) {
+    return simd_supports_avx512() ? apply_interleaved_kernels_to_row_avx512 : apply_interleaved_kernels_to_row;
+}
+
+#else
+
+static InterleavedRowKernel select_interleaved_row_kernel(void) {
+    return apply_interleaved_kernels_to_row;
+}
+
+#endif
+
+/**
+ * Clamp the left and right padding of a row of a plane to the outer pixels
+ */
+static void update_channel_row_borders(ChannelImage *img, double *row) {
+    int values = img->values_per_pixel;
+    int first = img->padding * values;
+    int last = (img->padding + img->inner_width - 1) * values;
+    for (int i = 0; i < first; ++i) {
+        row[i] = row[first + i % values];
+        row[last + values + i] = row[last + i % values];
+    }
+}
+
+void apply_kernels_to_channel_image(ChannelImage *img, ChannelKernels *kernels, Args *args, ChannelImage *buffer) {
+    int rows = img->planes * img->inner_height;
+    int padding_rows = img->planes * img->padding;
+    size_t row_size = sizeof(double) * img->width * img->values_per_pixel;
+#pragma omp parallel num_threads(args->number_of_processes)
+    {
+        // the rows of all planes are distributed at once, a thread may continue in the next channel
+#pragma omp for schedule(static)
+        for (int i = 0; i < rows; ++i) {
+            int plane = i / img->inner_height;
+            int y = i % img->inner_height;
+            // the window of the first pixel of the row starts at the upper left corner of the padding
+            const double *const *window = (const double *const *) img->rows + plane * img->height + y;
+            double *out = buffer->rows[plane * buffer->height + y + buffer->padding];
+            if (img->layout == CHANNELS_PLANAR) {
+                apply_fixed_kernel_to_row(&kernels->fixed[plane], kernels->kernels[plane], window,
+                                          out + img->padding, img->inner_width);
+            } else {
+                kernels->interleaved(window, kernels, out + img->padding * img->channels,
+                                     img->inner_width * img->channels);
+            }
+            update_channel_row_borders(buffer, out);
+        }
+        // the upper and lower padding rows copy the first and last row once all rows are done
+#pragma omp for schedule(static)
+        for (int i = 0; i < padding_rows; ++i) {
+            double **plane_rows = buffer->rows + (i / buffer->padding) * buffer->height;
+            int y = i % buffer->padding;
+            memcpy(plane_rows[y], plane_rows[buffer->padding], row_size);
+            memcpy(plane_rows[buffer->height - 1 - y], plane_rows[buffer->height - 1 - buffer->padding], row_size);
+        }
+    }
+}
+
+void run_on_channel_image(ChannelImage **img, ChannelKernels *kernels, Args *args, ChannelImage **buffer) {
+    for (int i = 0; i < args->number_of_iterations; i++) {
+        apply_kernels_to_channel_image(*img, kernels, args, *buffer);
+        swap_ptr(img, buffer, ChannelImage*);
+    }
+}
+
+time_t channel_benchmark(ChannelImage **img, ChannelKernels *kernels, Args *args, ChannelImage **buffer) {
+    time_t seq_t;
+    printf("Starting Kernel...\n");
+    TIC(0);
+    run_on_channel_image(img, kernels, args, buffer);
+    seq_t = TOC(0);
+    printf("Kernel time: %zu.%06zus\n", seq_t / 1000000, seq_t % 1000000);
+    return seq_t;
+}
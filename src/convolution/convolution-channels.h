@@ -0,0 +1,130 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_CHANNELS_H
+#define HG_C_BENCHMARKS_CONVOLUTION_CHANNELS_H
+
+#include "convolution-util.h"
+#include "convolution-fixed.h"
+
+// number of values the interleaved row kernel computes at once,
+// a multiple of every number of channels up to CHANNELS_MAX and of the number of doubles in a SIMD register
+#define CHANNEL_BLOCK_SIZE (24)
+// number of blocks that are computed with the same coefficients
+#define CHANNEL_BLOCKS_PER_STRIP (4)
+
+struct ChannelKernels;
+
+/**
+ * Typedef of a function that applies the kernels of the channels to count consecutive values of an interleaved row,
+ * see apply_interleaved_kernels_to_row(...)
+ */
+typedef void (*InterleavedRowKernel)(const double *const *rows, struct ChannelKernels *kernels, double *out,
+                                     int count);
+
+/**
+ * Kernels of the channels of an image, all of the same extent
+ */
+struct ChannelKernels {
+    int channels;
+    int width;
+    int height;
+    // kernel of every channel, owned by this struct
+    Image *kernels[CHANNELS_MAX];
+    // implementation of every kernel for planar images
+    FixedKernel fixed[CHANNELS_MAX];
+    // coefficients for interleaved images, value (ky * width + kx) * CHANNEL_BLOCK_SIZE + i is the coefficient
+    // kx, ky of the kernel of channel i % channels
+    double *pattern;
+    // row kernel for interleaved images, the AVX-512 version if the executing CPU supports it
+    InterleavedRowKernel interleaved;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct ChannelKernels ChannelKernels;
+
+/**
+ * Combine the kernels of the channels of an image
+ *
+ * @param kernels One kernel per channel, the struct takes ownership of them
+ * @param channels Number of channels, at most CHANNELS_MAX
+ * @return Kernels of the channels, NULL if the kernels differ in their extent, they are freed then.
+ * Must be freed with free_channel_kernels(...)
+ */
+ChannelKernels *init_channel_kernels(Image **kernels, int channels);
+
+/**
+ * @param kernels Kernels to free, may be NULL
+ */
+void free_channel_kernels(ChannelKernels *kernels);
+
+/**
+ * Create the kernels of the channels based on the arguments.
+ * args->kernel_file_path is a comma separated list of either one kernel that is shared by all channels
+ * or one kernel per channel. Without a kernel file all channels use get_default_kernel(...).
+ *
+ * @param args Program arguments
+ * @return Kernels of the channels, NULL if a kernel file could not be read, the number of kernels does not match
+ * or their extents differ
+ */
+ChannelKernels *create_channel_kernels(Args *args);
+
+/**
+ * Create a multi-channel image based on the arguments, see create_image(...).
+ * Every row of the image file holds args->channels interleaved values per pixel, args->width is set to the
+ * number of pixels of a row afterwards.
+ *
+ * @param args Program arguments
+ * @param padding Padding of the image in pixels
+ * @return Created image in args->channel_layout, NULL if the image can not be read or its width is not a
+ * multiple of the number of channels
+ */
+ChannelImage *create_channel_image(Args *args, int padding);
+
+/**
+ * Apply the kernels of the channels to count consecutive values of an interleaved row.
+ * Value i belongs to channel i % channels, the window of a value only covers values of its channel.
+ * Every output sums the products in the same order as apply_kernel_to_window(...).
+ *
+ * @param rows rows[y] points to the value of kernel row y that is multiplied with the first coefficient for out[0],
+ * out[0] must belong to channel 0
+ * @param kernels Kernels of the channels
+ * @param out Output values
+ * @param count Number of values
+ */
+void apply_interleaved_kernels_to_row(const double *const *rows, ChannelKernels *kernels, double *out, int count);
+
+/**
+ * Apply the kernel of every channel on every pixel of a multi-channel image in a single pass.
+ * The rows of all channels are shared by the threads of one parallel region, planar images use the fixed size
+ * or SIMD row kernel of each channel and interleaved images compute all channels of a pixel in the same
+ * SIMD registers. The borders of the buffer are updated in the same parallel region.
+ *
+ * @param img Image to which the kernels are applied, its padding must be half of the kernel extent
+ * @param kernels Kernels of the channels
+ * @param args Arguments to the program, the number of used processes is used for computation
+ * @param buffer Output buffer with the extent and layout of the image
+ */
+void apply_kernels_to_channel_image(ChannelImage *img, ChannelKernels *kernels, Args *args, ChannelImage *buffer);
+
+/**
+ * Runs args->number_of_iterations iterations on a multi-channel image, see run_on_padded_image(...)
+ *
+ * @param img Image to apply the kernels to, holds the result afterwards
+ * @param kernels Kernels of the channels
+ * @param args Arguments to the program, number of iterations and used processes are used for computation
+ * @param buffer Buffer image to avoid repeated allocation
+ */
+void run_on_channel_image(ChannelImage **img, ChannelKernels *kernels, Args *args, ChannelImage **buffer);
+
+/**
+ * Benchmark how long it takes to apply the kernels to a multi-channel image, see benchmark(...)
+ *
+ * @return time it took to apply the kernels
+ */
+time_t channel_benchmark(ChannelImage **img, ChannelKernels *kernels, Args *args, ChannelImage **buffer);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_CHANNELS_H
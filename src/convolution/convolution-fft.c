@@ -0,0 +1,253 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <math.h>
+#include "convolution-fft.h"
+
+#ifndef M_PI
+#define M_PI (3.14159265358979323846)
+#endif
+
+FftPlan *init_fft_plan(int size) {
+    FftPlan *plan = (FftPlan *) malloc(sizeof(FftPlan));
+    plan->size = size;
+    plan->twiddle_re = (double *) malloc(sizeof(double) * (size / 2 + 1));
+    plan->twiddle_im = (double *) malloc(sizeof(double) * (size / 2 + 1));
+    plan->reverse = (int *) malloc(sizeof(int) * size);
+    for (int k = 0; k < size / 2; ++k) {
+        double angle = -2.0 * M_PI * k / size;
+        plan->twiddle_re[k] = cos(angle);
+        plan->twiddle_im[k] = sin(angle);
+    }
+    int bits = 0;
+    while ((1 << bits) < size) {
+        ++bits;
+    }
+    for (int i = 0; i < size; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        plan->reverse[i] = reversed;
+    }
+    return plan;
+}
+
+void free_fft_plan(FftPlan *plan) {
+    if (plan != NULL) {
+        free(plan->twiddle_re);
+        free(plan->twiddle_im);
+        free(plan->reverse);
+        free(plan);
+    }
+}
+
+void fft(FftPlan *plan, double *re, double *im, bool inverse) {
+    int size = plan->size;
+    for (int i = 0; i < size; ++i) {
+        int j = plan->reverse[i];
+        if (i < j) {
+            double t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+    double sign = inverse ? -1.0 : 1.0;
+    for (int length = 2; length <= size; length *= 2) {
+        int half = length / 2;
+        int step = size / length;
+        for (int begin = 0; begin < size; begin += length) {
+            for (int k = 0; k < half; ++k) {
+                double w_re = plan->twiddle_re[k * step];
+                double w_im = sign * plan->twiddle_im[k * step];
+                int a = begin + k;
+                int b = a + half;
+                double t_re = re[b] * w_re - im[b] * w_im;
+                double t_im = re[b] * w_im + im[b] * w_re;
+                re[b] = re[a] - t_re;
+                im[b] = im[a] - t_im;
+                re[a] += t_re;
+                im[a] += t_im;
+            }
+        }
+    }
+}
+
+/**
+ * In place transposition of a square matrix
+ */
+static void transpose(double *values, int size) {
+    for (int y = 0; y < size; ++y) {
+        for (int x = y + 1; x < size; ++x) {
+            double t = values[y * size + x];
+            values[y * size + x] = values[x * size + y];
+            values[x * size + y] = t;
+        }
+    }
+}
+
+void fft_2d(FftPlan *plan, double *re, double *im, bool inverse) {
+    int size = plan->size;
+    for (int y = 0; y < size; ++y) {
+        fft(plan, re + y * size, im + y * size, inverse);
+    }
+    transpose(re, size);
+    transpose(im, size);
+    for (int y = 0; y < size; ++y) {
+        fft(plan, re + y * size, im + y * size, inverse);
+    }
+}
+
+double fft_cost_per_pixel(Image *kernel, int size) {
+    int block_width = size - kernel->width + 1;
+    int block_height = size - kernel->height + 1;
+    if (block_width <= 0 || block_height <= 0) {
+        return INFINITY;
+    }
+    double log_size = log2((double) size);
+    // forward and inverse transform: two passes of size rows with size / 2 * log(size) butterflies each
+    double transforms = 2.0 * 2.0 * size * (size / 2.0) * log_size * FFT_BUTTERFLY_COST;
+    if (2.0 * sizeof(double) * size * size > FFT_CACHE_BYTES) {
+        transforms *= FFT_SPILL_COST;
+    }
+    double multiply = (double) size * size * FFT_MULTIPLY_COST;
+    // every transform covers two blocks
+    return (transforms + multiply) / (2.0 * block_width * block_height);
+}
+
+int fft_tile_size(Image *kernel, int width, int height) {
+    int best_size = 0;
+    double best_cost = INFINITY;
+    int largest = width > height ? width : height;
+    largest += (kernel->width > kernel->height ? kernel->width : kernel->height) - 1;
+    for (int size = FFT_MIN_TILE_SIZE; size <= FFT_MAX_TILE_SIZE; size *= 2) {
+        double cost = fft_cost_per_pixel(kernel, size);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_size = size;
+        }
+        // the whole image already fits into a single tile
+        if (size >= largest) {
+            break;
+        }
+    }
+    return best_size;
+}
+
+FftKernel *init_fft_kernel(Image *kernel, int size) {
+    FftKernel *fft_kernel = (FftKernel *) malloc(sizeof(FftKernel));
+    fft_kernel->size = size;
+    fft_kernel->kernel_width = kernel->width;
+    fft_kernel->kernel_height = kernel->height;
+    fft_kernel->plan = init_fft_plan(size);
+    fft_kernel->re = (double *) calloc((size_t) size * size, sizeof(double));
+    fft_kernel->im = (double *) calloc((size_t) size * size, sizeof(double));
+    // the direct engine correlates, flipping the kernel turns the circular convolution into a correlation
+    for (int y = 0; y < kernel->height; ++y) {
+        for (int x = 0; x < kernel->width; ++x) {
+            fft_kernel->re[(kernel->height - 1 - y) * size + (kernel->width - 1 - x)] = kernel->image[y][x];
+        }
+    }
+    fft_2d(fft_kernel->plan, fft_kernel->re, fft_kernel->im, false);
+    return fft_kernel;
+}
+
+void free_fft_kernel(FftKernel *kernel) {
+    if (kernel != NULL) {
+        free_fft_plan(kernel->plan);
+        free(kernel->re);
+        free(kernel->im);
+        free(kernel);
+    }
+}
+
+/**
+ * Copy the tile of the padded image starting at the padded coordinates (x, y) into values.
+ * Values outside the padded image are set to zero, they only influence outputs that are discarded.
+ */
+static void load_tile(ImageWithPadding *padded_img, int x, int y, int size, double *values) {
+    int columns = padded_img->width - x < size ? padded_img->width - x : size;
+    for (int row = 0; row < size; ++row) {
+        double *out = values + row * size;
+        if (y + row < padded_img->height) {
+            memcpy(out, padded_img->image[y + row] + x, sizeof(double) * columns);
+            memset(out + columns, 0, sizeof(double) * (size - columns));
+        } else {
+            memset(out, 0, sizeof(double) * size);
+        }
+    }
+}
+
+/**
+ * Write the valid part of a transformed tile to the output block starting at the inner coordinates (x, y)
+ */
+static void store_block(FftKernel *kernel, ImageWithPadding *buffer, int x, int y, const double *values) {
+    int size = kernel->size;
+    int block_width = size - kernel->kernel_width + 1;
+    int block_height = size - kernel->kernel_height + 1;
+    int columns = buffer->inner_width - x < block_width ? buffer->inner_width - x : block_width;
+    int rows = buffer->inner_height - y < block_height ? buffer->inner_height - y : block_height;
+    double scale = 1.0 / ((double) size * size);
+    for (int row = 0; row < rows; ++row) {
+        const double *in = values + (row + kernel->kernel_height - 1) * size + kernel->kernel_width - 1;
+        double *out = &ACCESS_IMAGE(buffer, x, y + row);
+        for (int column = 0; column < columns; ++column) {
+            out[column] = in[column] * scale;
+        }
+    }
+}
+
+void apply_fft_kernel_to_padded_image(ImageWithPadding *padded_img, FftKernel *kernel, Args *args,
+                                      ImageWithPadding *buffer) {
+    int size = kernel->size;
+    int block_width = size - kernel->kernel_width + 1;
+    int block_height = size - kernel->kernel_height + 1;
+    int blocks_x = (padded_img->inner_width + block_width - 1) / block_width;
+    int blocks_y = (padded_img->inner_height + block_height - 1) / block_height;
+    int blocks = blocks_x * blocks_y;
+    // the padding of the image must cover the kernel, otherwise the tiles would not line up
+    int offset_x = padded_img->padding - kernel->kernel_width / 2;
+    int offset_y = padded_img->padding - kernel->kernel_height / 2;
+#pragma omp parallel num_threads(args->number_of_processes)
+    {
+        double *re = (double *) malloc(sizeof(double) * size * size);
+        double *im = (double *) malloc(sizeof(double) * size * size);
+#pragma omp for schedule(dynamic)
+        for (int pair = 0; pair < (blocks + 1) / 2; ++pair) {
+            int first = 2 * pair;
+            int second = 2 * pair + 1;
+            int first_x = (first % blocks_x) * block_width;
+            int first_y = (first / blocks_x) * block_height;
+            load_tile(padded_img, first_x + offset_x, first_y + offset_y, size, re);
+            int second_x = 0, second_y = 0;
+            if (second < blocks) {
+                second_x = (second % blocks_x) * block_width;
+                second_y = (second / blocks_x) * block_height;
+                load_tile(padded_img, second_x + offset_x, second_y + offset_y, size, im);
+            } else {
+                memset(im, 0, sizeof(double) * size * size);
+            }
+
+            fft_2d(kernel->plan, re, im, false);
+            for (int i = 0; i < size * size; ++i) {
+                double product_re = re[i] * kernel->re[i] - im[i] * kernel->im[i];
+                double product_im = re[i] * kernel->im[i] + im[i] * kernel->re[i];
+                re[i] = product_re;
+                im[i] = product_im;
+            }
+            fft_2d(kernel->plan, re, im, true);
+
+            // the kernel is real, so the real part belongs to the first tile and the imaginary part to the second
+            store_block(kernel, buffer, first_x, first_y, re);
+            if (second < blocks) {
+                store_block(kernel, buffer, second_x, second_y, im);
+            }
+        }
+        free(re);
+        free(im);
+    }
+}
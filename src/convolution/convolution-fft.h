@@ -0,0 +1,146 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_FFT_H
+#define HG_C_BENCHMARKS_CONVOLUTION_FFT_H
+
+#include "convolution-util.h"
+
+// smallest and largest edge length of a tile of the fft engine
+#define FFT_MIN_TILE_SIZE (16)
+#define FFT_MAX_TILE_SIZE (512)
+// cost of a radix 2 butterfly relative to a multiply add of the SIMD row kernels of the direct engine,
+// measured with AVX-512 on a 1024x1024 image
+#define FFT_BUTTERFLY_COST (70.0)
+// cost of a complex multiplication of the spectra relative to a multiply add of the SIMD row kernels
+#define FFT_MULTIPLY_COST (35.0)
+// tiles whose real and imaginary part exceed this size do not fit into the L2 cache any more ...
+#define FFT_CACHE_BYTES (1 << 20)
+// ... and their butterflies become this much more expensive
+#define FFT_SPILL_COST (3.0)
+// cost of a multiply add of the scalar row kernel relative to the SIMD row kernels
+#define FFT_SCALAR_DIRECT_COST (15.0)
+
+/**
+ * Precomputed tables for a radix 2 complex fft of a fixed size
+ */
+struct FftPlan {
+    int size;
+    // size / 2 twiddle factors exp(-2 pi i k / size)
+    double *twiddle_re;
+    double *twiddle_im;
+    // bit reversed index of every element
+    int *reverse;
+};
+
+/**
+ * Spectrum of a kernel, cached for all iterations.
+ * The image is cut into tiles of size x size values, every tile yields
+ * a block of (size - kernel_width + 1) x (size - kernel_height + 1) output values (overlap-save).
+ */
+struct FftKernel {
+    int size;
+    int kernel_width;
+    int kernel_height;
+    struct FftPlan *plan;
+    // spectrum of the flipped kernel, stored transposed like the result of fft_2d(...)
+    double *re;
+    double *im;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct FftPlan FftPlan;
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct FftKernel FftKernel;
+
+/**
+ * Create the tables for a fft of the given size
+ * @param size Number of elements, must be a power of two
+ * @return Plan, must be freed with free_fft_plan(...)
+ */
+FftPlan *init_fft_plan(int size);
+
+/**
+ * Free the tables of a plan
+ * @param plan Plan to free, may be NULL
+ */
+void free_fft_plan(FftPlan *plan);
+
+/**
+ * In place complex fft of plan->size elements, the inverse transform is not scaled
+ *
+ * @param plan Plan of the size of the data
+ * @param re Real parts
+ * @param im Imaginary parts
+ * @param inverse Compute the inverse transform, i.e. use exp(+2 pi i k / size)
+ */
+void fft(FftPlan *plan, double *re, double *im, bool inverse);
+
+/**
+ * In place two dimensional complex fft of size x size row major elements.
+ * Every row is transformed, the matrix transposed and every row is transformed again,
+ * so the result is transposed. Applying the inverse transform to it restores the original orientation.
+ * The inverse transform is not scaled.
+ *
+ * @param plan Plan of the edge length of the data
+ * @param re Real parts
+ * @param im Imaginary parts
+ * @param inverse Compute the inverse transform
+ */
+void fft_2d(FftPlan *plan, double *re, double *im, bool inverse);
+
+/**
+ * Estimated cost of the fft engine per output pixel in multiply adds of the direct engine
+ *
+ * @param kernel Kernel to apply
+ * @param size Edge length of a tile
+ * @return cost per pixel, infinite if the kernel does not fit into the tile
+ */
+double fft_cost_per_pixel(Image *kernel, int size);
+
+/**
+ * Choose the edge length of the tiles with the smallest estimated cost.
+ * Tiles are never larger than necessary to cover the whole image in one tile.
+ *
+ * @param kernel Kernel to apply
+ * @param width Width of the image
+ * @param height Height of the image
+ * @return power of two between FFT_MIN_TILE_SIZE and FFT_MAX_TILE_SIZE, 0 if the kernel does not fit into any tile
+ */
+int fft_tile_size(Image *kernel, int width, int height);
+
+/**
+ * Compute the spectrum of a kernel for tiles of the given size
+ *
+ * @param kernel Kernel to transform
+ * @param size Edge length of the tiles, must be a power of two and larger than the kernel
+ * @return Spectrum of the kernel, must be freed with free_fft_kernel(...)
+ */
+FftKernel *init_fft_kernel(Image *kernel, int size);
+
+/**
+ * Free the spectrum of a kernel
+ * @param kernel Kernel to free, may be NULL
+ */
+void free_fft_kernel(FftKernel *kernel);
+
+/**
+ * Apply a kernel on every pixel of an image with the overlap-save method, like apply_kernel_to_padded_image(...).
+ * The values outside the image are taken from the padding, so the borders are clamped exactly like the direct engine.
+ * Since kernel and image are real, two tiles are transformed at once as real and imaginary part.
+ *
+ * @param padded_img Image to which the kernel is applied
+ * @param kernel Spectrum of the kernel
+ * @param args Arguments to the program, the number of used processes is used for computation
+ * @param buffer Output buffer
+ */
+void apply_fft_kernel_to_padded_image(ImageWithPadding *padded_img, FftKernel *kernel, Args *args,
+                                      ImageWithPadding *buffer);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_FFT_H
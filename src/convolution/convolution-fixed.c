@@ -0,0 +1,147 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "convolution-fixed.h"
+#include "convolution-run.h"
+
+/**
+ * Loop over count windows with a N x N kernel whose coefficients are stored in the array c.
+ * Both loops over the kernel have a constant trip count and are fully unrolled.
+ */
+#define FIXED_KERNEL_LOOP(N, c) \
+    _Pragma("omp simd simdlen(8)") \
+    for (int x = 0; x < count; ++x) { \
+        double val = 0.0; \
+        _Pragma("GCC unroll 8") \
+        for (int ky = 0; ky < (N); ++ky) { \
+            const double *row = rows[ky] + x; \
+            _Pragma("GCC unroll 8") \
+            for (int kx = 0; kx < (N); ++kx) { \
+                val += c[ky * (N) + kx] * row[kx]; \
+            } \
+        } \
+        out[x] = val; \
+    }
+
+/**
+ * Define apply_kernel_NxN_to_row(...), the coefficients are copied into locals so they can stay in registers
+ */
+#define DEFINE_FIXED_KERNEL(N) \
+void apply_kernel_##N##x##N##_to_row(const double *const *rows, const double *coefficients, double *out, \
+                                     int count) { \
+    double c[(N) * (N)]; \
+    for (int i = 0; i < (N) * (N); ++i) { \
+        c[i] = coefficients[i]; \
+    } \
+    FIXED_KERNEL_LOOP(N, c) \
+}
+
+/**
+ * Define a function for a N x N kernel with the given constant coefficients
+ */
+#define DEFINE_BAKED_KERNEL(name, N, ...) \
+void apply_##name##_kernel_to_row(const double *const *rows, const double *coefficients, double *out, \
+                                  int count) { \
+    static const double c[(N) * (N)] = __VA_ARGS__; \
+    (void) coefficients; \
+    FIXED_KERNEL_LOOP(N, c) \
+}
+
+DEFINE_FIXED_KERNEL(3)
+
+DEFINE_FIXED_KERNEL(5)
+
+DEFINE_FIXED_KERNEL(7)
+
+#ifdef CONVOLUTION_BAKED_KERNELS
+
+// must match get_default_kernel(...)
+#define DEFAULT_KERNEL_COEFFICIENTS { \
+     2, -2,  2, -2,  2, \
+    -2,  2, -2,  2, -2, \
+     2, -2, -1, -2,  2, \
+    -2,  2, -2,  2, -2, \
+     2, -2,  2, -2,  2}
+
+// must match get_2d_laplace_kernel(...)
+#define LAPLACE_KERNEL_COEFFICIENTS { \
+    0,  1, 0, \
+    1, -4, 1, \
+    0,  1, 0}
+
+DEFINE_BAKED_KERNEL(default, 5, DEFAULT_KERNEL_COEFFICIENTS)
+
+DEFINE_BAKED_KERNEL(laplace, 3, LAPLACE_KERNEL_COEFFICIENTS)
+
+/**
+ * Check whether the kernel has exactly the given coefficients
+ */
+static bool kernel_equals(Image *kernel, int size, const double *coefficients) {
+    if (kernel->width != size || kernel->height != size) {
+        return false;
+    }
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            if (kernel->image[y][x] != coefficients[y * size + x]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#endif
+
+bool select_fixed_kernel(Image *kernel, FixedKernel *fixed) {
+    fixed->generic = select_row_kernel();
+    fixed->name = row_kernel_name(fixed->generic);
+    fixed->row = NULL;
+    if (kernel->width != kernel->height || kernel->width > FIXED_KERNEL_MAX_SIZE) {
+        return false;
+    }
+    for (int y = 0; y < kernel->height; ++y) {
+        for (int x = 0; x < kernel->width; ++x) {
+            fixed->coefficients[y * kernel->width + x] = kernel->image[y][x];
+        }
+    }
+#ifdef CONVOLUTION_BAKED_KERNELS
+    static const double default_coefficients[] = DEFAULT_KERNEL_COEFFICIENTS;
+    static const double laplace_coefficients[] = LAPLACE_KERNEL_COEFFICIENTS;
+    if (kernel_equals(kernel, 5, default_coefficients)) {
+        fixed->name = "default";
+        fixed->row = apply_default_kernel_to_row;
+        return true;
+    }
+    if (kernel_equals(kernel, 3, laplace_coefficients)) {
+        fixed->name = "laplace";
+        fixed->row = apply_laplace_kernel_to_row;
+        return true;
+    }
+#endif
+    switch (kernel->width) {
+        case 3:
+            fixed->name = "3x3";
+            fixed->row = apply_kernel_3x3_to_row;
+            break;
+        case 5:
+            fixed->name = "5x5";
+            fixed->row = apply_kernel_5x5_to_row;
+            break;
+        case 7:
+            fixed->name = "7x7";
+            fixed->row = apply_kernel_7x7_to_row;
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+void apply_fixed_kernel_to_row(FixedKernel *fixed, Image *kernel, const double *const *rows, double *out, int count) {
+    if (fixed->row != NULL) {
+        fixed->row(rows, fixed->coefficients, out, count);
+    } else {
+        fixed->generic(rows, kernel, out, count);
+    }
+}
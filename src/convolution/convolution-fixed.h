@@ -0,0 +1,100 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_FIXED_H
+#define HG_C_BENCHMARKS_CONVOLUTION_FIXED_H
+
+#include "convolution-util.h"
+#include "convolution-simd.h"
+
+// largest kernel with a specialized implementation
+#define FIXED_KERNEL_MAX_SIZE (7)
+
+/**
+ * Typedef of a function that applies a kernel of fixed size to count consecutive windows of a row,
+ * see apply_kernel_to_row(...)
+ */
+typedef void (*FixedKernelRow)(const double *const *rows, const double *coefficients, double *out, int count);
+
+/**
+ * Specialized implementation of a kernel
+ */
+struct FixedKernel {
+    // name of the implementation, the name of the generic row kernel if there is none
+    const char *name;
+    // implementation, NULL if the generic row kernel has to be used
+    FixedKernelRow row;
+    // widest SIMD row kernel of the executing CPU, used for all other kernels
+    RowKernel generic;
+    // coefficients of the kernel, row major
+    double coefficients[FIXED_KERNEL_MAX_SIZE * FIXED_KERNEL_MAX_SIZE];
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct FixedKernel FixedKernel;
+
+/**
+ * Fully unrolled kernels of fixed size, the coefficients are given row major and kept in registers.
+ * The outputs are computed in SIMD lanes, every output sums the products in the same order as
+ * apply_kernel_to_window(...).
+ *
+ * @param rows rows[y] points to the value of kernel row y that is multiplied with the first coefficient for out[0]
+ * @param coefficients Coefficients of the kernel, row major
+ * @param out Output values, out[x] is the value of the window starting x values further right
+ * @param count Number of windows
+ */
+void apply_kernel_3x3_to_row(const double *const *rows, const double *coefficients, double *out, int count);
+
+/**
+ * See apply_kernel_3x3_to_row(...)
+ */
+void apply_kernel_5x5_to_row(const double *const *rows, const double *coefficients, double *out, int count);
+
+/**
+ * See apply_kernel_3x3_to_row(...)
+ */
+void apply_kernel_7x7_to_row(const double *const *rows, const double *coefficients, double *out, int count);
+
+#ifdef CONVOLUTION_BAKED_KERNELS
+
+/**
+ * The kernel of get_default_kernel(...) baked in at compile time, the coefficients argument is ignored.
+ * See apply_kernel_3x3_to_row(...)
+ */
+void apply_default_kernel_to_row(const double *const *rows, const double *coefficients, double *out, int count);
+
+/**
+ * The kernel of get_2d_laplace_kernel(...) baked in at compile time, the coefficients argument is ignored.
+ * See apply_kernel_3x3_to_row(...)
+ */
+void apply_laplace_kernel_to_row(const double *const *rows, const double *coefficients, double *out, int count);
+
+#endif
+
+/**
+ * Select the specialized implementation of a kernel.
+ * Kernels that are equal to a baked kernel use it, other square kernels of size 3, 5 and 7 use the
+ * fully unrolled implementation of their size. All other kernels use the widest SIMD row kernel of the CPU.
+ *
+ * @param kernel Kernel that is going to be applied
+ * @param fixed Selected implementation
+ * @return true if a fixed size implementation was found
+ */
+bool select_fixed_kernel(Image *kernel, FixedKernel *fixed);
+
+/**
+ * Apply a kernel to count consecutive windows of a row with the selected implementation,
+ * falls back to the generic row kernel if there is none.
+ *
+ * @param fixed Implementation selected by select_fixed_kernel(...)
+ * @param kernel Kernel to apply
+ * @param rows rows[y] points to the value of kernel row y that is multiplied with the first coefficient for out[0]
+ * @param out Output values, out[x] is the value of the window starting x values further right
+ * @param count Number of windows
+ */
+void apply_fixed_kernel_to_row(FixedKernel *fixed, Image *kernel, const double *const *rows, double *out, int count);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_FIXED_H
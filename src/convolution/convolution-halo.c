@@ -0,0 +1,130 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "convolution-halo.h"
+#include "convolution-fixed.h"
+#include "convolution-simd.h"
+
+/**
+ * Columns at one side of the image that are computed from clamped copies.
+ * Every row of the image that is covered by the kernel has a strip in a ring of kernel->height strips,
+ * consecutive output rows only copy the one row that enters the window.
+ */
+struct HaloEdge {
+    // first output column and number of output columns
+    int x;
+    int count;
+    // number of computed windows, count rounded up to whole blocks
+    int windows;
+    // number of values of a strip, windows + kernel->width - 1
+    int length;
+    double *strips;
+    const double **rows;
+    // the windows behind count are computed into the scratch and dropped
+    double *out;
+};
+
+/**
+ * Number of windows the row kernel computes at once, shorter segments of a row end in slow remainder loops
+ */
+static int halo_block(FixedKernel *fixed) {
+    if (fixed->row != NULL) {
+        // simdlen of the fixed size kernels
+        return 8;
+    }
+    if (fixed->generic == apply_kernel_to_row_avx512) {
+        return 32;
+    }
+    return fixed->generic == apply_kernel_to_row_avx2 ? 16 : 1;
+}
+
+static int round_up_to_block(int count, int block) {
+    return (count + block - 1) / block * block;
+}
+
+static void init_halo_edge(struct HaloEdge *edge, Image *kernel, int block, int x, int count) {
+    edge->x = x;
+    edge->count = count;
+    edge->windows = round_up_to_block(count, block);
+    edge->length = edge->windows + kernel->width - 1;
+    edge->strips = (double *) malloc(sizeof(double) * kernel->height * edge->length);
+    edge->rows = (const double **) malloc(sizeof(const double *) * kernel->height);
+    edge->out = (double *) malloc(sizeof(double) * (edge->windows > 0 ? edge->windows : 1));
+}
+
+static void free_halo_edge(struct HaloEdge *edge) {
+    free(edge->strips);
+    free(edge->rows);
+    free(edge->out);
+}
+
+/**
+ * Copy the columns of a row that are covered by the windows of the edge, the indices are clamped to the image
+ */
+static void copy_clamped_strip(struct HaloEdge *edge, const double *row, int width, int first, double *strip) {
+    for (int i = 0; i < edge->length; ++i) {
+        int column = first + i;
+        strip[i] = row[column < 0 ? 0 : (column >= width ? width - 1 : column)];
+    }
+}
+
+void apply_kernel_with_virtual_halo(ImageWithPadding *img, Image *kernel, Args *args, ImageWithPadding *buffer) {
+    FixedKernel fixed;
+    select_fixed_kernel(kernel, &fixed);
+    int width = img->inner_width;
+    int height = img->inner_height;
+    int radius_x = kernel->width / 2;
+    int radius_y = kernel->height / 2;
+    // the left edge covers all columns whose window starts left of the image, so the interior windows start at
+    // column 0 like the ones of the padded image. The interior covers whole blocks whose window ends inside of the
+    // image and the right edge all other columns
+    int block = halo_block(&fixed);
+    int left = radius_x < width ? radius_x : width;
+    int last = width - (kernel->width - 1 - radius_x);
+    int right = last > left ? left + (last - left) / block * block : left;
+#pragma omp parallel num_threads(args->number_of_processes)
+    {
+        const double **rows = (const double **) malloc(sizeof(const double *) * kernel->height);
+        struct HaloEdge edges[2];
+        init_halo_edge(&edges[0], kernel, block, 0, left);
+        init_halo_edge(&edges[1], kernel, block, right, width - right);
+        // last output row of the thread whose strips are in the rings, none yet
+        int copied = -2;
+#pragma omp for schedule(static)
+        for (int y = 0; y < height; ++y) {
+            // the rows above and below the image are clamped like the aliased rows of the padding
+            for (int ky = 0; ky < kernel->height; ++ky) {
+                rows[ky] = &ACCESS_IMAGE(img, 0, clamp(0, y - radius_y + ky, height - 1));
+            }
+            double *out = &ACCESS_IMAGE(buffer, 0, y);
+            int entering = y == copied + 1 ? kernel->height - 1 : 0;
+            for (int e = 0; e < 2; ++e) {
+                struct HaloEdge *edge = &edges[e];
+                if (edge->count == 0) {
+                    continue;
+                }
+                for (int ky = entering; ky < kernel->height; ++ky) {
+                    copy_clamped_strip(edge, rows[ky], width, edge->x - radius_x,
+                                       edge->strips + (size_t) ((y + ky) % kernel->height) * edge->length);
+                }
+                for (int ky = 0; ky < kernel->height; ++ky) {
+                    edge->rows[ky] = edge->strips + (size_t) ((y + ky) % kernel->height) * edge->length;
+                }
+                apply_fixed_kernel_to_row(&fixed, kernel, edge->rows, edge->out, edge->windows);
+                memcpy(out + edge->x, edge->out, sizeof(double) * edge->count);
+            }
+            copied = y;
+            if (right > left) {
+                // the window of column x starts at column x - radius_x
+                for (int ky = 0; ky < kernel->height; ++ky) {
+                    rows[ky] += left - radius_x;
+                }
+                apply_fixed_kernel_to_row(&fixed, kernel, rows, out + left, right - left);
+            }
+        }
+        free_halo_edge(&edges[0]);
+        free_halo_edge(&edges[1]);
+        free(rows);
+    }
+}
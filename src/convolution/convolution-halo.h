@@ -0,0 +1,24 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_HALO_H
+#define HG_C_BENCHMARKS_CONVOLUTION_HALO_H
+
+#include "convolution-util.h"
+
+/**
+ * Apply a kernel on every pixel of an image without padding, like apply_kernel_to_padded_image(...).
+ * The halo is virtual: the rows above and below the image are clamped by pointing to the first and last row,
+ * the whole blocks of columns that are covered by the kernel use the unconditional fixed size or SIMD row kernel
+ * and only the columns at each side read through a small strip of clamped copies.
+ * Neither the image nor the buffer needs padding and update_borders(...) is not needed after an iteration.
+ *
+ * @param img Image to which the kernel is applied, its padding is ignored
+ * @param kernel Kernel to apply
+ * @param args Arguments to the program, the number of used processes is used for computation
+ * @param buffer Output buffer with the extent of the image
+ */
+void apply_kernel_with_virtual_halo(ImageWithPadding *img, Image *kernel, Args *args, ImageWithPadding *buffer);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_HALO_H
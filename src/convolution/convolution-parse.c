@@ -0,0 +1,351 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <stdint.h>
+#include "convolution-parse.h"
+
+// mantissas with more significant digits may not be representable, they are handed to strtod
+#define MAX_EXACT_DIGITS (19)
+// largest power of ten that is exactly representable as double
+#define MAX_EXACT_POWER (22)
+
+static const double exact_powers_of_ten[MAX_EXACT_POWER + 1] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * Errors that can be found while parsing the lines of a chunk
+ */
+enum ParseError {
+    PARSE_OK = 0,
+    PARSE_SHORT_LINE,
+    PARSE_INVALID_VALUE
+};
+
+/**
+ * Block of the file that is kept in memory.
+ * data[size] is always a terminating zero, so strtod stops at the end of the buffer.
+ */
+struct TextBuffer {
+    char *data;
+    size_t size;
+    size_t capacity;
+    // number of bytes read from the file so far
+    size_t total;
+};
+
+static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * Values are separated by spaces, tabs and the carriage return of windows line endings
+ */
+static inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * Append a digit to the mantissa as long as it stays exact
+ * @return false if the digit had to be dropped
+ */
+static inline bool append_digit(uint64_t *mantissa, int *significant, int digit) {
+    if (*significant < MAX_EXACT_DIGITS) {
+        *mantissa = *mantissa * 10 + (uint64_t) digit;
+        if (*mantissa != 0) {
+            ++*significant;
+        }
+        return true;
+    }
+    return false;
+}
+
+const char *parse_double(const char *begin, double *value) {
+    const char *p = begin;
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        ++p;
+    }
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool digits = false;
+    // only dropped digits that are not zero change the value
+    bool exact = true;
+    for (; is_digit(*p); ++p) {
+        digits = true;
+        if (!append_digit(&mantissa, &significant, *p - '0')) {
+            ++exponent;
+            exact = exact && *p == '0';
+        }
+    }
+    if (*p == '.') {
+        for (++p; is_digit(*p); ++p) {
+            digits = true;
+            if (append_digit(&mantissa, &significant, *p - '0')) {
+                --exponent;
+            } else {
+                exact = exact && *p == '0';
+            }
+        }
+    }
+    if (!digits) {
+        // no digits at all, may still be inf or nan
+        char *end;
+        *value = strtod(begin, &end);
+        return end == begin || is_blank(*begin) || *begin == '\n' ? NULL : end;
+    }
+    if (*p == 'e' || *p == 'E') {
+        const char *e = p + 1;
+        bool negative_exponent = false;
+        if (*e == '-' || *e == '+') {
+            negative_exponent = *e == '-';
+            ++e;
+        }
+        // an 'e' without digits is not part of the number, like strtod
+        if (is_digit(*e)) {
+            int value_of_exponent = 0;
+            for (; is_digit(*e); ++e) {
+                if (value_of_exponent < 100000) {
+                    value_of_exponent = value_of_exponent * 10 + (*e - '0');
+                }
+            }
+            exponent += negative_exponent ? -value_of_exponent : value_of_exponent;
+            p = e;
+        }
+    }
+    if (exact && mantissa <= (UINT64_C(1) << 53) && exponent >= -MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER) {
+        // mantissa and power of ten are exact, so the single division or multiplication rounds correctly
+        double result = (double) mantissa;
+        if (exponent < 0) {
+            result /= exact_powers_of_ten[-exponent];
+        } else {
+            result *= exact_powers_of_ten[exponent];
+        }
+        *value = negative ? -result : result;
+        return p;
+    }
+    char *end;
+    *value = strtod(begin, &end);
+    return end;
+}
+
+/**
+ * Read the next block of the file behind the data in the buffer.
+ * The buffer grows if it is full, so a line never has to be split.
+ *
+ * @return Number of bytes read, 0 at the end of the file
+ */
+static size_t fill_buffer(struct TextBuffer *buffer, FILE *fd) {
+    if (buffer->size == buffer->capacity) {
+        buffer->capacity *= 2;
+        buffer->data = (char *) realloc(buffer->data, buffer->capacity + 1);
+        if (buffer->data == NULL) {
+            bail_out("text buffer could not be allocated");
+        }
+    }
+    size_t read = fread(buffer->data + buffer->size, 1, buffer->capacity - buffer->size, fd);
+    buffer->size += read;
+    buffer->total += read;
+    buffer->data[buffer->size] = '\0';
+    return read;
+}
+
+/**
+ * Parse a non negative integer of the header line
+ * @return Parsed value, -1 if there is no number
+ */
+static int parse_extent(const char **p) {
+    while (is_blank(**p)) {
+        ++*p;
+    }
+    if (!is_digit(**p)) {
+        return -1;
+    }
+    int value = 0;
+    for (; is_digit(**p); ++*p) {
+        value = value * 10 + (**p - '0');
+    }
+    return value;
+}
+
+/**
+ * Count the lines between begin and end, a last line without newline counts as well
+ */
+static int count_lines(const char *begin, const char *end) {
+    int lines = 0;
+    while (begin < end) {
+        const char *newline = (const char *) memchr(begin, '\n', (size_t) (end - begin));
+        ++lines;
+        if (newline == NULL) {
+            break;
+        }
+        begin = newline + 1;
+    }
+    return lines;
+}
+
+/**
+ * Parse the lines between begin and end into the rows of the image, starting at the given row.
+ * Lines behind the height of the image are skipped.
+ */
+static enum ParseError parse_lines(const char *begin, const char *end, Image *img, int row) {
+    while (begin < end) {
+        const char *line_end = (const char *) memchr(begin, '\n', (size_t) (end - begin));
+        if (line_end == NULL) {
+            line_end = end;
+        }
+        if (row < img->height) {
+            double *out = img->image[row];
+            const char *p = begin;
+            for (int x = 0; x < img->width; ++x) {
+                while (p < line_end && is_blank(*p)) {
+                    ++p;
+                }
+                if (p == line_end) {
+                    return PARSE_SHORT_LINE;
+                }
+                p = parse_double(p, &out[x]);
+                if (p == NULL || (p < line_end && !is_blank(*p))) {
+                    return PARSE_INVALID_VALUE;
+                }
+            }
+        }
+        ++row;
+        begin = line_end + 1;
+    }
+    return PARSE_OK;
+}
+
+/**
+ * Parse complete lines in parallel.
+ * The block is split into chunks at line boundaries, the first row of every chunk
+ * is found by counting the lines of all chunks before it.
+ *
+ * @return Number of lines in the block
+ */
+static int parse_block(const char *begin, const char *end, Image *img, int first_row, int threads) {
+    int chunks = threads * TEXT_PARSE_CHUNKS_PER_THREAD;
+    const char **bounds = (const char **) malloc(sizeof(const char *) * (chunks + 1));
+    int *rows = (int *) malloc(sizeof(int) * (chunks + 1));
+    size_t length = (size_t) (end - begin);
+    bounds[0] = begin;
+    for (int i = 1; i < chunks; ++i) {
+        const char *split = begin + length / chunks * i;
+        if (split < bounds[i - 1]) {
+            split = bounds[i - 1];
+        }
+        const char *newline = (const char *) memchr(split, '\n', (size_t) (end - split));
+        bounds[i] = newline != NULL ? newline + 1 : end;
+    }
+    bounds[chunks] = end;
+
+    rows[0] = first_row;
+#pragma omp parallel for num_threads(threads) schedule(static) if(threads > 1)
+    for (int i = 0; i < chunks; ++i) {
+        rows[i + 1] = count_lines(bounds[i], bounds[i + 1]);
+    }
+    for (int i = 0; i < chunks; ++i) {
+        rows[i + 1] += rows[i];
+    }
+
+    int error = PARSE_OK;
+#pragma omp parallel for num_threads(threads) schedule(dynamic) reduction(max:error) if(threads > 1)
+    for (int i = 0; i < chunks; ++i) {
+        int chunk_error = parse_lines(bounds[i], bounds[i + 1], img, rows[i]);
+        if (chunk_error > error) {
+            error = chunk_error;
+        }
+    }
+    int lines = rows[chunks] - first_row;
+    free(bounds);
+    free(rows);
+
+    if (error == PARSE_SHORT_LINE) {
+        bail_out("the file dimensions were not correct, less number of values in a line than given width");
+    } else if (error == PARSE_INVALID_VALUE) {
+        bail_out("a value of the file could not be parsed");
+    }
+    return lines;
+}
+
+Image *parse_text_image(FILE *fd, int threads, TextParseStats *stats) {
+    time_t start = mytime();
+    struct TextBuffer buffer = {NULL, 0, TEXT_PARSE_BLOCK_SIZE, 0};
+    // small files like kernels and tiles do not need a whole block, one more byte detects the end of the file
+    long position = ftell(fd);
+    if (position >= 0 && fseek(fd, 0, SEEK_END) == 0) {
+        long remaining = ftell(fd) - position;
+        fseek(fd, position, SEEK_SET);
+        if (remaining >= 0 && remaining < TEXT_PARSE_BLOCK_SIZE) {
+            buffer.capacity = (size_t) remaining + 1;
+        }
+    }
+    buffer.data = (char *) malloc(buffer.capacity + 1);
+    if (buffer.data == NULL) {
+        bail_out("text buffer could not be allocated");
+    }
+    buffer.data[0] = '\0';
+
+    // the header line "<height> <width>"
+    const char *header_end;
+    bool eof = false;
+    while ((header_end = (const char *) memchr(buffer.data, '\n', buffer.size)) == NULL && !eof) {
+        eof = fill_buffer(&buffer, fd) == 0;
+    }
+    if (buffer.size == 0) {
+        free(buffer.data);
+        return NULL;
+    }
+    const char *p = buffer.data;
+    int height = parse_extent(&p);
+    if (height < 0) bail_out("height couldn't be read from file");
+    int width = parse_extent(&p);
+    if (width < 0) bail_out("width couldn't be read from file");
+    size_t offset = header_end != NULL ? (size_t) (header_end + 1 - buffer.data) : buffer.size;
+
+    Image *img = init_image(width, height, 0.0);
+    int row = 0;
+    for (;;) {
+        // parse all complete lines, the last line of the file does not need a newline
+        size_t end = buffer.size;
+        if (!eof) {
+            while (end > offset && buffer.data[end - 1] != '\n') {
+                --end;
+            }
+        }
+        if (end > offset) {
+            row += parse_block(buffer.data + offset, buffer.data + end, img, row, threads);
+            offset = end;
+        }
+        if (eof || row >= height) {
+            break;
+        }
+        // keep the incomplete line and read the next block behind it
+        memmove(buffer.data, buffer.data + offset, buffer.size - offset);
+        buffer.size -= offset;
+        offset = 0;
+        eof = fill_buffer(&buffer, fd) == 0;
+    }
+    free(buffer.data);
+    if (row < height) {
+        free_image(img);
+        bail_out("the file did not have enough lines to read");
+    }
+    if (stats != NULL) {
+        stats->bytes = buffer.total;
+        stats->time = mytime() - start;
+    }
+    return img;
+}
+
+double parse_throughput(const TextParseStats *stats) {
+    if (stats->time <= 0) {
+        return 0.0;
+    }
+    // bytes per microsecond are megabytes per second
+    return (double) stats->bytes / (double) stats->time;
+}
@@ -0,0 +1,63 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_PARSE_H
+#define HG_C_BENCHMARKS_CONVOLUTION_PARSE_H
+
+#include "convolution-util.h"
+
+// number of bytes that are read from the file at once, the buffer grows if a single line is longer
+#define TEXT_PARSE_BLOCK_SIZE (1 << 24)
+// every thread parses this many chunks of a block, evens out lines of different length
+#define TEXT_PARSE_CHUNKS_PER_THREAD (4)
+
+/**
+ * Statistics of parsing a text image
+ */
+struct TextParseStats {
+    // number of bytes that have been read from the file
+    size_t bytes;
+    // time spent reading and parsing in microseconds
+    time_t time;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct TextParseStats TextParseStats;
+
+/**
+ * Parse a floating point number.
+ * Numbers with at most 19 significant digits and a small exponent are converted directly,
+ * everything else (long mantissas, large exponents, inf, nan, hex) is handed to strtod.
+ * Both ways round correctly, so the result is identical to strtod.
+ *
+ * @param begin First character of the number, leading whitespace is not skipped
+ * @param value Parsed number
+ * @return Pointer behind the number, NULL if begin does not point to a number
+ */
+const char *parse_double(const char *begin, double *value);
+
+/**
+ * Read an image in the text format from a file.
+ * The first line holds "<height> <width>", followed by one line of whitespace separated values per row.
+ * The file is read in blocks of TEXT_PARSE_BLOCK_SIZE bytes, the complete lines of every block
+ * are split into chunks that are parsed in parallel. Lines may be arbitrarily long.
+ * Values behind the width of a row and lines behind the height of the image are ignored.
+ * Bails out if the file is shorter than its header claims or a value can not be parsed.
+ *
+ * @param fd File to read the image from
+ * @param threads Number of threads that parse the lines
+ * @param stats Statistics of the parsing, may be NULL
+ * @return Image read from the file
+ */
+Image *parse_text_image(FILE *fd, int threads, TextParseStats *stats);
+
+/**
+ * @param stats Statistics of a parsed image
+ * @return Parse throughput in MB/s
+ */
+double parse_throughput(const TextParseStats *stats);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_PARSE_H
@@ -0,0 +1,298 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <stdint.h>
+#include <math.h>
+#include "convolution-precision.h"
+#include "convolution-simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PRECISION_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Type of the row kernels for float images
+ */
+typedef void (*FloatRowKernel)(const float *const *rows, const float *coefficients, int kernel_width,
+                               int kernel_height, float *out, int count);
+
+TypedImage *init_typed_image(int inner_width, int inner_height, int padding, PixelType type) {
+    TypedImage *img = (TypedImage *) malloc(sizeof(TypedImage));
+    size_t size = pixel_type_size(type);
+    int per_line = IMAGE_ALIGNMENT / (int) size;
+    img->type = type;
+    img->padding = padding;
+    img->inner_width = inner_width;
+    img->inner_height = inner_height;
+    img->width = inner_width + 2 * padding;
+    img->height = inner_height + 2 * padding;
+    img->stride = ((img->width + per_line - 1) / per_line) * per_line;
+    size_t bytes = (size_t) img->height * img->stride * size;
+    // aligned_alloc demands a size that is a multiple of the alignment
+    bytes = ((bytes + IMAGE_ALIGNMENT - 1) / IMAGE_ALIGNMENT) * IMAGE_ALIGNMENT;
+    img->data = aligned_alloc(IMAGE_ALIGNMENT, bytes > 0 ? bytes : IMAGE_ALIGNMENT);
+    if (img->data == NULL) {
+        bail_out("typed image could not be allocated");
+    }
+    memset(img->data, 0, bytes);
+    return img;
+}
+
+TypedImage *convert_padded_image(ImageWithPadding *padded_img, PixelType type) {
+    TypedImage *img = init_typed_image(padded_img->inner_width, padded_img->inner_height, padded_img->padding, type);
+    for (int y = 0; y < img->height; ++y) {
+        char *row = typed_row(img, y);
+        for (int x = 0; x < img->width; ++x) {
+            store_pixel(row, x, type, ACCESS_FIELD(padded_img, x, y));
+        }
+    }
+    return img;
+}
+
+void free_typed_image(TypedImage *img) {
+    if (img != NULL) {
+        free(img->data);
+        free(img);
+    }
+}
+
+void update_typed_borders(TypedImage *img) {
+    size_t size = pixel_type_size(img->type);
+    int padding = img->padding;
+    // left and right bounds
+    for (int y = padding; y < padding + img->inner_height; ++y) {
+        char *row = typed_row(img, y);
+        for (int x = 0; x < padding; ++x) {
+            memcpy(row + x * size, row + padding * size, size);
+            memcpy(row + (padding + img->inner_width + x) * size, row + (padding + img->inner_width - 1) * size, size);
+        }
+    }
+    // upper and lower bounds, including the corners
+    for (int y = 0; y < padding; ++y) {
+        memcpy(typed_row(img, y), typed_row(img, padding), img->width * size);
+        memcpy(typed_row(img, padding + img->inner_height + y), typed_row(img, padding + img->inner_height - 1),
+               img->width * size);
+    }
+}
+
+double get_typed_checksum(TypedImage *img) {
+    double val = 0.0;
+    for (int y = 0; y < img->inner_height; ++y) {
+        const char *row = typed_row(img, y + img->padding);
+        for (int x = 0; x < img->inner_width; ++x) {
+            val += load_pixel(row, x + img->padding, img->type);
+        }
+    }
+    return val;
+}
+
+void apply_kernel_to_float_row(const float *const *rows, const float *coefficients, int kernel_width,
+                               int kernel_height, float *out, int count) {
+    int x = 0;
+    // full blocks keep their accumulators in registers for all taps
+    for (; x + PRECISION_BLOCK_SIZE <= count; x += PRECISION_BLOCK_SIZE) {
+        float acc[PRECISION_BLOCK_SIZE] = {0.0f};
+        for (int ky = 0; ky < kernel_height; ++ky) {
+            const float *row = rows[ky] + x;
+            for (int kx = 0; kx < kernel_width; ++kx) {
+                const float coefficient = coefficients[ky * kernel_width + kx];
+#pragma omp simd
+                for (int i = 0; i < PRECISION_BLOCK_SIZE; ++i) {
+                    acc[i] += coefficient * row[kx + i];
+                }
+            }
+        }
+        memcpy(out + x, acc, sizeof(acc));
+    }
+    // remaining windows of the row
+    for (; x < count; ++x) {
+        float value = 0.0f;
+        for (int ky = 0; ky < kernel_height; ++ky) {
+            for (int kx = 0; kx < kernel_width; ++kx) {
+                value += coefficients[ky * kernel_width + kx] * rows[ky][x + kx];
+            }
+        }
+        out[x] = value;
+    }
+}
+
+#ifdef PRECISION_X86
+
+/**
+ * AVX-512 version of apply_kernel_to_float_row(...), four independent accumulators hide the latency of the FMAs
+ */
+__attribute__((target("avx512f")))
+static void apply_kernel_to_float_row_avx512(const float *const *rows, const float *coefficients, int kernel_width,
+                                             int kernel_height, float *out, int count) {
+    int x = 0;
+    for (; x + 64 <= count; x += 64) {
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        __m512 acc2 = _mm512_setzero_ps();
+        __m512 acc3 = _mm512_setzero_ps();
+        for (int ky = 0; ky < kernel_height; ++ky) {
+            const float *row = rows[ky] + x;
+            const float *row_coefficients = coefficients + ky * kernel_width;
+            for (int kx = 0; kx < kernel_width; ++kx) {
+                __m512 c = _mm512_set1_ps(row_coefficients[kx]);
+                acc0 = _mm512_fmadd_ps(c, _mm512_loadu_ps(row + kx), acc0);
+                acc1 = _mm512_fmadd_ps(c, _mm512_loadu_ps(row + kx + 16), acc1);
+                acc2 = _mm512_fmadd_ps(c, _mm512_loadu_ps(row + kx + 32), acc2);
+                acc3 = _mm512_fmadd_ps(c, _mm512_loadu_ps(row + kx + 48), acc3);
+            }
+        }
+        _mm512_storeu_ps(out + x, acc0);
+        _mm512_storeu_ps(out + x + 16, acc1);
+        _mm512_storeu_ps(out + x + 32, acc2);
+        _mm512_storeu_ps(out + x + 48, acc3);
+    }
+    for (; x < count; x += 16) {
+        // the last strip must neither read behind the row nor write behind the output
+        __mmask16 mask = count - x < 16 ? (__mmask16) ((1u << (count - x)) - 1u) : (__mmask16) 0xFFFF;
+        __m512 acc = _mm512_setzero_ps();
+        for (int ky = 0; ky < kernel_height; ++ky) {
+            const float *row = rows[ky] + x;
+            const float *row_coefficients = coefficients + ky * kernel_width;
+            for (int kx = 0; kx < kernel_width; ++kx) {
+                __m512 c = _mm512_set1_ps(row_coefficients[kx]);
+                acc = _mm512_fmadd_ps(c, _mm512_maskz_loadu_ps(mask, row + kx), acc);
+            }
+        }
+        _mm512_mask_storeu_ps(out + x, mask, acc);
+    }
+}
+
+static FloatRowKernel select_float_row_kernel(void) {
+    return simd_supports_avx512() ? apply_kernel_to_float_row_avx512 : apply_kernel_to_float_row;
+}
+
+#else
+
+static FloatRowKernel select_float_row_kernel(void) {
+    return apply_kernel_to_float_row;
+}
+
+#endif
+
+/**
+ * Widening of integer rows to float and rounding, saturating narrowing back
+ */
+#define DEFINE_INTEGER_ROWS(type, suffix, minimum, maximum) \
+    static void widen_##suffix##_row(const type *from, float *to, int count) { \
+        _Pragma("omp simd") \
+        for (int x = 0; x < count; ++x) { \
+            to[x] = (float) from[x]; \
+        } \
+    } \
+    static void narrow_##suffix##_row(const float *from, type *to, int count) { \
+        _Pragma("omp simd") \
+        for (int x = 0; x < count; ++x) { \
+            float value = from[x] < (minimum) ? (minimum) : (from[x] > (maximum) ? (maximum) : from[x]); \
+            to[x] = (type) floorf(value + 0.5f); \
+        } \
+    }
+
+DEFINE_INTEGER_ROWS(uint8_t, uint8, 0.0f, 255.0f)
+
+DEFINE_INTEGER_ROWS(uint16_t, uint16, 0.0f, 65535.0f)
+
+DEFINE_INTEGER_ROWS(int16_t, int16, -32768.0f, 32767.0f)
+
+static void widen_row(PixelType type, const char *from, float *to, int count) {
+    if (type == PIXEL_UINT8) {
+        widen_uint8_row((const uint8_t *) from, to, count);
+    } else if (type == PIXEL_UINT16) {
+        widen_uint16_row((const uint16_t *) from, to, count);
+    } else {
+        widen_int16_row((const int16_t *) from, to, count);
+    }
+}
+
+static void narrow_row(PixelType type, const float *from, char *to, int count) {
+    if (type == PIXEL_UINT8) {
+        narrow_uint8_row(from, (uint8_t *) to, count);
+    } else if (type == PIXEL_UINT16) {
+        narrow_uint16_row(from, (uint16_t *) to, count);
+    } else {
+        narrow_int16_row(from, (int16_t *) to, count);
+    }
+}
+
+void run_on_typed_image(TypedImage **img, Image *kernel, Args *args, TypedImage **buffer) {
+    PixelType type = (*img)->type;
+    if (type == PIXEL_FLOAT64) {
+        bail_out("float64 images are convolved by run_on_padded_image");
+    }
+    int kernel_width = kernel->width;
+    int kernel_height = kernel->height;
+    float *coefficients = (float *) malloc(sizeof(float) * kernel_width * kernel_height);
+    for (int y = 0; y < kernel_height; ++y) {
+        for (int x = 0; x < kernel_width; ++x) {
+            coefficients[y * kernel_width + x] = (float) kernel->image[y][x];
+        }
+    }
+    size_t size = pixel_type_size(type);
+    FloatRowKernel row_kernel = select_float_row_kernel();
+
+    for (int i = 0; i < args->number_of_iterations; ++i) {
+        TypedImage *source = *img;
+        TypedImage *target = *buffer;
+        int padding = target->padding;
+#pragma omp parallel num_threads(args->number_of_processes)
+        {
+            const float **rows = (const float **) malloc(sizeof(const float *) * kernel_height);
+            // integer rows are widened once into a ring of kernel_height rows, results are narrowed from out
+            float *ring = NULL;
+            float *out = NULL;
+            // last row of the thread whose window is widened, none yet
+            int widened = -2;
+            if (type != PIXEL_FLOAT32) {
+                ring = (float *) malloc(sizeof(float) * kernel_height * source->width);
+                out = (float *) malloc(sizeof(float) * source->inner_width);
+            }
+#pragma omp for schedule(static)
+            for (int y = 0; y < source->inner_height; ++y) {
+                if (type == PIXEL_FLOAT32) {
+                    for (int ky = 0; ky < kernel_height; ++ky) {
+                        rows[ky] = (const float *) typed_row(source, y + ky);
+                    }
+                    row_kernel(rows, coefficients, kernel_width, kernel_height,
+                               (float *) typed_row(target, y + padding) + padding, source->inner_width);
+                } else {
+                    // consecutive rows of a thread only widen the one row that enters the window
+                    int first = y == widened + 1 ? y + kernel_height - 1 : y;
+                    for (int r = first; r < y + kernel_height; ++r) {
+                        widen_row(type, typed_row(source, r), ring + (size_t) (r % kernel_height) * source->width,
+                                  source->width);
+                    }
+                    widened = y;
+                    for (int ky = 0; ky < kernel_height; ++ky) {
+                        rows[ky] = ring + (size_t) ((y + ky) % kernel_height) * source->width;
+                    }
+                    row_kernel(rows, coefficients, kernel_width, kernel_height, out, source->inner_width);
+                    narrow_row(type, out, typed_row(target, y + padding) + padding * size, source->inner_width);
+                }
+            }
+            free(rows);
+            free(ring);
+            free(out);
+        }
+        update_typed_borders(target);
+        swap_ptr(img, buffer, TypedImage *);
+    }
+    free(coefficients);
+}
+
+time_t typed_benchmark(TypedImage **img, Image *kernel, Args *args, TypedImage **buffer) {
+    time_t seq_t;
+    printf("Starting Kernel...\n");
+    // start the clock
+    TIC(0);
+    run_on_typed_image(img, kernel, args, buffer);
+    seq_t = TOC(0); // stop the clock
+    // print kernel time
+    printf("Kernel time: %zu.%06zus\n", seq_t / 1000000, seq_t % 1000000);
+    return seq_t;
+}
@@ -0,0 +1,117 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_PRECISION_H
+#define HG_C_BENCHMARKS_CONVOLUTION_PRECISION_H
+
+#include "convolution-util.h"
+#include "convolution-binary.h"
+
+// number of outputs that are accumulated at once, the accumulators stay in vector registers
+#define PRECISION_BLOCK_SIZE (16)
+
+/**
+ * Padded image that stores its values in a type of reduced precision.
+ * The values are kept in one aligned block like LAYOUT_CONTIGUOUS, every row starts at a cache line.
+ */
+struct TypedImage {
+    PixelType type;
+    int width;
+    int height;
+    int padding;
+    int inner_width;
+    int inner_height;
+    // number of values between the beginning of two rows
+    int stride;
+    void *data;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct TypedImage TypedImage;
+
+/**
+ * @param img Image
+ * @param y Row, including the padding
+ * @return First value of the row, including the padding
+ */
+static inline char *typed_row(TypedImage *img, int y) {
+    return (char *) img->data + (size_t) y * img->stride * pixel_type_size(img->type);
+}
+
+/**
+ * Allocate a padded image of the given type, all values are zero
+ *
+ * @param inner_width Width of the image without padding
+ * @param inner_height Height of the image without padding
+ * @param padding Padding of the image
+ * @param type Type of the values
+ * @return Allocated image
+ */
+TypedImage *init_typed_image(int inner_width, int inner_height, int padding, PixelType type);
+
+/**
+ * Convert a padded image into the given type, integer types are rounded and saturated.
+ * The padding is converted as well.
+ *
+ * @param padded_img Image to convert
+ * @param type Type of the values
+ * @return Converted image
+ */
+TypedImage *convert_padded_image(ImageWithPadding *padded_img, PixelType type);
+
+/**
+ * @param img Image to free, may be NULL
+ */
+void free_typed_image(TypedImage *img);
+
+/**
+ * Update the padding of an image with the clamped border, see update_borders(...)
+ * @param img Image to update
+ */
+void update_typed_borders(TypedImage *img);
+
+/**
+ * Sum all inner values in double precision in the order of get_checksum(...)
+ * @param img Image to sum
+ * @return Checksum of the image
+ */
+double get_typed_checksum(TypedImage *img);
+
+/**
+ * Apply a kernel to a float image for count consecutive windows of a row.
+ * The coefficients are float and every product is accumulated in float, the taps are the outer loop
+ * so the outputs of a block are computed in full SIMD width.
+ *
+ * @param rows rows[y] points to the value of kernel row y that is multiplied with the first coefficient for out[0]
+ * @param coefficients Coefficients of the kernel, row major
+ * @param kernel_width Width of the kernel
+ * @param kernel_height Height of the kernel
+ * @param out Output values
+ * @param count Number of windows
+ */
+void apply_kernel_to_float_row(const float *const *rows, const float *coefficients, int kernel_width,
+                               int kernel_height, float *out, int count);
+
+/**
+ * Run the direct engine on an image of reduced precision for args->number_of_iterations iterations.
+ * Float images accumulate in float. Integer images are widened to float, accumulated in float
+ * and rounded and saturated when they are stored. Float64 images are not supported, they use
+ * run_on_padded_image(...).
+ *
+ * @param img Image to convolve, holds the result afterwards
+ * @param kernel Kernel to apply, the padding of the image must be kernel->width / 2
+ * @param args Number of iterations and processes
+ * @param buffer Buffer with the extent and type of the image
+ */
+void run_on_typed_image(TypedImage **img, Image *kernel, Args *args, TypedImage **buffer);
+
+/**
+ * Benchmark run_on_typed_image(...), see benchmark(...)
+ * @return Time of the convolution in microseconds
+ */
+time_t typed_benchmark(TypedImage **img, Image *kernel, Args *args, TypedImage **buffer);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_PRECISION_H
@@ -0,0 +1,287 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <math.h>
+#include "convolution-quantized.h"
+#include "convolution-simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define QUANTIZED_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Type of the row kernels for quantized images
+ */
+typedef void (*QuantizedRowKernel)(const int16_t *const *rows, QuantizedKernel *kernel, int16_t *out, int count);
+
+QuantizedKernel *quantize_kernel(Image *kernel, double tolerance) {
+    double largest = 0.0;
+    for (int y = 0; y < kernel->height; ++y) {
+        for (int x = 0; x < kernel->width; ++x) {
+            largest = fmax(largest, fabs(kernel->image[y][x]));
+        }
+    }
+    for (int shift = 0; shift <= QUANTIZED_MAX_SHIFT; ++shift) {
+        double scale = (double) (1 << shift);
+        double error = 0.0;
+        double gain = 0.0;
+        double widest = 0.0;
+        for (int y = 0; y < kernel->height; ++y) {
+            for (int x = 0; x < kernel->width; ++x) {
+                double scaled = round(kernel->image[y][x] * scale);
+                error = fmax(error, fabs(kernel->image[y][x] - scaled / scale));
+                gain += fabs(scaled);
+                widest = fmax(widest, fabs(scaled));
+            }
+        }
+        // more fraction bits only make the coefficients larger
+        if (gain > QUANTIZED_MAX_GAIN || widest > INT16_MAX) {
+            return NULL;
+        }
+        error = largest > 0.0 ? error / largest : error;
+        if (error > tolerance) {
+            continue;
+        }
+
+        QuantizedKernel *quantized = (QuantizedKernel *) malloc(sizeof(QuantizedKernel));
+        int pairs_per_row = (kernel->width + 1) / 2;
+        quantized->width = kernel->width;
+        quantized->height = kernel->height;
+        quantized->shift = shift;
+        quantized->error = error;
+        quantized->coefficients = (int16_t *) malloc(sizeof(int16_t) * kernel->width * kernel->height);
+        quantized->pairs = (int32_t *) malloc(sizeof(int32_t) * pairs_per_row * kernel->height);
+        for (int y = 0; y < kernel->height; ++y) {
+            int16_t *row = quantized->coefficients + y * kernel->width;
+            for (int x = 0; x < kernel->width; ++x) {
+                row[x] = (int16_t) round(kernel->image[y][x] * scale);
+            }
+            for (int pair = 0; pair < pairs_per_row; ++pair) {
+                uint32_t low = (uint16_t) row[2 * pair];
+                uint32_t high = 2 * pair + 1 < kernel->width ? (uint16_t) row[2 * pair + 1] : 0;
+                quantized->pairs[y * pairs_per_row + pair] = (int32_t) (low | high << 16);
+            }
+        }
+        return quantized;
+    }
+    return NULL;
+}
+
+void free_quantized_kernel(QuantizedKernel *kernel) {
+    if (kernel != NULL) {
+        free(kernel->coefficients);
+        free(kernel->pairs);
+        free(kernel);
+    }
+}
+
+TypedImage *quantize_padded_image(ImageWithPadding *padded_img, int threads) {
+    TypedImage *img = init_typed_image(padded_img->inner_width, padded_img->inner_height, padded_img->padding,
+                                       PIXEL_INT16);
+    int invalid = 0;
+#pragma omp parallel for num_threads(threads) schedule(static) reduction(+:invalid)
+    for (int y = 0; y < img->height; ++y) {
+        int16_t *row = (int16_t *) typed_row(img, y);
+        const double *values = padded_img->image[y];
+        for (int x = 0; x < img->width; ++x) {
+            // values out of range, fractions and NaN can not be represented, they are never cast
+            if (!(values[x] >= INT16_MIN && values[x] <= INT16_MAX) || values[x] != trunc(values[x])) {
+                row[x] = 0;
+                invalid++;
+                continue;
+            }
+            row[x] = (int16_t) values[x];
+        }
+    }
+    if (invalid > 0) {
+        free_typed_image(img);
+        return NULL;
+    }
+    return img;
+}
+
+/**
+ * Round half up and saturate an accumulated window
+ */
+static inline int16_t quantized_result(int32_t sum, int shift) {
+    int32_t value = shift > 0 ? (sum + (1 << (shift - 1))) >> shift : sum;
+    return (int16_t) (value < INT16_MIN ? INT16_MIN : (value > INT16_MAX ? INT16_MAX : value));
+}
+
+void apply_quantized_kernel_to_row(const int16_t *const *rows, QuantizedKernel *kernel, int16_t *out, int count) {
+    for (int x = 0; x < count; ++x) {
+        int32_t sum = 0;
+        for (int ky = 0; ky < kernel->height; ++ky) {
+            const int16_t *row = rows[ky] + x;
+            const int16_t *coefficients = kernel->coefficients + ky * kernel->width;
+            for (int kx = 0; kx < kernel->width; ++kx) {
+                sum += (int32_t) coefficients[kx] * row[kx];
+            }
+        }
+        out[x] = quantized_result(sum, kernel->shift);
+    }
+}
+
+#ifdef QUANTIZED_X86
+
+/**
+ * AVX2 version of apply_quantized_kernel_to_row(...).
+ * Interleaving the values of two neighbouring taps lets pmaddwd multiply and add both taps of 8 windows at once.
+ * The interleaving works within 128 bit lanes, so one accumulator holds windows 0-3 and 8-11 and the other one
+ * windows 4-7 and 12-15, which packing restores to their order.
+ */
+__attribute__((target("avx2")))
+static void apply_quantized_kernel_to_row_avx2(const int16_t *const *rows, QuantizedKernel *kernel, int16_t *out,
+                                               int count) {
+    int pairs_per_row = (kernel->width + 1) / 2;
+    const __m128i shift = _mm_cvtsi32_si128(kernel->shift);
+    const __m256i half = _mm256_set1_epi32(kernel->shift > 0 ? 1 << (kernel->shift - 1) : 0);
+    const __m256i zero = _mm256_setzero_si256();
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m256i low = zero;
+        __m256i high = zero;
+        for (int ky = 0; ky < kernel->height; ++ky) {
+            const int16_t *row = rows[ky] + x;
+            const int32_t *pairs = kernel->pairs + ky * pairs_per_row;
+            int kx = 0;
+            for (; kx + 1 < kernel->width; kx += 2) {
+                // sparse kernels like the one of kernel.txt skip most taps
+                if (pairs[kx / 2] == 0) {
+                    continue;
+                }
+                __m256i a = _mm256_loadu_si256((const __m256i *) (row + kx));
+                __m256i b = _mm256_loadu_si256((const __m256i *) (row + kx + 1));
+                __m256i c = _mm256_set1_epi32(pairs[kx / 2]);
+                low = _mm256_add_epi32(low, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), c));
+                high = _mm256_add_epi32(high, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), c));
+            }
+            if (kx < kernel->width && pairs[kx / 2] != 0) {
+                // the last tap of an odd row is paired with zeros, so no value behind the window is read
+                __m256i a = _mm256_loadu_si256((const __m256i *) (row + kx));
+                __m256i c = _mm256_set1_epi32(pairs[kx / 2]);
+                low = _mm256_add_epi32(low, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, zero), c));
+                high = _mm256_add_epi32(high, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, zero), c));
+            }
+        }
+        low = _mm256_sra_epi32(_mm256_add_epi32(low, half), shift);
+        high = _mm256_sra_epi32(_mm256_add_epi32(high, half), shift);
+        _mm256_storeu_si256((__m256i *) (out + x), _mm256_packs_epi32(low, high));
+    }
+    if (x < count) {
+        const int16_t **tail = (const int16_t **) malloc(sizeof(const int16_t *) * kernel->height);
+        for (int ky = 0; ky < kernel->height; ++ky) {
+            tail[ky] = rows[ky] + x;
+        }
+        apply_quantized_kernel_to_row(tail, kernel, out + x, count - x);
+        free(tail);
+    }
+}
+
+/**
+ * AVX-512 version of apply_quantized_kernel_to_row_avx2(...), the windows of every 128 bit lane are arranged alike
+ */
+__attribute__((target("avx512bw")))
+static void apply_quantized_kernel_to_row_avx512(const int16_t *const *rows, QuantizedKernel *kernel, int16_t *out,
+                                                 int count) {
+    int pairs_per_row = (kernel->width + 1) / 2;
+    const __m128i shift = _mm_cvtsi32_si128(kernel->shift);
+    const __m512i half = _mm512_set1_epi32(kernel->shift > 0 ? 1 << (kernel->shift - 1) : 0);
+    const __m512i zero = _mm512_setzero_si512();
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        __m512i low = zero;
+        __m512i high = zero;
+        for (int ky = 0; ky < kernel->height; ++ky) {
+            const int16_t *row = rows[ky] + x;
+            const int32_t *pairs = kernel->pairs + ky * pairs_per_row;
+            int kx = 0;
+            for (; kx + 1 < kernel->width; kx += 2) {
+                if (pairs[kx / 2] == 0) {
+                    continue;
+                }
+                __m512i a = _mm512_loadu_si512((const void *) (row + kx));
+                __m512i b = _mm512_loadu_si512((const void *) (row + kx + 1));
+                __m512i c = _mm512_set1_epi32(pairs[kx / 2]);
+                low = _mm512_add_epi32(low, _mm512_madd_epi16(_mm512_unpacklo_epi16(a, b), c));
+                high = _mm512_add_epi32(high, _mm512_madd_epi16(_mm512_unpackhi_epi16(a, b), c));
+            }
+            if (kx < kernel->width && pairs[kx / 2] != 0) {
+                __m512i a = _mm512_loadu_si512((const void *) (row + kx));
+                __m512i c = _mm512_set1_epi32(pairs[kx / 2]);
+                low = _mm512_add_epi32(low, _mm512_madd_epi16(_mm512_unpacklo_epi16(a, zero), c));
+                high = _mm512_add_epi32(high, _mm512_madd_epi16(_mm512_unpackhi_epi16(a, zero), c));
+            }
+        }
+        low = _mm512_sra_epi32(_mm512_add_epi32(low, half), shift);
+        high = _mm512_sra_epi32(_mm512_add_epi32(high, half), shift);
+        _mm512_storeu_si512((void *) (out + x), _mm512_packs_epi32(low, high));
+    }
+    if (x < count) {
+        const int16_t **tail = (const int16_t **) malloc(sizeof(const int16_t *) * kernel->height);
+        for (int ky = 0; ky < kernel->height; ++ky) {
+            tail[ky] = rows[ky] + x;
+        }
+        apply_quantized_kernel_to_row_avx2(tail, kernel, out + x, count - x);
+        free(tail);
+    }
+}
+
+static QuantizedRowKernel select_quantized_row_kernel(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) {
+        return apply_quantized_kernel_to_row_avx512;
+    }
+    return simd_supports_avx2() ? apply_quantized_kernel_to_row_avx2 : apply_quantized_kernel_to_row;
+}
+
+#else
+
+static QuantizedRowKernel select_quantized_row_kernel(void) {
+    return apply_quantized_kernel_to_row;
+}
+
+#endif
+
+void apply_quantized_kernel_to_typed_image(TypedImage *img, QuantizedKernel *kernel, Args *args, TypedImage *buffer) {
+    QuantizedRowKernel row_kernel = select_quantized_row_kernel();
+    int padding = buffer->padding;
+#pragma omp parallel num_threads(args->number_of_processes)
+    {
+        const int16_t **rows = (const int16_t **) malloc(sizeof(const int16_t *) * kernel->height);
+#pragma omp for schedule(static)
+        for (int y = 0; y < img->inner_height; ++y) {
+            for (int ky = 0; ky < kernel->height; ++ky) {
+                rows[ky] = (const int16_t *) typed_row(img, y + ky);
+            }
+            row_kernel(rows, kernel, (int16_t *) typed_row(buffer, y + padding) + padding, img->inner_width);
+        }
+        free(rows);
+    }
+}
+
+bool run_quantized_engine(ImageWithPadding *padded_img, QuantizedKernel *kernel, Args *args) {
+    TypedImage *img = quantize_padded_image(padded_img, args->number_of_processes);
+    if (img == NULL) {
+        return false;
+    }
+    TypedImage *buffer = init_typed_image(img->inner_width, img->inner_height, img->padding, PIXEL_INT16);
+    for (int i = 0; i < args->number_of_iterations; ++i) {
+        apply_quantized_kernel_to_typed_image(img, kernel, args, buffer);
+        update_typed_borders(buffer);
+        swap_ptr(&img, &buffer, TypedImage *);
+    }
+#pragma omp parallel for num_threads(args->number_of_processes) schedule(static)
+    for (int y = 0; y < img->inner_height; ++y) {
+        const int16_t *row = (const int16_t *) typed_row(img, y + img->padding) + img->padding;
+        for (int x = 0; x < img->inner_width; ++x) {
+            ACCESS_IMAGE(padded_img, x, y) = row[x];
+        }
+    }
+    update_borders(padded_img);
+    free_typed_image(img);
+    free_typed_image(buffer);
+    return true;
+}
@@ -0,0 +1,99 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_QUANTIZED_H
+#define HG_C_BENCHMARKS_CONVOLUTION_QUANTIZED_H
+
+#include <stdint.h>
+#include "convolution-util.h"
+#include "convolution-precision.h"
+
+// largest number of fraction bits of a quantized coefficient
+#define QUANTIZED_MAX_SHIFT (14)
+// largest sum of the absolute quantized coefficients, so a window of int16 values can not overflow an int32
+#define QUANTIZED_MAX_GAIN (INT32_MAX / 32768)
+
+/**
+ * Kernel with coefficients that are integers scaled by 2^shift.
+ * A window is accumulated in int32 and the sum is rounded and shifted back.
+ */
+struct QuantizedKernel {
+    int width;
+    int height;
+    // number of fraction bits of the coefficients
+    int shift;
+    // largest difference between a coefficient and its quantized value, relative to the largest coefficient
+    double error;
+    // height rows of width coefficients
+    int16_t *coefficients;
+    // coefficients kx and kx + 1 of every row packed into the low and high half of an int32, the last half of a
+    // row of odd width is zero. There are (width + 1) / 2 pairs per row.
+    int32_t *pairs;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct QuantizedKernel QuantizedKernel;
+
+/**
+ * Quantize a kernel with the least number of fraction bits that meets the tolerance.
+ * With a tolerance of 0 only kernels of dyadic rationals like 0.125 are quantized, which is lossless.
+ *
+ * @param kernel Kernel to quantize
+ * @param tolerance Largest error of a coefficient, relative to the largest coefficient of the kernel
+ * @return Quantized kernel, NULL if the tolerance can not be met with QUANTIZED_MAX_SHIFT fraction bits,
+ * a coefficient does not fit into an int16 or the coefficients could overflow the accumulator.
+ * Must be freed with free_quantized_kernel(...)
+ */
+QuantizedKernel *quantize_kernel(Image *kernel, double tolerance);
+
+/**
+ * @param kernel Kernel to free, may be NULL
+ */
+void free_quantized_kernel(QuantizedKernel *kernel);
+
+/**
+ * Convert a padded image to int16 if all of its values are integers in the range of int16
+ *
+ * @param padded_img Image to convert
+ * @param threads Number of threads that convert the rows
+ * @return Converted image, NULL if a value is not an integer or out of range
+ */
+TypedImage *quantize_padded_image(ImageWithPadding *padded_img, int threads);
+
+/**
+ * Apply a quantized kernel to count consecutive windows of a row, see apply_kernel_to_row(...).
+ * Every result is rounded half up and saturated to int16.
+ *
+ * @param rows rows[y] points to the value of kernel row y that is multiplied with the first coefficient for out[0]
+ * @param kernel Quantized kernel
+ * @param out Output values
+ * @param count Number of windows
+ */
+void apply_quantized_kernel_to_row(const int16_t *const *rows, QuantizedKernel *kernel, int16_t *out, int count);
+
+/**
+ * Apply a quantized kernel on every pixel of an int16 image, like apply_kernel_to_padded_image(...).
+ * Uses the AVX2 row kernel if the processor supports it.
+ *
+ * @param img Image to which the kernel is applied
+ * @param kernel Quantized kernel
+ * @param args Arguments to the program, the number of used processes is used for computation
+ * @param buffer Output buffer, its borders are not updated
+ */
+void apply_quantized_kernel_to_typed_image(TypedImage *img, QuantizedKernel *kernel, Args *args, TypedImage *buffer);
+
+/**
+ * Run args->number_of_iterations iterations of the quantized engine on an image.
+ * The image is converted to int16 once, the result is converted back into the image.
+ *
+ * @param padded_img Image to convolve, holds the result afterwards
+ * @param kernel Quantized kernel
+ * @param args Arguments to the program
+ * @return false if the image can not be represented in int16, it is unchanged then
+ */
+bool run_quantized_engine(ImageWithPadding *padded_img, QuantizedKernel *kernel, Args *args);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_QUANTIZED_H
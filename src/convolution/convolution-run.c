@@ -3,6 +3,13 @@
 //
 
 #include "convolution-run.h"
+#include "convolution-separable.h"
+#include "convolution-fft.h"
+#include "convolution-temporal.h"
+#include "convolution-fixed.h"
+#include "convolution-binary.h"
+#include "convolution-quantized.h"
+#include "convolution-halo.h"
 
 time_t benchmark(ImageWithPadding **image, Image *kernel, Args *args, ImageWithPadding **buffer) {
     time_t seq_t;
@@ -19,17 +26,67 @@ time_t benchmark(ImageWithPadding **image, Image *kernel, Args *args, ImageWithP
 Image *create_kernel(Args *args) {
     Image *kernel;
     if (args->opt_kernel_from_file) {
+        // reading a file stores its extent in the arguments, but they must keep describing the image
+        int width = args->width;
+        int height = args->height;
         FILE *fd = fopen(args->kernel_file_path, "r");
         kernel = read_image_from_fd(fd, args);
+        args->width = width;
+        args->height = height;
     } else {
         kernel = get_default_kernel();
     }
+    if (kernel != NULL && args->engine == ENGINE_AUTO) {
+        args->engine = select_engine(kernel, args);
+        if (args->debug) {
+            printf("Selected engine: %s\n", engine_name(args->engine));
+        }
+    }
+    if (kernel != NULL && args->debug && args->engine == ENGINE_DIRECT) {
+        FixedKernel fixed;
+        select_fixed_kernel(kernel, &fixed);
+        printf("Kernel implementation: %s\n", fixed.name);
+    }
+    if (kernel != NULL && args->debug && args->engine == ENGINE_QUANTIZED) {
+        QuantizedKernel *quantized = quantize_kernel(kernel, args->quantize_tolerance);
+        if (quantized != NULL) {
+            printf("Quantized kernel: %d fraction bits, relative error %g\n", quantized->shift, quantized->error);
+        } else {
+            printf("Kernel can not be quantized, falling back to the direct engine\n");
+        }
+        free_quantized_kernel(quantized);
+    }
     return kernel;
 }
 
+Engine select_engine(Image *kernel, Args *args) {
+    SeparableKernel *separable = separate_kernel(kernel, args->separable_tolerance);
+    if (separable != NULL) {
+        free_separable_kernel(separable);
+        return ENGINE_SEPARABLE;
+    }
+    // the direct engine needs one multiply add per kernel value and pixel
+    double direct_cost = (double) kernel->width * kernel->height;
+    if (select_row_kernel() == apply_kernel_to_row) {
+        direct_cost *= FFT_SCALAR_DIRECT_COST;
+    }
+    int size = fft_tile_size(kernel, args->width, args->height);
+    if (size > 0 && fft_cost_per_pixel(kernel, size) < direct_cost) {
+        return ENGINE_FFT;
+    }
+    return ENGINE_DIRECT;
+}
+
 Image *create_image(Args *args) {
     Image *image;
-    if (args->opt_image_from_file) {
+    if (args->opt_image_from_file && args->image_format == IMAGE_FORMAT_BINARY) {
+        ImageWithPadding *padded_img = map_padded_image(args->image_file_path, 0, LAYOUT_CONTIGUOUS);
+        if (padded_img == NULL) {
+            return NULL;
+        }
+        image = remove_padding(padded_img);
+        free_padded_image(padded_img);
+    } else if (args->opt_image_from_file) {
         FILE *fd = fopen(args->image_file_path, "r");
         image = read_image_from_fd(fd, args);
     } else {
@@ -38,31 +95,99 @@ Image *create_image(Args *args) {
     return image;
 }
 
+ImageWithPadding *create_padded_image(Args *args, int padding) {
+    if (args->opt_image_from_file && args->image_format == IMAGE_FORMAT_BINARY) {
+        return map_padded_image(args->image_file_path, padding, args->layout);
+    }
+    Image *image = create_image(args);
+    if (image == NULL) {
+        return NULL;
+    }
+    ImageWithPadding *padded_img = add_padding_with_layout(image, padding, args->layout);
+    free_image(image);
+    return padded_img;
+}
+
 void // __attribute__((noinline))
 run_on_padded_image(ImageWithPadding **padded_img, Image *kernel, Args *args,
                     ImageWithPadding **buffer) {
-    for (int i = 0; i < args->number_of_iterations; i++) {
-        apply_kernel_to_padded_image(*padded_img, kernel, args, *buffer);
-        update_borders(*buffer);
-        swap_ptr(padded_img, buffer, ImageWithPadding*);
+    if (args->virtual_halo) {
+        // the edge columns are clamped while the kernel is applied, there are no borders to update
+        for (int i = 0; i < args->number_of_iterations; i++) {
+            apply_kernel_with_virtual_halo(*padded_img, kernel, args, *buffer);
+            swap_ptr(padded_img, buffer, ImageWithPadding*);
+        }
+        return;
     }
+    Engine engine = args->engine == ENGINE_AUTO ? select_engine(kernel, args) : args->engine;
+    if (engine == ENGINE_QUANTIZED) {
+        // kernels and images that can not be represented in fixed point fall back to the direct engine
+        QuantizedKernel *quantized = quantize_kernel(kernel, args->quantize_tolerance);
+        bool done = quantized != NULL && run_quantized_engine(*padded_img, quantized, args);
+        free_quantized_kernel(quantized);
+        if (done) {
+            return;
+        }
+    }
+    SeparableKernel *separable = NULL;
+    FftKernel *fft_kernel = NULL;
+    if (engine == ENGINE_SEPARABLE) {
+        // kernels that are not separable fall back to the direct engine
+        separable = separate_kernel(kernel, args->separable_tolerance);
+    } else if (engine == ENGINE_FFT) {
+        // the spectrum of the kernel is computed once for all iterations
+        int size = fft_tile_size(kernel, (*padded_img)->inner_width, (*padded_img)->inner_height);
+        if (size > 0) {
+            fft_kernel = init_fft_kernel(kernel, size);
+        }
+    }
+    if (separable == NULL && fft_kernel == NULL && args->temporal_steps > 1
+        && temporal_blocking_supported(*padded_img, kernel)) {
+        // the direct engine advances several iterations per pass over the image
+        for (int i = 0; i < args->number_of_iterations; i += args->temporal_steps) {
+            int remaining = args->number_of_iterations - i;
+            int steps = remaining < args->temporal_steps ? remaining : args->temporal_steps;
+            apply_kernel_temporal_blocked(*padded_img, kernel, args, *buffer, steps);
+            swap_ptr(padded_img, buffer, ImageWithPadding*);
+        }
+    } else {
+        for (int i = 0; i < args->number_of_iterations; i++) {
+            if (separable != NULL) {
+                apply_separable_kernel_to_padded_image(*padded_img, separable, args, *buffer);
+            } else if (fft_kernel != NULL) {
+                apply_fft_kernel_to_padded_image(*padded_img, fft_kernel, args, *buffer);
+            } else {
+                apply_kernel_to_padded_image(*padded_img, kernel, args, *buffer);
+            }
+            update_borders(*buffer);
+            swap_ptr(padded_img, buffer, ImageWithPadding*);
+        }
+    }
+    free_separable_kernel(separable);
+    free_fft_kernel(fft_kernel);
 }
 
 
 void // __attribute__((noinline))
 apply_kernel_to_padded_image(ImageWithPadding *padded_img, Image *kernel, Args *args,
                              ImageWithPadding *buffer) {
-#pragma omp parallel for num_threads(args->number_of_processes)
+    // kernels of common sizes use a fully unrolled implementation, all others the widest SIMD row kernel
+    FixedKernel fixed;
+    select_fixed_kernel(kernel, &fixed);
+    // the static schedule matches the one the rows were first touched with, see init_padded_image_first_touch(...)
+#pragma omp parallel for num_threads(args->number_of_processes) schedule(static)
     for (int y = 0; y < padded_img->inner_height; ++y) {
-// #pragma omp simd
-        for (int x = 0; x < padded_img->inner_width; ++x) {
-            ACCESS_IMAGE(buffer, x, y) = apply_kernel_to_padded_point(padded_img, kernel, x, y);
-        }
+        // the window of the first pixel of the row starts at the upper left corner of the padding
+        apply_fixed_kernel_to_row(&fixed, kernel, (const double *const *) padded_img->image + y,
+                                  &ACCESS_IMAGE(buffer, 0, y), padded_img->inner_width);
     }
 }
 
 double // __attribute__((noinline))
 apply_kernel_to_padded_point(ImageWithPadding *padded_img, Image *kernel, int pointX, int pointY) {
+    if (padded_img->layout == LAYOUT_CONTIGUOUS) {
+        return apply_kernel_to_window(&ACCESS_DATA(padded_img, pointX, pointY), padded_img->stride, kernel);
+    }
     double val = 0.0;
 
 
@@ -78,4 +203,31 @@ apply_kernel_to_padded_point(ImageWithPadding *padded_img, Image *kernel, int po
         ++newY;
     }
     return val;
-}
\ No newline at end of file
+}
+
+double apply_kernel_to_window(const double *window, int stride, Image *kernel) {
+    double val = 0.0;
+    for (int y = 0; y < kernel->height; ++y) {
+        const double *row = window + (size_t) y * stride;
+        const double *coefficients = kernel->image[y];
+#pragma omp simd
+        for (int x = 0; x < kernel->width; ++x) {
+            val += coefficients[x] * row[x];
+        }
+    }
+    return val;
+}
+
+void apply_kernel_to_row(const double *const *rows, Image *kernel, double *out, int count) {
+    for (int x = 0; x < count; ++x) {
+        double val = 0.0;
+        for (int y = 0; y < kernel->height; ++y) {
+            const double *row = rows[y] + x;
+            const double *coefficients = kernel->image[y];
+            for (int kx = 0; kx < kernel->width; ++kx) {
+                val += coefficients[kx] * row[kx];
+            }
+        }
+        out[x] = val;
+    }
+}
@@ -15,12 +15,34 @@
 Image *create_image(Args *args);
 
 /**
- * Create kernel based on the arguments
+ * Create a padded image based on the arguments.
+ * Binary image files are mapped with map_padded_image(...), without copying if the file fits the layout.
+ * @param args Program arguments
+ * @param padding Padding of the image
+ * @return Created image, NULL if the image file could not be read
+ */
+ImageWithPadding *create_padded_image(Args *args, int padding);
+
+/**
+ * Create kernel based on the arguments.
+ * If the engine is ENGINE_AUTO, the engine of the arguments is set to the engine that fits the kernel best.
  * @param args Program arguments
  * @return Created Kernel
  */
 Image *create_kernel(Args *args);
 
+/**
+ * Select the engine that fits the kernel best.
+ * Kernels that can be decomposed into few rank one terms are applied by the separable engine,
+ * Large kernels are applied by the fft engine if its estimated cost per pixel is lower than the one of the direct engine,
+ * all other kernels by the direct engine.
+ *
+ * @param kernel Kernel that is going to be applied
+ * @param args Program arguments, provide the tolerance of the separability test and the extent of the image
+ * @return Engine for the kernel, never ENGINE_AUTO
+ */
+Engine select_engine(Image *kernel, Args *args);
+
 /**
  * Benchmark how long it takes to apply the kernel to an given image.
  *
@@ -45,6 +67,28 @@ time_t benchmark(ImageWithPadding **image, Image *kernel, Args *args, ImageWithP
 double
 apply_kernel_to_padded_point(ImageWithPadding *padded_img, Image *kernel, int pointX, int pointY);
 
+/**
+ * Apply a given kernel to the window of a contiguous image.
+ * The window starts at the upper left value that is multiplied with the first coefficient of the kernel.
+ *
+ * @param window Pointer to the upper left value of the window
+ * @param stride Number of values between two rows of the image
+ * @param kernel Kernel to apply
+ * @return Computed kernel value for the window
+ */
+double apply_kernel_to_window(const double *window, int stride, Image *kernel);
+
+/**
+ * Apply a given kernel to count consecutive windows of a row, scalar version of the row kernels.
+ * Every output sums the products row by row from the left, like apply_kernel_to_window(...).
+ *
+ * @param rows rows[y] points to the value of kernel row y that is multiplied with the first coefficient for out[0]
+ * @param kernel Kernel to apply
+ * @param out Output values, out[x] is the value of the window starting x values further right
+ * @param count Number of windows
+ */
+void apply_kernel_to_row(const double *const *rows, Image *kernel, double *out, int count);
+
 /**
  * Apply a given kernel of the size 5x5 on every pixel of an image.
  * Computed values are written to the buffer.
@@ -61,6 +105,10 @@ apply_kernel_to_padded_image(ImageWithPadding *img, Image *kernel, Args *args,
 
 /**
  * Runs the benchmark, comparable to the benchmarks in the haskell paper
+ * The kernel is applied by the engine of the arguments, ENGINE_AUTO is resolved by select_engine(...).
+ * The direct engine uses temporal blocking if args->temporal_steps is larger than one.
+ * With args->virtual_halo the direct engine clamps the edge columns itself and the images need no padding.
+ * The quantized engine falls back to the direct engine if the kernel or the image can not be represented in fixed point.
  *
  * @param img Image to apply the kernel to
  * @param kernel Kernel to apply on the image
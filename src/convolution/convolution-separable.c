@@ -0,0 +1,136 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <math.h>
+#include "convolution-separable.h"
+
+SeparableKernel *separate_kernel(Image *kernel, double tolerance) {
+    int width = kernel->width;
+    int height = kernel->height;
+    // largest rank for which the passes are cheaper than the direct kernel
+    int max_rank = (width * height - 1) / (width + height);
+    if (max_rank < 1) {
+        return NULL;
+    }
+
+    double *residual = (double *) malloc(sizeof(double) * width * height);
+    double scale = 0.0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            residual[y * width + x] = kernel->image[y][x];
+            scale = fmax(scale, fabs(kernel->image[y][x]));
+        }
+    }
+
+    SeparableKernel *separable = (SeparableKernel *) malloc(sizeof(SeparableKernel));
+    separable->width = width;
+    separable->height = height;
+    separable->rank = 0;
+    separable->horizontal = (double *) malloc(sizeof(double) * max_rank * width);
+    separable->vertical = (double *) malloc(sizeof(double) * max_rank * height);
+
+    for (;;) {
+        int pivot_x = 0, pivot_y = 0;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                if (fabs(residual[y * width + x]) > fabs(residual[pivot_y * width + pivot_x])) {
+                    pivot_x = x;
+                    pivot_y = y;
+                }
+            }
+        }
+        double pivot = residual[pivot_y * width + pivot_x];
+        if (fabs(pivot) <= tolerance * scale) {
+            break;
+        }
+        if (separable->rank == max_rank) {
+            // the residual is still too large, the passes would not pay off
+            free(residual);
+            free_separable_kernel(separable);
+            return NULL;
+        }
+        double *horizontal = separable->horizontal + separable->rank * width;
+        double *vertical = separable->vertical + separable->rank * height;
+        for (int x = 0; x < width; ++x) {
+            horizontal[x] = residual[pivot_y * width + x] / pivot;
+        }
+        for (int y = 0; y < height; ++y) {
+            vertical[y] = residual[y * width + pivot_x];
+        }
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                residual[y * width + x] -= vertical[y] * horizontal[x];
+            }
+        }
+        // the pivot row and column are eliminated exactly, this guarantees termination
+        for (int x = 0; x < width; ++x) {
+            residual[pivot_y * width + x] = 0.0;
+        }
+        for (int y = 0; y < height; ++y) {
+            residual[y * width + pivot_x] = 0.0;
+        }
+        separable->rank++;
+    }
+    free(residual);
+    return separable;
+}
+
+void free_separable_kernel(SeparableKernel *kernel) {
+    if (kernel != NULL) {
+        free(kernel->horizontal);
+        free(kernel->vertical);
+        free(kernel);
+    }
+}
+
+void apply_separable_kernel_to_padded_image(ImageWithPadding *padded_img, SeparableKernel *kernel, Args *args,
+                                            ImageWithPadding *buffer) {
+    int width = padded_img->inner_width;
+    int height = padded_img->inner_height;
+    int bands = (height + SEPARABLE_BAND - 1) / SEPARABLE_BAND;
+#pragma omp parallel num_threads(args->number_of_processes)
+    {
+        double *scratch = (double *) malloc(sizeof(double) * (SEPARABLE_BAND + kernel->height - 1) * width);
+#pragma omp for schedule(static)
+        for (int band = 0; band < bands; ++band) {
+            int y_begin = band * SEPARABLE_BAND;
+            int y_end = y_begin + SEPARABLE_BAND < height ? y_begin + SEPARABLE_BAND : height;
+            // rows of the horizontal pass, including the halo of the vertical pass
+            int rows = y_end - y_begin + kernel->height - 1;
+            for (int y = y_begin; y < y_end; ++y) {
+                memset(&ACCESS_IMAGE(buffer, 0, y), 0, sizeof(double) * width);
+            }
+            for (int r = 0; r < kernel->rank; ++r) {
+                const double *horizontal = kernel->horizontal + r * kernel->width;
+                const double *vertical = kernel->vertical + r * kernel->height;
+                // horizontal pass, the padded row y_begin + y is the first row of the window of output row y_begin
+                for (int y = 0; y < rows; ++y) {
+                    const double *in = padded_img->image[y_begin + y];
+                    double *out = scratch + y * width;
+                    memset(out, 0, sizeof(double) * width);
+                    for (int x = 0; x < kernel->width; ++x) {
+                        double coefficient = horizontal[x];
+#pragma omp simd
+                        for (int i = 0; i < width; ++i) {
+                            out[i] += coefficient * in[i + x];
+                        }
+                    }
+                }
+                // vertical pass, accumulates all terms in the output
+                for (int y = y_begin; y < y_end; ++y) {
+                    double *out = &ACCESS_IMAGE(buffer, 0, y);
+                    for (int i = 0; i < kernel->height; ++i) {
+                        const double *in = scratch + (y - y_begin + i) * width;
+                        double coefficient = vertical[i];
+#pragma omp simd
+                        for (int x = 0; x < width; ++x) {
+                            out[x] += coefficient * in[x];
+                        }
+                    }
+                }
+            }
+        }
+        free(scratch);
+    }
+}
@@ -0,0 +1,65 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_SEPARABLE_H
+#define HG_C_BENCHMARKS_CONVOLUTION_SEPARABLE_H
+
+#include "convolution-util.h"
+
+// number of output rows a thread computes with one scratch buffer
+#define SEPARABLE_BAND (32)
+
+/**
+ * Kernel decomposed into a sum of rank one kernels.
+ * The kernel is approximated by sum_r vertical_r * horizontal_r^T,
+ * every term is applied as a horizontal and a vertical one dimensional pass.
+ */
+struct SeparableKernel {
+    int width;
+    int height;
+    int rank;
+    // rank rows of width coefficients
+    double *horizontal;
+    // rank columns of height coefficients
+    double *vertical;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct SeparableKernel SeparableKernel;
+
+/**
+ * Decompose a kernel into rank one terms with fully pivoted elimination.
+ * The decomposition stops as soon as every coefficient of the residual is at most
+ * tolerance times the largest coefficient of the kernel.
+ * A kernel only counts as separable if the passes need less multiplications than the direct kernel,
+ * i.e. rank * (width + height) < width * height.
+ *
+ * @param kernel Kernel to decompose
+ * @param tolerance Relative tolerance of the residual
+ * @return Decomposed kernel, NULL if the kernel is not separable. Must be freed with free_separable_kernel(...)
+ */
+SeparableKernel *separate_kernel(Image *kernel, double tolerance);
+
+/**
+ * Free the decomposed kernel
+ * @param kernel Kernel to free, may be NULL
+ */
+void free_separable_kernel(SeparableKernel *kernel);
+
+/**
+ * Apply a decomposed kernel on every pixel of an image, like apply_kernel_to_padded_image(...).
+ * The image is processed in bands of SEPARABLE_BAND rows, the horizontal pass of a band
+ * including its halo is written to a per thread scratch buffer and the vertical pass reads it from there.
+ *
+ * @param padded_img Image to which the kernel is applied
+ * @param kernel Decomposed kernel
+ * @param args Arguments to the program, the number of used processes is used for computation
+ * @param buffer Output buffer
+ */
+void apply_separable_kernel_to_padded_image(ImageWithPadding *padded_img, SeparableKernel *kernel, Args *args,
+                                            ImageWithPadding *buffer);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_SEPARABLE_H
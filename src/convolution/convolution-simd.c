@@ -0,0 +1,147 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "convolution-simd.h"
+#include "convolution-run.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CONVOLUTION_X86 1
+#include <immintrin.h>
+#endif
+
+#ifdef CONVOLUTION_X86
+
+// loading four values starting at tail_mask + 4 - n enables exactly the first n lanes
+static const long long tail_mask[8] = {-1, -1, -1, -1, 0, 0, 0, 0};
+
+__attribute__((target("avx2,fma")))
+void apply_kernel_to_row_avx2(const double *const *rows, Image *kernel, double *out, int count) {
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        __m256d acc2 = _mm256_setzero_pd();
+        __m256d acc3 = _mm256_setzero_pd();
+        for (int ky = 0; ky < kernel->height; ++ky) {
+            const double *row = rows[ky] + x;
+            const double *coefficients = kernel->image[ky];
+            for (int kx = 0; kx < kernel->width; ++kx) {
+                __m256d c = _mm256_broadcast_sd(coefficients + kx);
+                acc0 = _mm256_fmadd_pd(c, _mm256_loadu_pd(row + kx), acc0);
+                acc1 = _mm256_fmadd_pd(c, _mm256_loadu_pd(row + kx + 4), acc1);
+                acc2 = _mm256_fmadd_pd(c, _mm256_loadu_pd(row + kx + 8), acc2);
+                acc3 = _mm256_fmadd_pd(c, _mm256_loadu_pd(row + kx + 12), acc3);
+            }
+        }
+        _mm256_storeu_pd(out + x, acc0);
+        _mm256_storeu_pd(out + x + 4, acc1);
+        _mm256_storeu_pd(out + x + 8, acc2);
+        _mm256_storeu_pd(out + x + 12, acc3);
+    }
+    for (; x < count; x += 4) {
+        // the last strip must neither read behind the row nor write behind the output
+        int lanes = count - x < 4 ? count - x : 4;
+        __m256i mask = _mm256_loadu_si256((const __m256i *) (tail_mask + 4 - lanes));
+        __m256d acc = _mm256_setzero_pd();
+        for (int ky = 0; ky < kernel->height; ++ky) {
+            const double *row = rows[ky] + x;
+            const double *coefficients = kernel->image[ky];
+            for (int kx = 0; kx < kernel->width; ++kx) {
+                __m256d c = _mm256_broadcast_sd(coefficients + kx);
+                acc = _mm256_fmadd_pd(c, _mm256_maskload_pd(row + kx, mask), acc);
+            }
+        }
+        _mm256_maskstore_pd(out + x, mask, acc);
+    }
+}
+
+__attribute__((target("avx512f")))
+void apply_kernel_to_row_avx512(const double *const *rows, Image *kernel, double *out, int count) {
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        __m512d acc0 = _mm512_setzero_pd();
+        __m512d acc1 = _mm512_setzero_pd();
+        __m512d acc2 = _mm512_setzero_pd();
+        __m512d acc3 = _mm512_setzero_pd();
+        for (int ky = 0; ky < kernel->height; ++ky) {
+            const double *row = rows[ky] + x;
+            const double *coefficients = kernel->image[ky];
+            for (int kx = 0; kx < kernel->width; ++kx) {
+                __m512d c = _mm512_set1_pd(coefficients[kx]);
+                acc0 = _mm512_fmadd_pd(c, _mm512_loadu_pd(row + kx), acc0);
+                acc1 = _mm512_fmadd_pd(c, _mm512_loadu_pd(row + kx + 8), acc1);
+                acc2 = _mm512_fmadd_pd(c, _mm512_loadu_pd(row + kx + 16), acc2);
+                acc3 = _mm512_fmadd_pd(c, _mm512_loadu_pd(row + kx + 24), acc3);
+            }
+        }
+        _mm512_storeu_pd(out + x, acc0);
+        _mm512_storeu_pd(out + x + 8, acc1);
+        _mm512_storeu_pd(out + x + 16, acc2);
+        _mm512_storeu_pd(out + x + 24, acc3);
+    }
+    for (; x < count; x += 8) {
+        // the last strip must neither read behind the row nor write behind the output
+        __mmask8 mask = count - x < 8 ? (__mmask8) ((1u << (count - x)) - 1u) : (__mmask8) 0xFF;
+        __m512d acc = _mm512_setzero_pd();
+        for (int ky = 0; ky < kernel->height; ++ky) {
+            const double *row = rows[ky] + x;
+            const double *coefficients = kernel->image[ky];
+            for (int kx = 0; kx < kernel->width; ++kx) {
+                __m512d c = _mm512_set1_pd(coefficients[kx]);
+                acc = _mm512_fmadd_pd(c, _mm512_maskz_loadu_pd(mask, row + kx), acc);
+            }
+        }
+        _mm512_mask_storeu_pd(out + x, mask, acc);
+    }
+}
+
+bool simd_supports_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+bool simd_supports_avx512(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+}
+
+#else
+
+void apply_kernel_to_row_avx2(const double *const *rows, Image *kernel, double *out, int count) {
+    apply_kernel_to_row(rows, kernel, out, count);
+}
+
+void apply_kernel_to_row_avx512(const double *const *rows, Image *kernel, double *out, int count) {
+    apply_kernel_to_row(rows, kernel, out, count);
+}
+
+bool simd_supports_avx2(void) {
+    return false;
+}
+
+bool simd_supports_avx512(void) {
+    return false;
+}
+
+#endif
+
+RowKernel select_row_kernel(void) {
+    if (simd_supports_avx512()) {
+        return apply_kernel_to_row_avx512;
+    }
+    if (simd_supports_avx2()) {
+        return apply_kernel_to_row_avx2;
+    }
+    return apply_kernel_to_row;
+}
+
+const char *row_kernel_name(RowKernel kernel) {
+    if (kernel == apply_kernel_to_row_avx512) {
+        return "avx512";
+    }
+    if (kernel == apply_kernel_to_row_avx2) {
+        return "avx2";
+    }
+    return "scalar";
+}
@@ -0,0 +1,54 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_SIMD_H
+#define HG_C_BENCHMARKS_CONVOLUTION_SIMD_H
+
+#include "convolution-util.h"
+
+/**
+ * Typedef of a function that applies a kernel to count consecutive windows of a row.
+ * rows[y] points to the value of kernel row y that is multiplied with the first coefficient for out[0],
+ * the window of out[x] starts x values further right. Works for both image layouts.
+ */
+typedef void (*RowKernel)(const double *const *rows, Image *kernel, double *out, int count);
+
+/**
+ * AVX2 version of apply_kernel_to_row(...).
+ * A strip of 16 outputs is kept in four registers, every coefficient is broadcast once per strip and
+ * multiplied with the shifted input rows by fused multiply adds.
+ * Must only be called if simd_supports_avx2() holds.
+ */
+void apply_kernel_to_row_avx2(const double *const *rows, Image *kernel, double *out, int count);
+
+/**
+ * AVX-512 version of apply_kernel_to_row(...), strips of 32 outputs and masked tails.
+ * Must only be called if simd_supports_avx512() holds.
+ */
+void apply_kernel_to_row_avx512(const double *const *rows, Image *kernel, double *out, int count);
+
+/**
+ * @return true if the executing CPU supports the AVX2 kernel
+ */
+bool simd_supports_avx2(void);
+
+/**
+ * @return true if the executing CPU supports the AVX-512 kernel
+ */
+bool simd_supports_avx512(void);
+
+/**
+ * Select the widest row kernel the executing CPU supports
+ * @return Row kernel, apply_kernel_to_row(...) if there is no SIMD support
+ */
+RowKernel select_row_kernel(void);
+
+/**
+ * Name of a row kernel for reports
+ * @param kernel Row kernel
+ * @return "avx512", "avx2" or "scalar"
+ */
+const char *row_kernel_name(RowKernel kernel);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_SIMD_H
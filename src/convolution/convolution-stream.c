@@ -0,0 +1,354 @@
+//
+// Created by agent on 10/17/26.
+//
+
+// asynchronous I/O and temporary files are POSIX
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "convolution-stream.h"
+#include "convolution-fixed.h"
+
+/**
+ * Binary image file that is read or written by a pass
+ */
+struct StreamFile {
+    int fd;
+    BinaryImageHeader header;
+    // size of a stored row in bytes
+    size_t row_size;
+};
+
+/**
+ * Asynchronous transfer of consecutive rows between a buffer and a file
+ */
+struct Transfer {
+    struct aiocb request;
+    bool pending;
+};
+
+/**
+ * Allocate an aligned buffer for a band, bails out if the memory can not be allocated
+ */
+static void *alloc_band(size_t size) {
+    size = ((size + IMAGE_ALIGNMENT - 1) / IMAGE_ALIGNMENT) * IMAGE_ALIGNMENT;
+    void *band = aligned_alloc(IMAGE_ALIGNMENT, size > 0 ? size : IMAGE_ALIGNMENT);
+    if (band == NULL) {
+        bail_out("band could not be allocated");
+    }
+    return band;
+}
+
+static void start_transfer(struct Transfer *transfer, int fd, void *buffer, size_t size, off_t offset, bool write) {
+    memset(&transfer->request, 0, sizeof(struct aiocb));
+    transfer->request.aio_fildes = fd;
+    transfer->request.aio_buf = buffer;
+    transfer->request.aio_nbytes = size;
+    transfer->request.aio_offset = offset;
+    if ((write ? aio_write(&transfer->request) : aio_read(&transfer->request)) != 0) {
+        bail_out("asynchronous transfer of a band could not be started");
+    }
+    transfer->pending = true;
+}
+
+/**
+ * Wait until a transfer is complete
+ * @return Time spent waiting in microseconds
+ */
+static time_t finish_transfer(struct Transfer *transfer) {
+    if (!transfer->pending) {
+        return 0;
+    }
+    time_t start = mytime();
+    const struct aiocb *requests[1] = {&transfer->request};
+    while (aio_error(&transfer->request) == EINPROGRESS) {
+        aio_suspend(requests, 1, NULL);
+    }
+    ssize_t done = aio_return(&transfer->request);
+    transfer->pending = false;
+    if (done != (ssize_t) transfer->request.aio_nbytes) {
+        bail_out("band could not be transferred");
+    }
+    return mytime() - start;
+}
+
+/**
+ * Create an unlinked temporary file in the directory of the given path.
+ * Temporary files of huge images must not end up in a memory backed /tmp.
+ */
+static int create_temporary_file(const char *near) {
+    const char *suffix = "hgc-stream-XXXXXX";
+    char *name = (char *) malloc(strlen(near) + strlen(suffix) + 1);
+    strcpy(name, near);
+    char *slash = strrchr(name, '/');
+    if (slash != NULL) {
+        slash[1] = '\0';
+    } else {
+        name[0] = '\0';
+    }
+    strcat(name, suffix);
+    int fd = mkstemp(name);
+    if (fd < 0) {
+        free(name);
+        bail_out("temporary file of the streaming engine could not be created");
+    }
+    unlink(name);
+    free(name);
+    return fd;
+}
+
+/**
+ * Prepare a float64 file for the result of a pass and write its header
+ */
+static void init_stream_target(struct StreamFile *file, int fd, int width, int height, int padding) {
+    file->fd = fd;
+    init_binary_image_header(&file->header, width, height, PIXEL_FLOAT64, padding);
+    file->row_size = file->header.stride * sizeof(double);
+    if (pwrite(fd, &file->header, sizeof(BinaryImageHeader), 0) != (ssize_t) sizeof(BinaryImageHeader)) {
+        bail_out("header of the streamed image could not be written");
+    }
+}
+
+/**
+ * Convert the read rows into a band with clamped halo columns
+ */
+static void convert_band(const struct StreamFile *source, const char *raw, double *band, int band_stride,
+                         int rows, int halo, int threads) {
+    int width = (int) source->header.width;
+    int padding = (int) source->header.padding;
+    PixelType type = (PixelType) source->header.pixel_type;
+#pragma omp parallel for num_threads(threads)
+    for (int y = 0; y < rows; ++y) {
+        const char *from = raw + (size_t) y * source->row_size;
+        double *to = band + (size_t) y * band_stride + halo;
+        if (type == PIXEL_FLOAT64) {
+            memcpy(to, (const double *) from + padding, sizeof(double) * width);
+        } else {
+            for (int x = 0; x < width; ++x) {
+                to[x] = load_pixel(from, x + padding, type);
+            }
+        }
+        for (int x = 1; x <= halo; ++x) {
+            to[-x] = to[0];
+            to[width - 1 + x] = to[width - 1];
+        }
+    }
+}
+
+/**
+ * @return First image row that is read for band b
+ */
+static int band_first_row(int b, int band_rows, int halo) {
+    return b * band_rows - halo > 0 ? b * band_rows - halo : 0;
+}
+
+/**
+ * @return Image row behind the last one that is read for band b
+ */
+static int band_last_row(int b, int band_rows, int halo, int height) {
+    return (b + 1) * band_rows + halo < height ? (b + 1) * band_rows + halo : height;
+}
+
+/**
+ * Start to read the rows of band b and its halo
+ * @return Number of bytes that are read
+ */
+static size_t start_band_read(const struct StreamFile *source, struct Transfer *transfer, char *raw, int b,
+                              int band_rows, int halo) {
+    int first = band_first_row(b, band_rows, halo);
+    int last = band_last_row(b, band_rows, halo, (int) source->header.height);
+    size_t size = (size_t) (last - first) * source->row_size;
+    off_t offset = BINARY_IMAGE_HEADER_SIZE + (off_t) (first + (int) source->header.padding) * (off_t) source->row_size;
+    start_transfer(transfer, source->fd, raw, size, offset, false);
+    return size;
+}
+
+/**
+ * Stream one iteration from source to target
+ *
+ * @param target File of the result, NULL if only the checksum is needed
+ * @return Checksum of the result
+ */
+static double stream_pass(const struct StreamFile *source, const struct StreamFile *target, FixedKernel *fixed,
+                          Image *kernel, Args *args, StreamStats *stats) {
+    int width = (int) source->header.width;
+    int height = (int) source->header.height;
+    int threads = args->number_of_processes;
+    int band_rows = args->stream_band_rows < height ? args->stream_band_rows : height;
+    int halo_x = kernel->width / 2;
+    int halo_y = kernel->height / 2;
+    int bands = (height + band_rows - 1) / band_rows;
+    int read_rows = band_rows + 2 * halo_y < height ? band_rows + 2 * halo_y : height;
+    int band_stride = image_stride(width + 2 * halo_x);
+    int out_padding = target != NULL ? (int) target->header.padding : 0;
+    int out_stride = target != NULL ? (int) target->header.stride : image_stride(width);
+    size_t out_rows = (size_t) band_rows + 2 * out_padding;
+
+    // double buffered reads and writes, the converted band is only used by the convolution
+    char *raw[2] = {(char *) alloc_band(read_rows * source->row_size),
+                    (char *) alloc_band(read_rows * source->row_size)};
+    double *band = (double *) alloc_band(sizeof(double) * read_rows * band_stride);
+    double *results[2] = {(double *) alloc_band(sizeof(double) * out_rows * out_stride),
+                          (double *) alloc_band(sizeof(double) * out_rows * out_stride)};
+    const double **rows = (const double **) malloc(sizeof(const double *) * (band_rows + 2 * halo_y));
+    size_t band_bytes = 2 * read_rows * source->row_size + sizeof(double) * read_rows * band_stride
+                        + 2 * sizeof(double) * out_rows * out_stride;
+    if (band_bytes > stats->band_bytes) {
+        stats->band_bytes = band_bytes;
+    }
+    struct Transfer reads[2];
+    struct Transfer writes[2];
+    memset(reads, 0, sizeof(reads));
+    memset(writes, 0, sizeof(writes));
+
+    double checksum = 0.0;
+    stats->bytes_read += start_band_read(source, &reads[0], raw[0], 0, band_rows, halo_y);
+    for (int b = 0; b < bands; ++b) {
+        int slot = b % 2;
+        int first_row = b * band_rows;
+        int count = first_row + band_rows < height ? band_rows : height - first_row;
+        int read_first = band_first_row(b, band_rows, halo_y);
+        int read_last = band_last_row(b, band_rows, halo_y, height);
+        stats->io_wait += finish_transfer(&reads[slot]);
+        if (b + 1 < bands) {
+            stats->bytes_read += start_band_read(source, &reads[1 - slot], raw[1 - slot], b + 1, band_rows, halo_y);
+        }
+        convert_band(source, raw[slot], band, band_stride, read_last - read_first, halo_x, threads);
+        for (int i = 0; i < count + 2 * halo_y; ++i) {
+            int y = clamp(0, first_row - halo_y + i, height - 1);
+            rows[i] = band + (size_t) (y - read_first) * band_stride;
+        }
+
+        // the result buffer is free once the write of two bands before is done
+        stats->io_wait += finish_transfer(&writes[slot]);
+        double *result = results[slot];
+#pragma omp parallel for num_threads(threads)
+        for (int y = 0; y < count; ++y) {
+            double *out = result + (size_t) (y + out_padding) * out_stride + out_padding;
+            apply_fixed_kernel_to_row(fixed, kernel, (const double *const *) rows + y, out, width);
+            for (int x = 1; x <= out_padding; ++x) {
+                out[-x] = out[0];
+                out[width - 1 + x] = out[width - 1];
+            }
+        }
+        // same summation order as get_checksum(...)
+        for (int y = 0; y < count; ++y) {
+            const double *out = result + (size_t) (y + out_padding) * out_stride + out_padding;
+            for (int x = 0; x < width; ++x) {
+                checksum += out[x];
+            }
+        }
+
+        if (target != NULL) {
+            // row i of the result buffer is row first_row + i of the file, the first and last band add the padding
+            int write_first = b == 0 ? 0 : out_padding;
+            int write_last = out_padding + count + (b == bands - 1 ? out_padding : 0);
+            size_t row_values = (size_t) out_stride;
+            for (int i = 0; i < out_padding - write_first; ++i) {
+                memcpy(result + i * row_values, result + out_padding * row_values, target->row_size);
+            }
+            for (int i = out_padding + count; i < write_last; ++i) {
+                memcpy(result + i * row_values, result + (out_padding + count - 1) * row_values, target->row_size);
+            }
+            size_t size = (size_t) (write_last - write_first) * target->row_size;
+            off_t offset = BINARY_IMAGE_HEADER_SIZE + (off_t) (first_row + write_first) * target->row_size;
+            start_transfer(&writes[slot], target->fd, result + write_first * row_values, size, offset, true);
+            stats->bytes_written += size;
+        }
+    }
+    for (int slot = 0; slot < 2; ++slot) {
+        stats->io_wait += finish_transfer(&reads[slot]);
+        stats->io_wait += finish_transfer(&writes[slot]);
+    }
+    free(rows);
+    free(results[0]);
+    free(results[1]);
+    free(band);
+    free(raw[0]);
+    free(raw[1]);
+    return checksum;
+}
+
+double stream_convolution(const char *input_path, const char *output_path, Image *kernel, Args *args,
+                          StreamStats *stats) {
+    StreamStats ignored;
+    if (stats == NULL) {
+        stats = &ignored;
+    }
+    memset(stats, 0, sizeof(StreamStats));
+
+    struct StreamFile input;
+    if (read_binary_image_header(input_path, &input.header) != 0) {
+        bail_out("the header of the streamed image is invalid");
+    }
+    input.fd = open(input_path, O_RDONLY);
+    if (input.fd < 0) {
+        bail_out("the streamed image could not be opened");
+    }
+    input.row_size = input.header.stride * pixel_type_size((PixelType) input.header.pixel_type);
+    int width = (int) input.header.width;
+    int height = (int) input.header.height;
+    // the padding of the result allows to map it without copying for the same kernel
+    int padding = kernel->width / 2;
+
+    struct StreamFile output;
+    output.fd = -1;
+    if (output_path != NULL) {
+        int fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            bail_out("the output image could not be created");
+        }
+        init_stream_target(&output, fd, width, height, padding);
+    }
+    // iterations in between alternate between two temporary files
+    struct StreamFile temporary[2];
+    int temporaries = args->number_of_iterations - 1 < 2 ? args->number_of_iterations - 1 : 2;
+    for (int i = 0; i < temporaries; ++i) {
+        init_stream_target(&temporary[i], create_temporary_file(output_path != NULL ? output_path : input_path),
+                           width, height, padding);
+    }
+
+    FixedKernel fixed;
+    select_fixed_kernel(kernel, &fixed);
+    double checksum = 0.0;
+    for (int i = 0; i < args->number_of_iterations; ++i) {
+        const struct StreamFile *source = i == 0 ? &input : &temporary[(i - 1) % 2];
+        const struct StreamFile *target = &temporary[i % 2];
+        if (i == args->number_of_iterations - 1) {
+            target = output_path != NULL ? &output : NULL;
+        }
+        checksum = stream_pass(source, target, &fixed, kernel, args, stats);
+    }
+
+    for (int i = 0; i < temporaries; ++i) {
+        close(temporary[i].fd);
+    }
+    if (output_path != NULL && close(output.fd) != 0) {
+        bail_out("the output image could not be written");
+    }
+    close(input.fd);
+    return checksum;
+}
+
+time_t stream_benchmark(Image *kernel, Args *args, double *checksum) {
+    time_t seq_t;
+    StreamStats stats;
+    printf("Starting Kernel...\n");
+    // start the clock
+    TIC(0);
+    *checksum = stream_convolution(args->image_file_path, args->output_file_path, kernel, args, &stats);
+    seq_t = TOC(0); // stop the clock
+    // print kernel time
+    printf("Kernel time: %zu.%06zus\n", seq_t / 1000000, seq_t % 1000000);
+    if (args->debug) {
+        printf("Streamed %zu bytes in, %zu bytes out, waited %zu.%06zus for I/O, %zu bytes of bands\n",
+               stats.bytes_read, stats.bytes_written, stats.io_wait / 1000000, stats.io_wait % 1000000,
+               stats.band_bytes);
+    }
+    return seq_t;
+}
@@ -0,0 +1,56 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_STREAM_H
+#define HG_C_BENCHMARKS_CONVOLUTION_STREAM_H
+
+#include "convolution-util.h"
+#include "convolution-binary.h"
+
+/**
+ * Statistics of a streamed convolution
+ */
+struct StreamStats {
+    size_t bytes_read;
+    size_t bytes_written;
+    // time the convolution waited for reads and writes to complete, in microseconds
+    time_t io_wait;
+    // largest amount of memory held by the bands of a pass
+    size_t band_bytes;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct StreamStats StreamStats;
+
+/**
+ * Convolve a binary image without loading it into memory.
+ * Every iteration is a pass over the image in bands of args->stream_band_rows rows. A band is read together
+ * with a halo of kernel->height / 2 rows above and below, convolved with the direct engine and written out.
+ * While a band is convolved, the next band is read and the previous band is written asynchronously.
+ * Borders are clamped like update_borders(...), so the result is identical to the in-memory direct engine.
+ * Iterations in between are kept in unlinked temporary files next to the output or the input image.
+ *
+ * @param input_path Path to the binary image
+ * @param output_path Path of the result, stored as float64 with a padding of kernel->width / 2, may be NULL
+ * @param kernel Kernel to apply
+ * @param args Number of iterations, processes and rows per band
+ * @param stats Statistics of all passes, may be NULL
+ * @return Checksum of the result, see get_checksum(...)
+ */
+double stream_convolution(const char *input_path, const char *output_path, Image *kernel, Args *args,
+                          StreamStats *stats);
+
+/**
+ * Benchmark the streaming engine on the image file of the arguments, see benchmark(...)
+ *
+ * @param kernel Kernel to apply
+ * @param args Arguments of the program
+ * @param checksum Checksum of the result
+ * @return Time of the convolution in microseconds
+ */
+time_t stream_benchmark(Image *kernel, Args *args, double *checksum);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_STREAM_H
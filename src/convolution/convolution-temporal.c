@@ -0,0 +1,158 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "convolution-temporal.h"
+#include "convolution-run.h"
+#include "convolution-fixed.h"
+
+bool temporal_blocking_supported(ImageWithPadding *padded_img, Image *kernel) {
+    return padded_img->layout == LAYOUT_CONTIGUOUS
+           && kernel->width - 1 - padded_img->padding <= padded_img->padding
+           && kernel->height - 1 - padded_img->padding <= padded_img->padding;
+}
+
+/**
+ * Extent of a tile in one dimension, all values are inner coordinates of the image
+ */
+struct TemporalRange {
+    // first value of the output block and the value after its last one
+    int first;
+    int last;
+    // value that is stored at index 0 of the scratch buffers
+    int base;
+    // values that are read by the kernel before and after the computed value
+    int before;
+    int after;
+    // extent of the image
+    int extent;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct TemporalRange TemporalRange;
+
+/**
+ * Values that have to be computed in the given step, so that all remaining steps can read their input.
+ * Step 0 returns the values that are loaded from the padded image, including the clamped values outside.
+ */
+static void needed_values(TemporalRange *range, int steps, int step, int *begin, int *end) {
+    int remaining = steps - step;
+    *begin = range->first - range->before * remaining;
+    *end = range->last + range->after * remaining;
+    int lower = step == 0 ? -range->before : 0;
+    int upper = step == 0 ? range->extent + range->after : range->extent;
+    *begin = *begin > lower ? *begin : lower;
+    *end = *end < upper ? *end : upper;
+}
+
+/**
+ * Values outside of the image that have to be clamped after the given step, empty if the tile is inside of the image
+ */
+static void clamped_values(TemporalRange *range, int steps, int step, int *low_begin, int *high_end) {
+    int remaining = steps - step;
+    int begin = range->first - range->before * remaining;
+    int end = range->last + range->after * remaining;
+    *low_begin = begin > -range->before ? begin : -range->before;
+    *high_end = end < range->extent + range->after ? end : range->extent + range->after;
+}
+
+/**
+ * Advance one tile by the given number of steps, the result is written to the output block of the tile in buffer
+ */
+static void advance_tile(ImageWithPadding *padded_img, Image *kernel, FixedKernel *fixed, ImageWithPadding *buffer,
+                         int steps, TemporalRange *columns, TemporalRange *rows, double *source, double *target,
+                         int stride, const double **window_rows) {
+    int begin_x, end_x, begin_y, end_y;
+    needed_values(columns, steps, 0, &begin_x, &end_x);
+    needed_values(rows, steps, 0, &begin_y, &end_y);
+    // rows outside the image come from the clamped padding
+    for (int y = begin_y; y < end_y; ++y) {
+        memcpy(source + (size_t) (y - rows->base) * stride + (begin_x - columns->base),
+               &ACCESS_IMAGE(padded_img, begin_x, y), sizeof(double) * (end_x - begin_x));
+    }
+
+    for (int step = 1; step <= steps; ++step) {
+        needed_values(columns, steps, step, &begin_x, &end_x);
+        needed_values(rows, steps, step, &begin_y, &end_y);
+        int low_x, high_x, low_y, high_y;
+        clamped_values(columns, steps, step, &low_x, &high_x);
+        clamped_values(rows, steps, step, &low_y, &high_y);
+        for (int y = begin_y; y < end_y; ++y) {
+            // the window of a pixel starts at the upper left corner of its neighbourhood
+            const double *window = source + (size_t) (y - rows->before - rows->base) * stride
+                                   + (begin_x - columns->before - columns->base);
+            double *out = target + (size_t) (y - rows->base) * stride - columns->base;
+            for (int ky = 0; ky < kernel->height; ++ky) {
+                window_rows[ky] = window + (size_t) ky * stride;
+            }
+            apply_fixed_kernel_to_row(fixed, kernel, window_rows, out + begin_x, end_x - begin_x);
+            // clamp the columns outside of the image, like update_borders(...)
+            for (int x = low_x; x < 0; ++x) {
+                out[x] = out[0];
+            }
+            for (int x = columns->extent; x < high_x; ++x) {
+                out[x] = out[columns->extent - 1];
+            }
+        }
+        // clamp the rows outside of the image, the clamped columns are part of them
+        size_t row_size = sizeof(double) * (high_x - low_x);
+        double *first_row = target + (size_t) (0 - rows->base) * stride + (low_x - columns->base);
+        double *last_row = target + (size_t) (rows->extent - 1 - rows->base) * stride + (low_x - columns->base);
+        for (int y = low_y; y < 0; ++y) {
+            memcpy(first_row + (size_t) (y - 0) * stride, first_row, row_size);
+        }
+        for (int y = rows->extent; y < high_y; ++y) {
+            memcpy(last_row + (size_t) (y - rows->extent + 1) * stride, last_row, row_size);
+        }
+        swap_ptr(&source, &target, double*);
+    }
+
+    for (int y = rows->first; y < rows->last; ++y) {
+        memcpy(&ACCESS_IMAGE(buffer, columns->first, y),
+               source + (size_t) (y - rows->base) * stride + (columns->first - columns->base),
+               sizeof(double) * (columns->last - columns->first));
+    }
+}
+
+void apply_kernel_temporal_blocked(ImageWithPadding *padded_img, Image *kernel, Args *args,
+                                   ImageWithPadding *buffer, int steps) {
+    int padding = padded_img->padding;
+    int left = padding;
+    int right = kernel->width - 1 - padding;
+    int above = padding;
+    int below = kernel->height - 1 - padding;
+    int tiles_x = (padded_img->inner_width + TEMPORAL_TILE_WIDTH - 1) / TEMPORAL_TILE_WIDTH;
+    int tiles_y = (padded_img->inner_height + TEMPORAL_TILE_HEIGHT - 1) / TEMPORAL_TILE_HEIGHT;
+    // a tile including the halo of the first step
+    int stride = image_stride(TEMPORAL_TILE_WIDTH + (left + right) * steps);
+    int height = TEMPORAL_TILE_HEIGHT + (above + below) * steps;
+    FixedKernel fixed;
+    select_fixed_kernel(kernel, &fixed);
+#pragma omp parallel num_threads(args->number_of_processes)
+    {
+        double *source = (double *) aligned_alloc(IMAGE_ALIGNMENT, sizeof(double) * height * stride);
+        double *target = (double *) aligned_alloc(IMAGE_ALIGNMENT, sizeof(double) * height * stride);
+        const double **window_rows = (const double **) malloc(sizeof(double *) * kernel->height);
+#pragma omp for collapse(2) schedule(static)
+        for (int tile_y = 0; tile_y < tiles_y; ++tile_y) {
+            for (int tile_x = 0; tile_x < tiles_x; ++tile_x) {
+                TemporalRange columns = {tile_x * TEMPORAL_TILE_WIDTH, (tile_x + 1) * TEMPORAL_TILE_WIDTH,
+                                         tile_x * TEMPORAL_TILE_WIDTH - left * steps, left, right,
+                                         padded_img->inner_width};
+                TemporalRange rows = {tile_y * TEMPORAL_TILE_HEIGHT, (tile_y + 1) * TEMPORAL_TILE_HEIGHT,
+                                      tile_y * TEMPORAL_TILE_HEIGHT - above * steps, above, below,
+                                      padded_img->inner_height};
+                columns.last = columns.last < columns.extent ? columns.last : columns.extent;
+                rows.last = rows.last < rows.extent ? rows.last : rows.extent;
+                advance_tile(padded_img, kernel, &fixed, buffer, steps, &columns, &rows, source, target, stride,
+                             window_rows);
+            }
+        }
+        free(source);
+        free(target);
+        free(window_rows);
+    }
+    update_borders(buffer);
+}
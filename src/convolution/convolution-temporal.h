@@ -0,0 +1,43 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_TEMPORAL_H
+#define HG_C_BENCHMARKS_CONVOLUTION_TEMPORAL_H
+
+#include "convolution-util.h"
+
+// extent of the output block of a tile, a tile and its halo stay in the L2 cache for all steps of a block
+#define TEMPORAL_TILE_WIDTH (256)
+#define TEMPORAL_TILE_HEIGHT (64)
+
+/**
+ * Check whether temporal blocking can be applied.
+ * Only contiguous images are supported and the padding must cover the kernel in every direction.
+ *
+ * @param padded_img Image to which the kernel is applied
+ * @param kernel Kernel that is going to be applied
+ * @return true if apply_kernel_temporal_blocked(...) may be used
+ */
+bool temporal_blocking_supported(ImageWithPadding *padded_img, Image *kernel);
+
+/**
+ * Advance the image by several iterations of the direct engine at once.
+ * The image is cut into tiles of TEMPORAL_TILE_WIDTH x TEMPORAL_TILE_HEIGHT pixels. Every tile is loaded together
+ * with a halo that shrinks by the kernel radius with every step (overlapped tiles), so all steps run on data in cache
+ * and the image is only streamed through memory once per block instead of once per iteration.
+ * The halo is computed redundantly by the neighbouring tiles.
+ * Every row is computed by apply_fixed_kernel_to_row(...) from the same values, and the borders are clamped
+ * like update_borders(...) after every step, so the result is bit identical to calling
+ * apply_kernel_to_padded_image(...) and update_borders(...) steps times.
+ *
+ * @param padded_img Image to which the kernel is applied, is not changed
+ * @param kernel Kernel to apply
+ * @param args Arguments to the program, the number of used processes is used for computation
+ * @param buffer Output buffer, contains the image after steps iterations with updated borders
+ * @param steps Number of iterations to advance
+ */
+void apply_kernel_temporal_blocked(ImageWithPadding *padded_img, Image *kernel, Args *args,
+                                   ImageWithPadding *buffer, int steps);
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_TEMPORAL_H
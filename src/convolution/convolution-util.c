@@ -2,46 +2,26 @@
 // Created by baldr on 5/23/17.
 //
 
+#include <sys/mman.h>
 #include "convolution-util.h"
-
-#define MAX_SIZE 16384
+#include "convolution-binary.h"
+#include "convolution-parse.h"
 
 Image *read_image_from_fd(FILE *fd, Args *args) {
-    if (fd != NULL) {
-        char buf[MAX_SIZE];
-        if (fgets(buf, MAX_SIZE, fd) != NULL) { ;
-            char *token = strtok(buf, " ");
-            if (NULL == token) bail_out("height couldn't be read from file");
-            int height = (int) strtol(token, NULL, 10);
-            token = strtok(NULL, " ");
-            if (NULL == token) bail_out("width couldn't be read from file");
-            int width = (int) strtol(token, NULL, 10);
-
-            Image *img = init_image(width, height, 0.0);
-
-            for (int y = 0; y < height; ++y) {
-                if (NULL != fgets(buf, MAX_SIZE, fd)) {
-                    token = strtok(buf, " ");
-                    for (int x = 0; x < width; ++x) {
-                        if (token != NULL) {
-                            img->image[y][x] = strtod(token, NULL);
-                        } else {
-                            bail_out("the file dimensions were not correct, less number of lines than given width");
-                        }
-                        token = strtok(NULL, " ");
-                    }
-                } else {
-                    bail_out("the file did not have enough lines to read");
-                }
-            }
-            args->width = width;
-            args->height = height;
-            return img;
-        }
-    } else {
+    if (fd == NULL) {
         bail_out("file descriptor couldn't was closed");
     }
-    return NULL;
+    TextParseStats stats;
+    Image *img = parse_text_image(fd, args->number_of_processes, &stats);
+    if (img != NULL) {
+        args->width = img->width;
+        args->height = img->height;
+        if (args->debug) {
+            printf("Parsed %zu bytes in %zu.%06zus (%.1f MB/s)\n", stats.bytes, stats.time / 1000000,
+                   stats.time % 1000000, parse_throughput(&stats));
+        }
+    }
+    return img;
 }
 
 
@@ -81,9 +61,15 @@ void write_checksum_to(FILE *fd, double checksum) {
 
 void free_image(Image *image) {
     if (image != NULL) {
-        for (int height = 0; height < image->height; ++height) {
-            if (image->image[height] != NULL) {
-                free(image->image[height]);
+        if (image->layout == LAYOUT_CONTIGUOUS) {
+            if (image->data != NULL) {
+                free(image->data);
+            }
+        } else {
+            for (int height = 0; height < image->height; ++height) {
+                if (image->image[height] != NULL) {
+                    free(image->image[height]);
+                }
             }
         }
         if (image->image != NULL) {
@@ -93,13 +79,89 @@ void free_image(Image *image) {
     }
 }
 
+int image_stride(int width) {
+    int per_line = IMAGE_ALIGNMENT / (int) sizeof(double);
+    return ((width + per_line - 1) / per_line) * per_line;
+}
+
+const char *layout_name(ImageLayout layout) {
+    switch (layout) {
+        case LAYOUT_CONTIGUOUS:
+            return "contiguous";
+        case LAYOUT_ROWS:
+            return "rows";
+    }
+    return "unknown";
+}
+
+const char *channel_layout_name(ChannelLayout layout) {
+    switch (layout) {
+        case CHANNELS_INTERLEAVED:
+            return "interleaved";
+        case CHANNELS_PLANAR:
+            return "planar";
+    }
+    return "unknown";
+}
+
+const char *engine_name(Engine engine) {
+    switch (engine) {
+        case ENGINE_AUTO:
+            return "auto";
+        case ENGINE_DIRECT:
+            return "direct";
+        case ENGINE_SEPARABLE:
+            return "separable";
+        case ENGINE_FFT:
+            return "fft";
+        case ENGINE_QUANTIZED:
+            return "quantized";
+    }
+    return "unknown";
+}
+
+/**
+ * Allocate an aligned block for an contiguous image with the given number of rows.
+ * Bails out if the memory can not be allocated.
+ */
+static double *alloc_image_block(int rows, int stride) {
+    size_t size = sizeof(double) * (size_t) rows * (size_t) stride;
+    // aligned_alloc demands a size that is a multiple of the alignment
+    size = ((size + IMAGE_ALIGNMENT - 1) / IMAGE_ALIGNMENT) * IMAGE_ALIGNMENT;
+    if (size == 0) {
+        size = IMAGE_ALIGNMENT;
+    }
+    double *block = (double *) aligned_alloc(IMAGE_ALIGNMENT, size);
+    if (block == NULL) {
+        bail_out("image block could not be allocated");
+    }
+    return block;
+}
+
 Image *init_image(int width, int height, double default_val) {
+    return init_image_with_layout(width, height, default_val, LAYOUT_CONTIGUOUS);
+}
+
+Image *init_image_with_layout(int width, int height, double default_val, ImageLayout layout) {
     Image *img = (Image *) malloc(sizeof(Image));
     img->width = width;
     img->height = height;
+    img->layout = layout;
     img->image = (double **) malloc(sizeof(double *) * height);
+    if (layout == LAYOUT_CONTIGUOUS) {
+        img->stride = image_stride(width);
+        img->data = alloc_image_block(height, img->stride);
+        for (int y = 0; y < img->height; ++y) {
+            img->image[y] = img->data + (size_t) y * img->stride;
+        }
+    } else {
+        img->stride = width;
+        img->data = NULL;
+        for (int y = 0; y < img->height; ++y) {
+            img->image[y] = (double *) malloc(sizeof(double) * width);
+        }
+    }
     for (int y = 0; y < img->height; ++y) {
-        img->image[y] = (double *) malloc(sizeof(double) * width);
         for (int x = 0; x < img->width; ++x) {
             img->image[y][x] = default_val;
         }
@@ -150,12 +212,22 @@ Image *get_default_kernel(void) {
     return img;
 }
 
+Image *get_2d_laplace_kernel(void) {
+    Image *img = init_image(3, 3, 0);
+    img->image[0][1] = 1;
+    img->image[1][0] = 1;
+    img->image[1][1] = -4;
+    img->image[1][2] = 1;
+    img->image[2][1] = 1;
+    return img;
+}
+
 /**
  * Prints Synopsis of the program
  */
 void usage() {
     fprintf(stderr,
-            "SYNOPSIS: %s [-d] [-p number_of_processes] ([-w width] [-h height] || -f image_file_name) [-k kernel_file_name] [-n iterations]\n",
+            "SYNOPSIS: %s [-d] [-p number_of_processes] ([-w width] [-h height] || -f text_or_binary_image_file_name) [-k kernel_file_name[,kernel_file_name...]]... [-n iterations] [-l contiguous|rows] [-e auto|direct|separable|fft|quantized] [-r separable_tolerance] [-q quantize_tolerance] [-t temporal_steps] [-m float64|float32|uint8|uint16|int16] [-v] [-c channels [-a interleaved|planar]] [-N] [-P none|compact|scatter] [-s stream_band_rows [-o binary_output_file_name] || -b image_directory_or_list [-o output_directory]]\n",
             pgmname);
     exit(1);
 }
@@ -169,8 +241,29 @@ void print_args(Args *args) {
         printf("\topt_image_file_path: %s\n", args->image_file_path);
     }
     printf("\topt_kernel_file: %d\n", args->opt_kernel_from_file);
-    if (args->opt_kernel_from_file) {
-        printf("\topt_image_file_path: %s\n", args->kernel_file_path);
+    for (int i = 0; i < args->number_of_kernels; ++i) {
+        printf("\topt_kernel_file_path: %s\n", args->kernel_file_paths[i]);
+    }
+    printf("\tlayout: %s\n", layout_name(args->layout));
+    printf("\tengine: %s, separable tolerance: %g, quantize tolerance: %g\n", engine_name(args->engine),
+           args->separable_tolerance, args->quantize_tolerance);
+    printf("\ttemporal steps: %d\n", args->temporal_steps);
+    printf("\tprecision: %s\n", pixel_type_name(args->precision));
+    printf("\thalo: %s\n", args->virtual_halo ? "virtual" : "padded");
+    printf("\tchannels: %d, %s\n", args->channels, channel_layout_name(args->channel_layout));
+    printf("\tfirst touch: %s, pinning: %s\n", args->numa_first_touch ? "parallel" : "serial",
+           pin_policy_name(args->pin_policy));
+    if (args->opt_image_from_file) {
+        printf("\timage format: %s\n", args->image_format == IMAGE_FORMAT_BINARY ? "binary" : "text");
+    }
+    if (args->stream_band_rows > 0) {
+        printf("\tstream band rows: %d\n", args->stream_band_rows);
+    }
+    if (args->batch_path != NULL) {
+        printf("\tbatch_path: %s\n", args->batch_path);
+    }
+    if (args->output_file_path != NULL) {
+        printf("\toutput_file_path: %s\n", args->output_file_path);
     }
     printf("\tdebug_mode: %d\n", args->debug);
 }
@@ -188,16 +281,37 @@ Args *parse_args(int argc, char **argv) {
     args->opt_kernel_from_file = false;
     args->opt_width = false;
     args->opt_height = false;
+    args->layout = LAYOUT_CONTIGUOUS;
+    args->engine = ENGINE_AUTO;
+    args->separable_tolerance = DEFAULT_SEPARABLE_TOLERANCE;
+    args->quantize_tolerance = DEFAULT_QUANTIZE_TOLERANCE;
+    args->temporal_steps = 1;
+    args->stream_band_rows = 0;
+    args->output_file_path = NULL;
+    args->batch_path = NULL;
+    args->precision = PIXEL_FLOAT64;
+    args->virtual_halo = false;
+    args->channels = 1;
+    args->channel_layout = CHANNELS_INTERLEAVED;
+    args->number_of_kernels = 0;
+    args->numa_first_touch = false;
+    args->pin_policy = PIN_NONE;
     // parse the args
     int c;
-    while ((c = getopt(argc, argv, "?dn:p:w:h:k:f:")) != -1) {
+    while ((c = getopt(argc, argv, "?dn:p:w:h:k:f:l:e:r:q:t:s:o:b:m:vc:a:NP:")) != -1) {
         switch (c) {
             case 'd':
                 args->debug = true;
                 break;
             case 'k':
+                if (args->number_of_kernels == KERNEL_CHAIN_MAX) {
+                    usage();
+                }
+                if (!args->opt_kernel_from_file) {
+                    args->kernel_file_path = optarg;
+                }
                 args->opt_kernel_from_file = true;
-                args->kernel_file_path = optarg;
+                args->kernel_file_paths[args->number_of_kernels++] = optarg;
                 break;
             case 'f':
                 args->opt_image_from_file = true;
@@ -217,6 +331,76 @@ Args *parse_args(int argc, char **argv) {
                 args->opt_height = true;
                 args->height = (int) strtol(optarg, NULL, 10);
                 break;
+            case 'l':
+                if (strcmp(optarg, "contiguous") == 0) {
+                    args->layout = LAYOUT_CONTIGUOUS;
+                } else if (strcmp(optarg, "rows") == 0) {
+                    args->layout = LAYOUT_ROWS;
+                } else {
+                    usage();
+                }
+                break;
+            case 'e':
+                if (strcmp(optarg, "auto") == 0) {
+                    args->engine = ENGINE_AUTO;
+                } else if (strcmp(optarg, "direct") == 0) {
+                    args->engine = ENGINE_DIRECT;
+                } else if (strcmp(optarg, "separable") == 0) {
+                    args->engine = ENGINE_SEPARABLE;
+                } else if (strcmp(optarg, "fft") == 0) {
+                    args->engine = ENGINE_FFT;
+                } else if (strcmp(optarg, "quantized") == 0) {
+                    args->engine = ENGINE_QUANTIZED;
+                } else {
+                    usage();
+                }
+                break;
+            case 'r':
+                args->separable_tolerance = strtod(optarg, NULL);
+                break;
+            case 'q':
+                args->quantize_tolerance = strtod(optarg, NULL);
+                break;
+            case 't':
+                args->temporal_steps = (int) strtol(optarg, NULL, 10);
+                break;
+            case 's':
+                args->stream_band_rows = (int) strtol(optarg, NULL, 10);
+                break;
+            case 'o':
+                args->output_file_path = optarg;
+                break;
+            case 'b':
+                args->batch_path = optarg;
+                break;
+            case 'v':
+                args->virtual_halo = true;
+                break;
+            case 'c':
+                args->channels = (int) strtol(optarg, NULL, 10);
+                break;
+            case 'a':
+                if (strcmp(optarg, "interleaved") == 0) {
+                    args->channel_layout = CHANNELS_INTERLEAVED;
+                } else if (strcmp(optarg, "planar") == 0) {
+                    args->channel_layout = CHANNELS_PLANAR;
+                } else {
+                    usage();
+                }
+                break;
+            case 'N':
+                args->numa_first_touch = true;
+                break;
+            case 'P':
+                if (parse_pin_policy(optarg, &args->pin_policy) != 0) {
+                    usage();
+                }
+                break;
+            case 'm':
+                if (parse_pixel_type(optarg, &args->precision) != 0) {
+                    usage();
+                }
+                break;
             case '?':
                 usage();
                 break;
@@ -229,8 +413,69 @@ Args *parse_args(int argc, char **argv) {
     if (args->opt_image_from_file && (args->opt_width || args->opt_height)) {
         usage();
     }
+    args->image_format = IMAGE_FORMAT_TEXT;
+    if (args->opt_image_from_file && is_binary_image(args->image_file_path)) {
+        // the extent of binary images is known before they are loaded
+        BinaryImageHeader header;
+        if (read_binary_image_header(args->image_file_path, &header) != 0) {
+            bail_out("the header of the binary image is invalid");
+        }
+        args->image_format = IMAGE_FORMAT_BINARY;
+        args->width = (int) header.width;
+        args->height = (int) header.height;
+    }
+
+    // streaming reads bands of a binary image, the batch mode reads whole images itself
+    // both only support the direct engine
+    if (args->stream_band_rows < 0 ||
+        (args->output_file_path != NULL && args->stream_band_rows == 0 && args->batch_path == NULL) ||
+        (args->batch_path != NULL && (args->opt_image_from_file || args->stream_band_rows > 0))) {
+        usage();
+    }
+    // the reduced precisions are implemented by the direct engine on whole images, one step per iteration
+    if (args->precision != PIXEL_FLOAT64 &&
+        (args->batch_path != NULL || args->stream_band_rows > 0 || args->temporal_steps > 1)) {
+        usage();
+    }
+    // without padding only the direct engine can be used, temporal blocking reads its halo from the padding
+    if (args->virtual_halo && (args->precision != PIXEL_FLOAT64 || args->batch_path != NULL ||
+                               args->stream_band_rows > 0 || args->temporal_steps > 1)) {
+        usage();
+    }
+    // multi-channel images are convolved by the direct engine of the channels, on whole images in float64
+    if (args->channels < 1 || args->channels > CHANNELS_MAX ||
+        (args->channels > 1 && (args->precision != PIXEL_FLOAT64 || args->batch_path != NULL ||
+                                args->stream_band_rows > 0 || args->temporal_steps > 1 || args->virtual_halo))) {
+        usage();
+    }
+    // a chain of kernels is applied by the direct engine as well, fused or stage by stage
+    if (args->number_of_kernels > 1 && (args->precision != PIXEL_FLOAT64 || args->batch_path != NULL ||
+                                        args->stream_band_rows > 0 || args->temporal_steps > 1 ||
+                                        args->virtual_halo || args->channels > 1)) {
+        usage();
+    }
+    // the first touch mode allocates the padded float64 images of the whole image engines
+    if (args->numa_first_touch && (args->precision != PIXEL_FLOAT64 || args->batch_path != NULL ||
+                                   args->stream_band_rows > 0 || args->channels > 1)) {
+        usage();
+    }
+    if (args->batch_path != NULL || args->precision != PIXEL_FLOAT64 || args->virtual_halo || args->channels > 1 ||
+        args->number_of_kernels > 1) {
+        if (args->engine != ENGINE_AUTO && args->engine != ENGINE_DIRECT) {
+            usage();
+        }
+        args->engine = ENGINE_DIRECT;
+    }
+    if (args->stream_band_rows > 0) {
+        if (args->image_format != IMAGE_FORMAT_BINARY || args->number_of_iterations == 0 ||
+            (args->engine != ENGINE_AUTO && args->engine != ENGINE_DIRECT)) {
+            usage();
+        }
+        args->engine = ENGINE_DIRECT;
+    }
 
-    if (args->height <= 0 || args->width <= 0 || args->number_of_processes <= 0 || args->number_of_iterations < 0) {
+    if (args->height <= 0 || args->width <= 0 || args->number_of_processes <= 0 || args->number_of_iterations < 0 ||
+        !(args->separable_tolerance >= 0.0) || !(args->quantize_tolerance >= 0.0) || args->temporal_steps <= 0) {
         usage();
     }
     // sanity was verified
@@ -243,10 +488,13 @@ double smart_access(Image *img, int x, int y) {
 }
 
 
-void append_convolution_csv(FILE *fd, ImageWithPadding *img, Args *args, time_t time) {
-    fprintf(fd, "%d,%d,%d,%d,%zu\n", args->number_of_processes, img->inner_height, img->inner_width,
+void append_convolution_csv(FILE *fd, int width, int height, Args *args, time_t time) {
+    fprintf(fd, "%d,%d,%d,%d,%zu,%s,%s,%d,%d,%s,%s,%d,%s,%d,%s,%s\n", args->number_of_processes, height, width,
             args->number_of_iterations,
-            time);
+            time, layout_name(args->layout), engine_name(args->engine), args->temporal_steps, args->stream_band_rows,
+            pixel_type_name(args->precision), args->virtual_halo ? "virtual" : "padded", args->channels,
+            channel_layout_name(args->channel_layout), args->number_of_kernels > 1 ? args->number_of_kernels : 1,
+            args->numa_first_touch ? "parallel" : "serial", pin_policy_name(args->pin_policy));
 }
 
 void free_args(Args *args) {
@@ -256,7 +504,11 @@ void free_args(Args *args) {
 }
 
 ImageWithPadding *add_padding(Image *img, int padding) {
-    ImageWithPadding *padded_img = init_padded_image(img->width, img->height, padding);
+    return add_padding_with_layout(img, padding, LAYOUT_CONTIGUOUS);
+}
+
+ImageWithPadding *add_padding_with_layout(Image *img, int padding, ImageLayout layout) {
+    ImageWithPadding *padded_img = init_padded_image_with_layout(img->width, img->height, padding, layout);
 
     for (int y = 0; y < img->height; ++y) {
         for (int x = 0; x < img->width; ++x) {
@@ -292,6 +544,16 @@ void update_borders(ImageWithPadding *padded_img) {
                     ACCESS_IMAGE(padded_img, padded_img->inner_width - 1, y);
         }
     }
+    // the rows layout aliases the upper and lower padding rows, the contiguous layout has to copy them
+    if (padded_img->layout == LAYOUT_CONTIGUOUS) {
+        size_t row_size = sizeof(double) * width;
+        int first = padded_img->padding;
+        int last = padded_img->padding + padded_img->inner_height - 1;
+        for (int y = 0; y < padded_img->padding; ++y) {
+            memcpy(padded_img->image[y], padded_img->image[first], row_size);
+            memcpy(padded_img->image[last + y + 1], padded_img->image[last], row_size);
+        }
+    }
     /*
     // upper and lower bounds
     for (int y = 0; y < padded_img->padding; ++y) {
@@ -341,10 +603,19 @@ void print_padded_image(ImageWithPadding *padded_img) {
 
 void free_padded_image(ImageWithPadding *padded_img) {
     if (padded_img != NULL) {
-        int height = padded_img->inner_height;
-        for (int y = padded_img->padding; y < height; ++y) {
-            if (padded_img->image[y] != NULL) {
-                free(padded_img->image[y]);
+        if (padded_img->mapping != NULL) {
+            munmap(padded_img->mapping, padded_img->mapping_size);
+        } else if (padded_img->layout == LAYOUT_CONTIGUOUS) {
+            if (padded_img->data != NULL) {
+                free(padded_img->data);
+            }
+        } else {
+            // upper and lower padding rows are aliases, only free the real rows
+            int height = padded_img->inner_height + padded_img->padding;
+            for (int y = padded_img->padding; y < height; ++y) {
+                if (padded_img->image[y] != NULL) {
+                    free(padded_img->image[y]);
+                }
             }
         }
         if (padded_img->image != NULL) {
@@ -363,27 +634,69 @@ int copy_padded_image(ImageWithPadding *padded_from, ImageWithPadding *padded_to
     }
     int width = padded_from->width;
     int height = padded_from->height;
+    if (padded_from->layout == LAYOUT_CONTIGUOUS && padded_to->layout == LAYOUT_CONTIGUOUS &&
+        padded_from->stride == padded_to->stride) {
+        memcpy(padded_to->data, padded_from->data, sizeof(double) * (size_t) height * padded_from->stride);
+        return 0;
+    }
     for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            ACCESS_FIELD(padded_to, x, y) = ACCESS_FIELD(padded_from, x, y);
-        }
+        memcpy(padded_to->image[y], padded_from->image[y], sizeof(double) * width);
     }
 
     return 0;
 }
 
 ImageWithPadding *init_padded_image(int inner_width, int inner_height, int padding) {
+    return init_padded_image_with_layout(inner_width, inner_height, padding, LAYOUT_CONTIGUOUS);
+}
+
+ImageWithPadding *init_padded_image_with_layout(int inner_width, int inner_height, int padding, ImageLayout layout) {
+    return init_padded_image_first_touch(inner_width, inner_height, padding, layout, 1);
+}
+
+ImageWithPadding *init_padded_image_first_touch(int inner_width, int inner_height, int padding, ImageLayout layout,
+                                                int number_of_processes) {
     ImageWithPadding *padded_img = (ImageWithPadding *) malloc(sizeof(ImageWithPadding));
     padded_img->padding = padding;
     padded_img->height = inner_height + 2 * padding;
     padded_img->width = inner_width + 2 * padding;
     padded_img->inner_height = inner_height;
     padded_img->inner_width = inner_width;
+    padded_img->layout = layout;
+    padded_img->mapping = NULL;
+    padded_img->mapping_size = 0;
 
     int width = padded_img->width;
     int height = padded_img->height;
 
     padded_img->image = (double **) malloc(sizeof(double *) * height);
+    if (layout == LAYOUT_CONTIGUOUS) {
+        padded_img->stride = image_stride(width);
+        padded_img->data = alloc_image_block(height, padded_img->stride);
+        size_t row_size = sizeof(double) * padded_img->stride;
+        for (int y = 0; y < height; ++y) {
+            padded_img->image[y] = padded_img->data + (size_t) y * padded_img->stride;
+        }
+        // the pages of a row are first touched by the thread that computes it
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+        for (int y = 0; y < inner_height; ++y) {
+            memset(padded_img->image[y + padding], 0, row_size);
+            if (y == 0) {
+                memset(padded_img->image[0], 0, row_size * padding);
+            }
+            if (y == inner_height - 1) {
+                memset(padded_img->image[inner_height + padding], 0, row_size * padding);
+            }
+        }
+        if (inner_height == 0) {
+            memset(padded_img->data, 0, row_size * height);
+        }
+        return padded_img;
+    }
+
+    padded_img->stride = width;
+    padded_img->data = NULL;
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
     for (int y = 0; y < padded_img->inner_height; ++y) {
         padded_img->image[y + padding] = (double *) malloc(sizeof(double) * width);
         for (int x = 0; x < width; ++x) {
@@ -400,4 +713,107 @@ ImageWithPadding *init_padded_image(int inner_width, int inner_height, int paddi
     }
 
     return padded_img;
-}
\ No newline at end of file
+}
+
+ChannelImage *init_channel_image(int inner_width, int inner_height, int channels, int padding, ChannelLayout layout) {
+    ChannelImage *img = (ChannelImage *) malloc(sizeof(ChannelImage));
+    img->channels = channels;
+    img->layout = layout;
+    img->padding = padding;
+    img->width = inner_width + 2 * padding;
+    img->height = inner_height + 2 * padding;
+    img->inner_width = inner_width;
+    img->inner_height = inner_height;
+    img->planes = layout == CHANNELS_PLANAR ? channels : 1;
+    img->values_per_pixel = layout == CHANNELS_PLANAR ? 1 : channels;
+    img->stride = image_stride(img->width * img->values_per_pixel);
+
+    int rows = img->planes * img->height;
+    img->data = alloc_image_block(rows, img->stride);
+    memset(img->data, 0, sizeof(double) * (size_t) rows * img->stride);
+    img->rows = (double **) malloc(sizeof(double *) * rows);
+    for (int y = 0; y < rows; ++y) {
+        img->rows[y] = img->data + (size_t) y * img->stride;
+    }
+    return img;
+}
+
+void free_channel_image(ChannelImage *img) {
+    if (img != NULL) {
+        free(img->data);
+        free(img->rows);
+        free(img);
+    }
+}
+
+ChannelImage *split_channels(Image *img, int channels, int padding, ChannelLayout layout) {
+    if (channels <= 0 || img->width % channels != 0) {
+        return NULL;
+    }
+    ChannelImage *channel_img = init_channel_image(img->width / channels, img->height, channels, padding, layout);
+    for (int y = 0; y < img->height; ++y) {
+        for (int x = 0; x < channel_img->inner_width; ++x) {
+            for (int c = 0; c < channels; ++c) {
+                ACCESS_CHANNEL(channel_img, c, x, y) = img->image[y][x * channels + c];
+            }
+        }
+    }
+    update_channel_borders(channel_img);
+    return channel_img;
+}
+
+Image *merge_channels(ChannelImage *img) {
+    Image *merged = init_image(img->inner_width * img->channels, img->inner_height, 0);
+    for (int y = 0; y < img->inner_height; ++y) {
+        for (int x = 0; x < img->inner_width; ++x) {
+            for (int c = 0; c < img->channels; ++c) {
+                merged->image[y][x * img->channels + c] = ACCESS_CHANNEL(img, c, x, y);
+            }
+        }
+    }
+    return merged;
+}
+
+void update_channel_borders(ChannelImage *img) {
+    int values = img->values_per_pixel;
+    int first = img->padding * values;
+    int last = (img->padding + img->inner_width - 1) * values;
+    size_t row_size = sizeof(double) * img->width * values;
+    for (int plane = 0; plane < img->planes; ++plane) {
+        double **rows = img->rows + plane * img->height;
+        // left and right bounds, every value of the padding repeats the same channel of the outer pixel
+        for (int y = img->padding; y < img->padding + img->inner_height; ++y) {
+            for (int i = 0; i < first; ++i) {
+                rows[y][i] = rows[y][first + i % values];
+                rows[y][last + values + i] = rows[y][last + i % values];
+            }
+        }
+        // upper and lower bounds
+        for (int y = 0; y < img->padding; ++y) {
+            memcpy(rows[y], rows[img->padding], row_size);
+            memcpy(rows[img->height - 1 - y], rows[img->height - 1 - img->padding], row_size);
+        }
+    }
+}
+
+int copy_channel_image(ChannelImage *from, ChannelImage *to) {
+    if (from == NULL || to == NULL) {
+        return -1;
+    }
+    if (from->width != to->width || from->height != to->height || from->channels != to->channels ||
+        from->layout != to->layout) {
+        return -2;
+    }
+    memcpy(to->data, from->data, sizeof(double) * (size_t) from->planes * from->height * from->stride);
+    return 0;
+}
+
+double get_channel_checksum(ChannelImage *img, int channel) {
+    double val = 0.0;
+    for (int y = 0; y < img->inner_height; ++y) {
+        for (int x = 0; x < img->inner_width; ++x) {
+            val += ACCESS_CHANNEL(img, channel, x, y);
+        }
+    }
+    return val;
+}
@@ -12,9 +12,82 @@
 #include <stdbool.h>
 #include <getopt.h>
 #include "../util/util.h"
+#include "../util/numa.h"
 
 #define ACCESS_IMAGE(img, x, y) (img->image[(y) + (img->padding)][(x) + (img->padding)])
 #define ACCESS_FIELD(img, x, y) (img->image[y][x])
+// direct access into the contiguous block, only valid for LAYOUT_CONTIGUOUS images
+#define ACCESS_DATA(img, x, y) (img->data[(y) * (img->stride) + (x)])
+// access of channel c of a pixel of a multi-channel image, without the padding like ACCESS_IMAGE
+#define ACCESS_CHANNEL(img, c, x, y) \
+    ((img)->rows[((img)->layout == CHANNELS_PLANAR ? (c) * (img)->height : 0) + (y) + (img)->padding] \
+                [(img)->layout == CHANNELS_PLANAR ? (x) + (img)->padding \
+                                                  : ((x) + (img)->padding) * (img)->channels + (c)])
+
+// default tolerance of the separability test, small enough to only accept kernels that are separable up to rounding
+#define DEFAULT_SEPARABLE_TOLERANCE (1e-12)
+// kernels are only quantized if that is lossless
+#define DEFAULT_QUANTIZE_TOLERANCE (0.0)
+
+// alignment of contiguous image blocks in bytes, every row starts at such a boundary
+#define IMAGE_ALIGNMENT (64)
+// largest number of channels of a multi-channel image
+#define CHANNELS_MAX (4)
+// largest number of kernels that are applied one after another
+#define KERNEL_CHAIN_MAX (8)
+
+/**
+ * Storage layout of the pixels of an image.
+ * LAYOUT_CONTIGUOUS stores all rows in one aligned block, separated by a fixed row stride.
+ * LAYOUT_ROWS allocates every row on its own, this is the original representation.
+ * In both cases img->image holds a pointer to the beginning of every row.
+ */
+enum ImageLayout {
+    LAYOUT_CONTIGUOUS = 0,
+    LAYOUT_ROWS = 1
+};
+
+/**
+ * Arrangement of the channels of a multi-channel image.
+ * CHANNELS_INTERLEAVED stores the channels of a pixel next to each other, like RGBRGB...
+ * CHANNELS_PLANAR stores every channel in a plane of its own.
+ */
+enum ChannelLayout {
+    CHANNELS_INTERLEAVED = 0,
+    CHANNELS_PLANAR
+};
+
+/**
+ * Engines that can be used to apply a kernel to an image.
+ * ENGINE_AUTO lets create_kernel(...) pick the engine that fits the kernel best.
+ */
+enum Engine {
+    ENGINE_AUTO = 0,
+    ENGINE_DIRECT,
+    ENGINE_SEPARABLE,
+    ENGINE_FFT,
+    // fixed point on int16 images, never selected automatically because every iteration rounds to integers
+    ENGINE_QUANTIZED
+};
+
+/**
+ * Format of an image file, detected by parse_args(...)
+ */
+enum ImageFormat {
+    IMAGE_FORMAT_TEXT = 0,
+    IMAGE_FORMAT_BINARY
+};
+
+/**
+ * Type of the values of a binary image, also the precision a kernel is applied with
+ */
+enum PixelType {
+    PIXEL_FLOAT64 = 0,
+    PIXEL_FLOAT32,
+    PIXEL_UINT8,
+    PIXEL_UINT16,
+    PIXEL_INT16
+};
 
 struct arguments {
     bool debug;
@@ -27,13 +100,50 @@ struct arguments {
     int width;
     int height;
     char *image_file_path;
+    // first kernel file, the kernels of all channels if several channels are used
     char *kernel_file_path;
+    // every -k adds a stage to the chain of kernels that is applied in every iteration
+    char *kernel_file_paths[KERNEL_CHAIN_MAX];
+    int number_of_kernels;
+    enum ImageLayout layout;
+    enum Engine engine;
+    // tolerance of the separability test, relative to the largest coefficient of the kernel
+    double separable_tolerance;
+    // largest error of a quantized coefficient, relative to the largest coefficient of the kernel
+    double quantize_tolerance;
+    // number of iterations that are advanced at once by temporal blocking, values below 2 disable it
+    int temporal_steps;
+    // format of the image file, only meaningful if opt_image_from_file is set
+    enum ImageFormat image_format;
+    // number of image rows per band of the streaming engine, 0 keeps the whole image in memory
+    int stream_band_rows;
+    // binary image file the streaming engine writes its result to, the output directory in batch mode, may be NULL
+    char *output_file_path;
+    // directory or list file of the images of the batch mode, NULL runs on a single image
+    char *batch_path;
+    // type the image is stored in by the direct engine, all types but float64 accumulate in float
+    enum PixelType precision;
+    // images are not padded, the direct engine clamps the outer columns instead of updating the borders
+    bool virtual_halo;
+    // number of channels of the image, the values of a pixel are interleaved in the image file
+    int channels;
+    // arrangement of the channels in memory while the kernels are applied
+    enum ChannelLayout channel_layout;
+    // the images are zeroed by the threads that compute their rows, so their pages are local to the thread's socket
+    bool numa_first_touch;
+    // policy the OpenMP threads are pinned to cores with
+    enum PinPolicy pin_policy;
 };
 
 struct Image {
     int width;
     int height;
     double **image;
+    enum ImageLayout layout;
+    // number of doubles between the beginning of two rows, only meaningful for LAYOUT_CONTIGUOUS
+    int stride;
+    // contiguous block of height * stride values, NULL for LAYOUT_ROWS
+    double *data;
 };
 
 struct ImageWithPadding {
@@ -43,7 +153,65 @@ struct ImageWithPadding {
     int inner_width;
     int inner_height;
     double **image;
+    enum ImageLayout layout;
+    // number of doubles between the beginning of two rows, only meaningful for LAYOUT_CONTIGUOUS
+    int stride;
+    // contiguous block of height * stride values, including the padding rows, NULL for LAYOUT_ROWS
+    double *data;
+    // mapped file that contains data, NULL if data was allocated
+    void *mapping;
+    size_t mapping_size;
+};
+
+/**
+ * Padded image with several channels per pixel.
+ * Every plane has height rows of stride values, the padding of padding pixels is clamped per channel.
+ * A planar image has one plane per channel, an interleaved image a single plane with channels values per pixel.
+ */
+struct ChannelImage {
+    int channels;
+    enum ChannelLayout layout;
+    int padding;
+    int width;
+    int height;
+    int inner_width;
+    int inner_height;
+    // channels for CHANNELS_PLANAR, 1 for CHANNELS_INTERLEAVED
+    int planes;
+    // number of values of a pixel in a plane, 1 for CHANNELS_PLANAR, channels for CHANNELS_INTERLEAVED
+    int values_per_pixel;
+    // number of doubles between the beginning of two rows
+    int stride;
+    // contiguous block of planes * height * stride values
+    double *data;
+    // rows[plane * height + y] points to row y of a plane, including the padding rows
+    double **rows;
 };
+/**
+ * Typedef for easier usage of the layout
+ */
+typedef enum ImageLayout ImageLayout;
+
+/**
+ * Typedef for easier usage of the channel layout
+ */
+typedef enum ChannelLayout ChannelLayout;
+
+/**
+ * Typedef for easier usage of the image format
+ */
+typedef enum ImageFormat ImageFormat;
+
+/**
+ * Typedef for easier usage of the pixel type
+ */
+typedef enum PixelType PixelType;
+
+/**
+ * Typedef for easier usage of the engine
+ */
+typedef enum Engine Engine;
+
 /**
  * Typedef of the arguments struct
  */
@@ -59,6 +227,11 @@ typedef struct Image Image;
  */
 typedef struct ImageWithPadding ImageWithPadding;
 
+/**
+ * Typedef for easier usage of the multi-channel image
+ */
+typedef struct ChannelImage ChannelImage;
+
 /**
  * Helper function to print the image in an easy way to read
  * @param img Image that shall be printed, line based
@@ -79,8 +252,11 @@ Args *parse_args(int argc, char **argv);
  * <width> <height>
  * These values must match the true extent of the image.
  * Values are separated by space. If one of the values can not be parsed, the function terminates.
+ * The lines are parsed by args->number_of_processes threads, see parse_text_image(...).
+ * Stores the extent of the image in the arguments and reports the parse throughput in debug mode.
  *
  * @param fd File to read the matrix from
+ * @param args Arguments of the program
  * @return Image read from a file
  */
 Image *read_image_from_fd(FILE *fd, Args *args);
@@ -108,11 +284,12 @@ int copy_image(Image *from, Image *to);
  * Append to a file the output of the benchmark.
  * The File mustn't be NULL
  * @param fd File to append the results to
- * @param img Image containing matching width and height values
+ * @param width Width of the image
+ * @param height Height of the image
  * @param args Arguments for number of processes and how many times the benchmarks has been iterated
  * @param time Time it took to execute the benchmark
  */
-void append_convolution_csv(FILE *fd, ImageWithPadding *img, Args *args, time_t time);
+void append_convolution_csv(FILE *fd, int width, int height, Args *args, time_t time);
 
 /**
  * Sum all pixels of the given image, represents a checksum for comparison
@@ -138,6 +315,47 @@ void write_checksum_to(FILE *fd, double checksum);
  */
 Image *init_image(int width, int height, double default_value);
 
+/**
+ * Human readable name of an engine, used for the benchmark output
+ * @param engine Engine to name
+ * @return static string, must not be freed
+ */
+const char *engine_name(Engine engine);
+
+/**
+ * Initialize an image with an explicit storage layout
+ *
+ * @param width width of the image
+ * @param height height of the image
+ * @param default_value set to every value in the image
+ * @param layout storage layout of the pixels
+ * @return image pointer with the set value and the respective sizes
+ */
+Image *init_image_with_layout(int width, int height, double default_value, ImageLayout layout);
+
+/**
+ * Number of doubles between two rows of a contiguous image of the given width.
+ * Rounded up so that every row starts at an IMAGE_ALIGNMENT boundary.
+ *
+ * @param width Number of values in a row
+ * @return stride of a row
+ */
+int image_stride(int width);
+
+/**
+ * Human readable name of a layout, used for the benchmark output
+ * @param layout Layout to name
+ * @return static string, must not be freed
+ */
+const char *layout_name(ImageLayout layout);
+
+/**
+ * Human readable name of a channel layout, used for the benchmark output
+ * @param layout Layout to name
+ * @return static string, must not be freed
+ */
+const char *channel_layout_name(ChannelLayout layout);
+
 /**
  * This Image is equal to the following Kernel
  *    2 -2  2 -2  2
@@ -199,6 +417,15 @@ void free_args(Args *args);
  */
 ImageWithPadding *add_padding(Image *img, int padding);
 
+/**
+ * Add padding to an image and store the padded image in the given layout.
+ * @param img Image to apply the padding
+ * @param padding Size of the padding for the new padded image
+ * @param layout Storage layout of the new padded image
+ * @return New padded image, must be freed with free_padded_image(...) after usage
+ */
+ImageWithPadding *add_padding_with_layout(Image *img, int padding, ImageLayout layout);
+
 /**
  * Remove the padding of an image and return just the image data.
  * it should hold: remove_padding(add_padding(img,2)) == img
@@ -247,4 +474,90 @@ int copy_padded_image(ImageWithPadding *padded_from, ImageWithPadding *padded_to
  */
 ImageWithPadding *init_padded_image(int inner_width, int inner_height, int padding);
 
+/**
+ * Initializes a new image with a padded border in the given layout. All values are initialized to 0
+ * For LAYOUT_ROWS the upper and lower padding rows alias the first and last row of the image,
+ * for LAYOUT_CONTIGUOUS every padding row is stored and kept up to date by update_borders(...)
+ *
+ * @param inner_width Width of the actual image
+ * @param inner_height Height of the actual image
+ * @param padding Size of the padding that should be added to the image
+ * @param layout Storage layout of the image
+ * @return Image with a padded border.
+ */
+ImageWithPadding *init_padded_image_with_layout(int inner_width, int inner_height, int padding, ImageLayout layout);
+
+/**
+ * Initializes a new image like init_padded_image_with_layout(...), but zeroes it with a team of threads.
+ * The rows are distributed by the static schedule of apply_kernel_to_padded_image(...), the padding rows are
+ * touched by the threads of the first and last row. So every page is first touched by the thread that writes it
+ * and ends up in the memory of its socket.
+ *
+ * @param inner_width Width of the actual image
+ * @param inner_height Height of the actual image
+ * @param padding Size of the padding that should be added to the image
+ * @param layout Storage layout of the image
+ * @param number_of_processes Number of threads that touch the image
+ * @return Image with a padded border.
+ */
+ImageWithPadding *init_padded_image_first_touch(int inner_width, int inner_height, int padding, ImageLayout layout,
+                                                int number_of_processes);
+
+/**
+ * Initializes a new multi-channel image with a padded border. All values are initialized to 0
+ *
+ * @param inner_width Width of the actual image in pixels
+ * @param inner_height Height of the actual image
+ * @param channels Number of channels, at most CHANNELS_MAX
+ * @param padding Size of the padding in pixels
+ * @param layout Arrangement of the channels
+ * @return Multi-channel image, must be freed with free_channel_image(...) after usage
+ */
+ChannelImage *init_channel_image(int inner_width, int inner_height, int channels, int padding, ChannelLayout layout);
+
+/**
+ * Free the resources allocated by this image
+ * @param img Multi-channel image to free, may be NULL
+ */
+void free_channel_image(ChannelImage *img);
+
+/**
+ * Split an image that stores the channels of every pixel next to each other into a padded multi-channel image.
+ * @param img Image of width * channels values per row
+ * @param channels Number of channels
+ * @param padding Size of the padding in pixels
+ * @param layout Arrangement of the channels of the new image
+ * @return New multi-channel image with updated borders, NULL if the width of img is not a multiple of channels
+ */
+ChannelImage *split_channels(Image *img, int channels, int padding, ChannelLayout layout);
+
+/**
+ * Inverse of split_channels(...)
+ * @param img Multi-channel image
+ * @return New image of inner_width * channels interleaved values per row without padding
+ */
+Image *merge_channels(ChannelImage *img);
+
+/**
+ * Update the padding of every channel of the image to match its borders, like update_borders(...)
+ * @param img Image to update the borders of
+ */
+void update_channel_borders(ChannelImage *img);
+
+/**
+ * Copy a multi-channel image, including its padding.
+ * @param from Source image
+ * @param to Target image
+ * @return zero on success, -1 if one of the parameters is NULL and -2 if the extents or layouts do not match
+ */
+int copy_channel_image(ChannelImage *from, ChannelImage *to);
+
+/**
+ * Sum all pixels of one channel of an image, see get_checksum(...)
+ * @param img Multi-channel image
+ * @param channel Channel to sum
+ * @return Summed value of the channel
+ */
+double get_channel_checksum(ChannelImage *img, int channel);
+
 #endif //HG_C_BENCHMARKS_CONVOLUTION_UTIL_H
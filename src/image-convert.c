@@ -0,0 +1,74 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "convolution/convolution-util.h"
+#include "convolution/convolution-binary.h"
+#include "convolution/convolution-parse.h"
+
+/**
+ * Prints Synopsis of the program
+ */
+static void convert_usage(void) {
+    fprintf(stderr,
+            "SYNOPSIS: %s [-p number_of_processes] [-t float64|float32|uint8|uint16|int16] [-P padding] text_image_file_name binary_image_file_name\n",
+            pgmname);
+    exit(1);
+}
+
+/**
+ * Convert an image from the text format to the binary format of 2D-Convolution
+ *
+ * @param argc Number of arguments
+ * @param argv String array of arguments
+ * @return non - zero exit code indicates error.
+ */
+int main(int argc, char **argv) {
+    pgmname = argv[0]; // for error messages
+    PixelType type = PIXEL_FLOAT64;
+    int padding = DEFAULT_BINARY_IMAGE_PADDING;
+    int threads = 1;
+    int c;
+    while ((c = getopt(argc, argv, "?p:t:P:")) != -1) {
+        switch (c) {
+            case 'p':
+                threads = (int) strtol(optarg, NULL, 10);
+                break;
+            case 't':
+                if (parse_pixel_type(optarg, &type) != 0) {
+                    convert_usage();
+                }
+                break;
+            case 'P':
+                padding = (int) strtol(optarg, NULL, 10);
+                break;
+            default:
+                convert_usage();
+        }
+    }
+    if (argc - optind != 2 || padding < 0 || threads <= 0) {
+        convert_usage();
+    }
+
+    FILE *fd = fopen(argv[optind], "r");
+    if (fd == NULL) {
+        bail_out("text image could not be opened");
+    }
+    TextParseStats stats;
+    Image *img = parse_text_image(fd, threads, &stats);
+    fclose(fd);
+    if (img == NULL) {
+        bail_out("text image could not be read");
+    }
+    if (write_binary_image(argv[optind + 1], img, type, padding) != 0) {
+        free_image(img);
+        bail_out("binary image could not be written");
+    }
+    printf("Parsed %zu bytes in %zu.%06zus (%.1f MB/s)\n", stats.bytes, stats.time / 1000000, stats.time % 1000000,
+           parse_throughput(&stats));
+    printf("Converted %dx%d image to %s with padding %d\n", img->width, img->height, pixel_type_name(type), padding);
+    free_image(img);
+    return 0;
+}
@@ -1,12 +1,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "nbody/nbody-run.h"
+#include "nbody/nbody-tiled.h"
+#include "nbody/nbody-integrator.h"
+#include "nbody/nbody-mixed.h"
 
 
 #ifndef REPETITION
 #define REPETITION (10)
 #endif
 
+/**
+ * Compare the leapfrog integrator with the swap loop of run(...) in time and memory traffic per step
+ * and report the energy drift of the integrator
+ */
+void compare_with_swap_loop(Args *args);
+
 
 int main(int argc, char **argv) {
     pgmname = argv[0];
@@ -14,6 +23,9 @@ int main(int argc, char **argv) {
     if (args->debug) {
         print_args(args);
     }
+    // the same team runs every parallel region, so the threads stay on their cores
+    ThreadPlacement *placement = pin_threads(args->pin_policy, args->number_of_processes);
+    int first_touch = args->numa_first_touch ? args->number_of_processes : 1;
 
     Float3D *planets = (Float3D *) malloc(sizeof(Float3D) * args->size);
     Float3D *buffer = (Float3D *) malloc(sizeof(Float3D) * args->size);
@@ -22,19 +34,41 @@ int main(int argc, char **argv) {
     FILE *check = fopen("../nbody.res", "w+");
 
     if (planets != NULL && buffer != NULL && res != NULL && check != NULL) {
-        for (int n = 0; n < REPETITION; ++n) {
-            for (int i = 0; i < args->size; i++) {
-                fill_planet(&planets[i], i);
-            }
-            printf("Starting Kernel...\n");
-            TIC(0);
-            run(planets, buffer, args->size, args->iterations, args->number_of_processes);
-            time_t seq_t = TOC(0);
-            printf("Kernel time: %zi.%06zis\n", seq_t / 1000000, seq_t % 1000000);
-
-            append_nbody_csv(res, args, seq_t);
-
+        if (args->sweep) {
+            int tile_size = sweep_tile_size(args, planets, buffer, res);
+            printf("Best tile size: %d\n", tile_size);
+        } else {
+            time_t last_t = 0;
+            for (int n = 0; n < REPETITION; ++n) {
+                fill_planets(planets, args->size, first_touch);
+                if (n == 0) {
+                    // the buffer is only written by the simulation, touch it the same way
+                    fill_planets(buffer, args->size, first_touch);
+                }
+                printf("Starting Kernel...\n");
+                TIC(0);
+                simulate(planets, buffer, args);
+                time_t seq_t = TOC(0);
+                printf("Kernel time: %zi.%06zis\n", seq_t / 1000000, seq_t % 1000000);
 
+                append_nbody_csv(res, args, seq_t);
+                last_t = seq_t;
+            }
+            if (args->numa_first_touch || args->pin_policy != PIN_NONE) {
+                // every step reads the positions and writes the accelerations of all bodies at least once
+                print_memory_locality(placement, planets, sizeof(Float3D) * args->size,
+                                      2.0 * sizeof(Float3D) * args->size * args->iterations, last_t);
+            }
+        }
+        if (args->debug && args->engine == ENGINE_LEAPFROG) {
+            compare_with_swap_loop(args);
+        } else if (args->debug && args->persistent) {
+            compare_persistent_region(args);
+        } else if (args->debug && args->engine != ENGINE_SIMD) {
+            printf("Max error of a single step against run(): %g\n", single_step_error(args));
+            if (args->engine == ENGINE_MIXED) {
+                printf("Max error of %d steps against run(): %g\n", args->iterations, mixed_precision_error(args));
+            }
         }
         pretty_print(check, planets, args->size);
 
@@ -43,5 +77,33 @@ int main(int argc, char **argv) {
         bail_out("Resources could not be allocated");
     }
     free_resources(planets, buffer, res, check);
+    free_thread_placement(placement);
     return 0;
 }
+
+void compare_with_swap_loop(Args *args) {
+    Float3D *planets = (Float3D *) malloc(sizeof(Float3D) * args->size);
+    Float3D *buffer = (Float3D *) malloc(sizeof(Float3D) * args->size);
+    if (planets == NULL || buffer == NULL) {
+        free_resources(planets, buffer, NULL, NULL);
+        bail_out("Resources could not be allocated");
+    }
+    time_t times[2];
+    Engine engines[2] = {ENGINE_LEAPFROG, ENGINE_SIMD};
+    for (int e = 0; e < 2; ++e) {
+        Args engine_args = *args;
+        engine_args.engine = engines[e];
+        fill_planets(planets, args->size, args->number_of_processes);
+        TIC(0);
+        simulate(planets, buffer, &engine_args);
+        times[e] = TOC(0);
+    }
+    double bytes = (double) sizeof(double) * args->size;
+    printf("Bytes per step: %.0f fused kick-drift-kick, %.0f kick-drift-kick in three sweeps, %.0f swap loop\n",
+           bytes * LEAPFROG_DOUBLES_PER_BODY, bytes * KICK_DRIFT_KICK_SWEEPS_DOUBLES_PER_BODY,
+           bytes * SWAP_LOOP_DOUBLES_PER_BODY);
+    printf("Leapfrog time relative to the swap loop: %.2fx\n",
+           (double) times[0] / (double) (times[1] > 0 ? times[1] : 1));
+    printf("Relative energy drift of the leapfrog integrator: %g\n", leapfrog_energy_drift(args));
+    free_resources(planets, buffer, NULL, NULL);
+}
@@ -0,0 +1,239 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "nbody-barnes-hut.h"
+
+// the depth of the collapsed tree is bounded by the number of levels of a morton key
+#define OCTREE_STACK_SIZE (8 * (MORTON_BITS + 1))
+
+Octree *init_octree(int size) {
+    Octree *tree = (Octree *) malloc(sizeof(Octree));
+    if (tree == NULL) {
+        bail_out("octree could not be allocated");
+    }
+    tree->capacity = 2 * size + 1;
+    tree->count = 0;
+    tree->nodes = (OctreeNode *) malloc(sizeof(OctreeNode) * tree->capacity);
+    tree->sorted = init_bodies(size);
+    tree->keys = (uint64_t *) malloc(sizeof(uint64_t) * size);
+    tree->index = (int *) malloc(sizeof(int) * size);
+    tree->tmp_keys = (uint64_t *) malloc(sizeof(uint64_t) * size);
+    tree->tmp_index = (int *) malloc(sizeof(int) * size);
+    if (tree->nodes == NULL || tree->keys == NULL || tree->index == NULL || tree->tmp_keys == NULL ||
+        tree->tmp_index == NULL) {
+        bail_out("octree could not be allocated");
+    }
+    return tree;
+}
+
+void free_octree(Octree *tree) {
+    if (tree != NULL) {
+        free(tree->nodes);
+        free_bodies(tree->sorted);
+        free(tree->keys);
+        free(tree->index);
+        free(tree->tmp_keys);
+        free(tree->tmp_index);
+        free(tree);
+    }
+}
+
+/**
+ * Octant of a key on the given level, level zero is the root
+ */
+static inline int octant(uint64_t key, int level) {
+    return (int) (key >> (MORTON_KEY_BITS - 3 * (level + 1))) & 7;
+}
+
+/**
+ * First level on which the two keys lie in different octants
+ */
+static inline int split_level(uint64_t first, uint64_t last) {
+    int highest_bit = 63 - __builtin_clzll(first ^ last);
+    return (MORTON_KEY_BITS - 1 - highest_bit) / 3;
+}
+
+/**
+ * Compute the center of mass of a leaf directly from its bodies
+ */
+static void summarize_leaf(Octree *tree, OctreeNode *node) {
+    Bodies *sorted = tree->sorted;
+    double x = 0.0, y = 0.0, z = 0.0;
+    for (int i = node->begin; i < node->end; i++) {
+        x += sorted->x[i];
+        y += sorted->y[i];
+        z += sorted->z[i];
+    }
+    node->mass = node->end - node->begin;
+    node->x = x / node->mass;
+    node->y = y / node->mass;
+    node->z = z / node->mass;
+    node->first_child = -1;
+    node->child_count = 0;
+}
+
+/**
+ * Build the node and its subtree, the node covers the sorted bodies [begin, end)
+ */
+static void build_node(Octree *tree, int index, int begin, int end, int level) {
+    OctreeNode *node = &tree->nodes[index];
+    uint64_t *keys = tree->keys;
+    node->begin = begin;
+    node->end = end;
+    if (end - begin <= OCTREE_LEAF_SIZE || keys[begin] == keys[end - 1]) {
+        node->size = ldexp(tree->box.size, -level);
+        summarize_leaf(tree, node);
+        return;
+    }
+    // skip all levels on which the bodies share a single octant
+    level = split_level(keys[begin], keys[end - 1]);
+    node->size = ldexp(tree->box.size, -level);
+
+    int bounds[9];
+    int child_count = 0;
+    bounds[0] = begin;
+    for (int i = begin; i < end;) {
+        // binary search for the end of the octant of the body i
+        int digit = octant(keys[i], level);
+        int low = i + 1, high = end;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (octant(keys[mid], level) == digit) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        bounds[++child_count] = low;
+        i = low;
+    }
+
+    int first_child;
+#pragma omp atomic capture
+    {
+        first_child = tree->count;
+        tree->count += child_count;
+    }
+    node->first_child = first_child;
+    node->child_count = child_count;
+
+    for (int child = 0; child < child_count; child++) {
+        int child_begin = bounds[child];
+        int child_end = bounds[child + 1];
+#pragma omp task if (child_end - child_begin > OCTREE_TASK_SIZE)
+        build_node(tree, first_child + child, child_begin, child_end, level + 1);
+    }
+#pragma omp taskwait
+
+    double x = 0.0, y = 0.0, z = 0.0;
+    for (int child = 0; child < child_count; child++) {
+        OctreeNode *c = &tree->nodes[first_child + child];
+        x += c->x * c->mass;
+        y += c->y * c->mass;
+        z += c->z * c->mass;
+    }
+    node->mass = end - begin;
+    node->x = x / node->mass;
+    node->y = y / node->mass;
+    node->z = z / node->mass;
+}
+
+void build_octree(Octree *tree, Bodies *bodies, int number_of_processes) {
+    int size = bodies->size;
+    tree->box = bounding_box(bodies, number_of_processes);
+    morton_keys(bodies, tree->box, tree->keys, tree->index, number_of_processes);
+    radix_sort_pairs(tree->keys, tree->index, tree->tmp_keys, tree->tmp_index, size, MORTON_KEY_BITS,
+                     number_of_processes);
+
+    Bodies *sorted = tree->sorted;
+#pragma omp parallel for num_threads(number_of_processes)
+    for (int i = 0; i < size; i++) {
+        sorted->x[i] = bodies->x[tree->index[i]];
+        sorted->y[i] = bodies->y[tree->index[i]];
+        sorted->z[i] = bodies->z[tree->index[i]];
+    }
+
+    tree->count = 1;
+#pragma omp parallel num_threads(number_of_processes)
+#pragma omp single
+    build_node(tree, 0, 0, size, 0);
+}
+
+void octree_accel(Octree *tree, double x, double y, double z, double theta, double *acc) {
+    Bodies *sorted = tree->sorted;
+    double theta_sq = theta * theta;
+    double ax = 0.0, ay = 0.0, az = 0.0;
+    int stack[OCTREE_STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        OctreeNode *node = &tree->nodes[stack[--top]];
+        if (node->first_child < 0) {
+            for (int i = node->begin; i < node->end; i++) {
+                double dx = sorted->x[i] - x;
+                double dy = sorted->y[i] - y;
+                double dz = sorted->z[i] - z;
+                double distance_sq = dx * dx + dy * dy + dz * dz + EPS;
+                double factor = 1.0 / sqrt(distance_sq * distance_sq * distance_sq);
+                ax += dx * factor;
+                ay += dy * factor;
+                az += dz * factor;
+            }
+            continue;
+        }
+        double dx = node->x - x;
+        double dy = node->y - y;
+        double dz = node->z - z;
+        double distance_sq = dx * dx + dy * dy + dz * dz;
+        if (node->size * node->size < theta_sq * distance_sq) {
+            distance_sq += EPS;
+            double factor = node->mass / sqrt(distance_sq * distance_sq * distance_sq);
+            ax += dx * factor;
+            ay += dy * factor;
+            az += dz * factor;
+        } else {
+            for (int child = node->child_count - 1; child >= 0; child--) {
+                stack[top++] = node->first_child + child;
+            }
+        }
+    }
+    acc[0] += ax;
+    acc[1] += ay;
+    acc[2] += az;
+}
+
+void run_barnes_hut_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes, double theta) {
+    Octree *tree = init_octree(planets->size);
+    for (int i = 0; i < iterations; i++) {
+        build_octree(tree, planets, number_of_processes);
+
+        // walk the bodies in morton order, neighbouring bodies visit mostly the same nodes
+        Bodies *sorted = tree->sorted;
+#pragma omp parallel for num_threads(number_of_processes) schedule(dynamic, 64)
+        for (int val = 0; val < planets->size; val++) {
+            double acc[3] = {0.0, 0.0, 0.0};
+            octree_accel(tree, sorted->x[val], sorted->y[val], sorted->z[val], theta, acc);
+            int index = tree->index[val];
+            buffer->x[index] = G * acc[0];
+            buffer->y[index] = G * acc[1];
+            buffer->z[index] = G * acc[2];
+        }
+
+        swap_ptr(&planets, &buffer, Bodies *);
+    }
+    free_octree(tree);
+}
+
+void run_barnes_hut(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes,
+                    double theta) {
+    Bodies *soa_planets = init_bodies_first_touch(number_of_planets, number_of_processes);
+    Bodies *soa_buffer = init_bodies_first_touch(number_of_planets, number_of_processes);
+    float3d_to_bodies(planets, soa_planets);
+
+    run_barnes_hut_soa(soa_planets, soa_buffer, iterations, number_of_processes, theta);
+
+    store_simulation(soa_planets, soa_buffer, planets, buffer, iterations);
+    free_bodies(soa_planets);
+    free_bodies(soa_buffer);
+}
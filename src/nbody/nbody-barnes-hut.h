@@ -0,0 +1,133 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_NBODY_BARNES_HUT_H
+#define HG_C_BENCHMARKS_NBODY_BARNES_HUT_H
+
+#include "nbody-util.h"
+#include "nbody-run.h"
+#include "nbody-morton.h"
+
+// cells with at most this many bodies are not split any further and summed up directly
+#define OCTREE_LEAF_SIZE (8)
+// cells with more bodies are built by a task of their own
+#define OCTREE_TASK_SIZE (4096)
+
+/**
+ * Node of an octree, all nodes are stored in one flat array.
+ * The children of a node are stored next to each other.
+ * Every node covers a contiguous range of the bodies sorted by their morton key.
+ */
+struct OctreeNode {
+    // center of mass
+    double x;
+    double y;
+    double z;
+    // number of bodies in the cell, all bodies have the same mass
+    double mass;
+    // edge length of the cell
+    double size;
+    // range of the sorted bodies [begin, end)
+    int begin;
+    int end;
+    // index of the first child, -1 for leaves
+    int first_child;
+    int child_count;
+};
+
+/**
+ * Octree and all buffers that are required to rebuild it every step
+ */
+struct Octree {
+    int capacity;
+    // number of used nodes, the root is always the first node
+    int count;
+    struct OctreeNode *nodes;
+    BoundingBox box;
+    // bodies ordered by their morton key
+    Bodies *sorted;
+    uint64_t *keys;
+    // index of the sorted body in the original bodies
+    int *index;
+    uint64_t *tmp_keys;
+    int *tmp_index;
+};
+
+/**
+ * Typedef for easier access
+ */
+typedef struct OctreeNode OctreeNode;
+
+/**
+ * Typedef for easier access
+ */
+typedef struct Octree Octree;
+
+/**
+ * Allocate an octree for the given number of bodies.
+ * An octree for N bodies never requires more than 2N nodes, since every inner node has at least two children.
+ *
+ * @param size Number of bodies
+ * @return Octree, must be freed with free_octree(...)
+ */
+Octree *init_octree(int size);
+
+/**
+ * Free the octree and all of its buffers
+ * @param tree Octree to free, may be NULL
+ */
+void free_octree(Octree *tree);
+
+/**
+ * Sort the bodies by their morton key and build the octree in parallel.
+ * Chains of cells with a single child are collapsed, a node is split at the first level its bodies differ.
+ *
+ * @param tree Octree of bodies->size bodies
+ * @param bodies Bodies to build the tree of
+ * @param number_of_processes that shall be used to build the tree
+ */
+void build_octree(Octree *tree, Bodies *bodies, int number_of_processes);
+
+/**
+ * Approximate the acceleration of a body with the octree.
+ * A cell is used as a whole if size / distance < theta, otherwise its children are visited.
+ * Leaves are always summed up directly, so theta = 0 computes the exact all pairs acceleration.
+ *
+ * @param tree Octree that has been built for the bodies
+ * @param x Position of the body
+ * @param y Position of the body
+ * @param z Position of the body
+ * @param theta Opening angle
+ * @param acc Three accumulators for x, y and z, the unscaled acceleration is added to them
+ */
+void octree_accel(Octree *tree, double x, double y, double z, double theta, double *acc);
+
+/**
+ * Runs the simulation on the structure of arrays with the barnes hut approximation.
+ * The octree is rebuilt every step and only the monopole of a cell is used.
+ * A single step from the fill_planet(...) initial conditions stays within 5e-3 of the largest acceleration
+ * of run(...) for theta <= 0.5, the error grows roughly with theta squared. theta = 0 matches run(...) up to rounding.
+ *
+ * @param planets Bodies that are being simulated
+ * @param buffer Buffer of the same size to store the results
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param theta Opening angle
+ */
+void run_barnes_hut_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes, double theta);
+
+/**
+ * Runs the simulation like run(...), but with the barnes hut engine
+ *
+ * @param planets planets that are being simulated
+ * @param buffer buffer to store the results
+ * @param number_of_planets number of planets that are being simulated
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param theta Opening angle
+ */
+void run_barnes_hut(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes,
+                    double theta);
+
+#endif //HG_C_BENCHMARKS_NBODY_BARNES_HUT_H
@@ -0,0 +1,206 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "nbody-grid.h"
+#include "nbody-morton.h"
+
+CellGrid *init_cell_grid(int size, int number_of_processes) {
+    CellGrid *grid = (CellGrid *) malloc(sizeof(CellGrid));
+    if (grid == NULL) {
+        bail_out("grid could not be allocated");
+    }
+    grid->size = size;
+    grid->max_cells = size > 0 ? GRID_CELLS_PER_BODY * size : 1;
+    grid->cells_x = grid->cells_y = grid->cells_z = 1;
+    grid->cell_start = (int *) malloc(sizeof(int) * (grid->max_cells + 1));
+    grid->cell_of = (int *) malloc(sizeof(int) * size);
+    grid->sorted = init_bodies_first_touch(size, number_of_processes);
+    grid->index = (int *) malloc(sizeof(int) * size);
+    grid->keys = (uint64_t *) malloc(sizeof(uint64_t) * size);
+    grid->tmp_keys = (uint64_t *) malloc(sizeof(uint64_t) * size);
+    grid->tmp_index = (int *) malloc(sizeof(int) * size);
+    if (grid->cell_start == NULL || grid->cell_of == NULL || grid->index == NULL || grid->keys == NULL ||
+        grid->tmp_keys == NULL || grid->tmp_index == NULL) {
+        bail_out("grid could not be allocated");
+    }
+    return grid;
+}
+
+void free_cell_grid(CellGrid *grid) {
+    if (grid != NULL) {
+        free(grid->cell_start);
+        free(grid->cell_of);
+        free_bodies(grid->sorted);
+        free(grid->index);
+        free(grid->keys);
+        free(grid->tmp_keys);
+        free(grid->tmp_index);
+        free(grid);
+    }
+}
+
+/**
+ * Number of cells of the given edge length that cover an extent
+ */
+static inline double cells_along(double extent, double cell_size) {
+    return floor(extent / cell_size) + 1.0;
+}
+
+/**
+ * Cell coordinate of a value along one axis
+ */
+static inline int cell_coordinate(double value, double min, double cell_size, int cells) {
+    int c = (int) ((value - min) / cell_size);
+    if (c < 0) {
+        return 0;
+    }
+    return c < cells ? c : cells - 1;
+}
+
+/**
+ * Choose the origin, the cell size and the number of cells along every axis for the current positions
+ */
+static void layout_cells(CellGrid *grid, Bodies *bodies, double cutoff, int number_of_processes) {
+    double min_x = INFINITY, min_y = INFINITY, min_z = INFINITY;
+    double max_x = -INFINITY, max_y = -INFINITY, max_z = -INFINITY;
+#pragma omp parallel for num_threads(number_of_processes) \
+        reduction(min:min_x, min_y, min_z) reduction(max:max_x, max_y, max_z)
+    for (int i = 0; i < bodies->size; i++) {
+        min_x = fmin(min_x, bodies->x[i]);
+        min_y = fmin(min_y, bodies->y[i]);
+        min_z = fmin(min_z, bodies->z[i]);
+        max_x = fmax(max_x, bodies->x[i]);
+        max_y = fmax(max_y, bodies->y[i]);
+        max_z = fmax(max_z, bodies->z[i]);
+    }
+    if (bodies->size == 0) {
+        min_x = min_y = min_z = max_x = max_y = max_z = 0.0;
+    }
+    // the extent along every axis is covered separately, bodies on a plane or a line need few cells
+    double extent_x = max_x - min_x, extent_y = max_y - min_y, extent_z = max_z - min_z;
+    double cell_size = cutoff;
+    while (cells_along(extent_x, cell_size) * cells_along(extent_y, cell_size) * cells_along(extent_z, cell_size) >
+           (double) grid->max_cells) {
+        cell_size *= 2.0;
+    }
+    grid->min_x = min_x;
+    grid->min_y = min_y;
+    grid->min_z = min_z;
+    grid->cell_size = cell_size;
+    grid->cells_x = (int) cells_along(extent_x, cell_size);
+    grid->cells_y = (int) cells_along(extent_y, cell_size);
+    grid->cells_z = (int) cells_along(extent_z, cell_size);
+}
+
+void build_cell_grid(CellGrid *grid, Bodies *bodies, double cutoff, int number_of_processes) {
+    layout_cells(grid, bodies, cutoff, number_of_processes);
+    int size = bodies->size;
+    int cells = grid->cells_x * grid->cells_y * grid->cells_z;
+    int key_bits = 1;
+    while (key_bits < 32 && (1 << key_bits) < cells) {
+        key_bits++;
+    }
+
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+    for (int i = 0; i < size; i++) {
+        int cx = cell_coordinate(bodies->x[i], grid->min_x, grid->cell_size, grid->cells_x);
+        int cy = cell_coordinate(bodies->y[i], grid->min_y, grid->cell_size, grid->cells_y);
+        int cz = cell_coordinate(bodies->z[i], grid->min_z, grid->cell_size, grid->cells_z);
+        int cell = (cz * grid->cells_y + cy) * grid->cells_x + cx;
+        grid->cell_of[i] = cell;
+        grid->keys[i] = (uint64_t) cell;
+        grid->index[i] = i;
+    }
+    // the histograms of the radix sort have a bucket per digit, not per cell
+    radix_sort_pairs(grid->keys, grid->index, grid->tmp_keys, grid->tmp_index, size, key_bits, number_of_processes);
+
+    // the cells between two sorted bodies of different cells are empty and start at the second one
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+    for (int i = 0; i <= size; i++) {
+        int first = i > 0 ? (int) grid->keys[i - 1] + 1 : 0;
+        int last = i < size ? (int) grid->keys[i] : cells;
+        for (int cell = first; cell <= last; cell++) {
+            grid->cell_start[cell] = i;
+        }
+        if (i < size) {
+            int index = grid->index[i];
+            grid->sorted->x[i] = bodies->x[index];
+            grid->sorted->y[i] = bodies->y[index];
+            grid->sorted->z[i] = bodies->z[index];
+        }
+    }
+}
+
+void grid_accel(CellGrid *grid, int sorted_index, double cutoff, double *acc) {
+    Bodies *sorted = grid->sorted;
+    double px = sorted->x[sorted_index];
+    double py = sorted->y[sorted_index];
+    double pz = sorted->z[sorted_index];
+    int cx = cell_coordinate(px, grid->min_x, grid->cell_size, grid->cells_x);
+    int cy = cell_coordinate(py, grid->min_y, grid->cell_size, grid->cells_y);
+    int cz = cell_coordinate(pz, grid->min_z, grid->cell_size, grid->cells_z);
+    int first_x = cx > 0 ? cx - 1 : 0;
+    int last_x = cx + 1 < grid->cells_x ? cx + 1 : cx;
+    double cutoff_sq = cutoff * cutoff;
+    double ax = 0.0;
+    double ay = 0.0;
+    double az = 0.0;
+    for (int z = cz > 0 ? cz - 1 : 0; z <= cz + 1 && z < grid->cells_z; z++) {
+        for (int y = cy > 0 ? cy - 1 : 0; y <= cy + 1 && y < grid->cells_y; y++) {
+            int row = (z * grid->cells_y + y) * grid->cells_x;
+            // the three cells along x are stored next to each other
+            int begin = grid->cell_start[row + first_x];
+            int end = grid->cell_start[row + last_x + 1];
+#pragma omp simd reduction(+:ax, ay, az)
+            for (int i = begin; i < end; i++) {
+                double dx = sorted->x[i] - px;
+                double dy = sorted->y[i] - py;
+                double dz = sorted->z[i] - pz;
+                double r_sq = dx * dx + dy * dy + dz * dz;
+                double distance_sq = r_sq + EPS;
+                double factor = r_sq <= cutoff_sq ? 1.0 / sqrt(distance_sq * distance_sq * distance_sq) : 0.0;
+                ax += dx * factor;
+                ay += dy * factor;
+                az += dz * factor;
+            }
+        }
+    }
+    acc[0] = ax;
+    acc[1] = ay;
+    acc[2] = az;
+}
+
+void run_grid_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes, double cutoff) {
+    CellGrid *grid = init_cell_grid(planets->size, number_of_processes);
+    for (int i = 0; i < iterations; i++) {
+        build_cell_grid(grid, planets, cutoff, number_of_processes);
+
+        // walk the bodies cell by cell, neighbouring bodies read the same cells, the density varies between cells
+#pragma omp parallel for num_threads(number_of_processes) schedule(dynamic, 64)
+        for (int val = 0; val < planets->size; val++) {
+            double acc[3];
+            grid_accel(grid, val, cutoff, acc);
+            int index = grid->index[val];
+            buffer->x[index] = G * acc[0];
+            buffer->y[index] = G * acc[1];
+            buffer->z[index] = G * acc[2];
+        }
+
+        swap_ptr(&planets, &buffer, Bodies *);
+    }
+    free_cell_grid(grid);
+}
+
+void run_grid(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes,
+              double cutoff) {
+    Bodies *soa_planets = init_bodies_first_touch(number_of_planets, number_of_processes);
+    Bodies *soa_buffer = init_bodies_first_touch(number_of_planets, number_of_processes);
+    float3d_to_bodies(planets, soa_planets);
+
+    run_grid_soa(soa_planets, soa_buffer, iterations, number_of_processes, cutoff);
+
+    store_simulation(soa_planets, soa_buffer, planets, buffer, iterations);
+    free_bodies(soa_planets);
+    free_bodies(soa_buffer);
+}
@@ -0,0 +1,118 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_NBODY_GRID_H
+#define HG_C_BENCHMARKS_NBODY_GRID_H
+
+#include <stdint.h>
+#include "nbody-util.h"
+#include "nbody-run.h"
+
+// the grid never has more cells than this many per body, sparse bodies get cells larger than the cutoff instead
+#define GRID_CELLS_PER_BODY (2)
+
+/**
+ * Uniform grid of cubic cells and all buffers that are required to rebuild it every step.
+ * The bodies are sorted by their cell, so the bodies of a cell and of the cells next to it along x
+ * are stored contiguously.
+ */
+struct CellGrid {
+    int size;
+    // maximal number of cells
+    int max_cells;
+    // number of cells along every axis, the cells are numbered with x running fastest
+    int cells_x;
+    int cells_y;
+    int cells_z;
+    // lower corner of the grid and edge length of a cell, never smaller than the cutoff
+    double min_x;
+    double min_y;
+    double min_z;
+    double cell_size;
+    // the bodies of cell c are the sorted bodies [cell_start[c], cell_start[c + 1])
+    int *cell_start;
+    // cell of every body in the original order
+    int *cell_of;
+    // bodies ordered by their cell
+    Bodies *sorted;
+    // index of the sorted body in the original bodies
+    int *index;
+    // cell of every sorted body, the keys of the radix sort
+    uint64_t *keys;
+    // temporary storage of the radix sort
+    uint64_t *tmp_keys;
+    int *tmp_index;
+};
+
+/**
+ * Typedef for easier access
+ */
+typedef struct CellGrid CellGrid;
+
+/**
+ * Allocate a grid for the given number of bodies
+ *
+ * @param size Number of bodies
+ * @param number_of_processes Number of threads that sort the bodies into the grid
+ * @return Grid, must be freed with free_cell_grid(...)
+ */
+CellGrid *init_cell_grid(int size, int number_of_processes);
+
+/**
+ * Free the grid and all of its buffers
+ * @param grid Grid to free, may be NULL
+ */
+void free_cell_grid(CellGrid *grid);
+
+/**
+ * Lay a grid of cells with an edge length of at least the cutoff over the bodies and sort them into the cells.
+ * The cells of the bodies are sorted with radix_sort_pairs(...), whose histograms do not grow with the number of
+ * cells, and the first body of every cell is found where the sorted cells change.
+ * The sort is stable, the bodies of a cell keep their original order.
+ *
+ * @param grid Grid of bodies->size bodies
+ * @param bodies Bodies to sort
+ * @param cutoff Cutoff radius, bodies further apart do not interact
+ * @param number_of_processes that shall be used to sort, at most the number the grid has been allocated for
+ */
+void build_cell_grid(CellGrid *grid, Bodies *bodies, double cutoff, int number_of_processes);
+
+/**
+ * Sum up the unscaled acceleration of a sorted body caused by all bodies within the cutoff radius.
+ * Only the 27 cells around the cell of the body are visited, as nine contiguous runs of three cells along x.
+ *
+ * @param grid Grid that has been built for the bodies
+ * @param sorted_index Index of the body in the sorted bodies
+ * @param cutoff Cutoff radius the grid has been built for
+ * @param acc Three accumulators for x, y and z
+ */
+void grid_accel(CellGrid *grid, int sorted_index, double cutoff, double *acc);
+
+/**
+ * Runs the simulation on the structure of arrays, but a body is only attracted by the bodies within
+ * the cutoff radius. The grid is rebuilt every step, so a step costs O(N) for a bounded density.
+ * A cutoff larger than the extent of the bodies computes the all pairs acceleration of run(...) up to rounding.
+ *
+ * @param planets Bodies that are being simulated
+ * @param buffer Buffer of the same size to store the results
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param cutoff Cutoff radius
+ */
+void run_grid_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes, double cutoff);
+
+/**
+ * Runs the simulation like run(...), but with the cell list engine
+ *
+ * @param planets planets that are being simulated
+ * @param buffer buffer to store the results
+ * @param number_of_planets number of planets that are being simulated
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param cutoff Cutoff radius
+ */
+void run_grid(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes,
+              double cutoff);
+
+#endif //HG_C_BENCHMARKS_NBODY_GRID_H
@@ -0,0 +1,245 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "nbody-integrator.h"
+#include "nbody-simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define INTEGRATOR_X86 1
+#include <immintrin.h>
+#endif
+
+BodyState *init_body_state(int size, int number_of_processes) {
+    BodyState *state = (BodyState *) malloc(sizeof(BodyState));
+    if (state == NULL) {
+        bail_out("body state could not be allocated");
+    }
+    state->position = init_bodies_first_touch(size, number_of_processes);
+    state->velocity = init_bodies_first_touch(size, number_of_processes);
+    state->next = init_bodies_first_touch(size, number_of_processes);
+    int capacity = state->position->capacity;
+    state->mass = (double *) aligned_alloc(BODY_ALIGNMENT, sizeof(double) * capacity);
+    if (state->mass == NULL) {
+        bail_out("body state could not be allocated");
+    }
+    double *mass = state->mass;
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+    for (int i = 0; i < capacity; i++) {
+        mass[i] = 0.0;
+    }
+    return state;
+}
+
+void free_body_state(BodyState *state) {
+    if (state != NULL) {
+        free_bodies(state->position);
+        free_bodies(state->velocity);
+        free_bodies(state->next);
+        free(state->mass);
+        free(state);
+    }
+}
+
+void mass_accel_scalar(BodyState *state, int index, double *acc) {
+    Bodies *bodies = state->position;
+    double px = bodies->x[index];
+    double py = bodies->y[index];
+    double pz = bodies->z[index];
+    double ax = 0.0;
+    double ay = 0.0;
+    double az = 0.0;
+    for (int i = 0; i < bodies->size; i++) {
+        double dx = bodies->x[i] - px;
+        double dy = bodies->y[i] - py;
+        double dz = bodies->z[i] - pz;
+        double distance_sq = dx * dx + dy * dy + dz * dz + EPS;
+        double factor = state->mass[i] / sqrt(distance_sq * distance_sq * distance_sq);
+        ax += dx * factor;
+        ay += dy * factor;
+        az += dz * factor;
+    }
+    acc[0] = ax;
+    acc[1] = ay;
+    acc[2] = az;
+}
+
+#ifdef INTEGRATOR_X86
+
+__attribute__((target("avx2")))
+void mass_accel_avx2(BodyState *state, int index, double *acc) {
+    Bodies *bodies = state->position;
+    __m256d px = _mm256_set1_pd(bodies->x[index]);
+    __m256d py = _mm256_set1_pd(bodies->y[index]);
+    __m256d pz = _mm256_set1_pd(bodies->z[index]);
+    __m256d eps = _mm256_set1_pd(EPS);
+    __m256d ax = _mm256_setzero_pd();
+    __m256d ay = _mm256_setzero_pd();
+    __m256d az = _mm256_setzero_pd();
+    for (int i = 0; i < bodies->capacity; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_load_pd(bodies->x + i), px);
+        __m256d dy = _mm256_sub_pd(_mm256_load_pd(bodies->y + i), py);
+        __m256d dz = _mm256_sub_pd(_mm256_load_pd(bodies->z + i), pz);
+        __m256d distance_sq = _mm256_add_pd(
+                _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz)),
+                eps);
+        __m256d cube = _mm256_mul_pd(_mm256_mul_pd(distance_sq, distance_sq), distance_sq);
+        __m256d factor = _mm256_div_pd(_mm256_load_pd(state->mass + i), _mm256_sqrt_pd(cube));
+        ax = _mm256_add_pd(ax, _mm256_mul_pd(dx, factor));
+        ay = _mm256_add_pd(ay, _mm256_mul_pd(dy, factor));
+        az = _mm256_add_pd(az, _mm256_mul_pd(dz, factor));
+    }
+    double sum[3][4];
+    _mm256_storeu_pd(sum[0], ax);
+    _mm256_storeu_pd(sum[1], ay);
+    _mm256_storeu_pd(sum[2], az);
+    acc[0] = (sum[0][0] + sum[0][1]) + (sum[0][2] + sum[0][3]);
+    acc[1] = (sum[1][0] + sum[1][1]) + (sum[1][2] + sum[1][3]);
+    acc[2] = (sum[2][0] + sum[2][1]) + (sum[2][2] + sum[2][3]);
+}
+
+__attribute__((target("avx512f")))
+void mass_accel_avx512(BodyState *state, int index, double *acc) {
+    Bodies *bodies = state->position;
+    __m512d px = _mm512_set1_pd(bodies->x[index]);
+    __m512d py = _mm512_set1_pd(bodies->y[index]);
+    __m512d pz = _mm512_set1_pd(bodies->z[index]);
+    __m512d eps = _mm512_set1_pd(EPS);
+    __m512d ax = _mm512_setzero_pd();
+    __m512d ay = _mm512_setzero_pd();
+    __m512d az = _mm512_setzero_pd();
+    for (int i = 0; i < bodies->capacity; i += 8) {
+        __m512d dx = _mm512_sub_pd(_mm512_load_pd(bodies->x + i), px);
+        __m512d dy = _mm512_sub_pd(_mm512_load_pd(bodies->y + i), py);
+        __m512d dz = _mm512_sub_pd(_mm512_load_pd(bodies->z + i), pz);
+        __m512d distance_sq = _mm512_add_pd(
+                _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)), _mm512_mul_pd(dz, dz)),
+                eps);
+        __m512d cube = _mm512_mul_pd(_mm512_mul_pd(distance_sq, distance_sq), distance_sq);
+        __m512d factor = _mm512_div_pd(_mm512_load_pd(state->mass + i), _mm512_sqrt_pd(cube));
+        ax = _mm512_add_pd(ax, _mm512_mul_pd(dx, factor));
+        ay = _mm512_add_pd(ay, _mm512_mul_pd(dy, factor));
+        az = _mm512_add_pd(az, _mm512_mul_pd(dz, factor));
+    }
+    acc[0] = _mm512_reduce_add_pd(ax);
+    acc[1] = _mm512_reduce_add_pd(ay);
+    acc[2] = _mm512_reduce_add_pd(az);
+}
+
+#else
+
+void mass_accel_avx2(BodyState *state, int index, double *acc) {
+    mass_accel_scalar(state, index, acc);
+}
+
+void mass_accel_avx512(BodyState *state, int index, double *acc) {
+    mass_accel_scalar(state, index, acc);
+}
+
+#endif
+
+MassAccelKernel select_mass_accel_kernel(void) {
+    if (simd_supports_avx512()) {
+        return mass_accel_avx512;
+    }
+    if (simd_supports_avx2()) {
+        return mass_accel_avx2;
+    }
+    return mass_accel_scalar;
+}
+
+/**
+ * One pass over the bodies: compute the acceleration of every body, kick its velocity by kick and,
+ * if drift is set, move it with the new velocity for time_step into the next positions
+ */
+static void leapfrog_pass(BodyState *state, double kick, bool drift, double time_step, int number_of_processes,
+                          MassAccelKernel kernel) {
+    Bodies *position = state->position;
+    Bodies *velocity = state->velocity;
+    Bodies *next = state->next;
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+    for (int i = 0; i < position->size; i++) {
+        double acc[3];
+        kernel(state, i, acc);
+        double vx = velocity->x[i] + G * acc[0] * kick;
+        double vy = velocity->y[i] + G * acc[1] * kick;
+        double vz = velocity->z[i] + G * acc[2] * kick;
+        velocity->x[i] = vx;
+        velocity->y[i] = vy;
+        velocity->z[i] = vz;
+        if (drift) {
+            next->x[i] = position->x[i] + vx * time_step;
+            next->y[i] = position->y[i] + vy * time_step;
+            next->z[i] = position->z[i] + vz * time_step;
+        }
+    }
+    if (drift) {
+        swap_ptr(&state->position, &state->next, Bodies *);
+    }
+}
+
+void run_leapfrog_state(BodyState *state, int iterations, double time_step, int number_of_processes,
+                        MassAccelKernel kernel) {
+    for (int i = 0; i < iterations; i++) {
+        // the first step starts with a half kick, every other kick is the second half kick of the previous step
+        // merged with the first half kick of this one
+        leapfrog_pass(state, i == 0 ? 0.5 * time_step : time_step, true, time_step, number_of_processes, kernel);
+    }
+    if (iterations > 0) {
+        leapfrog_pass(state, 0.5 * time_step, false, time_step, number_of_processes, kernel);
+    }
+}
+
+void run_leapfrog(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes,
+                  double time_step) {
+    BodyState *state = init_body_state(number_of_planets, number_of_processes);
+    float3d_to_bodies(planets, state->position);
+    for (int i = 0; i < number_of_planets; i++) {
+        state->mass[i] = 1.0;
+    }
+
+    run_leapfrog_state(state, iterations, time_step, number_of_processes, select_mass_accel_kernel());
+
+    bodies_to_float3d(state->position, planets);
+    bodies_to_float3d(state->velocity, buffer);
+    free_body_state(state);
+}
+
+double total_energy(BodyState *state, int number_of_processes) {
+    Bodies *position = state->position;
+    Bodies *velocity = state->velocity;
+    double kinetic = 0.0;
+    double potential = 0.0;
+    // the pairs get fewer with the index, the dynamic schedule balances the triangle
+#pragma omp parallel for num_threads(number_of_processes) schedule(dynamic, 16) reduction(+:kinetic, potential)
+    for (int i = 0; i < position->size; i++) {
+        kinetic += 0.5 * state->mass[i] *
+                   (velocity->x[i] * velocity->x[i] + velocity->y[i] * velocity->y[i] + velocity->z[i] * velocity->z[i]);
+        for (int j = i + 1; j < position->size; j++) {
+            double dx = position->x[j] - position->x[i];
+            double dy = position->y[j] - position->y[i];
+            double dz = position->z[j] - position->z[i];
+            // potential of the softened force dx / (|dx|^2 + EPS)^(3/2)
+            potential -= G * state->mass[i] * state->mass[j] / sqrt(dx * dx + dy * dy + dz * dz + EPS);
+        }
+    }
+    return kinetic + potential;
+}
+
+double leapfrog_energy_drift(Args *args) {
+    BodyState *state = init_body_state(args->size, args->number_of_processes);
+    for (int i = 0; i < args->size; i++) {
+        Float3D p;
+        fill_planet(&p, i);
+        state->position->x[i] = p.x;
+        state->position->y[i] = p.y;
+        state->position->z[i] = p.z;
+        state->mass[i] = 1.0;
+    }
+    double before = total_energy(state, args->number_of_processes);
+    run_leapfrog_state(state, args->iterations, args->time_step, args->number_of_processes,
+                       select_mass_accel_kernel());
+    double after = total_energy(state, args->number_of_processes);
+    free_body_state(state);
+    return before != 0.0 ? fabs(after - before) / fabs(before) : fabs(after);
+}
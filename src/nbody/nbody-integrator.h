@@ -0,0 +1,130 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_NBODY_INTEGRATOR_H
+#define HG_C_BENCHMARKS_NBODY_INTEGRATOR_H
+
+#include "nbody-util.h"
+#include "nbody-run.h"
+
+// doubles per body a step of the swap loop moves: positions are read, accelerations written
+#define SWAP_LOOP_DOUBLES_PER_BODY (6)
+// doubles per body a fused kick-drift-kick step moves: position and mass are read, the velocity is read and
+// written and the next position is written
+#define LEAPFROG_DOUBLES_PER_BODY (13)
+// doubles per body of kick-drift-kick in three sweeps: half kick and drift read velocity, acceleration and position
+// and write velocity and position, the force sweep reads position and mass and writes the acceleration,
+// the second half kick reads velocity and acceleration and writes the velocity
+#define KICK_DRIFT_KICK_SWEEPS_DOUBLES_PER_BODY (31)
+
+/**
+ * State of the bodies of a physical simulation, all arrays are aligned and padded like Bodies
+ */
+struct BodyState {
+    Bodies *position;
+    Bodies *velocity;
+    // positions of the next step, written while the other threads still read position
+    Bodies *next;
+    // mass of every body, the padding has a mass of zero and does not attract anything
+    double *mass;
+};
+
+/**
+ * Typedef for easier access
+ */
+typedef struct BodyState BodyState;
+
+/**
+ * Computes the unscaled, mass weighted acceleration of one body caused by all bodies of the state.
+ * The result is stored in the three accumulators for x, y and z.
+ */
+typedef void (*MassAccelKernel)(BodyState *state, int index, double *acc);
+
+/**
+ * Allocate the state of the given number of bodies, all values and masses are zero
+ *
+ * @param size Number of bodies
+ * @param number_of_processes Number of threads that touch the state, see init_bodies_first_touch(...)
+ * @return State, must be freed with free_body_state(...)
+ */
+BodyState *init_body_state(int size, int number_of_processes);
+
+/**
+ * @param state State to free, may be NULL
+ */
+void free_body_state(BodyState *state);
+
+/**
+ * Scalar mass weighted acceleration, see MassAccelKernel
+ *
+ * @param state State of the bodies
+ * @param index Index of the body which acceleration is being computed
+ * @param acc Three accumulators for x, y and z
+ */
+void mass_accel_scalar(BodyState *state, int index, double *acc);
+
+/**
+ * AVX2 version of mass_accel_scalar(...), the padding is summed up as well since it has no mass.
+ * Must only be called if simd_supports_avx2() holds.
+ */
+void mass_accel_avx2(BodyState *state, int index, double *acc);
+
+/**
+ * AVX-512 version of mass_accel_scalar(...), the padding is summed up as well since it has no mass.
+ * Must only be called if simd_supports_avx512() holds.
+ */
+void mass_accel_avx512(BodyState *state, int index, double *acc);
+
+/**
+ * Select the widest mass weighted kernel the executing CPU supports
+ * @return Mass weighted acceleration kernel
+ */
+MassAccelKernel select_mass_accel_kernel(void);
+
+/**
+ * Advance the state by the given number of leapfrog (kick-drift-kick) steps.
+ * The second half kick of a step and the first half kick of the next step are merged into one kick,
+ * so every step is a single pass that computes the acceleration of a body, kicks its velocity and drifts its
+ * position. The velocities are synchronized with the positions by a final half kick.
+ *
+ * @param state State of the bodies, holds the positions and velocities after the last step
+ * @param iterations Number of steps
+ * @param time_step Length of a step
+ * @param number_of_processes that shall be used to run
+ * @param kernel Kernel to compute the acceleration of a single body
+ */
+void run_leapfrog_state(BodyState *state, int iterations, double time_step, int number_of_processes,
+                        MassAccelKernel kernel);
+
+/**
+ * Runs the leapfrog integrator on bodies of unit mass that start at rest.
+ *
+ * @param planets Initial positions, holds the positions after the last step
+ * @param buffer Holds the velocities after the last step
+ * @param number_of_planets number of planets that are being simulated
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param time_step Length of a step
+ */
+void run_leapfrog(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes,
+                  double time_step);
+
+/**
+ * Total energy of the state, the kinetic energy and the potential of the softened gravity the kernels integrate
+ *
+ * @param state State of the bodies, the velocities must be synchronized with the positions
+ * @param number_of_processes that shall be used to compute the energy
+ * @return Total energy
+ */
+double total_energy(BodyState *state, int number_of_processes);
+
+/**
+ * Run the leapfrog integrator from the fill_planet(...) initial conditions and compare the energy before and after
+ *
+ * @param args Arguments that provide the number of planets, iterations, processes and the time step
+ * @return |E_after - E_before| / |E_before|
+ */
+double leapfrog_energy_drift(Args *args);
+
+#endif //HG_C_BENCHMARKS_NBODY_INTEGRATOR_H
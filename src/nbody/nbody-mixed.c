@@ -0,0 +1,265 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "nbody-mixed.h"
+#include "nbody-simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MIXED_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Allocate an aligned coordinate array of the given capacity, its pages are not touched yet
+ */
+static float *alloc_float_coordinates(int capacity) {
+    float *coordinates = (float *) aligned_alloc(BODY_ALIGNMENT, sizeof(float) * capacity);
+    if (coordinates == NULL) {
+        bail_out("bodies could not be allocated");
+    }
+    return coordinates;
+}
+
+FloatBodies *init_float_bodies(int size, int number_of_processes) {
+    FloatBodies *bodies = (FloatBodies *) malloc(sizeof(FloatBodies));
+    if (bodies == NULL) {
+        bail_out("bodies could not be allocated");
+    }
+    int width = (int) FLOAT_BODY_VECTOR_WIDTH;
+    bodies->size = size;
+    bodies->capacity = size > 0 ? ((size + width - 1) / width) * width : width;
+    bodies->x = alloc_float_coordinates(bodies->capacity);
+    bodies->y = alloc_float_coordinates(bodies->capacity);
+    bodies->z = alloc_float_coordinates(bodies->capacity);
+    float *x = bodies->x, *y = bodies->y, *z = bodies->z;
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+    for (int i = 0; i < bodies->capacity; i++) {
+        x[i] = 0.0f;
+        y[i] = 0.0f;
+        z[i] = 0.0f;
+    }
+    return bodies;
+}
+
+void free_float_bodies(FloatBodies *bodies) {
+    if (bodies != NULL) {
+        free(bodies->x);
+        free(bodies->y);
+        free(bodies->z);
+        free(bodies);
+    }
+}
+
+void bodies_to_float_bodies(Bodies *from, FloatBodies *to) {
+    for (int i = 0; i < from->size; i++) {
+        to->x[i] = (float) from->x[i];
+        to->y[i] = (float) from->y[i];
+        to->z[i] = (float) from->z[i];
+    }
+}
+
+void mixed_accel_scalar(FloatBodies *bodies, int index, double *acc) {
+    float px = bodies->x[index];
+    float py = bodies->y[index];
+    float pz = bodies->z[index];
+    double ax = 0.0;
+    double ay = 0.0;
+    double az = 0.0;
+    for (int i = 0; i < bodies->size; i++) {
+        float dx = bodies->x[i] - px;
+        float dy = bodies->y[i] - py;
+        float dz = bodies->z[i] - pz;
+        float distance_sq = dx * dx + dy * dy + dz * dz + (float) EPS;
+        // the cube of the reciprocal distance, distance_sq cubed would overflow a float for distant bodies
+        float inverse = 1.0f / sqrtf(distance_sq);
+        float factor = inverse * inverse * inverse;
+        ax += dx * factor;
+        ay += dy * factor;
+        az += dz * factor;
+    }
+    acc[0] = ax;
+    acc[1] = ay;
+    acc[2] = az;
+}
+
+#ifdef MIXED_X86
+
+// loading eight values starting at tail_mask + 8 - n enables exactly the first n lanes
+static const int mixed_tail_mask[16] = {-1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0};
+
+__attribute__((target("avx2,fma")))
+void mixed_accel_avx2(FloatBodies *bodies, int index, double *acc) {
+    __m256 px = _mm256_set1_ps(bodies->x[index]);
+    __m256 py = _mm256_set1_ps(bodies->y[index]);
+    __m256 pz = _mm256_set1_ps(bodies->z[index]);
+    __m256 eps = _mm256_set1_ps((float) EPS);
+    __m256 three_halves = _mm256_set1_ps(1.5f);
+    __m256 half = _mm256_set1_ps(0.5f);
+    __m256d ax = _mm256_setzero_pd();
+    __m256d ay = _mm256_setzero_pd();
+    __m256d az = _mm256_setzero_pd();
+    int size = bodies->size;
+    for (int i = 0; i < size; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_load_ps(bodies->x + i), px);
+        __m256 dy = _mm256_sub_ps(_mm256_load_ps(bodies->y + i), py);
+        __m256 dz = _mm256_sub_ps(_mm256_load_ps(bodies->z + i), pz);
+        __m256 distance_sq = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_fmadd_ps(dx, dx, eps)));
+        // one Newton-Raphson step y * (1.5 - 0.5 * d * y * y) refines the 12 bit estimate
+        __m256 inverse = _mm256_rsqrt_ps(distance_sq);
+        __m256 correction = _mm256_fnmadd_ps(_mm256_mul_ps(half, distance_sq), _mm256_mul_ps(inverse, inverse),
+                                             three_halves);
+        inverse = _mm256_mul_ps(inverse, correction);
+        __m256 factor = _mm256_mul_ps(_mm256_mul_ps(inverse, inverse), inverse);
+        if (size - i < 8) {
+            // bodies behind the end, the padding, must not contribute
+            __m256i mask = _mm256_loadu_si256((const __m256i *) (mixed_tail_mask + 8 - (size - i)));
+            factor = _mm256_and_ps(factor, _mm256_castsi256_ps(mask));
+        }
+        __m256 fx = _mm256_mul_ps(dx, factor);
+        __m256 fy = _mm256_mul_ps(dy, factor);
+        __m256 fz = _mm256_mul_ps(dz, factor);
+        // the interactions are summed up in double precision
+        ax = _mm256_add_pd(ax, _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(fx)),
+                                             _mm256_cvtps_pd(_mm256_extractf128_ps(fx, 1))));
+        ay = _mm256_add_pd(ay, _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(fy)),
+                                             _mm256_cvtps_pd(_mm256_extractf128_ps(fy, 1))));
+        az = _mm256_add_pd(az, _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(fz)),
+                                             _mm256_cvtps_pd(_mm256_extractf128_ps(fz, 1))));
+    }
+    double sum[3][4];
+    _mm256_storeu_pd(sum[0], ax);
+    _mm256_storeu_pd(sum[1], ay);
+    _mm256_storeu_pd(sum[2], az);
+    acc[0] = (sum[0][0] + sum[0][1]) + (sum[0][2] + sum[0][3]);
+    acc[1] = (sum[1][0] + sum[1][1]) + (sum[1][2] + sum[1][3]);
+    acc[2] = (sum[2][0] + sum[2][1]) + (sum[2][2] + sum[2][3]);
+}
+
+__attribute__((target("avx512f")))
+void mixed_accel_avx512(FloatBodies *bodies, int index, double *acc) {
+    __m512 px = _mm512_set1_ps(bodies->x[index]);
+    __m512 py = _mm512_set1_ps(bodies->y[index]);
+    __m512 pz = _mm512_set1_ps(bodies->z[index]);
+    __m512 eps = _mm512_set1_ps((float) EPS);
+    __m512 three_halves = _mm512_set1_ps(1.5f);
+    __m512 half = _mm512_set1_ps(0.5f);
+    __m512d ax = _mm512_setzero_pd();
+    __m512d ay = _mm512_setzero_pd();
+    __m512d az = _mm512_setzero_pd();
+    int size = bodies->size;
+    for (int i = 0; i < size; i += 16) {
+        __m512 dx = _mm512_sub_ps(_mm512_load_ps(bodies->x + i), px);
+        __m512 dy = _mm512_sub_ps(_mm512_load_ps(bodies->y + i), py);
+        __m512 dz = _mm512_sub_ps(_mm512_load_ps(bodies->z + i), pz);
+        __m512 distance_sq = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_fmadd_ps(dx, dx, eps)));
+        // one Newton-Raphson step y * (1.5 - 0.5 * d * y * y) refines the 14 bit estimate
+        __m512 inverse = _mm512_rsqrt14_ps(distance_sq);
+        __m512 correction = _mm512_fnmadd_ps(_mm512_mul_ps(half, distance_sq), _mm512_mul_ps(inverse, inverse),
+                                             three_halves);
+        inverse = _mm512_mul_ps(inverse, correction);
+        __m512 factor = _mm512_mul_ps(_mm512_mul_ps(inverse, inverse), inverse);
+        if (size - i < 16) {
+            // bodies behind the end, the padding, must not contribute
+            __mmask16 mask = (__mmask16) ((1u << (size - i)) - 1u);
+            factor = _mm512_maskz_mov_ps(mask, factor);
+        }
+        __m512 fx = _mm512_mul_ps(dx, factor);
+        __m512 fy = _mm512_mul_ps(dy, factor);
+        __m512 fz = _mm512_mul_ps(dz, factor);
+        // the interactions are summed up in double precision
+        ax = _mm512_add_pd(ax, _mm512_add_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(fx)),
+                                             _mm512_cvtps_pd(_mm256_castpd_ps(
+                                                     _mm512_extractf64x4_pd(_mm512_castps_pd(fx), 1)))));
+        ay = _mm512_add_pd(ay, _mm512_add_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(fy)),
+                                             _mm512_cvtps_pd(_mm256_castpd_ps(
+                                                     _mm512_extractf64x4_pd(_mm512_castps_pd(fy), 1)))));
+        az = _mm512_add_pd(az, _mm512_add_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(fz)),
+                                             _mm512_cvtps_pd(_mm256_castpd_ps(
+                                                     _mm512_extractf64x4_pd(_mm512_castps_pd(fz), 1)))));
+    }
+    acc[0] = _mm512_reduce_add_pd(ax);
+    acc[1] = _mm512_reduce_add_pd(ay);
+    acc[2] = _mm512_reduce_add_pd(az);
+}
+
+#else
+
+void mixed_accel_avx2(FloatBodies *bodies, int index, double *acc) {
+    mixed_accel_scalar(bodies, index, acc);
+}
+
+void mixed_accel_avx512(FloatBodies *bodies, int index, double *acc) {
+    mixed_accel_scalar(bodies, index, acc);
+}
+
+#endif
+
+MixedAccelKernel select_mixed_accel_kernel(void) {
+    if (simd_supports_avx512()) {
+        return mixed_accel_avx512;
+    }
+    if (simd_supports_avx2()) {
+        return mixed_accel_avx2;
+    }
+    return mixed_accel_scalar;
+}
+
+void run_mixed_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes, MixedAccelKernel kernel) {
+    int size = planets->size;
+    FloatBodies *positions = init_float_bodies(size, number_of_processes);
+    // the positions of the next step, the other threads still read the current ones
+    FloatBodies *next = init_float_bodies(size, number_of_processes);
+    bodies_to_float_bodies(planets, positions);
+    for (int i = 0; i < iterations; i++) {
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+        for (int val = 0; val < size; val++) {
+            double acc[3];
+            kernel(positions, val, acc);
+            buffer->x[val] = G * acc[0];
+            buffer->y[val] = G * acc[1];
+            buffer->z[val] = G * acc[2];
+            next->x[val] = (float) buffer->x[val];
+            next->y[val] = (float) buffer->y[val];
+            next->z[val] = (float) buffer->z[val];
+        }
+
+        swap_ptr(&planets, &buffer, Bodies *);
+        swap_ptr(&positions, &next, FloatBodies *);
+    }
+    free_float_bodies(positions);
+    free_float_bodies(next);
+}
+
+void run_mixed(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes) {
+    Bodies *soa_planets = init_bodies_first_touch(number_of_planets, number_of_processes);
+    Bodies *soa_buffer = init_bodies_first_touch(number_of_planets, number_of_processes);
+    float3d_to_bodies(planets, soa_planets);
+
+    run_mixed_soa(soa_planets, soa_buffer, iterations, number_of_processes, select_mixed_accel_kernel());
+
+    store_simulation(soa_planets, soa_buffer, planets, buffer, iterations);
+    free_bodies(soa_planets);
+    free_bodies(soa_buffer);
+}
+
+double mixed_precision_error(Args *args) {
+    int size = args->size;
+    Float3D *expected = (Float3D *) malloc(sizeof(Float3D) * size);
+    Float3D *expected_buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+    Float3D *actual = (Float3D *) malloc(sizeof(Float3D) * size);
+    Float3D *actual_buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+    if (expected == NULL || expected_buffer == NULL || actual == NULL || actual_buffer == NULL) {
+        bail_out("reference could not be allocated");
+    }
+    fill_planets(expected, size, args->number_of_processes);
+    fill_planets(actual, size, args->number_of_processes);
+    run(expected, expected_buffer, size, args->iterations, args->number_of_processes);
+    run_mixed(actual, actual_buffer, size, args->iterations, args->number_of_processes);
+    double error = max_relative_error(expected, actual, size);
+    free(expected);
+    free(expected_buffer);
+    free(actual);
+    free(actual_buffer);
+    return error;
+}
@@ -0,0 +1,122 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_NBODY_MIXED_H
+#define HG_C_BENCHMARKS_NBODY_MIXED_H
+
+#include "nbody-util.h"
+#include "nbody-run.h"
+
+// number of floats the coordinate arrays are padded to, matches the width of an AVX-512 register
+#define FLOAT_BODY_VECTOR_WIDTH (BODY_ALIGNMENT / sizeof(float))
+
+/**
+ * Structure of arrays of single precision positions, aligned and padded with zeros like Bodies
+ */
+struct FloatBodies {
+    int size;
+    int capacity;
+    float *x;
+    float *y;
+    float *z;
+};
+
+/**
+ * Typedef for easier access
+ */
+typedef struct FloatBodies FloatBodies;
+
+/**
+ * Computes the unscaled acceleration of one body caused by all bodies in single precision.
+ * The interactions are summed up in double precision and stored in the three accumulators for x, y and z.
+ */
+typedef void (*MixedAccelKernel)(FloatBodies *bodies, int index, double *acc);
+
+/**
+ * Allocate the single precision positions of the given number of bodies, all coordinates are zero
+ *
+ * @param size Number of bodies
+ * @param number_of_processes Number of threads that touch the positions, see init_bodies_first_touch(...)
+ * @return Positions, must be freed with free_float_bodies(...)
+ */
+FloatBodies *init_float_bodies(int size, int number_of_processes);
+
+/**
+ * @param bodies Positions to free, may be NULL
+ */
+void free_float_bodies(FloatBodies *bodies);
+
+/**
+ * Round the positions of the bodies to single precision
+ *
+ * @param from Bodies in double precision
+ * @param to Positions of the same size
+ */
+void bodies_to_float_bodies(Bodies *from, FloatBodies *to);
+
+/**
+ * Scalar mixed precision kernel, see MixedAccelKernel.
+ * Every interaction uses 1.0f / sqrtf(...), the reference for the vectorized kernels.
+ *
+ * @param bodies Positions of the bodies
+ * @param index Index of the body which acceleration is being computed
+ * @param acc Three accumulators for x, y and z
+ */
+void mixed_accel_scalar(FloatBodies *bodies, int index, double *acc);
+
+/**
+ * AVX2 version of mixed_accel_scalar(...), computes eight interactions at once with the rsqrt estimate
+ * and one Newton-Raphson step, accurate to about 22 bits.
+ * Must only be called if simd_supports_avx2() holds.
+ */
+void mixed_accel_avx2(FloatBodies *bodies, int index, double *acc);
+
+/**
+ * AVX-512 version of mixed_accel_scalar(...), computes sixteen interactions at once with the rsqrt14 estimate
+ * and one Newton-Raphson step, accurate to the last bit of a float.
+ * Must only be called if simd_supports_avx512() holds.
+ */
+void mixed_accel_avx512(FloatBodies *bodies, int index, double *acc);
+
+/**
+ * Select the widest mixed precision kernel the executing CPU supports
+ * @return Mixed precision acceleration kernel
+ */
+MixedAccelKernel select_mixed_accel_kernel(void);
+
+/**
+ * Runs the simulation like run_soa(...), but the interactions are computed on single precision positions.
+ * The accelerations are stored in double precision and rounded to single precision for the next step
+ * in the same pass.
+ *
+ * @param planets Bodies that are being simulated
+ * @param buffer Buffer of the same size to store the results
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param kernel Kernel to compute the acceleration of a single body
+ */
+void run_mixed_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes, MixedAccelKernel kernel);
+
+/**
+ * Runs the simulation like run(...), but with the mixed precision engine
+ *
+ * @param planets planets that are being simulated
+ * @param buffer buffer to store the results
+ * @param number_of_planets number of planets that are being simulated
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ */
+void run_mixed(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes);
+
+/**
+ * Run the mixed precision engine and run(...) from the fill_planet(...) initial conditions
+ * and compare the planets both print with pretty_print(...).
+ * The simulated map is chaotic, after a few steps run(...) and run_scalar(...) drift apart just as well.
+ *
+ * @param args Arguments that provide the number of planets, iterations and processes
+ * @return Error relative to the largest coordinate, see max_relative_error(...)
+ */
+double mixed_precision_error(Args *args);
+
+#endif //HG_C_BENCHMARKS_NBODY_MIXED_H
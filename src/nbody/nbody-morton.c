@@ -0,0 +1,170 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "nbody-morton.h"
+
+// number of bits sorted per pass of the radix sort
+#define RADIX_BITS (8)
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+BoundingBox bounding_box(Bodies *bodies, int number_of_processes) {
+    double min_x = INFINITY, min_y = INFINITY, min_z = INFINITY;
+    double max_x = -INFINITY, max_y = -INFINITY, max_z = -INFINITY;
+#pragma omp parallel for num_threads(number_of_processes) \
+        reduction(min:min_x, min_y, min_z) reduction(max:max_x, max_y, max_z)
+    for (int i = 0; i < bodies->size; i++) {
+        min_x = fmin(min_x, bodies->x[i]);
+        min_y = fmin(min_y, bodies->y[i]);
+        min_z = fmin(min_z, bodies->z[i]);
+        max_x = fmax(max_x, bodies->x[i]);
+        max_y = fmax(max_y, bodies->y[i]);
+        max_z = fmax(max_z, bodies->z[i]);
+    }
+    BoundingBox box;
+    box.min_x = min_x;
+    box.min_y = min_y;
+    box.min_z = min_z;
+    box.size = fmax(max_x - min_x, fmax(max_y - min_y, max_z - min_z));
+    if (!(box.size > 0.0)) {
+        box.size = 1.0;
+    }
+    return box;
+}
+
+/**
+ * Spread the lower MORTON_BITS bits of a value, so that two zero bits follow every bit
+ */
+static inline uint64_t spread_bits(uint32_t value) {
+    uint64_t x = value & 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8) & 0x100f00f00f00f00fULL;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2) & 0x1249249249249249ULL;
+    return x;
+}
+
+uint64_t morton_encode(uint32_t x, uint32_t y, uint32_t z) {
+    return spread_bits(x) << 2 | spread_bits(y) << 1 | spread_bits(z);
+}
+
+uint64_t hilbert_encode(uint32_t x, uint32_t y, uint32_t z) {
+    uint32_t axes[3] = {x & 0x1fffff, y & 0x1fffff, z & 0x1fffff};
+    uint32_t highest = 1u << (MORTON_BITS - 1);
+    // undo the rotations and reflections of the sub cubes from the top level down
+    for (uint32_t q = highest; q > 1; q >>= 1) {
+        uint32_t p = q - 1;
+        for (int i = 0; i < 3; i++) {
+            if (axes[i] & q) {
+                axes[0] ^= p;
+            } else {
+                uint32_t t = (axes[0] ^ axes[i]) & p;
+                axes[0] ^= t;
+                axes[i] ^= t;
+            }
+        }
+    }
+    // gray encode
+    axes[1] ^= axes[0];
+    axes[2] ^= axes[1];
+    uint32_t t = 0;
+    for (uint32_t q = highest; q > 1; q >>= 1) {
+        if (axes[2] & q) {
+            t ^= q - 1;
+        }
+    }
+    return morton_encode(axes[0] ^ t, axes[1] ^ t, axes[2] ^ t);
+}
+
+/**
+ * Map a coordinate into the integer grid of the morton keys
+ */
+static inline uint32_t quantize(double value, double min, double scale) {
+    double q = (value - min) * scale;
+    if (q < 0.0) {
+        return 0;
+    }
+    if (q >= (double) ((1 << MORTON_BITS) - 1)) {
+        return (1 << MORTON_BITS) - 1;
+    }
+    return (uint32_t) q;
+}
+
+void morton_keys(Bodies *bodies, BoundingBox box, uint64_t *keys, int *values, int number_of_processes) {
+    double scale = (double) ((1 << MORTON_BITS) - 1) / box.size;
+#pragma omp parallel for num_threads(number_of_processes)
+    for (int i = 0; i < bodies->size; i++) {
+        keys[i] = morton_encode(quantize(bodies->x[i], box.min_x, scale),
+                                quantize(bodies->y[i], box.min_y, scale),
+                                quantize(bodies->z[i], box.min_z, scale));
+        values[i] = i;
+    }
+}
+
+void curve_keys(Bodies *bodies, BoundingBox box, Curve curve, uint64_t *keys, int *values, int number_of_processes) {
+    if (curve == CURVE_MORTON) {
+        morton_keys(bodies, box, keys, values, number_of_processes);
+        return;
+    }
+    double scale = (double) ((1 << MORTON_BITS) - 1) / box.size;
+#pragma omp parallel for num_threads(number_of_processes)
+    for (int i = 0; i < bodies->size; i++) {
+        keys[i] = hilbert_encode(quantize(bodies->x[i], box.min_x, scale),
+                                 quantize(bodies->y[i], box.min_y, scale),
+                                 quantize(bodies->z[i], box.min_z, scale));
+        values[i] = i;
+    }
+}
+
+void radix_sort_pairs(uint64_t *keys, int *values, uint64_t *tmp_keys, int *tmp_values, int size, int key_bits,
+                      int number_of_processes) {
+    int chunks = number_of_processes;
+    int chunk_size = (size + chunks - 1) / chunks;
+    size_t *offsets = (size_t *) malloc(sizeof(size_t) * chunks * RADIX_BUCKETS);
+    if (offsets == NULL) {
+        bail_out("radix sort buckets could not be allocated");
+    }
+    uint64_t *from_keys = keys, *to_keys = tmp_keys;
+    int *from_values = values, *to_values = tmp_values;
+
+    for (int shift = 0; shift < key_bits; shift += RADIX_BITS) {
+        // every chunk counts its digits
+#pragma omp parallel for num_threads(number_of_processes) schedule(static, 1)
+        for (int chunk = 0; chunk < chunks; chunk++) {
+            size_t *count = offsets + (size_t) chunk * RADIX_BUCKETS;
+            memset(count, 0, sizeof(size_t) * RADIX_BUCKETS);
+            int end = (chunk + 1) * chunk_size < size ? (chunk + 1) * chunk_size : size;
+            for (int i = chunk * chunk_size; i < end; i++) {
+                count[(from_keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+            }
+        }
+        // exclusive prefix sum in bucket major order keeps the sort stable
+        size_t total = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+            for (int chunk = 0; chunk < chunks; chunk++) {
+                size_t count = offsets[(size_t) chunk * RADIX_BUCKETS + bucket];
+                offsets[(size_t) chunk * RADIX_BUCKETS + bucket] = total;
+                total += count;
+            }
+        }
+        // every chunk scatters its pairs to its own part of each bucket
+#pragma omp parallel for num_threads(number_of_processes) schedule(static, 1)
+        for (int chunk = 0; chunk < chunks; chunk++) {
+            size_t *offset = offsets + (size_t) chunk * RADIX_BUCKETS;
+            int end = (chunk + 1) * chunk_size < size ? (chunk + 1) * chunk_size : size;
+            for (int i = chunk * chunk_size; i < end; i++) {
+                size_t target = offset[(from_keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+                to_keys[target] = from_keys[i];
+                to_values[target] = from_values[i];
+            }
+        }
+        swap_ptr(&from_keys, &to_keys, uint64_t *);
+        swap_ptr(&from_values, &to_values, int *);
+    }
+    if (from_keys != keys) {
+        memcpy(keys, from_keys, sizeof(uint64_t) * size);
+        memcpy(values, from_values, sizeof(int) * size);
+    }
+    free(offsets);
+}
@@ -0,0 +1,104 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_NBODY_MORTON_H
+#define HG_C_BENCHMARKS_NBODY_MORTON_H
+
+#include <stdint.h>
+#include "nbody-util.h"
+
+// bits per dimension of a morton key, three dimensions fit into 63 bits
+#define MORTON_BITS (21)
+// number of bits of a complete morton key
+#define MORTON_KEY_BITS (3 * MORTON_BITS)
+
+/**
+ * Axis aligned bounding cube of a set of bodies
+ */
+struct BoundingBox {
+    double min_x;
+    double min_y;
+    double min_z;
+    // edge length of the cube, never zero
+    double size;
+};
+
+/**
+ * Typedef for easier access
+ */
+typedef struct BoundingBox BoundingBox;
+
+/**
+ * Compute the smallest cube that contains all bodies
+ *
+ * @param bodies Bodies to enclose
+ * @param number_of_processes that shall be used to compute the bounds
+ * @return Bounding cube, the lower corner is the minimum of every coordinate
+ */
+BoundingBox bounding_box(Bodies *bodies, int number_of_processes);
+
+/**
+ * Interleave the bits of three coordinates into a morton key.
+ * Bit i of x ends up in bit 3 * i + 2 of the key, y and z follow below, so x is the most significant dimension.
+ *
+ * @param x Coordinate with at most MORTON_BITS bits
+ * @param y Coordinate with at most MORTON_BITS bits
+ * @param z Coordinate with at most MORTON_BITS bits
+ * @return morton key with MORTON_KEY_BITS bits
+ */
+uint64_t morton_encode(uint32_t x, uint32_t y, uint32_t z);
+
+/**
+ * Map three coordinates to their index on a three dimensional hilbert curve through the grid of the morton keys.
+ * Bodies with consecutive indices lie in neighbouring cells, the curve never jumps like the morton order does.
+ * The axes are transformed with the algorithm of Skilling (2004) and interleaved like morton_encode(...).
+ *
+ * @param x Coordinate with at most MORTON_BITS bits
+ * @param y Coordinate with at most MORTON_BITS bits
+ * @param z Coordinate with at most MORTON_BITS bits
+ * @return hilbert index with MORTON_KEY_BITS bits
+ */
+uint64_t hilbert_encode(uint32_t x, uint32_t y, uint32_t z);
+
+/**
+ * Compute the morton key of every body relative to a bounding box.
+ * The values are initialized to the index of the body.
+ *
+ * @param bodies Bodies to compute the key for
+ * @param box Box that contains all bodies
+ * @param keys Output array of bodies->size keys
+ * @param values Output array of bodies->size indices
+ * @param number_of_processes that shall be used to compute the keys
+ */
+void morton_keys(Bodies *bodies, BoundingBox box, uint64_t *keys, int *values, int number_of_processes);
+
+/**
+ * Compute the key of every body on the given space filling curve, like morton_keys(...)
+ *
+ * @param bodies Bodies to compute the key for
+ * @param box Box that contains all bodies
+ * @param curve Curve the keys are computed for
+ * @param keys Output array of bodies->size keys
+ * @param values Output array of bodies->size indices
+ * @param number_of_processes that shall be used to compute the keys
+ */
+void curve_keys(Bodies *bodies, BoundingBox box, Curve curve, uint64_t *keys, int *values, int number_of_processes);
+
+/**
+ * Stable parallel least significant digit radix sort of key value pairs.
+ * Eight bits are sorted per pass, the temporary arrays must have the same size as the input.
+ * The sorted pairs are always returned in keys and values.
+ *
+ * @param keys Keys to sort by
+ * @param values Values that are moved together with the keys
+ * @param tmp_keys Temporary storage for size keys
+ * @param tmp_values Temporary storage for size values
+ * @param size Number of pairs
+ * @param key_bits Number of significant bits of the keys, higher bits are ignored
+ * @param number_of_processes that shall be used to sort
+ */
+void radix_sort_pairs(uint64_t *keys, int *values, uint64_t *tmp_keys, int *tmp_values, int size, int key_bits,
+                      int number_of_processes);
+
+#endif //HG_C_BENCHMARKS_NBODY_MORTON_H
@@ -0,0 +1,103 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "nbody-reorder.h"
+
+BodyOrder *init_body_order(int size, int number_of_processes) {
+    BodyOrder *order = (BodyOrder *) malloc(sizeof(BodyOrder));
+    if (order == NULL) {
+        bail_out("body order could not be allocated");
+    }
+    order->size = size;
+    order->index = (int *) malloc(sizeof(int) * size);
+    order->keys = (uint64_t *) malloc(sizeof(uint64_t) * size);
+    order->values = (int *) malloc(sizeof(int) * size);
+    order->tmp_keys = (uint64_t *) malloc(sizeof(uint64_t) * size);
+    order->tmp_values = (int *) malloc(sizeof(int) * size);
+    if (order->index == NULL || order->keys == NULL || order->values == NULL || order->tmp_keys == NULL ||
+        order->tmp_values == NULL) {
+        bail_out("body order could not be allocated");
+    }
+    order->spare = init_bodies_first_touch(size, number_of_processes);
+    for (int i = 0; i < size; i++) {
+        order->index[i] = i;
+    }
+    return order;
+}
+
+void free_body_order(BodyOrder *order) {
+    if (order != NULL) {
+        free(order->index);
+        free(order->keys);
+        free(order->values);
+        free(order->tmp_keys);
+        free(order->tmp_values);
+        free_bodies(order->spare);
+        free(order);
+    }
+}
+
+void reorder_bodies(BodyOrder *order, Bodies **bodies, Curve curve, int number_of_processes) {
+    Bodies *from = *bodies;
+    Bodies *to = order->spare;
+    curve_keys(from, bounding_box(from, number_of_processes), curve, order->keys, order->values, number_of_processes);
+    radix_sort_pairs(order->keys, order->values, order->tmp_keys, order->tmp_values, order->size, MORTON_KEY_BITS,
+                     number_of_processes);
+    // the sort is done, its temporary values receive the composed index
+    int *index = order->tmp_values;
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+    for (int i = 0; i < order->size; i++) {
+        int source = order->values[i];
+        to->x[i] = from->x[source];
+        to->y[i] = from->y[source];
+        to->z[i] = from->z[source];
+        index[i] = order->index[source];
+    }
+    order->tmp_values = order->index;
+    order->index = index;
+    order->spare = from;
+    *bodies = to;
+}
+
+void restore_order(BodyOrder *order, Bodies *bodies, Float3D *out) {
+    for (int i = 0; i < order->size; i++) {
+        Float3D *p = &out[order->index[i]];
+        p->x = bodies->x[i];
+        p->y = bodies->y[i];
+        p->z = bodies->z[i];
+    }
+}
+
+void run_reordered(Float3D *planets, Float3D *buffer, Args *args) {
+    Bodies *current = init_bodies_first_touch(args->size, args->number_of_processes);
+    Bodies *previous = init_bodies_first_touch(args->size, args->number_of_processes);
+    float3d_to_bodies(planets, current);
+    BodyOrder *order = init_body_order(args->size, args->number_of_processes);
+
+    for (int done = 0; done < args->iterations;) {
+        reorder_bodies(order, &current, args->curve, args->number_of_processes);
+        int steps = args->iterations - done < args->reorder_interval ? args->iterations - done
+                                                                       : args->reorder_interval;
+        simulate_soa(current, previous, steps, args);
+        // the swaps of the engine are local, after an odd number of steps the new positions are in previous
+        if (steps % 2 == 1) {
+            swap_ptr(&current, &previous, Bodies *);
+        }
+        done += steps;
+    }
+
+    // the arrays of the caller end up as if the simulation was run on them, see store_simulation(...)
+    if (args->iterations % 2 == 0) {
+        restore_order(order, current, planets);
+        if (args->iterations > 0) {
+            restore_order(order, previous, buffer);
+        }
+    } else {
+        restore_order(order, previous, planets);
+        restore_order(order, current, buffer);
+    }
+    free_body_order(order);
+    free_bodies(current);
+    free_bodies(previous);
+}
@@ -0,0 +1,80 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_NBODY_REORDER_H
+#define HG_C_BENCHMARKS_NBODY_REORDER_H
+
+#include "nbody-util.h"
+#include "nbody-run.h"
+#include "nbody-morton.h"
+
+/**
+ * Order of the bodies along a space filling curve and all buffers that are required to sort them again
+ */
+struct BodyOrder {
+    int size;
+    // index of the body at every position in the original bodies
+    int *index;
+    uint64_t *keys;
+    int *values;
+    uint64_t *tmp_keys;
+    int *tmp_values;
+    // the bodies are gathered into the spare bodies, which take their place afterwards
+    Bodies *spare;
+};
+
+/**
+ * Typedef for easier access
+ */
+typedef struct BodyOrder BodyOrder;
+
+/**
+ * Allocate the order of the given number of bodies, initially every body is at its original position
+ *
+ * @param size Number of bodies
+ * @param number_of_processes Number of threads that touch the spare bodies, see init_bodies_first_touch(...)
+ * @return Order, must be freed with free_body_order(...)
+ */
+BodyOrder *init_body_order(int size, int number_of_processes);
+
+/**
+ * Free the order and all of its buffers
+ * @param order Order to free, may be NULL
+ */
+void free_body_order(BodyOrder *order);
+
+/**
+ * Sort the bodies by their key on the space filling curve with the parallel radix sort.
+ * The bodies are gathered into the spare bodies of the order, which are swapped with the given bodies.
+ * The index of the order is updated, so it still maps every position to the original body.
+ *
+ * @param order Order of the bodies
+ * @param bodies Bodies to sort, points to the sorted bodies afterwards
+ * @param curve Curve the bodies are sorted along
+ * @param number_of_processes that shall be used to sort
+ */
+void reorder_bodies(BodyOrder *order, Bodies **bodies, Curve curve, int number_of_processes);
+
+/**
+ * Copy the bodies into the array of the original order
+ *
+ * @param order Order of the bodies
+ * @param bodies Bodies in the order
+ * @param out Array of order->size bodies in the original order
+ */
+void restore_order(BodyOrder *order, Bodies *bodies, Float3D *out);
+
+/**
+ * Runs the simulation with the engine selected by the arguments, but sorts the bodies along
+ * the space filling curve of the arguments every args->reorder_interval steps, starting with the first one.
+ * Neighbours in space end up close in memory. The arrays of the caller are stored in the original order,
+ * exactly like simulate(...) without reordering stores them.
+ *
+ * @param planets planets that are being simulated
+ * @param buffer buffer to store the results
+ * @param args Arguments, provide the engine, the curve and the interval
+ */
+void run_reordered(Float3D *planets, Float3D *buffer, Args *args);
+
+#endif //HG_C_BENCHMARKS_NBODY_REORDER_H
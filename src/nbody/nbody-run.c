@@ -1,7 +1,15 @@
 //
 // Created by baldr on 7/13/17.
 //
+#include <omp.h>
 #include "nbody-run.h"
+#include "nbody-simd.h"
+#include "nbody-tiled.h"
+#include "nbody-barnes-hut.h"
+#include "nbody-integrator.h"
+#include "nbody-mixed.h"
+#include "nbody-grid.h"
+#include "nbody-reorder.h"
 
 void pair_wise_accel(Float3D p1, Float3D p2, Float3D *out) {
     double dx = p2.x - p1.x;
@@ -26,12 +34,233 @@ void accel(Float3D *planets, Float3D *buffer, int index, int size) {
 
 void
 run(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes) {
+    Bodies *soa_planets = init_bodies_first_touch(number_of_planets, number_of_processes);
+    Bodies *soa_buffer = init_bodies_first_touch(number_of_planets, number_of_processes);
+    float3d_to_bodies(planets, soa_planets);
+
+    run_soa(soa_planets, soa_buffer, iterations, number_of_processes, select_accel_kernel());
+
+    store_simulation(soa_planets, soa_buffer, planets, buffer, iterations);
+    free_bodies(soa_planets);
+    free_bodies(soa_buffer);
+}
+
+void run_persistent(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations,
+                    int number_of_processes) {
+    Bodies *soa_planets = init_bodies_first_touch(number_of_planets, number_of_processes);
+    Bodies *soa_buffer = init_bodies_first_touch(number_of_planets, number_of_processes);
+    float3d_to_bodies(planets, soa_planets);
+
+    run_soa_persistent(soa_planets, soa_buffer, iterations, number_of_processes, select_accel_kernel());
+
+    store_simulation(soa_planets, soa_buffer, planets, buffer, iterations);
+    free_bodies(soa_planets);
+    free_bodies(soa_buffer);
+}
+
+void
+run_scalar(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes) {
     for (int i = 0; i < iterations; i++) {
-#pragma omp parallel for num_threads(number_of_processes)
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
         for (int val = 0; val < number_of_planets; val++) {
             accel(planets, buffer, val, number_of_planets);
         }
 
         swap_ptr(&planets, &buffer, Float3D *);
     }
-}
\ No newline at end of file
+}
+
+void run_symmetric_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes,
+                       SymmetricAccelKernel kernel) {
+    int size = planets->size;
+    // every thread accumulates into its own partial result, so no two threads ever write the same body
+    Bodies **partials = (Bodies **) malloc(sizeof(Bodies *) * number_of_processes);
+    if (partials == NULL) {
+        bail_out("partial accelerations could not be allocated");
+    }
+    // every partial result is allocated by the thread that accumulates into it, so it is local to its socket
+#pragma omp parallel for num_threads(number_of_processes) schedule(static, 1)
+    for (int t = 0; t < number_of_processes; t++) {
+        partials[t] = init_bodies(size);
+    }
+    for (int i = 0; i < iterations; i++) {
+#pragma omp parallel num_threads(number_of_processes)
+        {
+#pragma omp for schedule(static, 1)
+            for (int t = 0; t < number_of_processes; t++) {
+                memset(partials[t]->x, 0, sizeof(double) * size);
+                memset(partials[t]->y, 0, sizeof(double) * size);
+                memset(partials[t]->z, 0, sizeof(double) * size);
+            }
+            // the rows get shorter with the index, the dynamic schedule balances the triangle
+#pragma omp for schedule(dynamic, 16)
+            for (int val = 0; val < size; val++) {
+                kernel(planets, partials[omp_get_thread_num()], val);
+            }
+            // reduce the partial results of all threads in parallel
+#pragma omp for schedule(static)
+            for (int val = 0; val < size; val++) {
+                double ax = 0.0, ay = 0.0, az = 0.0;
+                for (int t = 0; t < number_of_processes; t++) {
+                    ax += partials[t]->x[val];
+                    ay += partials[t]->y[val];
+                    az += partials[t]->z[val];
+                }
+                buffer->x[val] = G * ax;
+                buffer->y[val] = G * ay;
+                buffer->z[val] = G * az;
+            }
+        }
+
+        swap_ptr(&planets, &buffer, Bodies *);
+    }
+    for (int t = 0; t < number_of_processes; t++) {
+        free_bodies(partials[t]);
+    }
+    free(partials);
+}
+
+void
+run_symmetric(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes) {
+    Bodies *soa_planets = init_bodies_first_touch(number_of_planets, number_of_processes);
+    Bodies *soa_buffer = init_bodies_first_touch(number_of_planets, number_of_processes);
+    float3d_to_bodies(planets, soa_planets);
+
+    run_symmetric_soa(soa_planets, soa_buffer, iterations, number_of_processes, select_symmetric_accel_kernel());
+
+    store_simulation(soa_planets, soa_buffer, planets, buffer, iterations);
+    free_bodies(soa_planets);
+    free_bodies(soa_buffer);
+}
+
+void simulate(Float3D *planets, Float3D *buffer, Args *args) {
+    if (args->reorder_interval > 0) {
+        run_reordered(planets, buffer, args);
+        return;
+    }
+    switch (args->engine) {
+        case ENGINE_SCALAR:
+            run_scalar(planets, buffer, args->size, args->iterations, args->number_of_processes);
+            break;
+        case ENGINE_TILED:
+            run_tiled(planets, buffer, args->size, args->iterations, args->number_of_processes, args->tile_size);
+            break;
+        case ENGINE_SYMMETRIC:
+            run_symmetric(planets, buffer, args->size, args->iterations, args->number_of_processes);
+            break;
+        case ENGINE_BARNES_HUT:
+            run_barnes_hut(planets, buffer, args->size, args->iterations, args->number_of_processes, args->theta);
+            break;
+        case ENGINE_LEAPFROG:
+            run_leapfrog(planets, buffer, args->size, args->iterations, args->number_of_processes, args->time_step);
+            break;
+        case ENGINE_MIXED:
+            run_mixed(planets, buffer, args->size, args->iterations, args->number_of_processes);
+            break;
+        case ENGINE_GRID:
+            run_grid(planets, buffer, args->size, args->iterations, args->number_of_processes, args->cutoff);
+            break;
+        case ENGINE_SIMD:
+        default:
+            if (args->persistent) {
+                run_persistent(planets, buffer, args->size, args->iterations, args->number_of_processes);
+            } else {
+                run(planets, buffer, args->size, args->iterations, args->number_of_processes);
+            }
+            break;
+    }
+}
+
+void simulate_soa(Bodies *planets, Bodies *buffer, int iterations, Args *args) {
+    int processes = args->number_of_processes;
+    switch (args->engine) {
+        case ENGINE_TILED:
+            run_tiled_soa(planets, buffer, iterations, processes, args->tile_size, select_partial_accel_kernel());
+            break;
+        case ENGINE_SYMMETRIC:
+            run_symmetric_soa(planets, buffer, iterations, processes, select_symmetric_accel_kernel());
+            break;
+        case ENGINE_BARNES_HUT:
+            run_barnes_hut_soa(planets, buffer, iterations, processes, args->theta);
+            break;
+        case ENGINE_MIXED:
+            run_mixed_soa(planets, buffer, iterations, processes, select_mixed_accel_kernel());
+            break;
+        case ENGINE_GRID:
+            run_grid_soa(planets, buffer, iterations, processes, args->cutoff);
+            break;
+        case ENGINE_SCALAR:
+        case ENGINE_LEAPFROG:
+            bail_out("engine has no structure of arrays simulation");
+            break;
+        case ENGINE_SIMD:
+        default:
+            if (args->persistent) {
+                run_soa_persistent(planets, buffer, iterations, processes, select_accel_kernel());
+            } else {
+                run_soa(planets, buffer, iterations, processes, select_accel_kernel());
+            }
+            break;
+    }
+}
+
+double single_step_error(Args *args) {
+    int size = args->size;
+    Float3D *expected = (Float3D *) malloc(sizeof(Float3D) * size);
+    Float3D *expected_buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+    Float3D *actual = (Float3D *) malloc(sizeof(Float3D) * size);
+    Float3D *actual_buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+    if (expected == NULL || expected_buffer == NULL || actual == NULL || actual_buffer == NULL) {
+        bail_out("reference could not be allocated");
+    }
+    for (int i = 0; i < size; i++) {
+        fill_planet(&expected[i], i);
+        fill_planet(&actual[i], i);
+    }
+    Args step = *args;
+    step.iterations = 1;
+    run(expected, expected_buffer, size, 1, args->number_of_processes);
+    simulate(actual, actual_buffer, &step);
+    // after a single step the accelerations are stored in the buffer
+    double error = max_relative_error(expected_buffer, actual_buffer, size);
+    free(expected);
+    free(expected_buffer);
+    free(actual);
+    free(actual_buffer);
+    return error;
+}
+
+int compare_persistent_region(Args *args) {
+    Float3D *planets = (Float3D *) malloc(sizeof(Float3D) * args->size);
+    Float3D *buffer = (Float3D *) malloc(sizeof(Float3D) * args->size);
+    if (planets == NULL || buffer == NULL) {
+        free_resources(planets, buffer, NULL, NULL);
+        bail_out("Resources could not be allocated");
+    }
+    printf("Bodies  fork-join  persistent  speedup\n");
+    // fewer bodies than the smallest size of the comparison, compare only the bodies that were allocated
+    int size = args->size < 3 ? args->size : 3;
+    for (;; size = size * 4 < args->size ? size * 4 : args->size) {
+        Args size_args = *args;
+        size_args.size = size;
+        time_t times[2] = {0, 0};
+        for (int mode = 0; mode < 2; ++mode) {
+            size_args.persistent = mode == 1;
+            // the best of a few runs, small sizes are dominated by noise otherwise
+            for (int n = 0; n < 3; ++n) {
+                fill_planets(planets, size, args->number_of_processes);
+                TIC(0);
+                simulate(planets, buffer, &size_args);
+                time_t seq_t = TOC(0);
+                times[mode] = n == 0 || seq_t < times[mode] ? seq_t : times[mode];
+            }
+        }
+        printf("%6d  %8zius  %9zius  %6.2fx\n", size, times[0], times[1],
+               (double) times[0] / (double) (times[1] > 0 ? times[1] : 1));
+        if (size >= args->size) {
+            break;
+        }
+    }
+    free_resources(planets, buffer, NULL, NULL);
+    return size;
+}
@@ -8,6 +8,7 @@
 
 #include "../util/util.h"
 #include "nbody-util.h"
+#include "nbody-simd.h"
 
 #define G (9.8)
 #define EPS (0.005)
@@ -36,6 +37,8 @@ void accel(Float3D *planets, Float3D *buffer, int index, int size);
 /**
  * Runs the simulation for a given number of planets for a given number of times
  * Results are stored in an output buffer
+ * The bodies are converted to a structure of arrays and the acceleration is computed
+ * by the widest vectorized kernel the CPU supports.
  *
  * @param planets planets that are being simulated
  * @param buffer buffer to store the results
@@ -45,4 +48,96 @@ void accel(Float3D *planets, Float3D *buffer, int index, int size);
  */
 void run(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes);
 
+/**
+ * Runs the simulation like run(...), but a single parallel region spans all iterations, see run_soa_persistent(...)
+ *
+ * @param planets planets that are being simulated
+ * @param buffer buffer to store the results
+ * @param number_of_planets number of planets that are being simulated
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ */
+void run_persistent(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations,
+                    int number_of_processes);
+
+/**
+ * Runs the simulation like run(...), but computes every acceleration with accel(...) on the array of bodies.
+ * This is the original implementation and serves as the reference for the other engines.
+ *
+ * @param planets planets that are being simulated
+ * @param buffer buffer to store the results
+ * @param number_of_planets number of planets that are being simulated
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ */
+void run_scalar(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes);
+
+/**
+ * Runs the simulation on the structure of arrays and evaluates every pair of bodies only once.
+ * Each thread accumulates the equal and opposite accelerations into its own partial buffer,
+ * the partial buffers are reduced in parallel at the end of every step.
+ *
+ * @param planets Bodies that are being simulated
+ * @param buffer Buffer of the same size to store the results
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param kernel Kernel to evaluate the pairs of a single body
+ */
+void run_symmetric_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes,
+                       SymmetricAccelKernel kernel);
+
+/**
+ * Runs the simulation like run(...), but evaluates every pair only once, see run_symmetric_soa(...)
+ *
+ * @param planets planets that are being simulated
+ * @param buffer buffer to store the results
+ * @param number_of_planets number of planets that are being simulated
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ */
+void
+run_symmetric(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes);
+
+/**
+ * Runs the simulation with the engine selected by the arguments.
+ * The leapfrog engine integrates physical state instead, see run_leapfrog(...)
+ *
+ * @param planets planets that are being simulated
+ * @param buffer buffer to store the results
+ * @param args Arguments, provide the engine, number of planets, iterations and processes
+ */
+void simulate(Float3D *planets, Float3D *buffer, Args *args);
+
+/**
+ * Runs the simulation on the structure of arrays with the engine selected by the arguments.
+ * The swaps of planets and buffer are local like the ones of run_soa(...).
+ * The scalar and the leapfrog engine have no such simulation.
+ *
+ * @param planets Bodies that are being simulated
+ * @param buffer Buffer of the same size to store the results
+ * @param iterations number of iterations the simulation should be run
+ * @param args Arguments, provide the engine, its parameters and the number of processes
+ */
+void simulate_soa(Bodies *planets, Bodies *buffer, int iterations, Args *args);
+
+/**
+ * Compare a single step of the engine selected by the arguments with a single step of run(...),
+ * both starting from the fill_planet(...) initial conditions.
+ * Only a single step is compared, since the simulation amplifies every difference,
+ * even the rounding differences between the scalar and the vectorized engine, after a few steps.
+ *
+ * @param args Arguments to run the engine with, the number of iterations is ignored
+ * @return Error relative to the largest coordinate, see max_relative_error(...)
+ */
+double single_step_error(Args *args);
+
+/**
+ * Compare the persistent parallel region with a parallel region per step for growing numbers of bodies,
+ * up to the number of bodies of the arguments, and print the best of three runs of each
+ *
+ * @param args Arguments that provide the number of bodies, iterations and processes
+ * @return Largest number of bodies that were compared, never more than args->size
+ */
+int compare_persistent_region(Args *args);
+
 #endif //HG_C_BENCHMARKS_NBODY_RUN_H
@@ -0,0 +1,360 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <omp.h>
+#include "nbody-run.h"
+#include "nbody-simd.h"
+#include "../util/barrier.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define NBODY_X86 1
+#include <immintrin.h>
+#endif
+
+void partial_accel_scalar(Bodies *bodies, int index, int begin, int end, double *acc) {
+    double px = bodies->x[index];
+    double py = bodies->y[index];
+    double pz = bodies->z[index];
+    double ax = 0.0;
+    double ay = 0.0;
+    double az = 0.0;
+    for (int i = begin; i < end; i++) {
+        double dx = bodies->x[i] - px;
+        double dy = bodies->y[i] - py;
+        double dz = bodies->z[i] - pz;
+        double distance_sq = dx * dx + dy * dy + dz * dz + EPS;
+        double factor = 1.0 / sqrt(distance_sq * distance_sq * distance_sq);
+        ax += dx * factor;
+        ay += dy * factor;
+        az += dz * factor;
+    }
+    acc[0] += ax;
+    acc[1] += ay;
+    acc[2] += az;
+}
+
+void symmetric_accel_scalar(Bodies *bodies, Bodies *partial, int index) {
+    double px = bodies->x[index];
+    double py = bodies->y[index];
+    double pz = bodies->z[index];
+    double ax = 0.0;
+    double ay = 0.0;
+    double az = 0.0;
+    for (int i = index + 1; i < bodies->size; i++) {
+        double dx = bodies->x[i] - px;
+        double dy = bodies->y[i] - py;
+        double dz = bodies->z[i] - pz;
+        double distance_sq = dx * dx + dy * dy + dz * dz + EPS;
+        double factor = 1.0 / sqrt(distance_sq * distance_sq * distance_sq);
+        ax += dx * factor;
+        ay += dy * factor;
+        az += dz * factor;
+        partial->x[i] -= dx * factor;
+        partial->y[i] -= dy * factor;
+        partial->z[i] -= dz * factor;
+    }
+    partial->x[index] += ax;
+    partial->y[index] += ay;
+    partial->z[index] += az;
+}
+
+#ifdef NBODY_X86
+
+// loading four values starting at tail_mask + 4 - n enables exactly the first n lanes
+static const long long tail_mask[8] = {-1, -1, -1, -1, 0, 0, 0, 0};
+
+__attribute__((target("avx2")))
+void partial_accel_avx2(Bodies *bodies, int index, int begin, int end, double *acc) {
+    __m256d px = _mm256_set1_pd(bodies->x[index]);
+    __m256d py = _mm256_set1_pd(bodies->y[index]);
+    __m256d pz = _mm256_set1_pd(bodies->z[index]);
+    __m256d eps = _mm256_set1_pd(EPS);
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d ax = _mm256_setzero_pd();
+    __m256d ay = _mm256_setzero_pd();
+    __m256d az = _mm256_setzero_pd();
+    for (int i = begin; i < end; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_load_pd(bodies->x + i), px);
+        __m256d dy = _mm256_sub_pd(_mm256_load_pd(bodies->y + i), py);
+        __m256d dz = _mm256_sub_pd(_mm256_load_pd(bodies->z + i), pz);
+        __m256d distance_sq = _mm256_add_pd(
+                _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz)),
+                eps);
+        __m256d cube = _mm256_mul_pd(_mm256_mul_pd(distance_sq, distance_sq), distance_sq);
+        __m256d factor = _mm256_div_pd(one, _mm256_sqrt_pd(cube));
+        if (end - i < 4) {
+            // bodies behind the end of the range, e.g. the padding, must not contribute
+            __m256i mask = _mm256_loadu_si256((const __m256i *) (tail_mask + 4 - (end - i)));
+            factor = _mm256_and_pd(factor, _mm256_castsi256_pd(mask));
+        }
+        ax = _mm256_add_pd(ax, _mm256_mul_pd(dx, factor));
+        ay = _mm256_add_pd(ay, _mm256_mul_pd(dy, factor));
+        az = _mm256_add_pd(az, _mm256_mul_pd(dz, factor));
+    }
+    double sum[3][4];
+    _mm256_storeu_pd(sum[0], ax);
+    _mm256_storeu_pd(sum[1], ay);
+    _mm256_storeu_pd(sum[2], az);
+    acc[0] += (sum[0][0] + sum[0][1]) + (sum[0][2] + sum[0][3]);
+    acc[1] += (sum[1][0] + sum[1][1]) + (sum[1][2] + sum[1][3]);
+    acc[2] += (sum[2][0] + sum[2][1]) + (sum[2][2] + sum[2][3]);
+}
+
+__attribute__((target("avx512f")))
+void partial_accel_avx512(Bodies *bodies, int index, int begin, int end, double *acc) {
+    __m512d px = _mm512_set1_pd(bodies->x[index]);
+    __m512d py = _mm512_set1_pd(bodies->y[index]);
+    __m512d pz = _mm512_set1_pd(bodies->z[index]);
+    __m512d eps = _mm512_set1_pd(EPS);
+    __m512d one = _mm512_set1_pd(1.0);
+    __m512d ax = _mm512_setzero_pd();
+    __m512d ay = _mm512_setzero_pd();
+    __m512d az = _mm512_setzero_pd();
+    for (int i = begin; i < end; i += 8) {
+        __m512d dx = _mm512_sub_pd(_mm512_load_pd(bodies->x + i), px);
+        __m512d dy = _mm512_sub_pd(_mm512_load_pd(bodies->y + i), py);
+        __m512d dz = _mm512_sub_pd(_mm512_load_pd(bodies->z + i), pz);
+        __m512d distance_sq = _mm512_add_pd(
+                _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)), _mm512_mul_pd(dz, dz)),
+                eps);
+        __m512d cube = _mm512_mul_pd(_mm512_mul_pd(distance_sq, distance_sq), distance_sq);
+        __m512d factor = _mm512_div_pd(one, _mm512_sqrt_pd(cube));
+        if (end - i < 8) {
+            // bodies behind the end of the range, e.g. the padding, must not contribute
+            __mmask8 mask = (__mmask8) ((1u << (end - i)) - 1u);
+            factor = _mm512_maskz_mov_pd(mask, factor);
+        }
+        ax = _mm512_add_pd(ax, _mm512_mul_pd(dx, factor));
+        ay = _mm512_add_pd(ay, _mm512_mul_pd(dy, factor));
+        az = _mm512_add_pd(az, _mm512_mul_pd(dz, factor));
+    }
+    acc[0] += _mm512_reduce_add_pd(ax);
+    acc[1] += _mm512_reduce_add_pd(ay);
+    acc[2] += _mm512_reduce_add_pd(az);
+}
+
+__attribute__((target("avx2")))
+void symmetric_accel_avx2(Bodies *bodies, Bodies *partial, int index) {
+    __m256d px = _mm256_set1_pd(bodies->x[index]);
+    __m256d py = _mm256_set1_pd(bodies->y[index]);
+    __m256d pz = _mm256_set1_pd(bodies->z[index]);
+    __m256d eps = _mm256_set1_pd(EPS);
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d ax = _mm256_setzero_pd();
+    __m256d ay = _mm256_setzero_pd();
+    __m256d az = _mm256_setzero_pd();
+    int size = bodies->size;
+    // the range starts behind the body, so the loads are unaligned and the tail is masked
+    for (int i = index + 1; i < size; i += 4) {
+        int remaining = size - i < 4 ? size - i : 4;
+        __m256i mask = _mm256_loadu_si256((const __m256i *) (tail_mask + 4 - remaining));
+        __m256d dx = _mm256_sub_pd(_mm256_maskload_pd(bodies->x + i, mask), px);
+        __m256d dy = _mm256_sub_pd(_mm256_maskload_pd(bodies->y + i, mask), py);
+        __m256d dz = _mm256_sub_pd(_mm256_maskload_pd(bodies->z + i, mask), pz);
+        __m256d distance_sq = _mm256_add_pd(
+                _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz)),
+                eps);
+        __m256d cube = _mm256_mul_pd(_mm256_mul_pd(distance_sq, distance_sq), distance_sq);
+        __m256d factor = _mm256_and_pd(_mm256_div_pd(one, _mm256_sqrt_pd(cube)), _mm256_castsi256_pd(mask));
+        __m256d fx = _mm256_mul_pd(dx, factor);
+        __m256d fy = _mm256_mul_pd(dy, factor);
+        __m256d fz = _mm256_mul_pd(dz, factor);
+        ax = _mm256_add_pd(ax, fx);
+        ay = _mm256_add_pd(ay, fy);
+        az = _mm256_add_pd(az, fz);
+        _mm256_maskstore_pd(partial->x + i, mask, _mm256_sub_pd(_mm256_maskload_pd(partial->x + i, mask), fx));
+        _mm256_maskstore_pd(partial->y + i, mask, _mm256_sub_pd(_mm256_maskload_pd(partial->y + i, mask), fy));
+        _mm256_maskstore_pd(partial->z + i, mask, _mm256_sub_pd(_mm256_maskload_pd(partial->z + i, mask), fz));
+    }
+    double sum[3][4];
+    _mm256_storeu_pd(sum[0], ax);
+    _mm256_storeu_pd(sum[1], ay);
+    _mm256_storeu_pd(sum[2], az);
+    partial->x[index] += (sum[0][0] + sum[0][1]) + (sum[0][2] + sum[0][3]);
+    partial->y[index] += (sum[1][0] + sum[1][1]) + (sum[1][2] + sum[1][3]);
+    partial->z[index] += (sum[2][0] + sum[2][1]) + (sum[2][2] + sum[2][3]);
+}
+
+__attribute__((target("avx512f")))
+void symmetric_accel_avx512(Bodies *bodies, Bodies *partial, int index) {
+    __m512d px = _mm512_set1_pd(bodies->x[index]);
+    __m512d py = _mm512_set1_pd(bodies->y[index]);
+    __m512d pz = _mm512_set1_pd(bodies->z[index]);
+    __m512d eps = _mm512_set1_pd(EPS);
+    __m512d one = _mm512_set1_pd(1.0);
+    __m512d ax = _mm512_setzero_pd();
+    __m512d ay = _mm512_setzero_pd();
+    __m512d az = _mm512_setzero_pd();
+    int size = bodies->size;
+    // the range starts behind the body, so the loads are unaligned and the tail is masked
+    for (int i = index + 1; i < size; i += 8) {
+        __mmask8 mask = size - i < 8 ? (__mmask8) ((1u << (size - i)) - 1u) : (__mmask8) 0xff;
+        __m512d dx = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, bodies->x + i), px);
+        __m512d dy = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, bodies->y + i), py);
+        __m512d dz = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, bodies->z + i), pz);
+        __m512d distance_sq = _mm512_add_pd(
+                _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)), _mm512_mul_pd(dz, dz)),
+                eps);
+        __m512d cube = _mm512_mul_pd(_mm512_mul_pd(distance_sq, distance_sq), distance_sq);
+        __m512d factor = _mm512_maskz_div_pd(mask, one, _mm512_sqrt_pd(cube));
+        __m512d fx = _mm512_mul_pd(dx, factor);
+        __m512d fy = _mm512_mul_pd(dy, factor);
+        __m512d fz = _mm512_mul_pd(dz, factor);
+        ax = _mm512_add_pd(ax, fx);
+        ay = _mm512_add_pd(ay, fy);
+        az = _mm512_add_pd(az, fz);
+        _mm512_mask_storeu_pd(partial->x + i, mask, _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, partial->x + i), fx));
+        _mm512_mask_storeu_pd(partial->y + i, mask, _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, partial->y + i), fy));
+        _mm512_mask_storeu_pd(partial->z + i, mask, _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, partial->z + i), fz));
+    }
+    partial->x[index] += _mm512_reduce_add_pd(ax);
+    partial->y[index] += _mm512_reduce_add_pd(ay);
+    partial->z[index] += _mm512_reduce_add_pd(az);
+}
+
+bool simd_supports_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+bool simd_supports_avx512(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+}
+
+#else
+
+void symmetric_accel_avx2(Bodies *bodies, Bodies *partial, int index) {
+    symmetric_accel_scalar(bodies, partial, index);
+}
+
+void symmetric_accel_avx512(Bodies *bodies, Bodies *partial, int index) {
+    symmetric_accel_scalar(bodies, partial, index);
+}
+
+void partial_accel_avx2(Bodies *bodies, int index, int begin, int end, double *acc) {
+    partial_accel_scalar(bodies, index, begin, end, acc);
+}
+
+void partial_accel_avx512(Bodies *bodies, int index, int begin, int end, double *acc) {
+    partial_accel_scalar(bodies, index, begin, end, acc);
+}
+
+bool simd_supports_avx2(void) {
+    return false;
+}
+
+bool simd_supports_avx512(void) {
+    return false;
+}
+
+#endif
+
+/**
+ * Sum the acceleration caused by all bodies and store it scaled by G
+ */
+static inline void accel_with(PartialAccelKernel partial, Bodies *bodies, Bodies *buffer, int index) {
+    double acc[3] = {0.0, 0.0, 0.0};
+    partial(bodies, index, 0, bodies->size, acc);
+    buffer->x[index] = G * acc[0];
+    buffer->y[index] = G * acc[1];
+    buffer->z[index] = G * acc[2];
+}
+
+void accel_soa_scalar(Bodies *bodies, Bodies *buffer, int index) {
+    accel_with(partial_accel_scalar, bodies, buffer, index);
+}
+
+void accel_soa_avx2(Bodies *bodies, Bodies *buffer, int index) {
+    accel_with(partial_accel_avx2, bodies, buffer, index);
+}
+
+void accel_soa_avx512(Bodies *bodies, Bodies *buffer, int index) {
+    accel_with(partial_accel_avx512, bodies, buffer, index);
+}
+
+SymmetricAccelKernel select_symmetric_accel_kernel(void) {
+    if (simd_supports_avx512()) {
+        return symmetric_accel_avx512;
+    }
+    if (simd_supports_avx2()) {
+        return symmetric_accel_avx2;
+    }
+    return symmetric_accel_scalar;
+}
+
+PartialAccelKernel select_partial_accel_kernel(void) {
+    if (simd_supports_avx512()) {
+        return partial_accel_avx512;
+    }
+    if (simd_supports_avx2()) {
+        return partial_accel_avx2;
+    }
+    return partial_accel_scalar;
+}
+
+AccelKernel select_accel_kernel(void) {
+    if (simd_supports_avx512()) {
+        return accel_soa_avx512;
+    }
+    if (simd_supports_avx2()) {
+        return accel_soa_avx2;
+    }
+    return accel_soa_scalar;
+}
+
+const char *accel_kernel_name(AccelKernel kernel) {
+    if (kernel == accel_soa_avx512) {
+        return "avx512";
+    }
+    if (kernel == accel_soa_avx2) {
+        return "avx2";
+    }
+    return "scalar";
+}
+
+void run_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes, AccelKernel kernel) {
+    for (int i = 0; i < iterations; i++) {
+        // the static schedule matches the one the bodies were first touched with, see init_bodies_first_touch(...)
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+        for (int val = 0; val < planets->size; val++) {
+            kernel(planets, buffer, val);
+        }
+
+        swap_ptr(&planets, &buffer, Bodies *);
+    }
+}
+
+void run_soa_persistent(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes,
+                        AccelKernel kernel) {
+    SpinBarrier barrier;
+    int size = planets->size;
+#pragma omp parallel num_threads(number_of_processes)
+    {
+        // the team may be smaller than requested, the implicit barrier of single publishes the barrier
+#pragma omp single
+        init_spin_barrier(&barrier, omp_get_num_threads());
+        int t = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        // the partition of schedule(static), so every thread computes the bodies it first touched
+        int chunk = size / threads;
+        int rest = size % threads;
+        int begin = t * chunk + (t < rest ? t : rest);
+        int end = begin + chunk + (t < rest ? 1 : 0);
+        // every thread swaps its own copy of the pointers, all copies stay the same
+        Bodies *from = planets;
+        Bodies *to = buffer;
+        int sense = 0;
+        for (int i = 0; i < iterations; i++) {
+            for (int val = begin; val < end; val++) {
+                kernel(from, to, val);
+            }
+            // the next step reads what the other threads wrote, the end of the region waits after the last one
+            if (i + 1 < iterations) {
+                spin_barrier_wait(&barrier, &sense);
+            }
+            swap_ptr(&from, &to, Bodies *);
+        }
+    }
+}
@@ -0,0 +1,156 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_NBODY_SIMD_H
+#define HG_C_BENCHMARKS_NBODY_SIMD_H
+
+#include "nbody-util.h"
+
+/**
+ * Computes the acceleration of one body caused by all bodies.
+ * Stores the result in the output buffer at the same index.
+ */
+typedef void (*AccelKernel)(Bodies *bodies, Bodies *buffer, int index);
+
+/**
+ * Adds the unscaled acceleration of one body caused by the bodies in the range [begin, end) to acc.
+ * begin must be a multiple of BODY_VECTOR_WIDTH, end must not exceed bodies->size.
+ */
+typedef void (*PartialAccelKernel)(Bodies *bodies, int index, int begin, int end, double *acc);
+
+/**
+ * Scalar partial acceleration, see PartialAccelKernel
+ *
+ * @param bodies Bodies that are being simulated
+ * @param index Index of the body which acceleration is being computed
+ * @param begin First body of the range, multiple of BODY_VECTOR_WIDTH
+ * @param end End of the range, exclusive
+ * @param acc Three accumulators for x, y and z, the result is added to them
+ */
+void partial_accel_scalar(Bodies *bodies, int index, int begin, int end, double *acc);
+
+/**
+ * AVX2 version of partial_accel_scalar(...), processes four bodies at once.
+ * Must only be called if simd_supports_avx2() holds.
+ */
+void partial_accel_avx2(Bodies *bodies, int index, int begin, int end, double *acc);
+
+/**
+ * AVX-512 version of partial_accel_scalar(...), processes eight bodies at once.
+ * Must only be called if simd_supports_avx512() holds.
+ */
+void partial_accel_avx512(Bodies *bodies, int index, int begin, int end, double *acc);
+
+/**
+ * Scalar acceleration of one body, computed on the structure of arrays.
+ * Reference for the vectorized kernels and fallback for CPUs without AVX2.
+ *
+ * @param bodies Bodies that are being simulated
+ * @param buffer Buffer to save the result to
+ * @param index Index of the body which acceleration is being computed
+ */
+void accel_soa_scalar(Bodies *bodies, Bodies *buffer, int index);
+
+/**
+ * AVX2 version of accel_soa_scalar(...), processes four bodies at once.
+ * Must only be called if simd_supports_avx2() holds.
+ */
+void accel_soa_avx2(Bodies *bodies, Bodies *buffer, int index);
+
+/**
+ * AVX-512 version of accel_soa_scalar(...), processes eight bodies at once.
+ * Must only be called if simd_supports_avx512() holds.
+ */
+void accel_soa_avx512(Bodies *bodies, Bodies *buffer, int index);
+
+/**
+ * Evaluates every pair of a body with the bodies behind it exactly once.
+ * The unscaled acceleration of the pair is added to the partial result of the body
+ * and subtracted from the partial result of the other body (Newton's third law).
+ */
+typedef void (*SymmetricAccelKernel)(Bodies *bodies, Bodies *partial, int index);
+
+/**
+ * Scalar symmetric kernel, see SymmetricAccelKernel
+ *
+ * @param bodies Bodies that are being simulated
+ * @param partial Partial accelerations of the same size, the pairs (index, i) with i > index are added
+ * @param index Index of the body
+ */
+void symmetric_accel_scalar(Bodies *bodies, Bodies *partial, int index);
+
+/**
+ * AVX2 version of symmetric_accel_scalar(...).
+ * Must only be called if simd_supports_avx2() holds.
+ */
+void symmetric_accel_avx2(Bodies *bodies, Bodies *partial, int index);
+
+/**
+ * AVX-512 version of symmetric_accel_scalar(...).
+ * Must only be called if simd_supports_avx512() holds.
+ */
+void symmetric_accel_avx512(Bodies *bodies, Bodies *partial, int index);
+
+/**
+ * @return true if the executing CPU supports the AVX2 kernel
+ */
+bool simd_supports_avx2(void);
+
+/**
+ * @return true if the executing CPU supports the AVX-512 kernel
+ */
+bool simd_supports_avx512(void);
+
+/**
+ * Select the widest symmetric kernel the executing CPU supports
+ * @return Symmetric acceleration kernel
+ */
+SymmetricAccelKernel select_symmetric_accel_kernel(void);
+
+/**
+ * Select the widest partial kernel the executing CPU supports
+ * @return Partial acceleration kernel
+ */
+PartialAccelKernel select_partial_accel_kernel(void);
+
+/**
+ * Select the widest kernel the executing CPU supports
+ * @return Acceleration kernel
+ */
+AccelKernel select_accel_kernel(void);
+
+/**
+ * Name of a kernel returned by select_accel_kernel(), for debug output
+ * @param kernel Kernel to name
+ * @return static string, must not be freed
+ */
+const char *accel_kernel_name(AccelKernel kernel);
+
+/**
+ * Runs the simulation on the structure of arrays with the given kernel.
+ * Behaves exactly like run(...): the accelerations are written to the buffer and buffer and planets are swapped.
+ *
+ * @param planets Bodies that are being simulated
+ * @param buffer Buffer of the same size to store the results
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param kernel Kernel to compute the acceleration of a single body
+ */
+void run_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes, AccelKernel kernel);
+
+/**
+ * Runs the simulation like run_soa(...), but a single parallel region spans all iterations.
+ * Every thread keeps the partition of schedule(static) for all steps, the threads meet at a sense-reversing
+ * barrier between two steps instead of forking and joining a team for every step.
+ *
+ * @param planets Bodies that are being simulated
+ * @param buffer Buffer of the same size to store the results
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param kernel Kernel to compute the acceleration of a single body
+ */
+void run_soa_persistent(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes,
+                        AccelKernel kernel);
+
+#endif //HG_C_BENCHMARKS_NBODY_SIMD_H
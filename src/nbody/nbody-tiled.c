@@ -0,0 +1,91 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "nbody-tiled.h"
+
+/**
+ * Compute the accelerations of the bodies in [i_begin, i_end), tile by tile
+ */
+static void accel_tile(Bodies *planets, Bodies *buffer, int i_begin, int i_end, int tile_size,
+                       PartialAccelKernel kernel, double *acc) {
+    int size = planets->size;
+    memset(acc, 0, sizeof(double) * 3 * (i_end - i_begin));
+    for (int j_begin = 0; j_begin < size; j_begin += tile_size) {
+        int j_end = j_begin + tile_size < size ? j_begin + tile_size : size;
+        for (int i = i_begin; i < i_end; i++) {
+            kernel(planets, i, j_begin, j_end, acc + 3 * (i - i_begin));
+        }
+    }
+    for (int i = i_begin; i < i_end; i++) {
+        double *a = acc + 3 * (i - i_begin);
+        buffer->x[i] = G * a[0];
+        buffer->y[i] = G * a[1];
+        buffer->z[i] = G * a[2];
+    }
+}
+
+void run_tiled_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes, int tile_size,
+                   PartialAccelKernel kernel) {
+    int size = planets->size;
+    int tiles = (size + tile_size - 1) / tile_size;
+    for (int i = 0; i < iterations; i++) {
+#pragma omp parallel num_threads(number_of_processes)
+        {
+            double *acc = (double *) malloc(sizeof(double) * 3 * tile_size);
+            if (acc == NULL) {
+                bail_out("tile accumulators could not be allocated");
+            }
+#pragma omp for schedule(static)
+            for (int tile = 0; tile < tiles; tile++) {
+                int i_begin = tile * tile_size;
+                int i_end = i_begin + tile_size < size ? i_begin + tile_size : size;
+                accel_tile(planets, buffer, i_begin, i_end, tile_size, kernel, acc);
+            }
+            free(acc);
+        }
+
+        swap_ptr(&planets, &buffer, Bodies *);
+    }
+}
+
+void run_tiled(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes,
+               int tile_size) {
+    Bodies *soa_planets = init_bodies_first_touch(number_of_planets, number_of_processes);
+    Bodies *soa_buffer = init_bodies_first_touch(number_of_planets, number_of_processes);
+    float3d_to_bodies(planets, soa_planets);
+
+    run_tiled_soa(soa_planets, soa_buffer, iterations, number_of_processes, tile_size,
+                  select_partial_accel_kernel());
+
+    store_simulation(soa_planets, soa_buffer, planets, buffer, iterations);
+    free_bodies(soa_planets);
+    free_bodies(soa_buffer);
+}
+
+int sweep_tile_size(Args *args, Float3D *planets, Float3D *buffer, FILE *res) {
+    int best_tile_size = args->tile_size;
+    time_t best_time = 0;
+    for (int tile_size = (int) BODY_VECTOR_WIDTH; tile_size <= MAX_SWEEP_TILE_SIZE; tile_size *= 2) {
+        // a single tile covers all bodies, larger tiles behave the same
+        if (tile_size / 2 >= args->size) {
+            break;
+        }
+        for (int i = 0; i < args->size; i++) {
+            fill_planet(&planets[i], i);
+        }
+        args->tile_size = tile_size;
+        TIC(0);
+        run_tiled(planets, buffer, args->size, args->iterations, args->number_of_processes, tile_size);
+        time_t seq_t = TOC(0);
+        printf("Tile size %5d: %zi.%06zis\n", tile_size, seq_t / 1000000, seq_t % 1000000);
+        append_nbody_csv(res, args, seq_t);
+
+        if (best_time == 0 || seq_t < best_time) {
+            best_time = seq_t;
+            best_tile_size = tile_size;
+        }
+    }
+    args->tile_size = best_tile_size;
+    return best_tile_size;
+}
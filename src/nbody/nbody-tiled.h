@@ -0,0 +1,56 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_NBODY_TILED_H
+#define HG_C_BENCHMARKS_NBODY_TILED_H
+
+#include "nbody-util.h"
+#include "nbody-run.h"
+#include "nbody-simd.h"
+
+// largest tile size that is tried by the sweep, 3 * 8 * 16384 bytes exceed every L2
+#define MAX_SWEEP_TILE_SIZE (16384)
+
+/**
+ * Runs the simulation on the structure of arrays, blocked into tiles.
+ * Every thread owns a tile of bodies and streams all tiles of the other bodies through the cache,
+ * so every tile of bodies that has been loaded is reused for a whole tile of accelerations.
+ *
+ * @param planets Bodies that are being simulated
+ * @param buffer Buffer of the same size to store the results
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param tile_size Number of bodies per tile, must be a multiple of BODY_VECTOR_WIDTH
+ * @param kernel Kernel to compute the acceleration a tile causes on a single body
+ */
+void run_tiled_soa(Bodies *planets, Bodies *buffer, int iterations, int number_of_processes, int tile_size,
+                   PartialAccelKernel kernel);
+
+/**
+ * Runs the simulation like run(...), but with the tiled engine
+ *
+ * @param planets planets that are being simulated
+ * @param buffer buffer to store the results
+ * @param number_of_planets number of planets that are being simulated
+ * @param iterations number of iterations the simulation should be run
+ * @param number_of_processes that shall be used to run
+ * @param tile_size Number of bodies per tile, must be a multiple of BODY_VECTOR_WIDTH
+ */
+void run_tiled(Float3D *planets, Float3D *buffer, int number_of_planets, int iterations, int number_of_processes,
+               int tile_size);
+
+/**
+ * Benchmark the tiled engine for all tile sizes from BODY_VECTOR_WIDTH up to MAX_SWEEP_TILE_SIZE.
+ * Tile sizes are doubled every step, tiles larger than the number of bodies are skipped.
+ * Every measurement is appended to the result file.
+ *
+ * @param args Arguments of the benchmark, the tile size is overwritten
+ * @param planets planets that are being simulated, refilled for every measurement
+ * @param buffer buffer to store the results
+ * @param res File the measurements are appended to
+ * @return Tile size with the smallest run time
+ */
+int sweep_tile_size(Args *args, Float3D *planets, Float3D *buffer, FILE *res);
+
+#endif //HG_C_BENCHMARKS_NBODY_TILED_H
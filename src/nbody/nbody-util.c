@@ -17,7 +17,8 @@ void pretty_print(FILE *fd, Float3D *planets, int size) {
  * Prints Synopsis of the program
  */
 void usage() {
-    fprintf(stderr, "SYNOPSIS: %s [-d] [-p number_of_processes] [-s number_of_planets] [-n iterations]\n", pgmname);
+    fprintf(stderr, "SYNOPSIS: %s [-d] [-p number_of_processes] [-s number_of_planets] [-n iterations] [-e simd|scalar|tiled|barnes-hut|symmetric|leapfrog|mixed|grid] [-t tile_size] [-S] [-o theta] [-T time_step] [-c cutoff] [-r reorder_interval] [-k morton|hilbert] [-R] [-N] [-P none|compact|scatter]\n",
+            pgmname);
     exit(1);
 }
 
@@ -28,10 +29,21 @@ Args *parse_args(int argc, char **argv) {
     args->iterations = 10;
     args->number_of_processes = 1;
     args->debug = false;
+    args->engine = ENGINE_SIMD;
+    args->tile_size = DEFAULT_TILE_SIZE;
+    args->sweep = false;
+    args->theta = DEFAULT_THETA;
+    args->numa_first_touch = false;
+    args->pin_policy = PIN_NONE;
+    args->time_step = DEFAULT_TIME_STEP;
+    args->persistent = false;
+    args->cutoff = DEFAULT_CUTOFF;
+    args->reorder_interval = 0;
+    args->curve = CURVE_MORTON;
 
     // parse the args
     int c;
-    while ((c = getopt(argc, argv, "?dn:p:s:")) != -1) {
+    while ((c = getopt(argc, argv, "?dn:p:s:e:t:So:NP:T:Rc:r:k:")) != -1) {
         switch (c) {
             case 'd':
                 args->debug = true;
@@ -45,6 +57,70 @@ Args *parse_args(int argc, char **argv) {
             case 's':
                 args->size = strtol(optarg, NULL, 10);
                 break;
+            case 'e':
+                if (strcmp(optarg, "simd") == 0) {
+                    args->engine = ENGINE_SIMD;
+                } else if (strcmp(optarg, "scalar") == 0) {
+                    args->engine = ENGINE_SCALAR;
+                } else if (strcmp(optarg, "tiled") == 0) {
+                    args->engine = ENGINE_TILED;
+                } else if (strcmp(optarg, "barnes-hut") == 0) {
+                    args->engine = ENGINE_BARNES_HUT;
+                } else if (strcmp(optarg, "symmetric") == 0) {
+                    args->engine = ENGINE_SYMMETRIC;
+                } else if (strcmp(optarg, "leapfrog") == 0) {
+                    args->engine = ENGINE_LEAPFROG;
+                } else if (strcmp(optarg, "mixed") == 0) {
+                    args->engine = ENGINE_MIXED;
+                } else if (strcmp(optarg, "grid") == 0) {
+                    args->engine = ENGINE_GRID;
+                } else {
+                    free(args);
+                    usage();
+                }
+                break;
+            case 't':
+                args->tile_size = strtol(optarg, NULL, 10);
+                break;
+            case 'S':
+                // the sweep only makes sense for the tiled engine
+                args->sweep = true;
+                args->engine = ENGINE_TILED;
+                break;
+            case 'o':
+                args->theta = strtod(optarg, NULL);
+                break;
+            case 'T':
+                args->time_step = strtod(optarg, NULL);
+                break;
+            case 'c':
+                args->cutoff = strtod(optarg, NULL);
+                break;
+            case 'r':
+                args->reorder_interval = strtol(optarg, NULL, 10);
+                break;
+            case 'k':
+                if (strcmp(optarg, "morton") == 0) {
+                    args->curve = CURVE_MORTON;
+                } else if (strcmp(optarg, "hilbert") == 0) {
+                    args->curve = CURVE_HILBERT;
+                } else {
+                    free(args);
+                    usage();
+                }
+                break;
+            case 'R':
+                args->persistent = true;
+                break;
+            case 'N':
+                args->numa_first_touch = true;
+                break;
+            case 'P':
+                if (parse_pin_policy(optarg, &args->pin_policy) != 0) {
+                    free(args);
+                    usage();
+                }
+                break;
             case '?':
                 free(args);
                 usage();
@@ -57,7 +133,19 @@ Args *parse_args(int argc, char **argv) {
     }
 
     /* sanity checks*/
-    if (args->size <= 0 || args->number_of_processes <= 0 || args->iterations < 0) {
+    if (args->size <= 0 || args->number_of_processes <= 0 || args->iterations < 0 ||
+        args->tile_size <= 0 || args->tile_size % (int) BODY_VECTOR_WIDTH != 0 || !(args->theta >= 0.0) ||
+        !(args->time_step > 0.0) || !(args->cutoff > 0.0) || args->reorder_interval < 0) {
+        free(args);
+        usage();
+    }
+    // only the simd engine runs in a persistent region
+    if (args->persistent && args->engine != ENGINE_SIMD) {
+        free(args);
+        usage();
+    }
+    // the scalar engine has no structure of arrays to reorder, the leapfrog engine has velocities as well
+    if (args->reorder_interval > 0 && (args->engine == ENGINE_SCALAR || args->engine == ENGINE_LEAPFROG)) {
         free(args);
         usage();
     }
@@ -83,9 +171,29 @@ void free_resources(Float3D *planets, Float3D *buffer, FILE *p_file, FILE *q_fil
 }
 
 void print_args(Args *args) {
-    printf("Args -> number of Planets: %zi, iterations: %zi, processes: %zi\n", args->size, args->iterations,
-           args->number_of_processes
+    printf("Args -> number of Planets: %d, iterations: %d, processes: %d, engine: %s\n", args->size, args->iterations,
+           args->number_of_processes, engine_name(args->engine)
     );
+    if (args->engine == ENGINE_TILED) {
+        printf("\ttile size: %d, sweep: %d\n", args->tile_size, args->sweep);
+    }
+    if (args->engine == ENGINE_BARNES_HUT) {
+        printf("\ttheta: %g\n", args->theta);
+    }
+    if (args->engine == ENGINE_LEAPFROG) {
+        printf("\ttime step: %g\n", args->time_step);
+    }
+    if (args->engine == ENGINE_GRID) {
+        printf("\tcutoff: %g\n", args->cutoff);
+    }
+    if (args->persistent) {
+        printf("\tpersistent parallel region\n");
+    }
+    if (args->reorder_interval > 0) {
+        printf("\treordered along the %s curve every %d steps\n", curve_name(args->curve), args->reorder_interval);
+    }
+    printf("\tfirst touch: %s, pinning: %s\n", args->numa_first_touch ? "parallel" : "serial",
+           pin_policy_name(args->pin_policy));
 }
 
 
@@ -95,7 +203,139 @@ void fill_planet(Float3D *p, int i) {
     p->z = i * 30.0;
 }
 
+void fill_planets(Float3D *planets, int size, int number_of_processes) {
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+    for (int i = 0; i < size; i++) {
+        fill_planet(&planets[i], i);
+    }
+}
+
 
 void append_nbody_csv(FILE *fd, Args *args, time_t seq_t) {
-    fprintf(fd, "%zi,%zi,%zi,%zi\n", args->number_of_processes, args->size, args->iterations, seq_t);
+    // the engine column carries the parameter of the engine and the curve the bodies are reordered by
+    char engine[64];
+    if (args->engine == ENGINE_TILED) {
+        snprintf(engine, sizeof(engine), "%s-%d", engine_name(args->engine), args->tile_size);
+    } else if (args->engine == ENGINE_BARNES_HUT) {
+        snprintf(engine, sizeof(engine), "%s-%g", engine_name(args->engine), args->theta);
+    } else if (args->engine == ENGINE_LEAPFROG) {
+        snprintf(engine, sizeof(engine), "%s-%g", engine_name(args->engine), args->time_step);
+    } else if (args->engine == ENGINE_GRID) {
+        snprintf(engine, sizeof(engine), "%s-%g", engine_name(args->engine), args->cutoff);
+    } else {
+        snprintf(engine, sizeof(engine), "%s%s", engine_name(args->engine), args->persistent ? "-persistent" : "");
+    }
+    if (args->reorder_interval > 0) {
+        size_t length = strlen(engine);
+        snprintf(engine + length, sizeof(engine) - length, "-%s%d", curve_name(args->curve), args->reorder_interval);
+    }
+    fprintf(fd, "%d,%d,%d,%zi,%s,%s,%s\n", args->number_of_processes, args->size, args->iterations, seq_t, engine,
+            args->numa_first_touch ? "parallel" : "serial", pin_policy_name(args->pin_policy));
+}
+
+const char *engine_name(Engine engine) {
+    switch (engine) {
+        case ENGINE_SIMD:
+            return "simd";
+        case ENGINE_SCALAR:
+            return "scalar";
+        case ENGINE_TILED:
+            return "tiled";
+        case ENGINE_BARNES_HUT:
+            return "barnes-hut";
+        case ENGINE_SYMMETRIC:
+            return "symmetric";
+        case ENGINE_LEAPFROG:
+            return "leapfrog";
+        case ENGINE_MIXED:
+            return "mixed";
+        case ENGINE_GRID:
+            return "grid";
+    }
+    return "unknown";
+}
+
+const char *curve_name(Curve curve) {
+    return curve == CURVE_HILBERT ? "hilbert" : "morton";
+}
+
+double max_relative_error(Float3D *expected, Float3D *actual, int size) {
+    double scale = 0.0;
+    double error = 0.0;
+    for (int i = 0; i < size; i++) {
+        scale = fmax(scale, fmax(fabs(expected[i].x), fmax(fabs(expected[i].y), fabs(expected[i].z))));
+        error = fmax(error, fabs(expected[i].x - actual[i].x));
+        error = fmax(error, fabs(expected[i].y - actual[i].y));
+        error = fmax(error, fabs(expected[i].z - actual[i].z));
+    }
+    return scale > 0.0 ? error / scale : error;
+}
+
+/**
+ * Allocate an aligned coordinate array of the given capacity, its pages are not touched yet
+ */
+static double *alloc_coordinates(int capacity) {
+    double *coordinates = (double *) aligned_alloc(BODY_ALIGNMENT, sizeof(double) * capacity);
+    if (coordinates == NULL) {
+        bail_out("bodies could not be allocated");
+    }
+    return coordinates;
+}
+
+Bodies *init_bodies(int size) {
+    return init_bodies_first_touch(size, 1);
+}
+
+Bodies *init_bodies_first_touch(int size, int number_of_processes) {
+    Bodies *bodies = (Bodies *) malloc(sizeof(Bodies));
+    if (bodies == NULL) {
+        bail_out("bodies could not be allocated");
+    }
+    int width = (int) BODY_VECTOR_WIDTH;
+    bodies->size = size;
+    // at least one vector, aligned_alloc does not guarantee anything for a size of zero
+    bodies->capacity = size > 0 ? ((size + width - 1) / width) * width : width;
+    bodies->x = alloc_coordinates(bodies->capacity);
+    bodies->y = alloc_coordinates(bodies->capacity);
+    bodies->z = alloc_coordinates(bodies->capacity);
+    double *x = bodies->x, *y = bodies->y, *z = bodies->z;
+#pragma omp parallel for num_threads(number_of_processes) schedule(static)
+    for (int i = 0; i < bodies->capacity; i++) {
+        x[i] = 0.0;
+        y[i] = 0.0;
+        z[i] = 0.0;
+    }
+    return bodies;
+}
+
+void free_bodies(Bodies *bodies) {
+    if (bodies != NULL) {
+        free(bodies->x);
+        free(bodies->y);
+        free(bodies->z);
+        free(bodies);
+    }
+}
+
+void float3d_to_bodies(Float3D *from, Bodies *to) {
+    for (int i = 0; i < to->size; i++) {
+        to->x[i] = from[i].x;
+        to->y[i] = from[i].y;
+        to->z[i] = from[i].z;
+    }
+}
+
+void bodies_to_float3d(Bodies *from, Float3D *to) {
+    for (int i = 0; i < from->size; i++) {
+        to[i].x = from->x[i];
+        to[i].y = from->y[i];
+        to[i].z = from->z[i];
+    }
+}
+
+void store_simulation(Bodies *planets, Bodies *buffer, Float3D *planets_out, Float3D *buffer_out, int iterations) {
+    bodies_to_float3d(planets, planets_out);
+    if (iterations > 0) {
+        bodies_to_float3d(buffer, buffer_out);
+    }
 }
@@ -10,9 +10,10 @@
 #include <math.h>
 #include <getopt.h>
 #include <stdbool.h>
+#include <string.h>
 #include "../util/util.h"
+#include "../util/numa.h"
 
-// TODO: change signature: prefer arrays
 /**
  * Represents a body, flowing in a 3D system
  */
@@ -22,6 +23,56 @@ struct Float3D {
     double z;
 };
 
+// alignment of the coordinate arrays in bytes, matches the width of an AVX-512 register
+#define BODY_ALIGNMENT (64)
+// number of doubles the coordinate arrays are padded to
+#define BODY_VECTOR_WIDTH (BODY_ALIGNMENT / sizeof(double))
+
+/**
+ * Structure of arrays representation of the bodies.
+ * Every coordinate is stored in its own aligned array.
+ * The arrays are padded with zeros to a multiple of BODY_VECTOR_WIDTH,
+ * so vectorized loops can always load full registers.
+ */
+struct Bodies {
+    int size;
+    int capacity;
+    double *x;
+    double *y;
+    double *z;
+};
+
+/**
+ * Engines that can be used to compute the simulation
+ */
+enum Engine {
+    ENGINE_SIMD = 0,
+    ENGINE_SCALAR,
+    ENGINE_TILED,
+    ENGINE_BARNES_HUT,
+    ENGINE_SYMMETRIC,
+    ENGINE_LEAPFROG,
+    ENGINE_MIXED,
+    ENGINE_GRID
+};
+
+/**
+ * Space filling curves the bodies can be ordered by
+ */
+enum Curve {
+    CURVE_MORTON = 0,
+    CURVE_HILBERT
+};
+
+// default number of bodies per tile of the tiled engine, three coordinates of 256 bodies fit easily into L1
+#define DEFAULT_TILE_SIZE (256)
+// default opening angle of the barnes hut engine
+#define DEFAULT_THETA (0.5)
+// default length of a step of the leapfrog integrator
+#define DEFAULT_TIME_STEP (0.01)
+// default cutoff radius of the grid engine, a few neighbours of the fill_planet(...) bodies along their line
+#define DEFAULT_CUTOFF (100.0)
+
 /**
  * Struct of optional arguments.
  * All arguments must always be set in order to avoid problems.
@@ -32,6 +83,23 @@ struct arguments {
     int iterations;
     int number_of_processes;
     bool debug;
+    enum Engine engine;
+    int tile_size;
+    bool sweep;
+    double theta;
+    // the bodies are initialized by the threads that compute on them, so their pages are local to the thread's socket
+    bool numa_first_touch;
+    // policy the OpenMP threads are pinned to cores with
+    PinPolicy pin_policy;
+    // length of a step of the leapfrog integrator
+    double time_step;
+    // a single parallel region spans all iterations of the simd engine
+    bool persistent;
+    // bodies further apart do not interact in the grid engine
+    double cutoff;
+    // the bodies are sorted along a space filling curve every this many steps, never if zero
+    int reorder_interval;
+    enum Curve curve;
 };
 
 /**
@@ -44,6 +112,21 @@ typedef struct Float3D Float3D;
  */
 typedef struct arguments Args;
 
+/**
+ * Typedef for easier access
+ */
+typedef struct Bodies Bodies;
+
+/**
+ * Typedef for easier access
+ */
+typedef enum Engine Engine;
+
+/**
+ * Typedef for easier access
+ */
+typedef enum Curve Curve;
+
 /**
  * Helper function to fil a planet according to the haskell implementation
  *
@@ -52,6 +135,17 @@ typedef struct arguments Args;
  */
 void fill_planet(Float3D *p, int i);
 
+/**
+ * Fill the planets like fill_planet(...).
+ * The planets are distributed to the threads by the static schedule of the simulation,
+ * so every page is first touched by the thread that computes on it.
+ *
+ * @param planets Planets to fill
+ * @param size Number of planets
+ * @param number_of_processes Number of threads that fill the planets
+ */
+void fill_planets(Float3D *planets, int size, int number_of_processes);
+
 /**
  * Free the allocated memory
  *
@@ -91,4 +185,86 @@ void print_args(Args *args);
  */
 void append_nbody_csv(FILE *fd, Args *args, time_t seq_t);
 
+/**
+ * Human readable name of an engine
+ * @param engine Engine to name
+ * @return static string, must not be freed
+ */
+const char *engine_name(Engine engine);
+
+/**
+ * Human readable name of a space filling curve
+ * @param curve Curve to name
+ * @return static string, must not be freed
+ */
+const char *curve_name(Curve curve);
+
+/**
+ * Largest deviation of two simulation results, relative to the largest coordinate of the expected result.
+ * Relative to the largest coordinate, since accelerations that cancel out are only noise of the summation order.
+ *
+ * @param expected Reference result
+ * @param actual Result to compare
+ * @param size Number of bodies
+ * @return max |expected - actual| / max |expected|
+ */
+double max_relative_error(Float3D *expected, Float3D *actual, int size);
+
+/**
+ * Allocate the structure of arrays for the given number of bodies.
+ * All coordinates, including the padding, are initialized to zero.
+ * Bails out if the memory can not be allocated.
+ *
+ * @param size Number of bodies
+ * @return Bodies, must be freed with free_bodies(...)
+ */
+Bodies *init_bodies(int size);
+
+/**
+ * Allocate the structure of arrays like init_bodies(...), but zero it with a team of threads.
+ * The bodies are distributed by the static schedule of the simulation, so every page is first touched by the thread
+ * that computes on it and ends up in the memory of its socket.
+ *
+ * @param size Number of bodies
+ * @param number_of_processes Number of threads that touch the bodies
+ * @return Bodies, must be freed with free_bodies(...)
+ */
+Bodies *init_bodies_first_touch(int size, int number_of_processes);
+
+/**
+ * Free the bodies and all of its arrays
+ * @param bodies Bodies to free, may be NULL
+ */
+void free_bodies(Bodies *bodies);
+
+/**
+ * Copy an array of bodies into the structure of arrays representation.
+ * Both must contain the same number of bodies.
+ *
+ * @param from Array of bodies, of the size bodies->size
+ * @param to Structure of arrays to copy into
+ */
+void float3d_to_bodies(Float3D *from, Bodies *to);
+
+/**
+ * Copy the structure of arrays representation back into an array of bodies
+ *
+ * @param from Structure of arrays to copy from
+ * @param to Array of bodies, of the size from->size
+ */
+void bodies_to_float3d(Bodies *from, Float3D *to);
+
+/**
+ * Copy the state of a simulation on the structure of arrays back into the arrays of bodies.
+ * Since the swaps of the simulation are local, the arrays end up exactly as if the simulation was run on them.
+ * The buffer is only written if at least one iteration has been run, it holds no data otherwise.
+ *
+ * @param planets Simulated planets
+ * @param buffer Simulation buffer
+ * @param planets_out Array that has been converted to planets
+ * @param buffer_out Array that corresponds to the buffer
+ * @param iterations Number of iterations that have been run
+ */
+void store_simulation(Bodies *planets, Bodies *buffer, Float3D *planets_out, Float3D *buffer_out, int iterations);
+
 #endif //HG_C_BENCHMARKS_NBODY_UTIL_H
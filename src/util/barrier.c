@@ -0,0 +1,44 @@
+//
+// Created by agent on 10/17/26.
+//
+
+// sched_yield is part of POSIX
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <sched.h>
+#include "barrier.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define spin_pause() _mm_pause()
+#else
+#define spin_pause() do {} while (0)
+#endif
+
+void init_spin_barrier(SpinBarrier *barrier, int threads) {
+    barrier->threads = threads;
+    barrier->count = threads;
+    barrier->sense = 0;
+}
+
+void spin_barrier_wait(SpinBarrier *barrier, int *local_sense) {
+    int sense = !*local_sense;
+    *local_sense = sense;
+    if (__atomic_sub_fetch(&barrier->count, 1, __ATOMIC_ACQ_REL) == 0) {
+        // nobody touches the counter until the sense is flipped, the release publishes both
+        __atomic_store_n(&barrier->count, barrier->threads, __ATOMIC_RELAXED);
+        __atomic_store_n(&barrier->sense, sense, __ATOMIC_RELEASE);
+        return;
+    }
+    int spins = 0;
+    while (__atomic_load_n(&barrier->sense, __ATOMIC_ACQUIRE) != sense) {
+        if (++spins == SPIN_BARRIER_SPINS) {
+            spins = 0;
+            sched_yield();
+        } else {
+            spin_pause();
+        }
+    }
+}
@@ -0,0 +1,46 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_BARRIER_H
+#define HG_C_BENCHMARKS_BARRIER_H
+
+// number of polls of a waiting thread before it yields its core, keeps oversubscribed teams going
+#define SPIN_BARRIER_SPINS (32)
+
+/**
+ * Sense-reversing barrier for a fixed team of threads.
+ * The last thread to arrive resets the counter and flips the shared sense, all other threads spin until the
+ * shared sense matches their own. It is reusable without a second phase, since every episode waits for
+ * the opposite sense of the previous one.
+ */
+struct SpinBarrier {
+    int threads;
+    // threads that have not arrived in the current episode
+    int count;
+    // flipped by the last thread of every episode
+    int sense;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct SpinBarrier SpinBarrier;
+
+/**
+ * Initialize a barrier, must be done before the team starts to wait on it
+ *
+ * @param barrier Barrier to initialize
+ * @param threads Number of threads of the team
+ */
+void init_spin_barrier(SpinBarrier *barrier, int threads);
+
+/**
+ * Wait until all threads of the team have arrived
+ *
+ * @param barrier Barrier of the team
+ * @param local_sense Sense of the calling thread, private to it and 0 before its first wait
+ */
+void spin_barrier_wait(SpinBarrier *barrier, int *local_sense);
+
+#endif //HG_C_BENCHMARKS_BARRIER_H
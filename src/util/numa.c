@@ -0,0 +1,266 @@
+//
+// Created by agent on 10/17/26.
+//
+
+// sched_setaffinity, sched_getcpu and syscall are GNU extensions
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <sched.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "numa.h"
+#include "util.h"
+
+int parse_pin_policy(const char *name, PinPolicy *policy) {
+    if (strcmp(name, "none") == 0) {
+        *policy = PIN_NONE;
+    } else if (strcmp(name, "compact") == 0) {
+        *policy = PIN_COMPACT;
+    } else if (strcmp(name, "scatter") == 0) {
+        *policy = PIN_SCATTER;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+const char *pin_policy_name(PinPolicy policy) {
+    switch (policy) {
+        case PIN_NONE:
+            return "none";
+        case PIN_COMPACT:
+            return "compact";
+        case PIN_SCATTER:
+            return "scatter";
+    }
+    return "unknown";
+}
+
+int cpu_socket(int cpu) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    FILE *fd = fopen(path, "r");
+    if (fd == NULL) {
+        return 0;
+    }
+    int socket = 0;
+    if (fscanf(fd, "%d", &socket) != 1 || socket < 0) {
+        socket = 0;
+    }
+    fclose(fd);
+    return socket;
+}
+
+void place_threads(const int *cpus, const int *sockets, int count, PinPolicy policy, int threads, int *placement) {
+    int number_of_sockets = 0;
+    for (int i = 0; i < count; ++i) {
+        if (sockets[i] >= number_of_sockets) {
+            number_of_sockets = sockets[i] + 1;
+        }
+    }
+    // the cores ordered by socket, the cores of socket s start at first[s]
+    int *first = (int *) calloc(number_of_sockets + 1, sizeof(int));
+    int *ordered = (int *) malloc(sizeof(int) * count);
+    if (first == NULL || ordered == NULL) {
+        bail_out("thread placement could not be allocated");
+    }
+    for (int i = 0; i < count; ++i) {
+        first[sockets[i] + 1]++;
+    }
+    for (int s = 0; s < number_of_sockets; ++s) {
+        first[s + 1] += first[s];
+    }
+    int *next = (int *) malloc(sizeof(int) * number_of_sockets);
+    memcpy(next, first, sizeof(int) * number_of_sockets);
+    for (int i = 0; i < count; ++i) {
+        ordered[next[sockets[i]]++] = cpus[i];
+    }
+    free(next);
+
+    if (policy == PIN_SCATTER) {
+        // only the sockets that have available cores take threads
+        int *used = (int *) malloc(sizeof(int) * number_of_sockets);
+        int number_of_used = 0;
+        for (int s = 0; s < number_of_sockets; ++s) {
+            if (first[s + 1] > first[s]) {
+                used[number_of_used++] = s;
+            }
+        }
+        for (int t = 0; t < threads; ++t) {
+            int s = used[t % number_of_used];
+            int cores = first[s + 1] - first[s];
+            placement[t] = ordered[first[s] + (t / number_of_used) % cores];
+        }
+        free(used);
+    } else {
+        for (int t = 0; t < threads; ++t) {
+            placement[t] = ordered[t % count];
+        }
+    }
+    free(ordered);
+    free(first);
+}
+
+ThreadPlacement *pin_threads(PinPolicy policy, int threads) {
+    ThreadPlacement *placement = (ThreadPlacement *) malloc(sizeof(ThreadPlacement));
+    if (placement == NULL) {
+        bail_out("thread placement could not be allocated");
+    }
+    placement->threads = threads;
+    placement->cpu = (int *) malloc(sizeof(int) * threads);
+    placement->socket = (int *) malloc(sizeof(int) * threads);
+    placement->node = (int *) malloc(sizeof(int) * threads);
+    if (placement->cpu == NULL || placement->socket == NULL || placement->node == NULL) {
+        bail_out("thread placement could not be allocated");
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) {
+        bail_out("available cores could not be read");
+    }
+    int count = CPU_COUNT(&allowed);
+    int *cpus = (int *) malloc(sizeof(int) * count);
+    int *sockets = (int *) malloc(sizeof(int) * count);
+    int *targets = (int *) malloc(sizeof(int) * threads);
+    if (cpus == NULL || sockets == NULL || targets == NULL) {
+        bail_out("thread placement could not be allocated");
+    }
+    for (int cpu = 0, i = 0; cpu < CPU_SETSIZE && i < count; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            cpus[i] = cpu;
+            sockets[i] = cpu_socket(cpu);
+            ++i;
+        }
+    }
+    if (policy != PIN_NONE) {
+        place_threads(cpus, sockets, count, policy, threads, targets);
+    }
+
+    int failed = 0;
+    for (int t = 0; t < threads; ++t) {
+        placement->cpu[t] = -1;
+    }
+#pragma omp parallel num_threads(threads) reduction(+:failed)
+    {
+        int t = omp_get_thread_num();
+        if (policy != PIN_NONE) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(targets[t], &set);
+            // a pid of zero pins the calling thread only
+            failed += sched_setaffinity(0, sizeof(cpu_set_t), &set) != 0;
+        }
+        placement->cpu[t] = sched_getcpu();
+        // glibc has no getcpu wrapper before 2.29
+        unsigned int cpu = 0, node = 0;
+        placement->node[t] = syscall(SYS_getcpu, &cpu, &node, NULL) == 0 ? (int) node : 0;
+    }
+    free(cpus);
+    free(sockets);
+    free(targets);
+    if (failed > 0) {
+        free_thread_placement(placement);
+        bail_out("threads could not be pinned");
+    }
+
+    placement->sockets = 1;
+    placement->nodes = 1;
+    for (int t = 0; t < threads; ++t) {
+        placement->socket[t] = placement->cpu[t] >= 0 ? cpu_socket(placement->cpu[t]) : 0;
+        if (placement->socket[t] >= placement->sockets) {
+            placement->sockets = placement->socket[t] + 1;
+        }
+        if (placement->node[t] >= placement->nodes) {
+            placement->nodes = placement->node[t] + 1;
+        }
+    }
+    return placement;
+}
+
+void free_thread_placement(ThreadPlacement *placement) {
+    if (placement != NULL) {
+        free(placement->cpu);
+        free(placement->socket);
+        free(placement->node);
+        free(placement);
+    }
+}
+
+long page_nodes(const void *data, size_t size, int **nodes) {
+    uintptr_t page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t first = (uintptr_t) data / page_size * page_size;
+    long count = (long) (((uintptr_t) data + size - first + page_size - 1) / page_size);
+    void **pages = (void **) malloc(sizeof(void *) * count);
+    *nodes = (int *) malloc(sizeof(int) * count);
+    if (pages == NULL || *nodes == NULL) {
+        bail_out("page nodes could not be allocated");
+    }
+    for (long i = 0; i < count; ++i) {
+        pages[i] = (void *) (first + i * page_size);
+    }
+    // without target nodes move_pages only reports the node of every page
+    long result = syscall(SYS_move_pages, 0, (unsigned long) count, pages, NULL, *nodes, 0);
+    free(pages);
+    if (result != 0) {
+        free(*nodes);
+        *nodes = NULL;
+        return -1;
+    }
+    return count;
+}
+
+void print_memory_locality(ThreadPlacement *placement, const void *data, size_t size, double bytes, time_t time) {
+    double seconds = time > 0 ? (double) time / 1e6 : 1e-6;
+    printf("Estimated memory bandwidth: %.2f GB/s\n", bytes / seconds / 1e9);
+    int *nodes = NULL;
+    long count = data != NULL && size > 0 ? page_nodes(data, size, &nodes) : -1;
+    if (count < 0) {
+        return;
+    }
+    int number_of_nodes = placement->nodes;
+    for (long i = 0; i < count; ++i) {
+        if (nodes[i] >= number_of_nodes) {
+            number_of_nodes = nodes[i] + 1;
+        }
+    }
+    long *resident = (long *) calloc(number_of_nodes, sizeof(long));
+    long *local = (long *) calloc(number_of_nodes, sizeof(long));
+    if (resident == NULL || local == NULL) {
+        bail_out("page locality could not be allocated");
+    }
+    long untouched = 0;
+    for (long i = 0; i < count; ++i) {
+        if (nodes[i] < 0) {
+            untouched++;
+            continue;
+        }
+        // a static schedule gives every thread an equal contiguous chunk of the data
+        int owner = (int) (i * placement->threads / count);
+        resident[nodes[i]]++;
+        local[nodes[i]] += placement->node[owner] == nodes[i];
+    }
+    printf("Pages of the data per node: %ld pages, %ld not touched\n", count, untouched);
+    for (int n = 0; n < number_of_nodes; ++n) {
+        int threads = 0;
+        for (int t = 0; t < placement->threads; ++t) {
+            threads += placement->node[t] == n;
+        }
+        if (threads == 0 && resident[n] == 0) {
+            continue;
+        }
+        printf("\tnode %d: %d threads, %ld pages (%.0f%%), %.0f%% of them local to the thread of their chunk\n", n,
+               threads, resident[n], 100.0 * (double) resident[n] / (double) count,
+               resident[n] > 0 ? 100.0 * (double) local[n] / (double) resident[n] : 0.0);
+    }
+    free(resident);
+    free(local);
+    free(nodes);
+}
@@ -0,0 +1,128 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_NUMA_H
+#define HG_C_BENCHMARKS_NUMA_H
+
+#include <sys/time.h>
+
+/**
+ * Policies to pin the OpenMP threads to cores
+ */
+enum PinPolicy {
+    // threads are left to the scheduler
+    PIN_NONE = 0,
+    // threads fill the cores of a socket before the next socket is used
+    PIN_COMPACT,
+    // consecutive threads are placed on different sockets
+    PIN_SCATTER
+};
+
+/**
+ * Cores and sockets of the threads of a team
+ */
+struct ThreadPlacement {
+    int threads;
+    // highest socket id of a thread plus one
+    int sockets;
+    // core of every thread, the core it was last seen on if the threads are not pinned
+    int *cpu;
+    // socket of every thread
+    int *socket;
+    // highest NUMA node id of a thread plus one
+    int nodes;
+    // NUMA node of every thread
+    int *node;
+};
+
+/**
+ * Typedef for easier usage
+ */
+typedef enum PinPolicy PinPolicy;
+
+/**
+ * Typedef for easier usage
+ */
+typedef struct ThreadPlacement ThreadPlacement;
+
+/**
+ * Parse the name of a pinning policy
+ *
+ * @param name none, compact or scatter
+ * @param policy Parsed policy
+ * @return 0 on success, -1 if the name is unknown
+ */
+int parse_pin_policy(const char *name, PinPolicy *policy);
+
+/**
+ * Human readable name of a pinning policy
+ * @param policy Policy to name
+ * @return static string, must not be freed
+ */
+const char *pin_policy_name(PinPolicy policy);
+
+/**
+ * Socket of a core, as reported by sysfs
+ *
+ * @param cpu Index of the core
+ * @return physical package id of the core, 0 if the system does not report it
+ */
+int cpu_socket(int cpu);
+
+/**
+ * Assign a core to every thread.
+ * Compact placement fills the cores of the lowest socket first, scatter placement deals the threads round robin
+ * to the sockets. Cores are reused if there are more threads than cores.
+ *
+ * @param cpus Available cores in ascending order
+ * @param sockets Socket of every available core
+ * @param count Number of available cores, at least one
+ * @param policy PIN_COMPACT or PIN_SCATTER
+ * @param threads Number of threads
+ * @param placement Core of every thread
+ */
+void place_threads(const int *cpus, const int *sockets, int count, PinPolicy policy, int threads, int *placement);
+
+/**
+ * Pin the threads of the OpenMP team of the given size to the cores the process may run on.
+ * Every later parallel region of the same size reuses the pinned threads.
+ * Bails out if a thread can not be pinned.
+ *
+ * @param policy Pinning policy, PIN_NONE only records the current core of every thread
+ * @param threads Size of the team
+ * @return Placement of the threads, must be freed with free_thread_placement(...)
+ */
+ThreadPlacement *pin_threads(PinPolicy policy, int threads);
+
+/**
+ * @param placement Placement to free, may be NULL
+ */
+void free_thread_placement(ThreadPlacement *placement);
+
+/**
+ * Query the NUMA node of every page of a memory range with move_pages(2), no page is moved
+ *
+ * @param data Start of the range
+ * @param size Number of bytes of the range
+ * @param nodes Node of every page, negative if the page has not been touched yet. Must be freed
+ * @return Number of pages, -1 if the system does not report the nodes
+ */
+long page_nodes(const void *data, size_t size, int **nodes);
+
+/**
+ * Print the memory bandwidth of a benchmark and where the pages of its data reside.
+ * The bandwidth is the modelled traffic divided by the time of the whole benchmark.
+ * For every node the pages of the data on it are counted with page_nodes(...). A page counts as local if it
+ * resides on the node of the thread whose static chunk of the data contains it, which is the thread that touched
+ * it first in the first touch mode.
+ *
+ * @param placement Placement of the threads that ran the benchmark
+ * @param data Data the threads split with a static schedule, NULL to print the bandwidth only
+ * @param size Number of bytes of the data
+ * @param bytes Number of bytes that were read and written from memory
+ * @param time Time of the benchmark in microseconds
+ */
+void print_memory_locality(ThreadPlacement *placement, const void *data, size_t size, double bytes, time_t time);
+
+#endif //HG_C_BENCHMARKS_NUMA_H
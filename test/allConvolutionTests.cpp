@@ -1,9 +1,24 @@
 //
 // Created by baldr on 7/21/17.
 //
+#include "convolutionTestHelpers.h"
 #include "utilTests.cpp"
 #include "convolutionUtilTests.cpp"
 #include "convolutionTests.cpp"
+#include "convolutionSeparableTests.cpp"
+#include "convolutionFftTests.cpp"
+#include "convolutionTemporalTests.cpp"
+#include "convolutionSimdTests.cpp"
+#include "convolutionFixedTests.cpp"
+#include "convolutionBinaryTests.cpp"
+#include "convolutionParseTests.cpp"
+#include "convolutionStreamTests.cpp"
+#include "convolutionBatchTests.cpp"
+#include "convolutionPrecisionTests.cpp"
+#include "convolutionQuantizedTests.cpp"
+#include "convolutionHaloTests.cpp"
+#include "convolutionChannelsTests.cpp"
+#include "convolutionChainTests.cpp"
 
 TEST(general, success) {
     ASSERT_TRUE(1);
@@ -0,0 +1,105 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-batch.h"
+#include "../src/convolution/convolution-batch.c"
+
+static void write_text_image(const char *path, Image *img) {
+    FILE *fd = fopen(path, "w");
+    fprintf(fd, "%d %d\n", img->height, img->width);
+    for (int y = 0; y < img->height; ++y) {
+        for (int x = 0; x < img->width; ++x) {
+            fprintf(fd, "%.17g ", img->image[y][x]);
+        }
+        fprintf(fd, "\n");
+    }
+    fclose(fd);
+}
+
+TEST(run_batch, matches_direct_engine) {
+    char input[32];
+    char output[32];
+    strcpy(input, "/tmp/hgcbatchXXXXXX");
+    strcpy(output, "/tmp/hgcresultXXXXXX");
+    ASSERT_TRUE(mkdtemp(input) != NULL);
+    ASSERT_TRUE(mkdtemp(output) != NULL);
+    const int count = 7;
+    Image *images[count];
+    for (int i = 0; i < count; ++i) {
+        // one image has another extent and forces the pool to reallocate
+        images[i] = i == 5 ? pattern_image(17, 31, -0.5, 1.0, i) : pattern_image(40, 25, -0.5, 1.0, i);
+        char path[64];
+        if (i % 2 == 0) {
+            sprintf(path, "%s/image%d.bin", input, i);
+            ASSERT_EQ(0, write_binary_image(path, images[i], PIXEL_FLOAT64, 1));
+        } else {
+            sprintf(path, "%s/image%d.txt", input, i);
+            write_text_image(path, images[i]);
+        }
+    }
+    int listed;
+    char **paths = list_batch_images(input, &listed);
+    ASSERT_EQ(count, listed);
+
+    Image *kernel = pattern_kernel(5, 5, 30.0);
+    Args args = {false, false, false, true, true, 3, 2, 0, 0, NULL, NULL};
+    args.engine = ENGINE_DIRECT;
+    args.temporal_steps = 1;
+    BatchStats stats;
+    ASSERT_EQ(0, run_batch(paths, listed, output, kernel, &args, &stats));
+    ASSERT_EQ(count, stats.images);
+    // four slots, the slot of the odd image reallocates once
+    ASSERT_EQ(2 * 4 + 2, stats.allocations);
+
+    double checksum = 0.0;
+    for (int i = 0; i < count; ++i) {
+        ImageWithPadding *expected = add_padding(images[i], 2);
+        ImageWithPadding *buffer = add_padding(images[i], 2);
+        run_on_padded_image(&expected, kernel, &args, &buffer);
+        Image *result = remove_padding(expected);
+        checksum += get_checksum(result);
+
+        char path[64];
+        sprintf(path, "%s/image%d.conv.bin", output, i);
+        ImageWithPadding *written = map_padded_image(path, 2, LAYOUT_CONTIGUOUS);
+        ASSERT_TRUE(written != NULL);
+        for (int y = 0; y < expected->height; ++y) {
+            for (int x = 0; x < expected->width; ++x) {
+                ASSERT_EQ(ACCESS_FIELD(expected, x, y), ACCESS_FIELD(written, x, y))
+                                            << "Following indices did not match: " << x << ", " << y;
+            }
+        }
+        free_padded_image(written);
+        free_image(result);
+        free_padded_image(expected);
+        free_padded_image(buffer);
+        remove(path);
+        remove(paths[i]);
+        free_image(images[i]);
+    }
+    ASSERT_EQ(checksum, stats.checksum);
+
+    free_batch_images(paths, listed);
+    free_image(kernel);
+    rmdir(input);
+    rmdir(output);
+}
+
+TEST(list_batch_images, reads_list_files) {
+    char path[32];
+    strcpy(path, "/tmp/hgclistXXXXXX");
+    close(mkstemp(path));
+    FILE *fd = fopen(path, "w");
+    fputs("first.txt\r\n\nsecond.bin\nthird image.txt  \n", fd);
+    fclose(fd);
+    int count;
+    char **paths = list_batch_images(path, &count);
+    ASSERT_EQ(3, count);
+    ASSERT_STREQ("first.txt", paths[0]);
+    ASSERT_STREQ("second.bin", paths[1]);
+    ASSERT_STREQ("third image.txt", paths[2]);
+    free_batch_images(paths, count);
+    remove(path);
+    ASSERT_TRUE(list_batch_images("/nonexistent/list", &count) == NULL);
+}
@@ -0,0 +1,128 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-binary.h"
+#include "../src/convolution/convolution-binary.c"
+
+/**
+ * Create an empty temporary file and store its path
+ */
+static void temporary_path(char *path) {
+    strcpy(path, "/tmp/hgcimgXXXXXX");
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+}
+
+TEST(binary_image, float64_is_mapped_without_copy) {
+    char path[32];
+    temporary_path(path);
+    Image *img = pattern_image(13, 7, -2.25);
+    ASSERT_EQ(0, write_binary_image(path, img, PIXEL_FLOAT64, 2));
+    ASSERT_TRUE(is_binary_image(path));
+
+    BinaryImageHeader header;
+    ASSERT_EQ(0, read_binary_image_header(path, &header));
+    ASSERT_EQ(13u, header.width);
+    ASSERT_EQ(7u, header.height);
+
+    ImageWithPadding *mapped = map_padded_image(path, 2, LAYOUT_CONTIGUOUS);
+    ASSERT_TRUE(mapped != NULL);
+    ASSERT_TRUE(mapped->mapping != NULL);
+    ImageWithPadding *expected = add_padding(img, 2);
+    for (int y = 0; y < expected->height; ++y) {
+        for (int x = 0; x < expected->width; ++x) {
+            ASSERT_EQ(ACCESS_FIELD(expected, x, y), ACCESS_FIELD(mapped, x, y))
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    // the mapping is private, changes never reach the file
+    ACCESS_IMAGE(mapped, 0, 0) = 1000.0;
+    free_padded_image(mapped);
+    mapped = map_padded_image(path, 2, LAYOUT_CONTIGUOUS);
+    ASSERT_EQ(img->image[0][0], ACCESS_IMAGE(mapped, 0, 0));
+
+    free_padded_image(mapped);
+    free_padded_image(expected);
+    free_image(img);
+    remove(path);
+}
+
+TEST(binary_image, other_padding_and_layout_are_copied) {
+    char path[32];
+    temporary_path(path);
+    Image *img = pattern_image(13, 7, -2.25);
+    ASSERT_EQ(0, write_binary_image(path, img, PIXEL_FLOAT32, 1));
+    for (int layout = LAYOUT_CONTIGUOUS; layout <= LAYOUT_ROWS; ++layout) {
+        ImageWithPadding *mapped = map_padded_image(path, 3, (ImageLayout) layout);
+        ASSERT_TRUE(mapped != NULL);
+        ASSERT_TRUE(mapped->mapping == NULL);
+        ImageWithPadding *expected = add_padding_with_layout(img, 3, (ImageLayout) layout);
+        for (int y = 0; y < expected->height; ++y) {
+            for (int x = 0; x < expected->width; ++x) {
+                ASSERT_EQ(ACCESS_FIELD(expected, x, y), ACCESS_FIELD(mapped, x, y))
+                                            << "Following indices did not match: " << x << ", " << y;
+            }
+        }
+        free_padded_image(mapped);
+        free_padded_image(expected);
+    }
+    free_image(img);
+    remove(path);
+}
+
+TEST(binary_image, integer_types_are_rounded_and_saturated) {
+    char path[32];
+    temporary_path(path);
+    Image *img = init_image(4, 1, 0);
+    img->image[0][0] = -3.0;
+    img->image[0][1] = 2.6;
+    img->image[0][2] = 300.0;
+    img->image[0][3] = 70000.0;
+    double expected_uint8[4] = {0.0, 3.0, 255.0, 255.0};
+    double expected_uint16[4] = {0.0, 3.0, 300.0, 65535.0};
+    double expected_int16[4] = {-3.0, 3.0, 300.0, 32767.0};
+    PixelType types[3] = {PIXEL_UINT8, PIXEL_UINT16, PIXEL_INT16};
+    double *expected[3] = {expected_uint8, expected_uint16, expected_int16};
+    for (int t = 0; t < 3; ++t) {
+        ASSERT_EQ(0, write_binary_image(path, img, types[t], 0));
+        ImageWithPadding *mapped = map_padded_image(path, 0, LAYOUT_CONTIGUOUS);
+        ASSERT_TRUE(mapped != NULL);
+        for (int x = 0; x < 4; ++x) {
+            ASSERT_EQ(expected[t][x], ACCESS_IMAGE(mapped, x, 0)) << pixel_type_name(types[t]) << " " << x;
+        }
+        free_padded_image(mapped);
+    }
+    free_image(img);
+    remove(path);
+}
+
+TEST(binary_image, text_and_truncated_files_are_rejected) {
+    char path[32];
+    temporary_path(path);
+    FILE *fd = fopen(path, "w");
+    fprintf(fd, "1 2\n1 2\n");
+    fclose(fd);
+    ASSERT_FALSE(is_binary_image(path));
+    ASSERT_TRUE(map_padded_image(path, 0, LAYOUT_CONTIGUOUS) == NULL);
+
+    Image *img = pattern_image(13, 7, -2.25);
+    ASSERT_EQ(0, write_binary_image(path, img, PIXEL_FLOAT64, 0));
+    ASSERT_EQ(0, truncate(path, BINARY_IMAGE_HEADER_SIZE + 8));
+    ASSERT_TRUE(is_binary_image(path));
+    BinaryImageHeader header;
+    ASSERT_EQ(-1, read_binary_image_header(path, &header));
+    ASSERT_TRUE(map_padded_image(path, 0, LAYOUT_CONTIGUOUS) == NULL);
+    free_image(img);
+    remove(path);
+}
+
+TEST(pixel_type, names_are_parsed) {
+    PixelType type;
+    for (int t = PIXEL_FLOAT64; t <= PIXEL_INT16; ++t) {
+        ASSERT_EQ(0, parse_pixel_type(pixel_type_name((PixelType) t), &type));
+        ASSERT_EQ(t, type);
+    }
+    ASSERT_EQ(-1, parse_pixel_type("int7", &type));
+}
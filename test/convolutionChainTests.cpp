@@ -0,0 +1,135 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-chain.h"
+#include "../src/convolution/convolution-chain.c"
+
+/**
+ * Blur, Laplace and sharpen, the stages have different extents
+ */
+static KernelChain *blur_laplace_sharpen_chain(void) {
+    Image *kernels[3] = {init_image(5, 5, 1.0 / 25.0), get_2d_laplace_kernel(), init_image(3, 3, 0)};
+    kernels[2]->image[0][1] = -1;
+    kernels[2]->image[1][0] = -1;
+    kernels[2]->image[1][1] = 5;
+    kernels[2]->image[1][2] = -1;
+    kernels[2]->image[2][1] = -1;
+    return init_kernel_chain(kernels, 3);
+}
+
+TEST(kernel_chain, stages_match_direct_engine) {
+    Image *img = pattern_image(37, 23);
+    KernelChain *chain = blur_laplace_sharpen_chain();
+    EXPECT_EQ(2, chain->padding);
+    Args args = {false, false, false, true, true, 1, 2, img->width, img->height, NULL, NULL};
+    args.engine = ENGINE_DIRECT;
+    ImageWithPadding *chained = add_padding(img, chain->padding);
+    ImageWithPadding *chained_buffer = add_padding(img, chain->padding);
+    run_kernel_chain(&chained, chain, &args, &chained_buffer);
+
+    // every kernel on its own with a padding of its own radius
+    Image *expected = img;
+    for (int s = 0; s < chain->stages; ++s) {
+        ImageWithPadding *padded_img = add_padding(expected, chain->kernels[s]->width / 2);
+        ImageWithPadding *padded_buffer = add_padding(expected, chain->kernels[s]->width / 2);
+        run_on_padded_image(&padded_img, chain->kernels[s], &args, &padded_buffer);
+        if (expected != img) {
+            free_image(expected);
+        }
+        expected = remove_padding(padded_img);
+        free_padded_image(padded_img);
+        free_padded_image(padded_buffer);
+    }
+    for (int y = 0; y < img->height; ++y) {
+        for (int x = 0; x < img->width; ++x) {
+            ASSERT_EQ(expected->image[y][x], ACCESS_IMAGE(chained, x, y))
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    free_image(expected);
+    free_padded_image(chained);
+    free_padded_image(chained_buffer);
+    free_kernel_chain(chain);
+    free_image(img);
+}
+
+TEST(kernel_chain, fused_stages_match_stage_by_stage) {
+    // several tiles in both directions
+    Image *img = pattern_image(2 * CHAIN_TILE_WIDTH + 45, 2 * CHAIN_TILE_HEIGHT + 21);
+    KernelChain *chain = blur_laplace_sharpen_chain();
+    Args args = {false, false, false, true, true, 2, 2, img->width, img->height, NULL, NULL};
+    args.engine = ENGINE_DIRECT;
+
+    ImageWithPadding *staged = add_padding(img, chain->padding);
+    ImageWithPadding *staged_buffer = add_padding(img, chain->padding);
+    run_kernel_chain(&staged, chain, &args, &staged_buffer);
+
+    // all stages in one group
+    chain->groups = 1;
+    chain->first_stage[1] = chain->stages;
+    ImageWithPadding *fused = add_padding(img, chain->padding);
+    ImageWithPadding *fused_buffer = add_padding(img, chain->padding);
+    run_kernel_chain(&fused, chain, &args, &fused_buffer);
+
+    // the padding is compared as well, the next iteration reads it
+    for (int y = 0; y < staged->height; ++y) {
+        for (int x = 0; x < staged->width; ++x) {
+            ASSERT_EQ(ACCESS_FIELD(staged, x, y), ACCESS_FIELD(fused, x, y))
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    free_padded_image(staged);
+    free_padded_image(staged_buffer);
+    free_padded_image(fused);
+    free_padded_image(fused_buffer);
+    free_kernel_chain(chain);
+    free_image(img);
+}
+
+TEST(kernel_chain, plan_fuses_large_images_only) {
+    KernelChain *chain = blur_laplace_sharpen_chain();
+    plan_kernel_chain(chain, 64, 64);
+    EXPECT_EQ(3, chain->groups);
+    // far larger than any cache
+    plan_kernel_chain(chain, 16384, 16384);
+    EXPECT_EQ(1, chain->groups);
+    EXPECT_EQ(3, chain->first_stage[1]);
+    free_kernel_chain(chain);
+
+    // the halos of many large kernels cost more than the stages they save
+    Image *kernels[KERNEL_CHAIN_MAX];
+    for (int s = 0; s < KERNEL_CHAIN_MAX; ++s) {
+        kernels[s] = init_image(15, 15, 1.0 / 225.0);
+    }
+    chain = init_kernel_chain(kernels, KERNEL_CHAIN_MAX);
+    plan_kernel_chain(chain, 16384, 16384);
+    EXPECT_GT(chain->groups, 1);
+    EXPECT_LT(chain->groups, KERNEL_CHAIN_MAX + 1);
+    free_kernel_chain(chain);
+}
+
+TEST(kernel_chain, empty_kernel_files_are_rejected) {
+    char empty[32];
+    char laplace[32];
+    strcpy(empty, "/tmp/hgcemptyXXXXXX");
+    strcpy(laplace, "/tmp/hgclaplaceXXXXXX");
+    close(mkstemp(empty));
+    close(mkstemp(laplace));
+    FILE *fd = fopen(laplace, "w");
+    fputs("3 3\n0 0.25 0\n0.25 -1 0.25\n0 0.25 0\n", fd);
+    fclose(fd);
+    Args args = {false, false, true, true, true, 1, 1, 16, 16, NULL, empty};
+    args.number_of_kernels = 2;
+    args.kernel_file_paths[0] = laplace;
+    args.kernel_file_paths[1] = empty;
+    EXPECT_TRUE(create_kernel_chain(&args) == NULL);
+    args.kernel_file_paths[0] = empty;
+    args.kernel_file_paths[1] = laplace;
+    EXPECT_TRUE(create_kernel_chain(&args) == NULL);
+    // the extent of the image is kept
+    EXPECT_EQ(16, args.width);
+    EXPECT_EQ(16, args.height);
+    remove(empty);
+    remove(laplace);
+}
@@ -0,0 +1,145 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-channels.h"
+#include "../src/convolution/convolution-channels.c"
+
+/**
+ * Image of width pixels with channels interleaved values each, every channel has other values
+ */
+static Image *channels_test_image(int width, int height, int channels) {
+    Image *img = pattern_image(width * channels, height, -5.0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width * channels; ++x) {
+            img->image[y][x] += (x % channels) * 0.25;
+        }
+    }
+    return img;
+}
+
+/**
+ * Convolve every channel on its own with the padded direct engine and compare it with the multi-channel image
+ */
+static void expect_channels_match_single_channel_runs(Image *img, ChannelKernels *kernels, int iterations,
+                                                      ChannelLayout layout) {
+    int channels = kernels->channels;
+    int width = img->width / channels;
+    Args args = {false, false, false, true, true, iterations, 2, width, img->height, NULL, NULL};
+    args.engine = ENGINE_DIRECT;
+    int padding = kernels->width / 2;
+    ChannelImage *channel_img = split_channels(img, channels, padding, layout);
+    ChannelImage *channel_buffer = init_channel_image(width, img->height, channels, padding, layout);
+    run_on_channel_image(&channel_img, kernels, &args, &channel_buffer);
+
+    for (int c = 0; c < channels; ++c) {
+        Image *plane = init_image(width, img->height, 0);
+        for (int y = 0; y < img->height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                plane->image[y][x] = img->image[y][x * channels + c];
+            }
+        }
+        ImageWithPadding *padded_img = add_padding(plane, padding);
+        ImageWithPadding *padded_buffer = add_padding(plane, padding);
+        run_on_padded_image(&padded_img, kernels->kernels[c], &args, &padded_buffer);
+        // the padding of the channel is clamped like the one of the padded image
+        for (int y = -padding; y < img->height + padding; ++y) {
+            for (int x = -padding; x < width + padding; ++x) {
+                double expected = ACCESS_IMAGE(padded_img, x, y);
+                ASSERT_NEAR(expected, ACCESS_CHANNEL(channel_img, c, x, y), 1e-12 * fabs(expected) + 1e-12)
+                                            << "Following indices did not match: " << x << ", " << y
+                                            << " of channel " << c << " " << channel_layout_name(layout);
+            }
+        }
+        Image *result = remove_padding(padded_img);
+        double checksum = get_checksum(result);
+        EXPECT_NEAR(checksum, get_channel_checksum(channel_img, c), 1e-9 * fabs(checksum) + 1e-9);
+        free_image(result);
+        free_padded_image(padded_img);
+        free_padded_image(padded_buffer);
+        free_image(plane);
+    }
+    free_channel_image(channel_img);
+    free_channel_image(channel_buffer);
+}
+
+TEST(channels, per_channel_kernels_match_single_channel_runs) {
+    Image *kernels[3] = {get_default_kernel(), init_image(5, 5, 1.0 / 25.0), init_image(5, 5, 0)};
+    kernels[2]->image[1][2] = 0.5;
+    kernels[2]->image[2][2] = 0.25;
+    kernels[2]->image[4][0] = -0.125;
+    ChannelKernels *channel_kernels = init_channel_kernels(kernels, 3);
+    ASSERT_TRUE(channel_kernels != NULL);
+    // more values than a block per row, so the tail of the interleaved row kernel is covered as well
+    Image *img = channels_test_image(CHANNEL_BLOCK_SIZE + 13, 11, 3);
+    expect_channels_match_single_channel_runs(img, channel_kernels, 3, CHANNELS_INTERLEAVED);
+    expect_channels_match_single_channel_runs(img, channel_kernels, 3, CHANNELS_PLANAR);
+    free_image(img);
+    free_channel_kernels(channel_kernels);
+}
+
+TEST(channels, shared_kernel_of_rgba_images) {
+    Image *kernels[4];
+    for (int c = 0; c < 4; ++c) {
+        kernels[c] = get_2d_laplace_kernel();
+    }
+    ChannelKernels *channel_kernels = init_channel_kernels(kernels, 4);
+    Image *img = channels_test_image(2 * CHANNEL_BLOCK_SIZE, 7, 4);
+    expect_channels_match_single_channel_runs(img, channel_kernels, 2, CHANNELS_INTERLEAVED);
+    expect_channels_match_single_channel_runs(img, channel_kernels, 2, CHANNELS_PLANAR);
+    free_image(img);
+    free_channel_kernels(channel_kernels);
+}
+
+TEST(channels, kernels_of_different_extent_are_rejected) {
+    Image *kernels[2] = {get_default_kernel(), get_2d_laplace_kernel()};
+    EXPECT_TRUE(init_channel_kernels(kernels, 2) == NULL);
+}
+
+TEST(channels, empty_kernel_files_are_rejected) {
+    char empty[32];
+    char laplace[32];
+    strcpy(empty, "/tmp/hgcemptyXXXXXX");
+    strcpy(laplace, "/tmp/hgclaplaceXXXXXX");
+    close(mkstemp(empty));
+    close(mkstemp(laplace));
+    FILE *fd = fopen(laplace, "w");
+    fputs("3 3\n0 0.25 0\n0.25 -1 0.25\n0 0.25 0\n", fd);
+    fclose(fd);
+    char lists[3][80];
+    snprintf(lists[0], sizeof(lists[0]), "%s", empty);
+    snprintf(lists[1], sizeof(lists[1]), "%s,%s", laplace, empty);
+    snprintf(lists[2], sizeof(lists[2]), "%s,%s", empty, laplace);
+    for (int i = 0; i < 3; ++i) {
+        Args args = {false, false, true, true, true, 1, 1, 16, 16, NULL, lists[i]};
+        args.channels = 2;
+        EXPECT_TRUE(create_channel_kernels(&args) == NULL) << lists[i];
+        // the extent of the image is kept
+        EXPECT_EQ(16, args.width);
+    }
+    remove(empty);
+    remove(laplace);
+}
+
+TEST(channels, split_rejects_incomplete_pixels) {
+    Image *img = init_image(7, 2, 1.0);
+    EXPECT_TRUE(split_channels(img, 3, 1, CHANNELS_INTERLEAVED) == NULL);
+    free_image(img);
+}
+
+TEST(channels, selected_row_kernel_matches_generic_row_kernel) {
+    Image *kernels[3] = {get_default_kernel(), get_default_kernel(), init_image(5, 5, 0.5)};
+    ChannelKernels *channel_kernels = init_channel_kernels(kernels, 3);
+    // a strip of four blocks, a whole block and a partial one
+    int count = 4 * CHANNEL_BLOCK_SIZE + CHANNEL_BLOCK_SIZE + 5;
+    Image *img = channels_test_image(count + 4 * 3, 5, 1);
+    double expected[4 * CHANNEL_BLOCK_SIZE + CHANNEL_BLOCK_SIZE + 5];
+    double actual[4 * CHANNEL_BLOCK_SIZE + CHANNEL_BLOCK_SIZE + 5];
+    apply_interleaved_kernels_to_row((const double *const *) img->image, channel_kernels, expected, count);
+    channel_kernels->interleaved((const double *const *) img->image, channel_kernels, actual, count);
+    for (int x = 0; x < count; ++x) {
+        ASSERT_NEAR(expected[x], actual[x], 1e-12 * fabs(expected[x]) + 1e-12) << "Following index did not match: " << x;
+    }
+    free_image(img);
+    free_channel_kernels(channel_kernels);
+}
@@ -0,0 +1,96 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-fft.h"
+#include "../src/convolution/convolution-fft.c"
+
+TEST(fft, inverse_restores_input) {
+    FftPlan *plan = init_fft_plan(16);
+    double re[16 * 16], im[16 * 16], expected[16 * 16];
+    for (int i = 0; i < 16 * 16; ++i) {
+        expected[i] = re[i] = (i * 7) % 13 - 6.0;
+        im[i] = 0.0;
+    }
+    fft_2d(plan, re, im, false);
+    fft_2d(plan, re, im, true);
+    for (int i = 0; i < 16 * 16; ++i) {
+        ASSERT_NEAR(expected[i], re[i] / 256.0, 1e-12) << "Following index did not match: " << i;
+        ASSERT_NEAR(0.0, im[i] / 256.0, 1e-12) << "Following index did not match: " << i;
+    }
+    free_fft_plan(plan);
+}
+
+TEST(fft, matches_discrete_fourier_transform) {
+    FftPlan *plan = init_fft_plan(8);
+    double re[8], im[8];
+    for (int i = 0; i < 8; ++i) {
+        re[i] = i + 1.0;
+        im[i] = 2.0 - i;
+    }
+    double expected_re[8], expected_im[8];
+    for (int k = 0; k < 8; ++k) {
+        expected_re[k] = expected_im[k] = 0.0;
+        for (int n = 0; n < 8; ++n) {
+            double angle = -2.0 * M_PI * k * n / 8.0;
+            expected_re[k] += re[n] * cos(angle) - im[n] * sin(angle);
+            expected_im[k] += re[n] * sin(angle) + im[n] * cos(angle);
+        }
+    }
+    fft(plan, re, im, false);
+    for (int k = 0; k < 8; ++k) {
+        ASSERT_NEAR(expected_re[k], re[k], 1e-12);
+        ASSERT_NEAR(expected_im[k], im[k], 1e-12);
+    }
+    free_fft_plan(plan);
+}
+
+TEST(fft_tile_size, tiles_fit_the_kernel_and_the_image) {
+    Image *kernel = init_image(21, 21, 1.0);
+    int size = fft_tile_size(kernel, 1024, 1024);
+    ASSERT_GE(size, 32);
+    ASSERT_LE(size, FFT_MAX_TILE_SIZE);
+    ASSERT_EQ(0, size & (size - 1));
+    // a small image is covered by one tile
+    ASSERT_EQ(64, fft_tile_size(kernel, 30, 20));
+    free_image(kernel);
+
+    Image *huge = init_image(FFT_MAX_TILE_SIZE + 1, 3, 1.0);
+    ASSERT_EQ(0, fft_tile_size(huge, 1024, 1024));
+    free_image(huge);
+}
+
+TEST(run_on_image, fft_matches_direct) {
+    Image *img = pattern_image(45, 70);
+    Image *kernel = pattern_kernel(9, 9, 100.0);
+    Args args = {false, false, false, true, true, 3, 2, 45, 70, NULL, NULL};
+    for (int layout = LAYOUT_CONTIGUOUS; layout <= LAYOUT_ROWS; ++layout) {
+        args.engine = ENGINE_DIRECT;
+        ImageWithPadding *direct = add_padding(img, 4);
+        ImageWithPadding *direct_buffer = add_padding(img, 4);
+        run_on_padded_image(&direct, kernel, &args, &direct_buffer);
+
+        args.engine = ENGINE_FFT;
+        ImageWithPadding *fft = add_padding_with_layout(img, 4, (ImageLayout) layout);
+        ImageWithPadding *fft_buffer = add_padding_with_layout(img, 4, (ImageLayout) layout);
+        run_on_padded_image(&fft, kernel, &args, &fft_buffer);
+
+        Image *expected = remove_padding(direct);
+        Image *actual = remove_padding(fft);
+        for (int y = 0; y < img->height; ++y) {
+            for (int x = 0; x < img->width; ++x) {
+                ASSERT_NEAR(expected->image[y][x], actual->image[y][x], 1e-9 * fabs(expected->image[y][x]) + 1e-9)
+                                            << "Following indices did not match: " << x << ", " << y;
+            }
+        }
+
+        free_image(expected);
+        free_image(actual);
+        free_padded_image(direct);
+        free_padded_image(direct_buffer);
+        free_padded_image(fft);
+        free_padded_image(fft_buffer);
+    }
+    free_image(kernel);
+    free_image(img);
+}
@@ -0,0 +1,65 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-fixed.h"
+#include "../src/convolution/convolution-fixed.c"
+
+/**
+ * Apply the selected implementation and the generic loop to some rows of an image and compare them
+ */
+static void expect_fixed_matches_generic(Image *kernel, const char *name) {
+    FixedKernel fixed;
+    ASSERT_TRUE(select_fixed_kernel(kernel, &fixed));
+    ASSERT_STREQ(name, fixed.name);
+
+    Image *img = pattern_image(37, 20, -5.0);
+    ImageWithPadding *padded_img = add_padding(img, kernel->width / 2);
+    double expected[37], actual[37];
+    for (int y = 0; y < img->height; ++y) {
+        const double *const *rows = (const double *const *) padded_img->image + y;
+        apply_kernel_to_row(rows, kernel, expected, img->width);
+        apply_fixed_kernel_to_row(&fixed, kernel, rows, actual, img->width);
+        for (int x = 0; x < img->width; ++x) {
+            ASSERT_NEAR(expected[x], actual[x], 1e-12 * fabs(expected[x]) + 1e-12)
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    free_padded_image(padded_img);
+    free_image(img);
+}
+
+TEST(fixed_kernel, unrolled_kernels_match_generic_loop) {
+    for (int size = 3; size <= FIXED_KERNEL_MAX_SIZE; size += 2) {
+        Image *kernel = pattern_kernel(size, size, 10.0, -0.3);
+        char name[8];
+        snprintf(name, sizeof(name), "%dx%d", size, size);
+        expect_fixed_matches_generic(kernel, name);
+        free_image(kernel);
+    }
+}
+
+TEST(fixed_kernel, baked_kernels_match_generic_loop) {
+    Image *kernel = get_default_kernel();
+    Image *laplace = get_2d_laplace_kernel();
+#ifdef CONVOLUTION_BAKED_KERNELS
+    expect_fixed_matches_generic(kernel, "default");
+    expect_fixed_matches_generic(laplace, "laplace");
+#else
+    expect_fixed_matches_generic(kernel, "5x5");
+    expect_fixed_matches_generic(laplace, "3x3");
+#endif
+    free_image(kernel);
+    free_image(laplace);
+}
+
+TEST(fixed_kernel, other_kernels_use_row_kernel) {
+    Image *wide = init_image(5, 3, 1.0);
+    Image *large = init_image(9, 9, 1.0);
+    FixedKernel fixed;
+    ASSERT_FALSE(select_fixed_kernel(wide, &fixed));
+    ASSERT_FALSE(select_fixed_kernel(large, &fixed));
+    ASSERT_STREQ(row_kernel_name(select_row_kernel()), fixed.name);
+    free_image(wide);
+    free_image(large);
+}
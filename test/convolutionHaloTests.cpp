@@ -0,0 +1,56 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-halo.h"
+#include "../src/convolution/convolution-halo.c"
+
+/**
+ * Run the padded direct engine and the virtual halo on the same image and compare the results
+ */
+static void expect_virtual_halo_matches_padded(int width, int height, Image *kernel, int iterations) {
+    Image *img = pattern_image(width, height, -5.0);
+    Args args = {false, false, false, true, true, iterations, 2, width, height, NULL, NULL};
+    args.engine = ENGINE_DIRECT;
+    ImageWithPadding *padded_img = add_padding(img, kernel->width / 2);
+    ImageWithPadding *padded_buffer = add_padding(img, kernel->width / 2);
+    run_on_padded_image(&padded_img, kernel, &args, &padded_buffer);
+
+    args.virtual_halo = true;
+    ImageWithPadding *halo_img = add_padding(img, 0);
+    ImageWithPadding *halo_buffer = add_padding(img, 0);
+    run_on_padded_image(&halo_img, kernel, &args, &halo_buffer);
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            double expected = ACCESS_IMAGE(padded_img, x, y);
+            ASSERT_NEAR(expected, ACCESS_IMAGE(halo_img, x, y), 1e-12 * fabs(expected) + 1e-12)
+                                        << "Following indices did not match: " << x << ", " << y << " for "
+                                        << width << "x" << height;
+        }
+    }
+    free_padded_image(padded_img);
+    free_padded_image(padded_buffer);
+    free_padded_image(halo_img);
+    free_padded_image(halo_buffer);
+    free_image(img);
+}
+
+TEST(virtual_halo, matches_padded_direct_engine) {
+    for (int size = 3; size <= 9; size += 2) {
+        Image *kernel = pattern_kernel(size, size, 10.0, -0.3);
+        expect_virtual_halo_matches_padded(41, 23, kernel, 3);
+        free_image(kernel);
+    }
+    Image *kernel = get_default_kernel();
+    expect_virtual_halo_matches_padded(64, 64, kernel, 2);
+    free_image(kernel);
+}
+
+TEST(virtual_halo, images_smaller_than_the_kernel) {
+    Image *kernel = init_image(7, 7, 1.0 / 49.0);
+    expect_virtual_halo_matches_padded(1, 1, kernel, 2);
+    expect_virtual_halo_matches_padded(3, 2, kernel, 2);
+    expect_virtual_halo_matches_padded(7, 4, kernel, 2);
+    free_image(kernel);
+}
@@ -0,0 +1,115 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-parse.h"
+#include "../src/convolution/convolution-parse.c"
+
+TEST(parse_double, matches_strtod) {
+    const char *numbers[] = {"0", "-0", "1", "+2.5", "-3.75", "0.1", "0.30000000000000004", ".5", "5.", "1e10",
+                             "1E-10", "-2.5e+3", "123456789012345678", "1234567890123456789012345",
+                             "0.000000000000000000000000001234", "9007199254740993", "1.7976931348623157e308",
+                             "4.9e-324", "1e400", "1e-400", "0.00001", "2.2250738585072014e-308", "inf", "-nan",
+                             "0.123456789012345678901234567890"};
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i) {
+        double value;
+        const char *end = parse_double(numbers[i], &value);
+        char *expected_end;
+        double expected = strtod(numbers[i], &expected_end);
+        ASSERT_EQ(expected_end, end) << numbers[i];
+        if (expected != expected) {
+            ASSERT_NE(value, value) << numbers[i];
+        } else {
+            ASSERT_EQ(0, memcmp(&expected, &value, sizeof(double))) << numbers[i];
+        }
+    }
+}
+
+TEST(parse_double, matches_strtod_for_random_values) {
+    srand(42);
+    char buf[64];
+    for (int i = 0; i < 100000; ++i) {
+        double number = ((double) rand() / RAND_MAX - 0.5) * pow(10.0, rand() % 40 - 20);
+        snprintf(buf, sizeof(buf), i % 2 == 0 ? "%.17g" : "%f", number);
+        double value;
+        parse_double(buf, &value);
+        ASSERT_EQ(strtod(buf, NULL), value) << buf;
+    }
+}
+
+TEST(parse_double, rejects_non_numbers) {
+    double value;
+    ASSERT_TRUE(parse_double("x1", &value) == NULL);
+    ASSERT_TRUE(parse_double("-", &value) == NULL);
+    ASSERT_TRUE(parse_double(".", &value) == NULL);
+    ASSERT_TRUE(parse_double(" 1", &value) == NULL);
+    // the exponent is not part of the number without digits
+    const char *text = "2e+";
+    ASSERT_EQ(text + 1, parse_double(text, &value));
+    ASSERT_EQ(2.0, value);
+}
+
+TEST(parse_text_image, long_lines_in_parallel) {
+    // every row is longer than any fixed line buffer and the file is larger than one block
+    const int width = 3000;
+    const int height = 3000;
+    FILE *fd = tmpfile();
+    ASSERT_TRUE(fd != NULL);
+    fprintf(fd, "%d %d\n", height, width);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            fputc('0' + (x * 7 + y * 3) % 10, fd);
+            fputc(x + 1 < width ? ' ' : '\n', fd);
+        }
+    }
+    rewind(fd);
+    TextParseStats stats;
+    Image *img = parse_text_image(fd, 3, &stats);
+    fclose(fd);
+    ASSERT_TRUE(img != NULL);
+    ASSERT_EQ(width, img->width);
+    ASSERT_EQ(height, img->height);
+    ASSERT_GT(stats.bytes, (size_t) TEXT_PARSE_BLOCK_SIZE);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            ASSERT_EQ((double) ((x * 7 + y * 3) % 10), img->image[y][x])
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    free_image(img);
+}
+
+TEST(parse_text_image, separators_and_missing_newline) {
+    FILE *fd = tmpfile();
+    ASSERT_TRUE(fd != NULL);
+    // windows line endings, tabs, values behind the width and extra lines are accepted
+    fputs("3 2\r\n1.5\t-2 7\r\n  3e1 4  \n5 .25\n6 6 6\n", fd);
+    rewind(fd);
+    Image *img = parse_text_image(fd, 2, NULL);
+    fclose(fd);
+    ASSERT_TRUE(img != NULL);
+    double expected[3][2] = {{1.5, -2.0},
+                             {30.0, 4.0},
+                             {5.0, 0.25}};
+    for (int y = 0; y < 3; ++y) {
+        for (int x = 0; x < 2; ++x) {
+            ASSERT_EQ(expected[y][x], img->image[y][x]);
+        }
+    }
+    free_image(img);
+
+    fd = tmpfile();
+    fputs("1 2\n8 9", fd);
+    rewind(fd);
+    img = parse_text_image(fd, 1, NULL);
+    fclose(fd);
+    ASSERT_EQ(8.0, img->image[0][0]);
+    ASSERT_EQ(9.0, img->image[0][1]);
+    free_image(img);
+}
+
+TEST(parse_text_image, empty_file) {
+    FILE *fd = tmpfile();
+    ASSERT_TRUE(parse_text_image(fd, 1, NULL) == NULL);
+    fclose(fd);
+}
@@ -0,0 +1,127 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-precision.h"
+#include "../src/convolution/convolution-precision.c"
+
+/**
+ * Convolve an image in double precision and in the given type, the padding is the one of the kernel
+ */
+static void convolve_both(Image *img, Image *kernel, int iterations, PixelType type, Image **expected,
+                          TypedImage **actual) {
+    Args args = {false, false, false, true, true, iterations, 2, img->width, img->height, NULL, NULL};
+    ImageWithPadding *padded_img = add_padding(img, kernel->width / 2);
+    ImageWithPadding *padded_buffer = add_padding(img, kernel->width / 2);
+    TypedImage *typed_img = convert_padded_image(padded_img, type);
+    TypedImage *typed_buffer = convert_padded_image(padded_img, type);
+
+    run_on_padded_image(&padded_img, kernel, &args, &padded_buffer);
+    run_on_typed_image(&typed_img, kernel, &args, &typed_buffer);
+
+    *expected = remove_padding(padded_img);
+    *actual = typed_img;
+    free_typed_image(typed_buffer);
+    free_padded_image(padded_img);
+    free_padded_image(padded_buffer);
+}
+
+TEST(precision, float32_is_close_to_float64) {
+    // wider than a block, so the tail of the row is covered as well
+    Image *img = pattern_image(PRECISION_BLOCK_SIZE + 37, 23, 0.0, 0.25);
+    Image *kernel = get_default_kernel();
+    Image *expected;
+    TypedImage *actual;
+    convolve_both(img, kernel, 3, PIXEL_FLOAT32, &expected, &actual);
+    for (int y = 0; y < img->height; ++y) {
+        const float *row = (const float *) typed_row(actual, y + actual->padding) + actual->padding;
+        for (int x = 0; x < img->width; ++x) {
+            ASSERT_NEAR(expected->image[y][x], row[x], 1e-5 * fabs(expected->image[y][x]) + 1e-5)
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    double checksum = get_checksum(expected);
+    EXPECT_NEAR(checksum, get_typed_checksum(actual), 1e-5 * fabs(checksum));
+    free_typed_image(actual);
+    free_image(expected);
+    free_image(kernel);
+    free_image(img);
+}
+
+TEST(precision, uint16_rounds_the_float64_result) {
+    Image *img = pattern_image(61, 17, 0.0, 1000.0);
+    Image *kernel = get_default_kernel();
+    Image *expected;
+    TypedImage *actual;
+    convolve_both(img, kernel, 1, PIXEL_UINT16, &expected, &actual);
+    for (int y = 0; y < img->height; ++y) {
+        const uint16_t *row = (const uint16_t *) typed_row(actual, y + actual->padding) + actual->padding;
+        for (int x = 0; x < img->width; ++x) {
+            double value = expected->image[y][x] < 0.0 ? 0.0 : expected->image[y][x];
+            // float accumulation may round the other way for values close to .5
+            ASSERT_NEAR(value, row[x], 0.5 + 1e-3) << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    free_typed_image(actual);
+    free_image(expected);
+    free_image(kernel);
+    free_image(img);
+}
+
+TEST(precision, uint8_saturates) {
+    Image *img = pattern_image(13, 9, 0.0, 30.0);
+    img->image[0][0] = -3.0;
+    img->image[0][1] = 2.5;
+    img->image[0][2] = 300.0;
+    ImageWithPadding *padded_img = add_padding(img, 1);
+    TypedImage *typed = convert_padded_image(padded_img, PIXEL_UINT8);
+    const uint8_t *row = (const uint8_t *) typed_row(typed, 1);
+    EXPECT_EQ(0, row[1]);
+    EXPECT_EQ(3, row[2]);
+    EXPECT_EQ(255, row[3]);
+    // the clamped border is converted as well
+    EXPECT_EQ(0, row[0]);
+    EXPECT_EQ(0, ((const uint8_t *) typed_row(typed, 0))[0]);
+
+    // doubling every value saturates everything above 127
+    Image *kernel = init_image(3, 3, 0);
+    kernel->image[1][1] = 2.0;
+    Args args = {false, false, false, true, true, 1, 2, img->width, img->height, NULL, NULL};
+    TypedImage *buffer = convert_padded_image(padded_img, PIXEL_UINT8);
+    run_on_typed_image(&typed, kernel, &args, &buffer);
+    for (int y = 0; y < img->height; ++y) {
+        const uint8_t *out = (const uint8_t *) typed_row(typed, y + 1) + 1;
+        for (int x = 0; x < img->width; ++x) {
+            double value = 2.0 * round(img->image[y][x] < 0.0 ? 0.0 : img->image[y][x]);
+            EXPECT_EQ(value > 255.0 ? 255 : (int) value, out[x]) << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    free_typed_image(buffer);
+    free_typed_image(typed);
+    free_image(kernel);
+    free_padded_image(padded_img);
+    free_image(img);
+}
+
+TEST(precision, typed_borders_are_clamped) {
+    Image *img = pattern_image(7, 5);
+    ImageWithPadding *padded_img = add_padding(img, 2);
+    TypedImage *typed = init_typed_image(7, 5, 2, PIXEL_UINT16);
+    EXPECT_EQ(0, typed->stride % (IMAGE_ALIGNMENT / 2));
+    for (int y = 0; y < img->height; ++y) {
+        for (int x = 0; x < img->width; ++x) {
+            ((uint16_t *) typed_row(typed, y + 2))[x + 2] = (uint16_t) img->image[y][x];
+        }
+    }
+    update_typed_borders(typed);
+    for (int y = 0; y < typed->height; ++y) {
+        const uint16_t *row = (const uint16_t *) typed_row(typed, y);
+        for (int x = 0; x < typed->width; ++x) {
+            ASSERT_EQ(ACCESS_FIELD(padded_img, x, y), row[x]) << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    EXPECT_EQ(get_checksum(img), get_typed_checksum(typed));
+    free_typed_image(typed);
+    free_padded_image(padded_img);
+    free_image(img);
+}
@@ -0,0 +1,225 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-quantized.h"
+#include "../src/convolution/convolution-quantized.c"
+
+/**
+ * Kernel of kernel.txt, all coefficients are multiples of 0.125
+ */
+static Image *quantized_test_kernel(void) {
+    Image *kernel = init_image(5, 5, 0);
+    kernel->image[1][2] = 0.125;
+    kernel->image[2][1] = 0.125;
+    kernel->image[2][2] = 0.5;
+    kernel->image[2][3] = 0.125;
+    kernel->image[3][2] = 0.125;
+    return kernel;
+}
+
+static Image *quantized_test_image(int width, int height) {
+    Image *img = init_image(width, height, 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            img->image[y][x] = (x * 37 + y * 101) % 256;
+        }
+    }
+    return img;
+}
+
+TEST(quantize_kernel, dyadic_kernels_are_lossless) {
+    Image *kernel = quantized_test_kernel();
+    QuantizedKernel *quantized = quantize_kernel(kernel, DEFAULT_QUANTIZE_TOLERANCE);
+    ASSERT_TRUE(quantized != NULL);
+    EXPECT_EQ(3, quantized->shift);
+    EXPECT_EQ(0.0, quantized->error);
+    EXPECT_EQ(4, quantized->coefficients[2 * 5 + 2]);
+    // the pair of the odd last tap has a zero high half
+    EXPECT_EQ(0, quantized->pairs[2 * 3 + 2] >> 16);
+    free_quantized_kernel(quantized);
+    free_image(kernel);
+
+    kernel = get_default_kernel();
+    quantized = quantize_kernel(kernel, DEFAULT_QUANTIZE_TOLERANCE);
+    ASSERT_TRUE(quantized != NULL);
+    EXPECT_EQ(0, quantized->shift);
+    free_quantized_kernel(quantized);
+    free_image(kernel);
+}
+
+TEST(quantize_kernel, tolerance_accepts_rounded_coefficients) {
+    Image *kernel = init_image(3, 3, 1.0 / 9.0);
+    ASSERT_TRUE(quantize_kernel(kernel, DEFAULT_QUANTIZE_TOLERANCE) == NULL);
+    QuantizedKernel *quantized = quantize_kernel(kernel, 1e-2);
+    ASSERT_TRUE(quantized != NULL);
+    EXPECT_LE(quantized->error, 1e-2);
+    // a tighter tolerance needs more fraction bits
+    QuantizedKernel *tighter = quantize_kernel(kernel, 1e-3);
+    ASSERT_TRUE(tighter != NULL);
+    EXPECT_GT(tighter->shift, quantized->shift);
+    EXPECT_LE(tighter->error, 1e-3);
+    free_quantized_kernel(tighter);
+    free_quantized_kernel(quantized);
+    free_image(kernel);
+}
+
+TEST(quantize_kernel, coefficients_fit_into_int16) {
+    // 2.0 needs 15 integer bits with the 14 fraction bits of the small neighbour, which wrapped to -32768
+    Image *kernel = init_image(3, 3, 0);
+    kernel->image[1][1] = 2.0;
+    kernel->image[1][2] = 3.0 / 16384.0;
+    ASSERT_TRUE(quantize_kernel(kernel, 0.0) == NULL);
+    // fewer fraction bits keep 2.0 in range
+    kernel->image[1][2] = 0.25;
+    QuantizedKernel *quantized = quantize_kernel(kernel, 0.0);
+    ASSERT_TRUE(quantized != NULL);
+    EXPECT_EQ(2, quantized->shift);
+    EXPECT_EQ(8, quantized->coefficients[1 * 3 + 1]);
+    free_quantized_kernel(quantized);
+    free_image(kernel);
+
+    Image *img = init_image(20, 3, 100.0);
+    kernel = init_image(3, 3, 0);
+    kernel->image[1][1] = 2.0;
+    Args args = {false, false, false, true, true, 1, 1, 20, 3, NULL, NULL};
+    args.engine = ENGINE_QUANTIZED;
+    ImageWithPadding *padded_img = add_padding(img, 1);
+    ImageWithPadding *padded_buffer = add_padding(img, 1);
+    run_on_padded_image(&padded_img, kernel, &args, &padded_buffer);
+    EXPECT_EQ(200.0, ACCESS_IMAGE(padded_img, 10, 1));
+    free_padded_image(padded_img);
+    free_padded_image(padded_buffer);
+    free_image(kernel);
+    free_image(img);
+}
+
+TEST(quantized_row, simd_matches_generic) {
+    // odd and even kernel widths and a tail that is not a multiple of 16 windows
+    for (int size = 3; size <= 6; ++size) {
+        Image *kernel = init_image(size, size, 0);
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                kernel->image[y][x] = ((x * 5 + y * 3) % 7 - 3) / 16.0;
+            }
+        }
+        QuantizedKernel *quantized = quantize_kernel(kernel, DEFAULT_QUANTIZE_TOLERANCE);
+        ASSERT_TRUE(quantized != NULL);
+        const int count = 53;
+        int16_t values[6][count + 6];
+        const int16_t *rows[6];
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < count + size - 1; ++x) {
+                values[y][x] = (int16_t) ((x * 811 + y * 1543) % 20000 - 10000);
+            }
+            rows[y] = values[y];
+        }
+        int16_t expected[count], actual[count];
+        apply_quantized_kernel_to_row(rows, quantized, expected, count);
+        select_quantized_row_kernel()(rows, quantized, actual, count);
+        for (int x = 0; x < count; ++x) {
+            ASSERT_EQ(expected[x], actual[x]) << "Following index did not match: " << x << ", size " << size;
+        }
+        free_quantized_kernel(quantized);
+        free_image(kernel);
+    }
+}
+
+TEST(run_on_image, quantized_rounds_the_direct_result) {
+    Image *img = quantized_test_image(45, 19);
+    Image *kernel = quantized_test_kernel();
+    Args args = {false, false, false, true, true, 1, 2, 45, 19, NULL, NULL};
+
+    args.engine = ENGINE_DIRECT;
+    ImageWithPadding *direct = add_padding(img, 2);
+    ImageWithPadding *direct_buffer = add_padding(img, 2);
+    run_on_padded_image(&direct, kernel, &args, &direct_buffer);
+
+    args.engine = ENGINE_QUANTIZED;
+    ImageWithPadding *quantized = add_padding(img, 2);
+    ImageWithPadding *quantized_buffer = add_padding(img, 2);
+    run_on_padded_image(&quantized, kernel, &args, &quantized_buffer);
+
+    for (int y = 0; y < img->height; ++y) {
+        for (int x = 0; x < img->width; ++x) {
+            ASSERT_EQ(floor(ACCESS_IMAGE(direct, x, y) + 0.5), ACCESS_IMAGE(quantized, x, y))
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    // the borders of the result are clamped like the ones of the direct engine
+    ASSERT_EQ(ACCESS_IMAGE(quantized, 0, 0), ACCESS_FIELD(quantized, 0, 0));
+
+    free_padded_image(direct);
+    free_padded_image(direct_buffer);
+    free_padded_image(quantized);
+    free_padded_image(quantized_buffer);
+    free_image(kernel);
+    free_image(img);
+}
+
+TEST(run_on_image, quantized_saturates) {
+    Image *img = init_image(20, 3, 10000.0);
+    img->image[1][5] = -10000.0;
+    Image *kernel = init_image(3, 3, 0);
+    kernel->image[1][1] = 4.0;
+    Args args = {false, false, false, true, true, 1, 1, 20, 3, NULL, NULL};
+    args.engine = ENGINE_QUANTIZED;
+    ImageWithPadding *padded_img = add_padding(img, 1);
+    ImageWithPadding *padded_buffer = add_padding(img, 1);
+    run_on_padded_image(&padded_img, kernel, &args, &padded_buffer);
+    EXPECT_EQ(INT16_MAX, ACCESS_IMAGE(padded_img, 0, 0));
+    EXPECT_EQ(INT16_MIN, ACCESS_IMAGE(padded_img, 5, 1));
+    free_padded_image(padded_img);
+    free_padded_image(padded_buffer);
+    free_image(kernel);
+    free_image(img);
+}
+
+TEST(quantize_padded_image, rejects_values_that_are_not_int16) {
+    double rejected[] = {NAN, INFINITY, -INFINITY, 32768.0, -32769.0, 1e300, 0.5};
+    for (double value : rejected) {
+        Image *img = init_image(5, 4, 7.0);
+        img->image[2][3] = value;
+        ImageWithPadding *padded_img = add_padding(img, 1);
+        ASSERT_TRUE(quantize_padded_image(padded_img, 2) == NULL) << "value " << value;
+        free_padded_image(padded_img);
+        free_image(img);
+    }
+    Image *img = init_image(5, 4, INT16_MAX);
+    img->image[2][3] = INT16_MIN;
+    ImageWithPadding *padded_img = add_padding(img, 1);
+    TypedImage *quantized = quantize_padded_image(padded_img, 2);
+    ASSERT_TRUE(quantized != NULL);
+    EXPECT_EQ(INT16_MIN, ((int16_t *) typed_row(quantized, 2 + 1))[3 + 1]);
+    free_typed_image(quantized);
+    free_padded_image(padded_img);
+    free_image(img);
+}
+
+TEST(run_on_image, quantized_falls_back_for_fractional_images) {
+    Image *img = init_image(9, 7, 0.5);
+    img->image[3][4] = 2.25;
+    Image *kernel = quantized_test_kernel();
+    Args args = {false, false, false, true, true, 2, 1, 9, 7, NULL, NULL};
+
+    args.engine = ENGINE_DIRECT;
+    ImageWithPadding *direct = add_padding(img, 2);
+    ImageWithPadding *direct_buffer = add_padding(img, 2);
+    run_on_padded_image(&direct, kernel, &args, &direct_buffer);
+
+    args.engine = ENGINE_QUANTIZED;
+    ImageWithPadding *quantized = add_padding(img, 2);
+    ImageWithPadding *quantized_buffer = add_padding(img, 2);
+    run_on_padded_image(&quantized, kernel, &args, &quantized_buffer);
+    for (int y = 0; y < img->height; ++y) {
+        for (int x = 0; x < img->width; ++x) {
+            ASSERT_EQ(ACCESS_IMAGE(direct, x, y), ACCESS_IMAGE(quantized, x, y));
+        }
+    }
+    free_padded_image(direct);
+    free_padded_image(direct_buffer);
+    free_padded_image(quantized);
+    free_padded_image(quantized_buffer);
+    free_image(kernel);
+    free_image(img);
+}
@@ -0,0 +1,108 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-separable.h"
+#include "../src/convolution/convolution-separable.c"
+
+/**
+ * Multiply the decomposition out and compare it with the kernel
+ */
+static void expect_decomposition_matches(SeparableKernel *separable, Image *kernel) {
+    for (int y = 0; y < kernel->height; ++y) {
+        for (int x = 0; x < kernel->width; ++x) {
+            double value = 0.0;
+            for (int r = 0; r < separable->rank; ++r) {
+                value += separable->vertical[r * kernel->height + y] * separable->horizontal[r * kernel->width + x];
+            }
+            EXPECT_NEAR(kernel->image[y][x], value, 1e-12) << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+}
+
+TEST(separate_kernel, gaussian_is_rank_one) {
+    double binomial[5] = {1, 4, 6, 4, 1};
+    Image *kernel = init_image(5, 5, 0);
+    for (int y = 0; y < 5; ++y) {
+        for (int x = 0; x < 5; ++x) {
+            kernel->image[y][x] = binomial[y] * binomial[x] / 256.0;
+        }
+    }
+    SeparableKernel *separable = separate_kernel(kernel, DEFAULT_SEPARABLE_TOLERANCE);
+    ASSERT_TRUE(separable != NULL);
+    ASSERT_EQ(1, separable->rank);
+    expect_decomposition_matches(separable, kernel);
+
+    free_separable_kernel(separable);
+    free_image(kernel);
+}
+
+TEST(separate_kernel, default_kernel_is_rank_two) {
+    Image *kernel = get_default_kernel();
+    SeparableKernel *separable = separate_kernel(kernel, DEFAULT_SEPARABLE_TOLERANCE);
+    ASSERT_TRUE(separable != NULL);
+    ASSERT_EQ(2, separable->rank);
+    expect_decomposition_matches(separable, kernel);
+
+    free_separable_kernel(separable);
+    free_image(kernel);
+}
+
+TEST(separate_kernel, small_and_full_rank_kernels_are_rejected) {
+    Image *laplace = get_2d_laplace_kernel();
+    ASSERT_TRUE(separate_kernel(laplace, DEFAULT_SEPARABLE_TOLERANCE) == NULL);
+    free_image(laplace);
+
+    Image *kernel = init_image(5, 5, 0);
+    for (int y = 0; y < 5; ++y) {
+        kernel->image[y][(y * 2) % 5] = 1.0 + y;
+    }
+    ASSERT_TRUE(separate_kernel(kernel, DEFAULT_SEPARABLE_TOLERANCE) == NULL);
+    free_image(kernel);
+}
+
+TEST(separate_kernel, tolerance_accepts_nearly_separable_kernel) {
+    Image *kernel = init_image(5, 5, 1.0);
+    kernel->image[0][0] = 1.0 + 1e-6;
+    ASSERT_TRUE(separate_kernel(kernel, DEFAULT_SEPARABLE_TOLERANCE) != NULL);
+    SeparableKernel *separable = separate_kernel(kernel, 1e-5);
+    ASSERT_TRUE(separable != NULL);
+    ASSERT_EQ(1, separable->rank);
+
+    free_separable_kernel(separable);
+    free_image(kernel);
+}
+
+TEST(run_on_image, separable_matches_direct) {
+    Image *img = pattern_image(37, 70);
+    Args args = {false, false, false, true, true, 3, 2, 37, 70, NULL, NULL};
+    Image *kernel = get_default_kernel();
+
+    args.engine = ENGINE_DIRECT;
+    ImageWithPadding *direct = add_padding(img, 2);
+    ImageWithPadding *direct_buffer = add_padding(img, 2);
+    run_on_padded_image(&direct, kernel, &args, &direct_buffer);
+
+    args.engine = ENGINE_SEPARABLE;
+    ImageWithPadding *separable = add_padding_with_layout(img, 2, LAYOUT_ROWS);
+    ImageWithPadding *separable_buffer = add_padding_with_layout(img, 2, LAYOUT_ROWS);
+    run_on_padded_image(&separable, kernel, &args, &separable_buffer);
+
+    Image *expected = remove_padding(direct);
+    Image *actual = remove_padding(separable);
+    for (int y = 0; y < img->height; ++y) {
+        for (int x = 0; x < img->width; ++x) {
+            ASSERT_NEAR(expected->image[y][x], actual->image[y][x], 1e-9 * fabs(expected->image[y][x]) + 1e-9)
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+
+    free_image(expected);
+    free_image(actual);
+    free_padded_image(direct);
+    free_padded_image(direct_buffer);
+    free_padded_image(separable);
+    free_padded_image(separable_buffer);
+    free_image(kernel);
+    free_image(img);
+}
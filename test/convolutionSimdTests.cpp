@@ -0,0 +1,64 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-simd.h"
+#include "../src/convolution/convolution-simd.c"
+
+/**
+ * Apply a row kernel to every row of an image and compare it with the scalar row kernel
+ */
+static void expect_row_kernel_matches_scalar(RowKernel row_kernel, int width, int kernel_width, int kernel_height,
+                                             ImageLayout layout) {
+    Image *img = pattern_image(width, 9, -5.0);
+    Image *kernel = pattern_kernel(kernel_width, kernel_height, 10.0, -0.3);
+    ImageWithPadding *padded_img = add_padding_with_layout(img, kernel_width > kernel_height ? kernel_width / 2
+                                                                                             : kernel_height / 2,
+                                                           layout);
+    double *expected = (double *) malloc(sizeof(double) * width);
+    double *actual = (double *) malloc(sizeof(double) * (width + 1));
+    for (int y = 0; y < img->height; ++y) {
+        const double *const *rows = (const double *const *) padded_img->image + y;
+        apply_kernel_to_row(rows, kernel, expected, width);
+        // the value behind the row must not be written
+        actual[width] = 42.0;
+        row_kernel(rows, kernel, actual, width);
+        ASSERT_EQ(42.0, actual[width]);
+        for (int x = 0; x < width; ++x) {
+            ASSERT_NEAR(expected[x], actual[x], 1e-12 * fabs(expected[x]) + 1e-12)
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+    free(expected);
+    free(actual);
+    free_padded_image(padded_img);
+    free_image(kernel);
+    free_image(img);
+}
+
+TEST(row_kernel, simd_kernels_match_scalar) {
+    RowKernel kernels[2] = {apply_kernel_to_row_avx2, apply_kernel_to_row_avx512};
+    bool supported[2] = {simd_supports_avx2(), simd_supports_avx512()};
+    for (int k = 0; k < 2; ++k) {
+        if (!supported[k]) {
+            continue;
+        }
+        // widths with and without tails of the strips
+        int widths[5] = {1, 7, 32, 45, 100};
+        for (int w = 0; w < 5; ++w) {
+            expect_row_kernel_matches_scalar(kernels[k], widths[w], 9, 9, LAYOUT_CONTIGUOUS);
+            expect_row_kernel_matches_scalar(kernels[k], widths[w], 4, 2, LAYOUT_ROWS);
+        }
+    }
+}
+
+TEST(row_kernel, selection_prefers_widest) {
+    RowKernel kernel = select_row_kernel();
+    if (simd_supports_avx512()) {
+        ASSERT_STREQ("avx512", row_kernel_name(kernel));
+    } else if (simd_supports_avx2()) {
+        ASSERT_STREQ("avx2", row_kernel_name(kernel));
+    } else {
+        ASSERT_STREQ("scalar", row_kernel_name(kernel));
+    }
+}
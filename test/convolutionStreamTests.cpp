@@ -0,0 +1,74 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-stream.h"
+#include "../src/convolution/convolution-stream.c"
+
+/**
+ * Stream the image through a file and expect the bits of the in-memory direct engine, padding included
+ */
+static void expect_streaming_is_exact(Image *img, PixelType type, int stored_padding, Image *kernel, int iterations,
+                                      int band_rows) {
+    char input[32];
+    char output[32];
+    strcpy(input, "/tmp/hgcinXXXXXX");
+    strcpy(output, "/tmp/hgcoutXXXXXX");
+    close(mkstemp(input));
+    close(mkstemp(output));
+    ASSERT_EQ(0, write_binary_image(input, img, type, stored_padding));
+
+    Args args = {false, false, false, true, true, iterations, 2, img->width, img->height, NULL, NULL};
+    args.engine = ENGINE_DIRECT;
+    args.temporal_steps = 1;
+    args.stream_band_rows = band_rows;
+    int padding = kernel->width / 2;
+
+    // the reference starts from the stored values, which may have been rounded
+    ImageWithPadding *direct = map_padded_image(input, padding, LAYOUT_CONTIGUOUS);
+    ImageWithPadding *direct_buffer = map_padded_image(input, padding, LAYOUT_CONTIGUOUS);
+    run_on_padded_image(&direct, kernel, &args, &direct_buffer);
+    Image *expected = remove_padding(direct);
+
+    StreamStats stats;
+    double checksum = stream_convolution(input, output, kernel, &args, &stats);
+    ASSERT_EQ(get_checksum(expected), checksum);
+    ASSERT_GT(stats.bytes_read, 0u);
+    ASSERT_GT(stats.bytes_written, 0u);
+    ASSERT_EQ(checksum, stream_convolution(input, NULL, kernel, &args, NULL));
+
+    ImageWithPadding *streamed = map_padded_image(output, padding, LAYOUT_CONTIGUOUS);
+    ASSERT_TRUE(streamed != NULL);
+    // the result is stored with the padding of the kernel and can be mapped without copying
+    ASSERT_TRUE(streamed->mapping != NULL);
+    for (int y = 0; y < direct->height; ++y) {
+        for (int x = 0; x < direct->width; ++x) {
+            ASSERT_EQ(ACCESS_FIELD(direct, x, y), ACCESS_FIELD(streamed, x, y))
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+
+    free_padded_image(streamed);
+    free_image(expected);
+    free_padded_image(direct);
+    free_padded_image(direct_buffer);
+    remove(input);
+    remove(output);
+}
+
+TEST(stream_convolution, matches_direct) {
+    Image *img = pattern_image(70, 45, 0.1);
+    Image *kernel = pattern_kernel(5, 5, 30.0);
+    // the band height does not divide the image height
+    expect_streaming_is_exact(img, PIXEL_FLOAT64, 2, kernel, 3, 7);
+    // bands thinner than the halo and an input that has to be converted
+    expect_streaming_is_exact(img, PIXEL_FLOAT32, 0, kernel, 4, 1);
+    // a single band
+    expect_streaming_is_exact(img, PIXEL_UINT16, 5, kernel, 1, 100);
+
+    Image *laplace = get_2d_laplace_kernel();
+    expect_streaming_is_exact(img, PIXEL_FLOAT64, 1, laplace, 2, 16);
+    free_image(laplace);
+    free_image(kernel);
+    free_image(img);
+}
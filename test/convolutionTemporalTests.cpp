@@ -0,0 +1,73 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <gtest/gtest.h>
+#include "../src/convolution/convolution-temporal.h"
+#include "../src/convolution/convolution-temporal.c"
+
+/**
+ * Apply the kernel with and without temporal blocking and expect identical bits
+ */
+static void expect_temporal_blocking_is_exact(Image *img, Image *kernel, int iterations, int steps) {
+    Args args = {false, false, false, true, true, iterations, 2, img->width, img->height, NULL, NULL};
+    args.engine = ENGINE_DIRECT;
+    int padding = kernel->width / 2;
+
+    args.temporal_steps = 1;
+    ImageWithPadding *direct = add_padding(img, padding);
+    ImageWithPadding *direct_buffer = add_padding(img, padding);
+    run_on_padded_image(&direct, kernel, &args, &direct_buffer);
+
+    args.temporal_steps = steps;
+    ImageWithPadding *blocked = add_padding(img, padding);
+    ImageWithPadding *blocked_buffer = add_padding(img, padding);
+    ASSERT_TRUE(temporal_blocking_supported(blocked, kernel));
+    run_on_padded_image(&blocked, kernel, &args, &blocked_buffer);
+
+    // the padding is compared as well, the next iteration reads it
+    for (int y = 0; y < direct->height; ++y) {
+        for (int x = 0; x < direct->width; ++x) {
+            ASSERT_EQ(ACCESS_FIELD(direct, x, y), ACCESS_FIELD(blocked, x, y))
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+
+    free_padded_image(direct);
+    free_padded_image(direct_buffer);
+    free_padded_image(blocked);
+    free_padded_image(blocked_buffer);
+}
+
+TEST(run_on_image, temporal_blocking_matches_direct) {
+    // several tiles in both directions
+    Image *img = pattern_image(300, 150);
+    Image *kernel = pattern_kernel(5, 5, 30.0);
+    // the number of iterations is no multiple of the steps, the last block is shorter
+    expect_temporal_blocking_is_exact(img, kernel, 7, 3);
+    // the halo is wider than a tile
+    expect_temporal_blocking_is_exact(img, kernel, 40, 40);
+
+    Image *laplace = get_2d_laplace_kernel();
+    expect_temporal_blocking_is_exact(img, laplace, 9, 4);
+
+    free_image(laplace);
+    free_image(kernel);
+    free_image(img);
+}
+
+TEST(run_on_image, temporal_blocking_requires_contiguous_layout) {
+    Image *img = init_image(10, 10, 1.0);
+    Image *kernel = get_default_kernel();
+    ImageWithPadding *rows = add_padding_with_layout(img, 2, LAYOUT_ROWS);
+    ImageWithPadding *contiguous = add_padding_with_layout(img, 2, LAYOUT_CONTIGUOUS);
+    ASSERT_FALSE(temporal_blocking_supported(rows, kernel));
+    ASSERT_TRUE(temporal_blocking_supported(contiguous, kernel));
+    ImageWithPadding *small = add_padding_with_layout(img, 1, LAYOUT_CONTIGUOUS);
+    ASSERT_FALSE(temporal_blocking_supported(small, kernel));
+
+    free_padded_image(rows);
+    free_padded_image(contiguous);
+    free_padded_image(small);
+    free_image(kernel);
+    free_image(img);
+}
@@ -0,0 +1,50 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef HG_C_BENCHMARKS_CONVOLUTION_TEST_HELPERS_H
+#define HG_C_BENCHMARKS_CONVOLUTION_TEST_HELPERS_H
+
+#include "../src/convolution/convolution-util.h"
+
+/**
+ * Image with the values ((x * 7 + y * 13 + seed) % 11) * scale + offset.
+ * The pattern repeats neither along a row nor along a column of a kernel window.
+ *
+ * @param width Width of the image
+ * @param height Height of the image
+ * @param offset Value added to every pixel
+ * @param scale Factor of the pattern
+ * @param seed Shift of the pattern, images with different seeds differ
+ * @return Image, must be freed with free_image(...)
+ */
+static Image *pattern_image(int width, int height, double offset = 0.0, double scale = 1.0, int seed = 0) {
+    Image *img = init_image(width, height, 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            img->image[y][x] = ((x * 7 + y * 13 + seed) % 11) * scale + offset;
+        }
+    }
+    return img;
+}
+
+/**
+ * Kernel with the values ((x * 5 + y * 3) % 7) / divisor + offset, it is neither symmetric nor separable
+ *
+ * @param width Width of the kernel
+ * @param height Height of the kernel
+ * @param divisor Divisor of the pattern
+ * @param offset Value added to every coefficient
+ * @return Kernel, must be freed with free_image(...)
+ */
+static Image *pattern_kernel(int width, int height, double divisor, double offset = 0.0) {
+    Image *kernel = init_image(width, height, 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            kernel->image[y][x] = ((x * 5 + y * 3) % 7) / divisor + offset;
+        }
+    }
+    return kernel;
+}
+
+#endif //HG_C_BENCHMARKS_CONVOLUTION_TEST_HELPERS_H
@@ -62,3 +62,38 @@ TEST(run_on_image, run_laplace_neutralizes_image) {
     free_image(laplace);
     free_image(img);
 }
+
+TEST(run_on_image, layouts_compute_same_result) {
+    Image *img = init_image(7, 5, 0);
+    for (int y = 0; y < 5; ++y) {
+        for (int x = 0; x < 7; ++x) {
+            img->image[y][x] = (x * 3 + y * 5) % 7;
+        }
+    }
+    Args args = {false, false, false, true, true, 3, 2, 7, 5, NULL, NULL};
+    Image *kernel = get_default_kernel();
+
+    args.layout = LAYOUT_ROWS;
+    ImageWithPadding *rows = add_padding_with_layout(img, 2, LAYOUT_ROWS);
+    ImageWithPadding *rows_buffer = add_padding_with_layout(img, 2, LAYOUT_ROWS);
+    run_on_padded_image(&rows, kernel, &args, &rows_buffer);
+
+    args.layout = LAYOUT_CONTIGUOUS;
+    ImageWithPadding *contiguous = add_padding_with_layout(img, 2, LAYOUT_CONTIGUOUS);
+    ImageWithPadding *contiguous_buffer = add_padding_with_layout(img, 2, LAYOUT_CONTIGUOUS);
+    run_on_padded_image(&contiguous, kernel, &args, &contiguous_buffer);
+
+    for (int y = 0; y < 5; ++y) {
+        for (int x = 0; x < 7; ++x) {
+            ASSERT_DOUBLE_EQ(ACCESS_IMAGE(rows, x, y), ACCESS_IMAGE(contiguous, x, y))
+                                        << "Following indices did not match: " << x << ", " << y;
+        }
+    }
+
+    free_padded_image(rows);
+    free_padded_image(rows_buffer);
+    free_padded_image(contiguous);
+    free_padded_image(contiguous_buffer);
+    free_image(kernel);
+    free_image(img);
+}
@@ -229,3 +229,94 @@ TEST(update_borders, check_if_borders_have_been_updated) {
 
     free_padded_image(padding);
 }
+
+TEST(init_image, contiguous_rows_are_aligned) {
+    Image *img = init_image_with_layout(13, 4, 2, LAYOUT_CONTIGUOUS);
+    ASSERT_EQ(16, img->stride);
+    for (int y = 0; y < 4; ++y) {
+        ASSERT_EQ(img->data + y * img->stride, img->image[y]);
+        ASSERT_EQ(0u, ((uintptr_t) img->image[y]) % IMAGE_ALIGNMENT);
+    }
+    ASSERT_EQ(2 * 13 * 4, get_checksum(img));
+
+    free_image(img);
+}
+
+TEST(init_padded_image, add_padding_layouts_match) {
+    Image *img = init_image(4, 3, 1);
+    for (int y = 0; y < 3; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            img->image[y][x] = x * 10 + y;
+        }
+    }
+    ImageWithPadding *rows = add_padding_with_layout(img, 2, LAYOUT_ROWS);
+    ImageWithPadding *contiguous = add_padding_with_layout(img, 2, LAYOUT_CONTIGUOUS);
+    ImageWithPadding *copy = init_padded_image_with_layout(4, 3, 2, LAYOUT_ROWS);
+    ASSERT_EQ(0, copy_padded_image(contiguous, copy));
+
+    for (int y = 0; y < rows->height; ++y) {
+        for (int x = 0; x < rows->width; ++x) {
+            ASSERT_EQ(ACCESS_FIELD(rows, x, y), ACCESS_FIELD(contiguous, x, y))
+                                        << "Following indices did not match: " << x << ", " << y;
+            ASSERT_EQ(ACCESS_FIELD(rows, x, y), ACCESS_DATA(contiguous, x, y));
+            ASSERT_EQ(ACCESS_FIELD(rows, x, y), ACCESS_FIELD(copy, x, y));
+        }
+    }
+    Image *restored = remove_padding(contiguous);
+    ASSERT_EQ(get_checksum(img), get_checksum(restored));
+
+    free_image(restored);
+    free_padded_image(copy);
+    free_padded_image(contiguous);
+    free_padded_image(rows);
+    free_image(img);
+}
+
+TEST(init_padded_image, first_touch_matches_serial_init) {
+    ImageLayout layouts[2] = {LAYOUT_CONTIGUOUS, LAYOUT_ROWS};
+    for (int l = 0; l < 2; ++l) {
+        ImageWithPadding *serial = init_padded_image_with_layout(37, 13, 2, layouts[l]);
+        ImageWithPadding *parallel = init_padded_image_first_touch(37, 13, 2, layouts[l], 3);
+        ASSERT_EQ(serial->stride, parallel->stride);
+        for (int y = 0; y < serial->height; ++y) {
+            for (int x = 0; x < serial->width; ++x) {
+                ASSERT_EQ(0.0, ACCESS_FIELD(parallel, x, y))
+                                            << "Following indices did not match: " << x << ", " << y;
+            }
+        }
+        // the padding rows of the rows layout alias the outer rows in both
+        ASSERT_EQ(parallel->image[0], parallel->image[layouts[l] == LAYOUT_ROWS ? 2 : 0]);
+        free_padded_image(serial);
+        free_padded_image(parallel);
+    }
+}
+
+TEST(update_channel_borders, channels_are_clamped_on_their_own) {
+    // two pixels of three channels per row
+    Image *img = init_image(6, 2, 0);
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 6; ++x) {
+            img->image[y][x] = 10 * y + x;
+        }
+    }
+    ChannelLayout layouts[2] = {CHANNELS_INTERLEAVED, CHANNELS_PLANAR};
+    for (int l = 0; l < 2; ++l) {
+        ChannelImage *channel_img = split_channels(img, 3, 2, layouts[l]);
+        ASSERT_EQ(2, channel_img->inner_width);
+        for (int c = 0; c < 3; ++c) {
+            for (int y = -2; y < 4; ++y) {
+                for (int x = -2; x < 4; ++x) {
+                    ASSERT_EQ(smart_access(img, 3 * clamp(0, x, 1) + c, y), ACCESS_CHANNEL(channel_img, c, x, y))
+                                                << "Following indices did not match: " << x << ", " << y
+                                                << " of channel " << c << " " << channel_layout_name(layouts[l]);
+                }
+            }
+        }
+        Image *merged = merge_channels(channel_img);
+        EXPECT_EQ(get_checksum(img), get_checksum(merged));
+        EXPECT_EQ(0 + 3 + 10 + 13, get_channel_checksum(channel_img, 0));
+        free_image(merged);
+        free_channel_image(channel_img);
+    }
+    free_image(img);
+}
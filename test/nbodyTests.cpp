@@ -1,3 +1,546 @@
 //
 // Created by baldr on 5/23/17.
-//
\ No newline at end of file
+//
+#include <gtest/gtest.h>
+#include "../src/nbody/nbody-run.h"
+#include "../src/nbody/nbody-simd.h"
+#include "../src/nbody/nbody-run.c"
+#include "../src/nbody/nbody-simd.c"
+#include "../src/nbody/nbody-tiled.c"
+#include "../src/nbody/nbody-morton.c"
+#include "../src/nbody/nbody-barnes-hut.c"
+#include "../src/nbody/nbody-integrator.c"
+#include "../src/nbody/nbody-mixed.c"
+#include "../src/nbody/nbody-grid.c"
+#include "../src/nbody/nbody-reorder.c"
+
+/**
+ * Fill planets and buffer like the main program does and run the given engine
+ */
+static Float3D *simulate_engine(Engine engine, int size, int iterations, int processes, double theta = 0.5) {
+    Float3D *planets = (Float3D *) malloc(sizeof(Float3D) * size);
+    Float3D *buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+    for (int i = 0; i < size; i++) {
+        fill_planet(&planets[i], i);
+    }
+    Args args = {size, iterations, processes, false, engine, 16, false, theta};
+    simulate(planets, buffer, &args);
+    free(buffer);
+    return planets;
+}
+
+/**
+ * Compare two simulations, the tolerance is relative to the largest coordinate,
+ * since accelerations that cancel out are only noise of the summation order
+ */
+static void expect_near_planets(Float3D *expected, Float3D *actual, int size, double relative) {
+    double scale = 1e-300;
+    for (int i = 0; i < size; i++) {
+        scale = fmax(scale, fmax(fabs(expected[i].x), fmax(fabs(expected[i].y), fabs(expected[i].z))));
+    }
+    for (int i = 0; i < size; i++) {
+        EXPECT_NEAR(expected[i].x, actual[i].x, relative * scale) << "index " << i;
+        EXPECT_NEAR(expected[i].y, actual[i].y, relative * scale) << "index " << i;
+        EXPECT_NEAR(expected[i].z, actual[i].z, relative * scale) << "index " << i;
+    }
+}
+
+TEST(nbody_run, simd_matches_scalar) {
+    int sizes[] = {1, 3, 13, 64};
+    for (int size : sizes) {
+        for (int iterations = 1; iterations <= 4; ++iterations) {
+            Float3D *expected = simulate_engine(ENGINE_SCALAR, size, iterations, 1);
+            Float3D *actual = simulate_engine(ENGINE_SIMD, size, iterations, 2);
+            expect_near_planets(expected, actual, size, 1e-9);
+            free(expected);
+            free(actual);
+        }
+    }
+}
+
+TEST(nbody_run, persistent_region_matches_simd) {
+    int sizes[] = {1, 3, 13, 64};
+    for (int size : sizes) {
+        for (int iterations = 0; iterations <= 4; ++iterations) {
+            Float3D *expected = (Float3D *) malloc(sizeof(Float3D) * size);
+            Float3D *expected_buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+            Float3D *actual = (Float3D *) malloc(sizeof(Float3D) * size);
+            Float3D *actual_buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+            fill_planets(expected, size, 1);
+            fill_planets(actual, size, 1);
+            run(expected, expected_buffer, size, iterations, 3);
+            run_persistent(actual, actual_buffer, size, iterations, 3);
+            // every body is computed by the same kernel, only the threads differ
+            for (int i = 0; i < size; i++) {
+                ASSERT_EQ(expected[i].x, actual[i].x) << "index " << i << " after " << iterations;
+                ASSERT_EQ(expected[i].y, actual[i].y) << "index " << i << " after " << iterations;
+                ASSERT_EQ(expected[i].z, actual[i].z) << "index " << i << " after " << iterations;
+            }
+            free(expected);
+            free(expected_buffer);
+            free(actual);
+            free(actual_buffer);
+        }
+    }
+}
+
+TEST(nbody_run, persistent_region_comparison_stays_within_the_bodies) {
+    // fewer bodies than the smallest size of the comparison
+    int sizes[] = {1, 2, 3, 13};
+    for (int size : sizes) {
+        Args args = {size, 2, 2, false, ENGINE_SIMD, 16, false, 0.5};
+        ASSERT_EQ(size, compare_persistent_region(&args));
+    }
+}
+
+TEST(nbody_simd, kernels_match_scalar_kernel) {
+    int size = 21;
+    Bodies *bodies = init_bodies(size);
+    Bodies *expected = init_bodies(size);
+    Bodies *actual = init_bodies(size);
+    for (int i = 0; i < size; i++) {
+        Float3D p;
+        fill_planet(&p, i);
+        bodies->x[i] = p.x;
+        bodies->y[i] = p.y;
+        bodies->z[i] = p.z;
+    }
+    AccelKernel kernels[] = {accel_soa_avx2, accel_soa_avx512};
+    bool supported[] = {simd_supports_avx2(), simd_supports_avx512()};
+    for (int i = 0; i < size; i++) {
+        accel_soa_scalar(bodies, expected, i);
+    }
+    for (int k = 0; k < 2; ++k) {
+        if (!supported[k]) {
+            continue;
+        }
+        for (int i = 0; i < size; i++) {
+            kernels[k](bodies, actual, i);
+            EXPECT_NEAR(expected->x[i], actual->x[i], 1e-12 * fabs(expected->x[i]) + 1e-15);
+            EXPECT_NEAR(expected->y[i], actual->y[i], 1e-12 * fabs(expected->y[i]) + 1e-15);
+            EXPECT_NEAR(expected->z[i], actual->z[i], 1e-12 * fabs(expected->z[i]) + 1e-15);
+        }
+    }
+    free_bodies(bodies);
+    free_bodies(expected);
+    free_bodies(actual);
+}
+
+TEST(nbody_run, symmetric_matches_scalar) {
+    int sizes[] = {1, 2, 9, 40};
+    for (int size : sizes) {
+        Float3D *expected = simulate_engine(ENGINE_SCALAR, size, 3, 1);
+        Float3D *actual = simulate_engine(ENGINE_SYMMETRIC, size, 3, 3);
+        expect_near_planets(expected, actual, size, 1e-9);
+        free(expected);
+        free(actual);
+    }
+}
+
+TEST(nbody_simd, symmetric_kernels_match_scalar_kernel) {
+    int size = 19;
+    Bodies *bodies = init_bodies(size);
+    Bodies *expected = init_bodies(size);
+    Bodies *actual = init_bodies(size);
+    for (int i = 0; i < size; i++) {
+        Float3D p;
+        fill_planet(&p, i);
+        bodies->x[i] = p.x;
+        bodies->y[i] = p.y - i * i;
+        bodies->z[i] = p.z;
+    }
+    for (int i = 0; i < size; i++) {
+        symmetric_accel_scalar(bodies, expected, i);
+    }
+    SymmetricAccelKernel kernels[] = {symmetric_accel_avx2, symmetric_accel_avx512};
+    bool supported[] = {simd_supports_avx2(), simd_supports_avx512()};
+    for (int k = 0; k < 2; ++k) {
+        if (!supported[k]) {
+            continue;
+        }
+        memset(actual->x, 0, sizeof(double) * actual->capacity);
+        memset(actual->y, 0, sizeof(double) * actual->capacity);
+        memset(actual->z, 0, sizeof(double) * actual->capacity);
+        for (int i = 0; i < size; i++) {
+            kernels[k](bodies, actual, i);
+        }
+        for (int i = 0; i < size; i++) {
+            EXPECT_NEAR(expected->x[i], actual->x[i], 1e-12);
+            EXPECT_NEAR(expected->y[i], actual->y[i], 1e-12);
+            EXPECT_NEAR(expected->z[i], actual->z[i], 1e-12);
+        }
+        // the padding must never be written
+        for (int i = size; i < actual->capacity; i++) {
+            ASSERT_EQ(0.0, actual->x[i]);
+        }
+    }
+    free_bodies(bodies);
+    free_bodies(expected);
+    free_bodies(actual);
+}
+
+TEST(nbody_run, tiled_matches_scalar) {
+    int sizes[] = {5, 16, 37};
+    for (int size : sizes) {
+        Float3D *expected = simulate_engine(ENGINE_SCALAR, size, 3, 1);
+        Float3D *actual = simulate_engine(ENGINE_TILED, size, 3, 2);
+        expect_near_planets(expected, actual, size, 1e-9);
+        free(expected);
+        free(actual);
+    }
+}
+
+TEST(nbody_morton, radix_sort_is_stable) {
+    int size = 1000;
+    uint64_t keys[1000], tmp_keys[1000];
+    int values[1000], tmp_values[1000];
+    for (int i = 0; i < size; i++) {
+        keys[i] = ((uint64_t) (i * 7919 % 113)) << 40 | (uint64_t) (i % 5);
+        values[i] = i;
+    }
+    radix_sort_pairs(keys, values, tmp_keys, tmp_values, size, MORTON_KEY_BITS, 3);
+    for (int i = 1; i < size; i++) {
+        ASSERT_LE(keys[i - 1], keys[i]);
+        if (keys[i - 1] == keys[i]) {
+            ASSERT_LT(values[i - 1], values[i]);
+        }
+    }
+}
+
+TEST(nbody_morton, morton_encode_interleaves) {
+    ASSERT_EQ(4u, morton_encode(1, 0, 0));
+    ASSERT_EQ(2u, morton_encode(0, 1, 0));
+    ASSERT_EQ(1u, morton_encode(0, 0, 1));
+    ASSERT_EQ(7u << 3, morton_encode(2, 2, 2));
+    ASSERT_EQ((1ULL << MORTON_KEY_BITS) - 1, morton_encode(0x1fffff, 0x1fffff, 0x1fffff));
+}
+
+TEST(nbody_morton, hilbert_curve_steps_to_neighbours) {
+    // the curve fills the cube at the origin before it leaves it, so the first 512 indices are its cells
+    int side = 8;
+    int cells = side * side * side;
+    int *at = (int *) malloc(sizeof(int) * cells);
+    for (int i = 0; i < cells; i++) {
+        at[i] = -1;
+    }
+    for (int x = 0; x < side; x++) {
+        for (int y = 0; y < side; y++) {
+            for (int z = 0; z < side; z++) {
+                uint64_t key = hilbert_encode(x, y, z);
+                ASSERT_LT(key, (uint64_t) cells);
+                ASSERT_EQ(-1, at[key]);
+                at[key] = (x * side + y) * side + z;
+            }
+        }
+    }
+    for (int i = 1; i < cells; i++) {
+        int dx = abs(at[i] / (side * side) - at[i - 1] / (side * side));
+        int dy = abs(at[i] / side % side - at[i - 1] / side % side);
+        int dz = abs(at[i] % side - at[i - 1] % side);
+        ASSERT_EQ(1, dx + dy + dz) << "index " << i;
+    }
+    free(at);
+}
+
+TEST(nbody_run, barnes_hut_with_zero_theta_is_exact) {
+    int size = 300;
+    Float3D *expected = simulate_engine(ENGINE_SCALAR, size, 2, 1);
+    Float3D *actual = simulate_engine(ENGINE_BARNES_HUT, size, 2, 2, 0.0);
+    expect_near_planets(expected, actual, size, 1e-9);
+    free(expected);
+    free(actual);
+}
+
+TEST(nbody_run, barnes_hut_stays_within_error_bound) {
+    Args args = {2000, 1, 2, false, ENGINE_BARNES_HUT, 16, false, 0.5};
+    ASSERT_LT(single_step_error(&args), 5e-3);
+    args.theta = 0.0;
+    ASSERT_LT(single_step_error(&args), 1e-12);
+}
+
+/**
+ * Bodies of different masses on a small cloud, with some initial velocity
+ */
+static BodyState *integrator_test_state(int size) {
+    BodyState *state = init_body_state(size, 2);
+    for (int i = 0; i < size; i++) {
+        state->position->x[i] = (i * 7 % 11) * 0.5;
+        state->position->y[i] = (i * 5 % 13) * 0.25;
+        state->position->z[i] = (i * 3 % 7) * 0.75;
+        state->velocity->x[i] = (i % 3) * 0.1;
+        state->velocity->y[i] = -(i % 5) * 0.05;
+        state->velocity->z[i] = 0.02 * i;
+        state->mass[i] = 1.0 + (i % 4) * 0.5;
+    }
+    return state;
+}
+
+TEST(nbody_integrator, fused_steps_match_kick_drift_kick) {
+    int size = 19;
+    int steps = 5;
+    double dt = 0.001;
+    BodyState *state = integrator_test_state(size);
+    double *x = (double *) malloc(sizeof(double) * 3 * size);
+    double *v = (double *) malloc(sizeof(double) * 3 * size);
+    double *a = (double *) malloc(sizeof(double) * 3 * size);
+    for (int i = 0; i < size; i++) {
+        x[3 * i] = state->position->x[i];
+        x[3 * i + 1] = state->position->y[i];
+        x[3 * i + 2] = state->position->z[i];
+        v[3 * i] = state->velocity->x[i];
+        v[3 * i + 1] = state->velocity->y[i];
+        v[3 * i + 2] = state->velocity->z[i];
+    }
+    // textbook kick-drift-kick with a separate sweep for every stage
+    for (int step = 0; step < steps; step++) {
+        for (int half = 0; half < 2; half++) {
+            for (int i = 0; i < size; i++) {
+                double acc[3] = {0.0, 0.0, 0.0};
+                for (int j = 0; j < size; j++) {
+                    double d[3] = {x[3 * j] - x[3 * i], x[3 * j + 1] - x[3 * i + 1], x[3 * j + 2] - x[3 * i + 2]};
+                    double distance_sq = d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + EPS;
+                    double factor = state->mass[j] / sqrt(distance_sq * distance_sq * distance_sq);
+                    for (int k = 0; k < 3; k++) {
+                        acc[k] += d[k] * factor;
+                    }
+                }
+                for (int k = 0; k < 3; k++) {
+                    a[3 * i + k] = G * acc[k];
+                }
+            }
+            for (int i = 0; i < 3 * size; i++) {
+                v[i] += 0.5 * dt * a[i];
+            }
+            if (half == 0) {
+                for (int i = 0; i < 3 * size; i++) {
+                    x[i] += dt * v[i];
+                }
+            }
+        }
+    }
+    run_leapfrog_state(state, steps, dt, 2, mass_accel_scalar);
+    for (int i = 0; i < size; i++) {
+        EXPECT_NEAR(x[3 * i], state->position->x[i], 1e-12) << "index " << i;
+        EXPECT_NEAR(x[3 * i + 1], state->position->y[i], 1e-12) << "index " << i;
+        EXPECT_NEAR(x[3 * i + 2], state->position->z[i], 1e-12) << "index " << i;
+        EXPECT_NEAR(v[3 * i], state->velocity->x[i], 1e-10) << "index " << i;
+        EXPECT_NEAR(v[3 * i + 1], state->velocity->y[i], 1e-10) << "index " << i;
+        EXPECT_NEAR(v[3 * i + 2], state->velocity->z[i], 1e-10) << "index " << i;
+    }
+    free(x);
+    free(v);
+    free(a);
+    free_body_state(state);
+}
+
+TEST(nbody_integrator, mass_kernels_match_scalar_kernel) {
+    int size = 21;
+    BodyState *state = integrator_test_state(size);
+    MassAccelKernel kernels[] = {mass_accel_avx2, mass_accel_avx512};
+    bool supported[] = {simd_supports_avx2(), simd_supports_avx512()};
+    for (int k = 0; k < 2; ++k) {
+        if (!supported[k]) {
+            continue;
+        }
+        for (int i = 0; i < size; i++) {
+            double expected[3];
+            double actual[3];
+            mass_accel_scalar(state, i, expected);
+            kernels[k](state, i, actual);
+            for (int c = 0; c < 3; ++c) {
+                EXPECT_NEAR(expected[c], actual[c], 1e-12 * fabs(expected[c]) + 1e-12) << "index " << i;
+            }
+        }
+    }
+    free_body_state(state);
+}
+
+TEST(nbody_integrator, energy_of_an_orbit_is_conserved) {
+    // two equal bodies on a circular orbit around their center of mass
+    BodyState *state = init_body_state(2, 1);
+    double radius = 1.0;
+    double distance_sq = 4.0 * radius * radius + EPS;
+    double speed = sqrt(G * 2.0 * radius * radius / (distance_sq * sqrt(distance_sq)));
+    state->position->x[0] = -radius;
+    state->position->x[1] = radius;
+    state->velocity->y[0] = -speed;
+    state->velocity->y[1] = speed;
+    state->mass[0] = 1.0;
+    state->mass[1] = 1.0;
+    double before = total_energy(state, 1);
+    // about two revolutions
+    run_leapfrog_state(state, 8000, 0.001, 1, select_mass_accel_kernel());
+    double after = total_energy(state, 1);
+    EXPECT_LT(fabs(after - before) / fabs(before), 1e-6);
+    // the orbit stays circular
+    double dx = state->position->x[1] - state->position->x[0];
+    double dy = state->position->y[1] - state->position->y[0];
+    EXPECT_NEAR(2.0 * radius, sqrt(dx * dx + dy * dy), 1e-3);
+    free_body_state(state);
+}
+
+TEST(nbody_mixed, mixed_kernels_match_scalar_kernel) {
+    int sizes[] = {1, 13, 37};
+    for (int size : sizes) {
+        FloatBodies *bodies = init_float_bodies(size, 1);
+        for (int i = 0; i < size; i++) {
+            bodies->x[i] = (float) (i * 1.0);
+            bodies->y[i] = (float) (i * 0.2 - 3.0);
+            bodies->z[i] = (float) (i * 30.0);
+        }
+        MixedAccelKernel kernels[] = {mixed_accel_avx2, mixed_accel_avx512};
+        bool supported[] = {simd_supports_avx2(), simd_supports_avx512()};
+        for (int k = 0; k < 2; ++k) {
+            if (!supported[k]) {
+                continue;
+            }
+            for (int i = 0; i < size; i++) {
+                double expected[3];
+                double actual[3];
+                mixed_accel_scalar(bodies, i, expected);
+                kernels[k](bodies, i, actual);
+                // the refined rsqrt is accurate to a few ulp of a float
+                for (int c = 0; c < 3; ++c) {
+                    EXPECT_NEAR(expected[c], actual[c], 1e-5 * fabs(expected[c]) + 1e-9) << "index " << i;
+                }
+            }
+        }
+        free_float_bodies(bodies);
+    }
+}
+
+TEST(nbody_run, mixed_stays_close_to_simd) {
+    int size = 100;
+    Float3D *expected = (Float3D *) malloc(sizeof(Float3D) * size);
+    Float3D *expected_buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+    Float3D *actual = (Float3D *) malloc(sizeof(Float3D) * size);
+    Float3D *actual_buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+    fill_planets(expected, size, 1);
+    fill_planets(actual, size, 1);
+    run(expected, expected_buffer, size, 1, 2);
+    run_mixed(actual, actual_buffer, size, 1, 2);
+    EXPECT_LT(max_relative_error(expected, actual, size), 1e-5);
+    free(expected);
+    free(expected_buffer);
+    free(actual);
+    free(actual_buffer);
+}
+
+static Bodies *grid_test_bodies(int size) {
+    Bodies *bodies = init_bodies(size);
+    // a deterministic cloud with dense and sparse regions
+    unsigned int seed = 7;
+    for (int i = 0; i < size; i++) {
+        seed = seed * 1103515245u + 12345u;
+        bodies->x[i] = (seed >> 8) % 1000 / 100.0;
+        seed = seed * 1103515245u + 12345u;
+        bodies->y[i] = (seed >> 8) % 1000 / 100.0 * (i % 3 == 0 ? 0.1 : 1.0);
+        seed = seed * 1103515245u + 12345u;
+        bodies->z[i] = (seed >> 8) % 1000 / 100.0;
+    }
+    return bodies;
+}
+
+TEST(nbody_grid, counting_sort_is_stable) {
+    int size = 500;
+    Bodies *bodies = grid_test_bodies(size);
+    CellGrid *grid = init_cell_grid(size, 3);
+    build_cell_grid(grid, bodies, 1.5, 3);
+    int cells = grid->cells_x * grid->cells_y * grid->cells_z;
+    ASSERT_LE(cells, grid->max_cells);
+    ASSERT_GE(grid->cell_size, 1.5);
+    ASSERT_EQ(0, grid->cell_start[0]);
+    ASSERT_EQ(size, grid->cell_start[cells]);
+    for (int cell = 0; cell < cells; cell++) {
+        for (int i = grid->cell_start[cell]; i < grid->cell_start[cell + 1]; i++) {
+            int index = grid->index[i];
+            ASSERT_EQ(cell, grid->cell_of[index]) << "sorted body " << i;
+            ASSERT_EQ(bodies->x[index], grid->sorted->x[i]);
+            if (i > grid->cell_start[cell]) {
+                ASSERT_LT(grid->index[i - 1], index) << "sorted body " << i;
+            }
+        }
+    }
+    free_cell_grid(grid);
+    free_bodies(bodies);
+}
+
+TEST(nbody_grid, grid_matches_direct_cutoff_sum) {
+    int size = 300;
+    Bodies *bodies = grid_test_bodies(size);
+    Bodies *expected = init_bodies(size);
+    Bodies *actual = init_bodies(size);
+    double cutoffs[] = {0.8, 2.5, 1e9};
+    for (double cutoff : cutoffs) {
+        for (int i = 0; i < size; i++) {
+            double acc[3] = {0.0, 0.0, 0.0};
+            for (int j = 0; j < size; j++) {
+                double dx = bodies->x[j] - bodies->x[i];
+                double dy = bodies->y[j] - bodies->y[i];
+                double dz = bodies->z[j] - bodies->z[i];
+                if (dx * dx + dy * dy + dz * dz <= cutoff * cutoff) {
+                    double distance_sq = dx * dx + dy * dy + dz * dz + EPS;
+                    double factor = 1.0 / sqrt(distance_sq * distance_sq * distance_sq);
+                    acc[0] += dx * factor;
+                    acc[1] += dy * factor;
+                    acc[2] += dz * factor;
+                }
+            }
+            expected->x[i] = G * acc[0];
+            expected->y[i] = G * acc[1];
+            expected->z[i] = G * acc[2];
+        }
+        Bodies *planets = init_bodies(size);
+        memcpy(planets->x, bodies->x, sizeof(double) * size);
+        memcpy(planets->y, bodies->y, sizeof(double) * size);
+        memcpy(planets->z, bodies->z, sizeof(double) * size);
+        run_grid_soa(planets, actual, 1, 2, cutoff);
+        for (int i = 0; i < size; i++) {
+            EXPECT_NEAR(expected->x[i], actual->x[i], 1e-9 * fabs(expected->x[i]) + 1e-9) << "cutoff " << cutoff;
+            EXPECT_NEAR(expected->y[i], actual->y[i], 1e-9 * fabs(expected->y[i]) + 1e-9) << "cutoff " << cutoff;
+            EXPECT_NEAR(expected->z[i], actual->z[i], 1e-9 * fabs(expected->z[i]) + 1e-9) << "cutoff " << cutoff;
+        }
+        free_bodies(planets);
+    }
+    free_bodies(bodies);
+    free_bodies(expected);
+    free_bodies(actual);
+}
+
+TEST(nbody_run, reordered_engines_match_original_order) {
+    int size = 77;
+    Engine engines[] = {ENGINE_SIMD, ENGINE_BARNES_HUT, ENGINE_GRID};
+    Curve curves[] = {CURVE_MORTON, CURVE_HILBERT};
+    for (Engine engine : engines) {
+        for (Curve curve : curves) {
+            for (int interval = 1; interval <= 2; ++interval) {
+                for (int iterations = 0; iterations <= 3; ++iterations) {
+                    Args args = {size, iterations, 2, false, engine, 16, false, 0.0, false, PIN_NONE,
+                                 DEFAULT_TIME_STEP, false, 1e9, 0, curve};
+                    Float3D *expected = (Float3D *) malloc(sizeof(Float3D) * size);
+                    Float3D *expected_buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+                    Float3D *actual = (Float3D *) malloc(sizeof(Float3D) * size);
+                    Float3D *actual_buffer = (Float3D *) malloc(sizeof(Float3D) * size);
+                    fill_planets(expected, size, 1);
+                    fill_planets(actual, size, 1);
+                    simulate(expected, expected_buffer, &args);
+                    args.reorder_interval = interval;
+                    simulate(actual, actual_buffer, &args);
+                    // only the order of the sums differs
+                    EXPECT_LT(max_relative_error(expected, actual, size), 1e-9)
+                                        << engine_name(engine) << " " << curve_name(curve) << " every " << interval
+                                        << " after " << iterations;
+                    if (iterations > 0) {
+                        EXPECT_LT(max_relative_error(expected_buffer, actual_buffer, size), 1e-9)
+                                            << engine_name(engine) << " " << curve_name(curve) << " every "
+                                            << interval << " after " << iterations;
+                    }
+                    free(expected);
+                    free(expected_buffer);
+                    free(actual);
+                    free(actual_buffer);
+                }
+            }
+        }
+    }
+}
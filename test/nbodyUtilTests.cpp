@@ -4,9 +4,54 @@
 
 #include <gtest/gtest.h>
 #include "../src/nbody/nbody-util.h"
+#include "../src/nbody/nbody-util.c"
 
 
 TEST(nbody_util, fill_planet) {
     // dummy test for now
     ASSERT_EQ(1, 1);
 }
+
+TEST(nbody_util, bodies_are_padded_and_aligned) {
+    Bodies *bodies = init_bodies(11);
+    ASSERT_EQ(11, bodies->size);
+    ASSERT_EQ(16, bodies->capacity);
+    ASSERT_EQ(0u, ((uintptr_t) bodies->x) % BODY_ALIGNMENT);
+    ASSERT_EQ(0u, ((uintptr_t) bodies->y) % BODY_ALIGNMENT);
+    ASSERT_EQ(0u, ((uintptr_t) bodies->z) % BODY_ALIGNMENT);
+    for (int i = 0; i < bodies->capacity; ++i) {
+        ASSERT_EQ(0.0, bodies->x[i]);
+    }
+    free_bodies(bodies);
+}
+
+TEST(nbody_util, bodies_round_trip) {
+    Float3D planets[5];
+    Float3D restored[5];
+    for (int i = 0; i < 5; i++) {
+        fill_planet(&planets[i], i);
+    }
+    Bodies *bodies = init_bodies(5);
+    float3d_to_bodies(planets, bodies);
+    ASSERT_EQ(0.8, bodies->y[4]);
+    bodies_to_float3d(bodies, restored);
+    for (int i = 0; i < 5; i++) {
+        ASSERT_EQ(planets[i].x, restored[i].x);
+        ASSERT_EQ(planets[i].y, restored[i].y);
+        ASSERT_EQ(planets[i].z, restored[i].z);
+    }
+    free_bodies(bodies);
+}
+
+TEST(nbody_util, first_touched_bodies_are_zeroed) {
+    Bodies *bodies = init_bodies_first_touch(1001, 3);
+    ASSERT_EQ(1001, bodies->size);
+    ASSERT_EQ(1008, bodies->capacity);
+    ASSERT_EQ(0u, ((uintptr_t) bodies->x) % BODY_ALIGNMENT);
+    for (int i = 0; i < bodies->capacity; ++i) {
+        ASSERT_EQ(0.0, bodies->x[i]);
+        ASSERT_EQ(0.0, bodies->y[i]);
+        ASSERT_EQ(0.0, bodies->z[i]);
+    }
+    free_bodies(bodies);
+}
@@ -4,6 +4,8 @@
 #include <gtest/gtest.h>
 #include "../src/util/util.c"
 #include "../src/util/util.h"
+#include "../src/util/numa.c"
+#include "../src/util/barrier.c"
 
 
 TEST(clamper, clamp) {
@@ -15,3 +17,104 @@ TEST(clamper, clamp) {
     ASSERT_EQ(5, clamp(0, 5, 6));
     ASSERT_EQ(-7, clamp(-10, -7, -5));
 }
+
+TEST(numa, threads_are_placed_compact_and_scatter) {
+    // two sockets with interleaved core numbers, like most dual socket nodes
+    int cpus[6] = {0, 1, 2, 3, 4, 5};
+    int sockets[6] = {0, 1, 0, 1, 0, 1};
+    int placement[8];
+    place_threads(cpus, sockets, 6, PIN_COMPACT, 4, placement);
+    int compact[4] = {0, 2, 4, 1};
+    for (int t = 0; t < 4; ++t) {
+        ASSERT_EQ(compact[t], placement[t]) << "Following thread did not match: " << t;
+    }
+    // more threads than cores reuse them in the same order
+    place_threads(cpus, sockets, 6, PIN_SCATTER, 8, placement);
+    int scatter[8] = {0, 1, 2, 3, 4, 5, 0, 1};
+    for (int t = 0; t < 8; ++t) {
+        ASSERT_EQ(scatter[t], placement[t]) << "Following thread did not match: " << t;
+    }
+}
+
+TEST(numa, scatter_skips_sockets_without_cores) {
+    int cpus[3] = {4, 5, 9};
+    int sockets[3] = {2, 2, 0};
+    int placement[4];
+    place_threads(cpus, sockets, 3, PIN_SCATTER, 4, placement);
+    int expected[4] = {9, 4, 9, 5};
+    for (int t = 0; t < 4; ++t) {
+        ASSERT_EQ(expected[t], placement[t]) << "Following thread did not match: " << t;
+    }
+}
+
+TEST(numa, pinned_threads_run_on_their_core) {
+    cpu_set_t allowed;
+    ASSERT_EQ(0, sched_getaffinity(0, sizeof(cpu_set_t), &allowed));
+    ThreadPlacement *placement = pin_threads(PIN_COMPACT, 2);
+    ASSERT_EQ(2, placement->threads);
+    ASSERT_GE(placement->sockets, 1);
+    int moved = 0;
+#pragma omp parallel num_threads(2) reduction(+:moved)
+    {
+        moved += sched_getcpu() != placement->cpu[omp_get_thread_num()];
+    }
+    EXPECT_EQ(0, moved);
+    for (int t = 0; t < 2; ++t) {
+        EXPECT_GE(placement->cpu[t], 0);
+        EXPECT_EQ(cpu_socket(placement->cpu[t]), placement->socket[t]);
+        EXPECT_GE(placement->node[t], 0);
+        EXPECT_LT(placement->node[t], placement->nodes);
+    }
+    free_thread_placement(placement);
+    // release the threads again, the other tests do not expect them to be pinned
+#pragma omp parallel num_threads(2)
+    {
+        sched_setaffinity(0, sizeof(cpu_set_t), &allowed);
+    }
+}
+
+TEST(numa, page_nodes_of_touched_pages) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    char *data = (char *) aligned_alloc(page_size, 4 * page_size);
+    data[0] = 1;
+    data[2 * page_size + 5] = 1;
+    int *nodes = NULL;
+    long count = page_nodes(data, 4 * page_size, &nodes);
+    // systems without move_pages report no nodes
+    if (count >= 0) {
+        ASSERT_EQ(4, count);
+        EXPECT_GE(nodes[0], 0);
+        EXPECT_LT(nodes[1], 0);
+        EXPECT_GE(nodes[2], 0);
+        EXPECT_LT(nodes[3], 0);
+        free(nodes);
+    }
+    // a range that does not start at a page boundary covers the pages it overlaps
+    count = page_nodes(data + page_size - 1, 2, &nodes);
+    if (count >= 0) {
+        ASSERT_EQ(2, count);
+        free(nodes);
+    }
+    free(data);
+}
+
+TEST(spin_barrier, no_thread_passes_before_all_arrived) {
+    int threads = 4;
+    int rounds = 200;
+    int arrived[200] = {0};
+    int early = 0;
+    SpinBarrier barrier;
+    init_spin_barrier(&barrier, threads);
+#pragma omp parallel num_threads(threads) reduction(+:early)
+    {
+        int sense = 0;
+        for (int r = 0; r < rounds; ++r) {
+            __atomic_add_fetch(&arrived[r], 1, __ATOMIC_RELAXED);
+            spin_barrier_wait(&barrier, &sense);
+            early += __atomic_load_n(&arrived[r], __ATOMIC_RELAXED) != threads;
+        }
+    }
+    EXPECT_EQ(0, early);
+    // the barrier is ready for the next episode
+    EXPECT_EQ(threads, barrier.count);
+}